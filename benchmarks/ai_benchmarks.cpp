@@ -1,4 +1,45 @@
 #include <benchmark/benchmark.h>
+#include <cortan/ai/context_manager.hpp>
+#include <cortan/ai/input_validator.hpp>
+#include <cortan/ai/model_manager.hpp>
+#include <cortan/ai/ollama_client.hpp>
+#include <cortan/ai/response_aggregator.hpp>
+#include <cortan/ai/security_manager.hpp>
+#include <cortan/core/alloc_tracking.hpp>
+#include <cortan/core/request_arena.hpp>
+#include "mock_ollama_server.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace cortan;
+using core::alloc_tracking::AllocationScope;
+using core::alloc_tracking::Subsystem;
+
+namespace {
+
+constexpr const char* kPrompt =
+    "  Summarize the attached design notes for the event bus, highlighting\n"
+    "\tany allocation on the publish path and proposing a fix.\x01  ";
+
+struct PipelineFixture {
+    ai::test_support::MockOllamaServer ollama;
+    ai::InputValidator validator;
+    ai::ContextManager context;
+    ai::ModelManager models;
+    ai::ResponseAggregator aggregator;
+
+    PipelineFixture() {
+        context.set_context("user", "rishab");
+        context.set_context("session", "bench-session-0001");
+        context.set_context("location", "mission_control");
+        models.addModel(std::make_unique<ai::OllamaModel>("llama3:8b", ollama.endpoint()));
+    }
+};
+
+} // namespace
 
 // AI model processing simulation
 static void BM_AIModelProcessing(benchmark::State& state) {
@@ -12,10 +53,10 @@ BENCHMARK(BM_AIModelProcessing);
 
 // Input validation benchmark
 static void BM_InputValidation(benchmark::State& state) {
+    ai::InputValidator validator;
     for (auto _ : state) {
-        // TODO: Implement input validation benchmarking when input validator is implemented
-        volatile int dummy = 0;
-        benchmark::DoNotOptimize(dummy);
+        auto sanitized = validator.sanitize_input(std::string(kPrompt));
+        benchmark::DoNotOptimize(sanitized);
     }
 }
 BENCHMARK(BM_InputValidation);
@@ -30,4 +71,303 @@ static void BM_ConversationProcessing(benchmark::State& state) {
 }
 BENCHMARK(BM_ConversationProcessing);
 
+// ============================================================================
+// Request pipeline: heap strings vs per-request arena
+// ============================================================================
+
+// validate -> sanitize -> render context -> model -> aggregate, with every
+// stage allocating its own std::string temporaries
+static void BM_RequestPipelineHeap(benchmark::State& state) {
+    PipelineFixture pipeline;
+    size_t allocations = 0;
+
+    for (auto _ : state) {
+        AllocationScope scope(Subsystem::AI);
+
+        std::string prompt(kPrompt);
+        auto sanitized = pipeline.validator.sanitize_input(prompt);
+        std::string full_prompt;
+        for (const auto& key : {"location", "session", "user"}) {
+            full_prompt += std::string(key) + ": " + pipeline.context.get_context(key) + "\n";
+        }
+        full_prompt += "\n" + sanitized;
+        auto [ok, response] = pipeline.models.processRequest("llama3:8b", full_prompt).get();
+        pipeline.aggregator.add_response("task", response);
+        auto aggregated = pipeline.aggregator.get_aggregated_response("task");
+        pipeline.aggregator.clear_responses("task");
+        benchmark::DoNotOptimize(aggregated);
+
+        allocations += scope.allocations();
+    }
+
+    state.counters["allocs_per_request"] =
+        benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_RequestPipelineHeap)->UseRealTime();
+
+// Same pipeline with every transient string in one RequestArena
+static void BM_RequestPipelineArena(benchmark::State& state) {
+    PipelineFixture pipeline;
+    size_t allocations = 0;
+    size_t arena_bytes = 0;
+
+    for (auto _ : state) {
+        AllocationScope scope(Subsystem::AI);
+
+        auto arena = std::make_shared<core::RequestArena>();
+        auto sanitized = pipeline.validator.sanitize_input(kPrompt, *arena);
+        auto full_prompt = pipeline.context.build_prompt(sanitized, *arena);
+        auto [ok, response] = pipeline.models.processRequest("llama3:8b", full_prompt, arena).get();
+        pipeline.aggregator.add_response("task", response);
+        auto aggregated = pipeline.aggregator.get_aggregated_response("task", *arena);
+        pipeline.aggregator.clear_responses("task");
+        benchmark::DoNotOptimize(aggregated);
+        arena_bytes += arena->bytes_allocated();
+
+        allocations += scope.allocations();
+    }
+
+    state.counters["allocs_per_request"] =
+        benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+    state.counters["arena_bytes"] =
+        benchmark::Counter(static_cast<double>(arena_bytes), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_RequestPipelineArena)->UseRealTime();
+
+// ============================================================================
+// Ollama streaming
+// ============================================================================
+
+// Client-side time to first token against the local mock, which starts
+// answering at once and then paces tokens 1ms apart like a fast model:
+// request encoding, the loopback round trip and NDJSON decoding. Iteration
+// time is the first-token latency; the whole 16-token reply is reported
+// alongside.
+static void BM_OllamaTimeToFirstToken(benchmark::State& state) {
+    ai::test_support::MockOllamaServer::Script script;
+    script.tokens.assign(16, " token");
+    script.token_interval = std::chrono::milliseconds(1);
+    ai::test_support::MockOllamaServer server(script);
+    ai::OllamaClient client(server.endpoint());
+    double total_seconds = 0;
+
+    for (auto _ : state) {
+        auto started = std::chrono::steady_clock::now();
+        auto result = client.generate("llama3:8b", kPrompt, [](std::string_view) { return true; }).get();
+        total_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        if (!result.success) {
+            state.SkipWithError(result.error.c_str());
+            break;
+        }
+        state.SetIterationTime(std::chrono::duration<double>(result.stats.time_to_first_token).count());
+    }
+
+    state.counters["full_reply_us"] =
+        benchmark::Counter(total_seconds * 1e6, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_OllamaTimeToFirstToken)->UseManualTime()->Unit(benchmark::kMicrosecond);
+
+// NDJSON line decoding, DOM vs SAX. Each iteration decodes a whole
+// 64-token /api/generate stream; the argument is the length of the
+// "context" token array on its final line, which /api/generate sends back
+// in full and grows with the conversation.
+namespace {
+
+std::vector<std::string> ollama_stream_lines(size_t context_length) {
+    ai::test_support::MockOllamaServer::Script script;
+    script.tokens.assign(64, " token");
+    script.context_length = context_length;
+    auto stream = ai::test_support::MockOllamaServer::generate_stream(script);
+
+    std::vector<std::string> lines;
+    for (size_t start = 0, end; (end = stream.find('\n', start)) != std::string::npos; start = end + 1) {
+        lines.push_back(stream.substr(start, end - start));
+    }
+    return lines;
+}
+
+// The straightforward decode: build the line's whole object, then look up
+// the few fields the client needs
+bool decode_line_dom(std::string_view line, ai::OllamaLine& out) {
+    auto json = nlohmann::json::parse(line, nullptr, false);
+    if (json.is_discarded() || !json.is_object()) return false;
+    out.token = json.value("response", "");
+    out.done = json.value("done", false);
+    out.eval_count = json.value("eval_count", uint64_t{0});
+    out.prompt_eval_count = json.value("prompt_eval_count", uint64_t{0});
+    out.total_duration_ns = json.value("total_duration", uint64_t{0});
+    out.eval_duration_ns = json.value("eval_duration", uint64_t{0});
+    return true;
+}
+
+template<typename Decode>
+void run_line_decode(benchmark::State& state, Decode decode) {
+    const auto lines = ollama_stream_lines(static_cast<size_t>(state.range(0)));
+    size_t bytes = 0;
+    for (const auto& line : lines) bytes += line.size() + 1;
+
+    ai::OllamaLine out;
+    size_t allocations = 0;
+    for (auto _ : state) {
+        AllocationScope scope(Subsystem::AI);
+        for (const auto& line : lines) {
+            bool ok = decode(line, out);
+            benchmark::DoNotOptimize(ok);
+            benchmark::DoNotOptimize(out.token.data());
+        }
+        allocations += scope.allocations();
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+    state.counters["allocs_per_line"] = benchmark::Counter(
+        static_cast<double>(allocations) / static_cast<double>(lines.size()), benchmark::Counter::kAvgIterations);
+}
+
+} // namespace
+
+static void BM_OllamaLineDecodeDom(benchmark::State& state) {
+    run_line_decode(state, decode_line_dom);
+}
+BENCHMARK(BM_OllamaLineDecodeDom)->Arg(16)->Arg(4096);
+
+static void BM_OllamaLineDecodeSax(benchmark::State& state) {
+    run_line_decode(state, &ai::OllamaStreamParser::decode);
+}
+BENCHMARK(BM_OllamaLineDecodeSax)->Arg(16)->Arg(4096);
+
+// ============================================================================
+// Admission control
+// ============================================================================
+
+// Per-request cost of the rate limiter and in-flight slots as threads grow.
+// Arg 0: every thread has its own user; arg 1: all threads share one user,
+// so they contend on a single bucket.
+static void BM_AdmitRequest(benchmark::State& state) {
+    static ai::SecurityManager security([] {
+        ai::RateLimitConfig config;
+        config.requests_per_second = 1e9;   // measure the check, not refusals
+        config.burst = 1e6;
+        config.max_in_flight_per_user = 1024;
+        config.max_in_flight_global = 1024;
+        return config;
+    }());
+    const std::string user = state.range(0) == 0 ? "user-" + std::to_string(state.thread_index()) : "shared";
+    size_t admitted = 0;
+
+    for (auto _ : state) {
+        auto permit = security.admit_request(user);
+        if (permit) ++admitted;
+        benchmark::DoNotOptimize(permit);
+    }
+
+    state.counters["admitted"] =
+        benchmark::Counter(static_cast<double>(admitted), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_AdmitRequest)->Arg(0)->Arg(1)->ThreadRange(1, 8)->UseRealTime();
+
+namespace {
+
+ai::SecurityPolicy bench_policy() {
+    std::string roles = R"({"roles": {"operator": [)";
+    for (int i = 0; i < 64; ++i) {
+        roles += (i ? ",\"action." : "\"action.") + std::to_string(i) + "\"";
+    }
+    return ai::SecurityPolicy::parse(roles + R"(]}, "default_roles": ["operator"]})");
+}
+
+} // namespace
+
+// Compiled policy alone: two hash lookups and a bit test
+static void BM_PolicyLookup(benchmark::State& state) {
+    auto policy = bench_policy();
+    const std::string user = "user-0001", action = "action.42";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(policy.allows(user, action));
+    }
+}
+BENCHMARK(BM_PolicyLookup);
+
+// authorize_request over a working set of (user, action) pairs; arg is its
+// size, so the larger sets spill out of the per-thread decision cache
+static void BM_AuthorizeRequest(benchmark::State& state) {
+    ai::SecurityManager security;
+    security.load_policy(bench_policy());
+    std::vector<std::pair<std::string, std::string>> pairs;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        pairs.emplace_back("user-" + std::to_string(i % 16), "action." + std::to_string(i % 64));
+    }
+    size_t next = 0;
+    for (auto _ : state) {
+        const auto& [user, action] = pairs[next];
+        benchmark::DoNotOptimize(security.authorize_request(user, action));
+        if (++next == pairs.size()) next = 0;
+    }
+}
+BENCHMARK(BM_AuthorizeRequest)->Arg(1)->Arg(16)->Arg(1024);
+
+// ============================================================================
+// Security audit log: cost on the calling thread
+// ============================================================================
+
+namespace {
+
+constexpr const char* kAuditDetails = "user=guest action=model.query model=llama3:8b reason=role";
+
+std::string audit_bench_path(const char* name) {
+    return (std::filesystem::temp_directory_path() / "cortan_audit_bench" / name).string();
+}
+
+} // namespace
+
+// log_security_event through the ring; the writer thread does the I/O.
+// Each thread lets the writer catch up every 4096 events, off the clock, so
+// this measures accepted events rather than the (cheaper) drop path.
+static void BM_LogSecurityEvent(benchmark::State& state) {
+    static ai::SecurityManager* security = nullptr;
+    if (state.thread_index() == 0) {
+        std::filesystem::remove_all(std::filesystem::path(audit_bench_path("")).parent_path());
+        security = new ai::SecurityManager();
+        ai::AuditLogConfig config;
+        config.path = audit_bench_path("ring.audit");
+        config.ring_capacity = 1 << 16;
+        config.max_file_bytes = 64 * 1024 * 1024;
+        security->open_audit_log(config);
+    }
+    const std::string event_type = "auth.denied";
+    const std::string details = kAuditDetails;
+    size_t pending = 0;
+    for (auto _ : state) {
+        security->log_security_event(event_type, details);
+        if (++pending == 4096) {
+            state.PauseTiming();
+            security->audit_log()->flush();
+            state.ResumeTiming();
+            pending = 0;
+        }
+    }
+    if (state.thread_index() == 0) {
+        security->audit_log()->flush();
+        auto stats = security->audit_log()->stats();
+        state.counters["dropped"] = benchmark::Counter(static_cast<double>(stats.events_dropped) /
+                                                       static_cast<double>(stats.events_appended + stats.events_dropped));
+        state.counters["batch_events"] = benchmark::Counter(static_cast<double>(stats.events_written) /
+                                                            static_cast<double>(std::max<uint64_t>(1, stats.batches_written)));
+        delete security;
+        security = nullptr;
+    }
+}
+BENCHMARK(BM_LogSecurityEvent)->ThreadRange(1, 8)->UseRealTime();
+
+// Baseline: the same record written and flushed on the calling thread
+static void BM_LogSecurityEventSynchronous(benchmark::State& state) {
+    std::filesystem::create_directories(std::filesystem::path(audit_bench_path("")).parent_path());
+    std::ofstream file(audit_bench_path("sync.log"), std::ios::binary | std::ios::trunc);
+    const std::string line = std::string("auth.denied ") + kAuditDetails + "\n";
+    for (auto _ : state) {
+        file.write(line.data(), static_cast<std::streamsize>(line.size()));
+        file.flush();
+    }
+}
+BENCHMARK(BM_LogSecurityEventSynchronous);
+
 // Main is in core_benchmarks.cpp
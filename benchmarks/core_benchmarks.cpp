@@ -1,5 +1,28 @@
 #include <benchmark/benchmark.h>
+#include <cortan/core/alloc_tracking.hpp>
 #include <cortan/core/event_system.hpp>
+#include <cortan/core/frame_allocator.hpp>
+#include <cortan/core/workflow_engine.hpp>
+
+using namespace cortan::core;
+using alloc_tracking::AllocationScope;
+using alloc_tracking::Subsystem;
+
+namespace {
+
+// Reports allocations per iteration and fails the benchmark when a budget is
+// exceeded, so regressions show up in perf_check runs
+void report_allocations(benchmark::State& state, size_t allocations, size_t budget_per_iteration) {
+    auto iterations = static_cast<size_t>(state.iterations());
+    state.counters["allocs_per_iter"] =
+        benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+    if (alloc_tracking::hook_installed() && iterations > 0 &&
+        allocations > budget_per_iteration * iterations) {
+        state.SkipWithError("allocation budget exceeded");
+    }
+}
+
+} // namespace
 
 static void BM_EventCreation(benchmark::State& state) {
     for (auto _ : state) {
@@ -9,4 +32,74 @@ static void BM_EventCreation(benchmark::State& state) {
 }
 BENCHMARK(BM_EventCreation);
 
+static void BM_EventPublishNoSubscribers(benchmark::State& state) {
+    EventBus bus;
+    auto event = BaseEvent::create("bench.unhandled");
+    size_t allocations = 0;
+
+    for (auto _ : state) {
+        AllocationScope scope(Subsystem::Events);
+        bus.publish("bench.unhandled", event).get();
+        allocations += scope.allocations();
+    }
+
+    report_allocations(state, allocations, 2);
+}
+BENCHMARK(BM_EventPublishNoSubscribers);
+
+// ============================================================================
+// Coroutine frames
+// ============================================================================
+
+namespace {
+
+WorkflowTask<int> leaf_step(int value) {
+    co_return value + 1;
+}
+
+WorkflowTask<int> fan_out_step(int width) {
+    int total = 0;
+    for (int i = 0; i < width; ++i) {
+        total += co_await leaf_step(i);
+    }
+    co_return total;
+}
+
+} // namespace
+
+// Creates, runs and destroys one frame per iteration; arg 0 = global
+// operator new, arg 1 = pooled frames (left enabled for later benchmarks)
+static void BM_CoroutineFrameLifecycle(benchmark::State& state) {
+    frame_allocator::set_pooling_enabled(state.range(0) != 0);
+    size_t allocations = 0;
+
+    for (auto _ : state) {
+        AllocationScope scope(Subsystem::Workflow);
+        auto task = leaf_step(1);
+        task.coro.resume();
+        benchmark::DoNotOptimize(task.result());
+        allocations += scope.allocations();
+    }
+
+    state.counters["allocs_per_iter"] =
+        benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CoroutineFrameLifecycle)->Arg(0)->Arg(1)->ThreadRange(1, 4)->UseRealTime();
+
+// A parent awaiting 64 short-lived children, the shape of a fan-out workflow
+static void BM_CoroutineFanOut(benchmark::State& state) {
+    frame_allocator::set_pooling_enabled(state.range(0) != 0);
+    constexpr int kWidth = 64;
+
+    for (auto _ : state) {
+        auto task = fan_out_step(kWidth);
+        task.coro.resume();
+        benchmark::DoNotOptimize(task.result());
+    }
+
+    state.SetItemsProcessed(state.iterations() * (kWidth + 1));
+}
+BENCHMARK(BM_CoroutineFanOut)->Arg(0)->Arg(1)->ThreadRange(1, 4)->UseRealTime();
+
 BENCHMARK_MAIN();
@@ -1,5 +1,70 @@
 #include <benchmark/benchmark.h>
+#include <cortan/core/allocator.hpp>
+#include <cortan/core/memory_pool.hpp>
+#include <cstdint>
+#include <cstdlib>
 #include <memory>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+using namespace cortan::core;
+
+namespace {
+
+// Cheap deterministic size stream so the RNG does not dominate the loop
+struct SizeStream {
+    uint64_t state;
+
+    explicit SizeStream(uint64_t seed) : state(seed | 1) {}
+
+    size_t next(size_t max_size) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return 16 + static_cast<size_t>(state % (max_size - 15));
+    }
+};
+
+constexpr size_t kLiveBlocksPerThread = 4096;
+
+struct LiveBlock {
+    void* ptr = nullptr;
+    size_t size = 0;
+};
+
+// Steady-state churn: each iteration frees one live block and allocates a
+// block of a new random size in its place.
+template<typename Allocate, typename Deallocate>
+void run_churn(benchmark::State& state, Allocate allocate, Deallocate deallocate) {
+    auto max_size = static_cast<size_t>(state.range(0));
+    SizeStream sizes(static_cast<uint64_t>(state.thread_index()) * 7919 + 17);
+    std::vector<LiveBlock> live(kLiveBlocksPerThread);
+
+    for (auto& block : live) {
+        block.size = sizes.next(max_size);
+        block.ptr = allocate(block.size);
+    }
+
+    size_t slot = 0;
+    for (auto _ : state) {
+        LiveBlock& block = live[slot];
+        deallocate(block.ptr, block.size);
+        block.size = sizes.next(max_size);
+        block.ptr = allocate(block.size);
+        benchmark::DoNotOptimize(block.ptr);
+        slot = (slot + 1) % kLiveBlocksPerThread;
+    }
+
+    for (auto& block : live) {
+        deallocate(block.ptr, block.size);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+} // namespace
 
 // Memory allocation benchmarks
 static void BM_MemoryAllocation(benchmark::State& state) {
@@ -10,14 +75,111 @@ static void BM_MemoryAllocation(benchmark::State& state) {
 }
 BENCHMARK(BM_MemoryAllocation);
 
-// Memory pool simulation benchmark
+// Single fixed-size slab: allocate/deallocate round trip
 static void BM_MemoryPoolSimulation(benchmark::State& state) {
+    MemoryPool pool(64, 1024);
     for (auto _ : state) {
-        // TODO: Implement memory pool benchmarking when memory pool is implemented
-        volatile int dummy = 0;
-        benchmark::DoNotOptimize(dummy);
+        void* ptr = pool.allocate();
+        benchmark::DoNotOptimize(ptr);
+        pool.deallocate(ptr);
     }
+    state.SetItemsProcessed(state.iterations());
 }
 BENCHMARK(BM_MemoryPoolSimulation);
 
+// ============================================================================
+// Multi-threaded churn: CustomAllocator vs glibc malloc
+// ============================================================================
+
+static void BM_ChurnMalloc(benchmark::State& state) {
+    run_churn(state,
+        [](size_t size) { return std::malloc(size); },
+        [](void* ptr, size_t) { std::free(ptr); });
+}
+BENCHMARK(BM_ChurnMalloc)->Arg(256)->Arg(4096)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_ChurnCustomAllocator(benchmark::State& state) {
+    auto& allocator = CustomAllocator::shared();
+    run_churn(state,
+        [&allocator](size_t size) { return allocator.allocate(size); },
+        [&allocator](void* ptr, size_t size) { allocator.deallocate(ptr, size); });
+}
+BENCHMARK(BM_ChurnCustomAllocator)->Arg(256)->Arg(4096)->ThreadRange(1, 8)->UseRealTime();
+
+// ============================================================================
+// Fragmentation after churn (reserved vs live requested bytes)
+// ============================================================================
+
+static void BM_FragmentationCustomAllocator(benchmark::State& state) {
+    auto max_size = static_cast<size_t>(state.range(0));
+    CustomAllocator allocator;
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        SizeStream sizes(42);
+        std::vector<LiveBlock> live(kLiveBlocksPerThread * 4);
+        state.ResumeTiming();
+
+        // Fill, then free every other block and refill with new sizes
+        for (auto& block : live) {
+            block.size = sizes.next(max_size);
+            block.ptr = allocator.allocate(block.size);
+        }
+        for (size_t i = 0; i < live.size(); i += 2) {
+            allocator.deallocate(live[i].ptr, live[i].size);
+            live[i].size = sizes.next(max_size);
+            live[i].ptr = allocator.allocate(live[i].size);
+        }
+
+        state.PauseTiming();
+        auto stats = allocator.stats();
+        state.counters["fragmentation"] = stats.fragmentation();
+        state.counters["reserved_kb"] = static_cast<double>(stats.bytes_reserved) / 1024.0;
+        for (auto& block : live) {
+            allocator.deallocate(block.ptr, block.size);
+        }
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_FragmentationCustomAllocator)->Arg(256)->Arg(4096);
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+static void BM_FragmentationMalloc(benchmark::State& state) {
+    auto max_size = static_cast<size_t>(state.range(0));
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        SizeStream sizes(42);
+        std::vector<LiveBlock> live(kLiveBlocksPerThread * 4);
+        state.ResumeTiming();
+
+        for (auto& block : live) {
+            block.size = sizes.next(max_size);
+            block.ptr = std::malloc(block.size);
+        }
+        for (size_t i = 0; i < live.size(); i += 2) {
+            std::free(live[i].ptr);
+            live[i].size = sizes.next(max_size);
+            live[i].ptr = std::malloc(live[i].size);
+        }
+
+        state.PauseTiming();
+        size_t requested = 0;
+        for (const auto& block : live) {
+            requested += block.size;
+        }
+        auto info = mallinfo2();
+        auto reserved = info.arena + info.hblkhd;
+        state.counters["fragmentation"] =
+            reserved == 0 ? 0.0 : 1.0 - static_cast<double>(requested) / static_cast<double>(reserved);
+        state.counters["reserved_kb"] = static_cast<double>(reserved) / 1024.0;
+        for (auto& block : live) {
+            std::free(block.ptr);
+        }
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_FragmentationMalloc)->Arg(256)->Arg(4096);
+#endif
+
 // Main is in core_benchmarks.cpp
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace cortan::ai {
+
+// ============================================================================
+// Audit Log
+// ============================================================================
+
+struct AuditLogConfig {
+    std::string path = "logs/security.audit";   // rotated files get .1, .2, ...
+
+    // Events waiting for the writer. Must be a power of two; when it is full
+    // events are dropped (and the drop recorded) rather than blocking.
+    size_t ring_capacity = 8192;
+
+    size_t max_file_bytes = 16 * 1024 * 1024;
+    size_t max_rotated_files = 8;
+
+    // How long the writer sleeps when idle; also the longest an event waits
+    // before it is written, unless the ring fills faster
+    std::chrono::milliseconds flush_interval = std::chrono::milliseconds(50);
+};
+
+struct AuditRecord {
+    uint64_t sequence = 0;
+    std::chrono::system_clock::time_point time;
+    std::string event_type;
+    std::string details;
+};
+
+// Append-only security event log.
+//
+// append() only claims a slot in a bounded lock-free ring and copies the two
+// strings into it (slots keep their capacity, so steady state does not
+// allocate). A background thread drains the ring in batches, encodes them
+// and writes each batch with one call. Events lost to a full ring are
+// recorded as one "audit.dropped" record giving their count. Every record,
+// drop records included, takes the next sequence number, so sequences in a
+// log run without duplicates or gaps. Reopening an existing log resumes
+// after the highest sequence of its last valid record.
+//
+// File layout: an 8-byte "CTNAUDIT" magic and a u32 version, then records of
+//   u32 marker | u32 payload length | u32 CRC-32 of payload | payload
+// with payload = u64 sequence | i64 unix time ns | u16 type length |
+// u32 details length | type | details, all little-endian. The marker lets a
+// reader resynchronise after a damaged record.
+class AuditLog {
+public:
+    struct Stats {
+        uint64_t events_appended = 0;
+        uint64_t events_dropped = 0;   // ring was full
+        uint64_t events_written = 0;
+        uint64_t batches_written = 0;
+        uint64_t bytes_written = 0;
+        uint64_t files_rotated = 0;
+        uint64_t write_errors = 0;
+        uint64_t open_failures = 0;   // the next file could not be opened; retried every batch
+        bool file_open = false;       // false while events are held back for a reopen
+    };
+
+    struct ReadResult {
+        size_t records = 0;
+        size_t corrupt = 0;       // failed their checksum or length and were skipped
+        bool truncated = false;   // the file ends inside its last record
+        std::string error;        // set when the file cannot be read at all
+    };
+
+    // Throws std::invalid_argument for a ring capacity that is not a power of
+    // two or zero file limits
+    explicit AuditLog(AuditLogConfig config = {});
+    ~AuditLog();   // writes everything appended, then stops the writer
+
+    AuditLog(const AuditLog&) = delete;
+    AuditLog& operator=(const AuditLog&) = delete;
+
+    // Opens (or continues) the log file and starts the writer.
+    // {false, error} if the file cannot be opened or was already opened.
+    std::pair<bool, std::string> open();
+
+    // Never blocks; false when the event was dropped
+    bool append(std::string_view event_type, std::string_view details);
+
+    // Waits until everything appended before the call has been written
+    void flush();
+
+    Stats stats() const;
+    const AuditLogConfig& config() const;
+
+    // Decodes one log file in order
+    static ReadResult read_file(const std::string& path, const std::function<void(const AuditRecord&)>& on_record);
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace cortan::ai
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cortan/core/request_arena.hpp>
+
+#include <map>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace cortan::ai {
+
+class ContextManager {
+public:
+    ContextManager();
+    ~ContextManager();
+
+    void set_context(const std::string& key, const std::string& value);
+    std::string get_context(const std::string& key) const;
+    void clear_context();
+
+    // Renders the stored context ahead of the prompt ("key: value" lines,
+    // blank line, prompt) directly into the request arena
+    std::pmr::string build_prompt(std::string_view prompt, core::RequestArena& arena) const;
+
+private:
+    std::map<std::string, std::string, std::less<>> context_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace cortan::ai
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cortan::ai {
+
+struct ConversationMessage {
+    std::string role;      // "system", "user", "assistant"
+    std::string content;
+    std::chrono::system_clock::time_point timestamp;
+};
+
+class ConversationManager {
+public:
+    ConversationManager();
+    // Conversation buffer (and message text) is drawn from the given resource,
+    // e.g. &core::CustomAllocator::shared()
+    explicit ConversationManager(std::pmr::memory_resource* resource);
+    ~ConversationManager();
+
+    void add_message(const std::string& role, const std::string& content);
+    std::vector<ConversationMessage> get_history() const;
+    void clear_history();
+
+private:
+    struct StoredMessage {
+        std::pmr::string role;
+        std::pmr::string content;
+        std::chrono::system_clock::time_point timestamp;
+    };
+
+    std::pmr::memory_resource* resource_;
+    std::pmr::vector<StoredMessage> messages_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace cortan::ai
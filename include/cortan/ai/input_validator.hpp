@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cortan/core/request_arena.hpp>
+
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+namespace cortan::ai {
+
+class InputValidator {
+public:
+    InputValidator();
+    ~InputValidator();
+
+    bool validate_prompt(std::string_view prompt);
+    bool validate_model_name(std::string_view model_name);
+
+    // Strips control characters (keeping tab/newline) and surrounding whitespace
+    std::string sanitize_input(const std::string& input);
+
+    // Same, with the sanitized copy living in the request arena
+    std::pmr::string sanitize_input(std::string_view input, core::RequestArena& arena);
+};
+
+} // namespace cortan::ai
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <cortan/ai/ollama_client.hpp>
+#include <cortan/core/request_arena.hpp>
+
+#include <atomic>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <future>
@@ -14,20 +19,51 @@ public:
     virtual std::string getName() const = 0;
     virtual bool isLoaded() const = 0;
     virtual std::future<std::pair<bool, std::string>> processAsync(const std::string& prompt) = 0;
+
+    // Request-scoped variant: the prompt may live in the caller's arena, which
+    // is kept alive until the reply arrives. Nothing is allocated from it.
+    // Defaults to the plain overload.
+    virtual std::future<std::pair<bool, std::string>> processAsync(
+        std::string_view prompt,
+        std::shared_ptr<core::RequestArena> arena) {
+        (void)arena;
+        return processAsync(std::string(prompt));
+    }
+
+    // Hands the reply to on_token as it is generated. Defaults to one token
+    // carrying the whole reply from processAsync.
+    virtual std::future<std::pair<bool, std::string>> processStream(std::string_view prompt, TokenHandler on_token) {
+        return std::async(std::launch::async,
+                          [reply = processAsync(std::string(prompt)), on_token = std::move(on_token)]() mutable {
+                              auto result = reply.get();
+                              if (result.first && on_token) on_token(result.second);
+                              return result;
+                          });
+    }
 };
 
+// A model served by Ollama. Models sharing an endpoint can share a client
+// (and so its connection pool).
 class OllamaModel : public ModelInterface {
 public:
     OllamaModel(std::string name, std::string endpoint = "http://localhost:11434");
+    OllamaModel(std::string name, std::shared_ptr<OllamaClient> client);
 
     std::string getName() const override;
+    // True once the server has answered a generation for this model
     bool isLoaded() const override;
     std::future<std::pair<bool, std::string>> processAsync(const std::string& prompt) override;
+    std::future<std::pair<bool, std::string>> processAsync(
+        std::string_view prompt,
+        std::shared_ptr<core::RequestArena> arena) override;
+    std::future<std::pair<bool, std::string>> processStream(std::string_view prompt, TokenHandler on_token) override;
 
 private:
     std::string name_;
-    std::string endpoint_;
-    bool loaded_ = false;
+    std::shared_ptr<OllamaClient> client_;
+    // Set from the runtime thread that completes a generation, which may
+    // finish after the model is gone
+    std::shared_ptr<std::atomic<bool>> loaded_ = std::make_shared<std::atomic<bool>>(false);
 };
 
 class ModelManager {
@@ -39,11 +75,17 @@ public:
     ModelInterface* getModel(const std::string& name);
     std::vector<std::string> getAvailableModels() const;
 
-        std::future<std::pair<bool, std::string>> processRequest(
+    std::future<std::pair<bool, std::string>> processRequest(
         const std::string& model_name,
         const std::string& prompt
     );
 
+    std::future<std::pair<bool, std::string>> processRequest(
+        const std::string& model_name,
+        std::string_view prompt,
+        std::shared_ptr<core::RequestArena> arena
+    );
+
 private:
     std::vector<std::unique_ptr<ModelInterface>> models_;
 };
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cortan/network/http_client.hpp>
+#include <cortan/network/resilient_client.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace cortan::ai {
+
+// ============================================================================
+// Streaming
+// ============================================================================
+
+// Receives generated text as soon as each NDJSON line is decoded; return
+// false to stop the generation. The view is only valid during the call.
+using TokenHandler = std::function<bool(std::string_view token)>;
+
+// Counters Ollama reports on the final ("done": true) line, plus what the
+// client measured itself
+struct GenerationStats {
+    uint64_t prompt_eval_count = 0;
+    uint64_t eval_count = 0;   // generated tokens
+    std::chrono::nanoseconds total_duration{};
+    std::chrono::nanoseconds load_duration{};
+    std::chrono::nanoseconds prompt_eval_duration{};
+    std::chrono::nanoseconds eval_duration{};
+
+    // From sending the request to the first non-empty token, client side
+    std::chrono::steady_clock::duration time_to_first_token{};
+    size_t chunks = 0;   // NDJSON lines decoded
+};
+
+// The fields of one NDJSON line the client acts on. Everything else on the
+// line (model, created_at, the token "context" array, ...) is skipped
+// without being materialised.
+struct OllamaLine {
+    std::string token;   // "response", or "message.content" for /api/chat
+    std::string error;
+    bool done = false;
+    uint64_t prompt_eval_count = 0;
+    uint64_t eval_count = 0;
+    uint64_t total_duration_ns = 0;
+    uint64_t load_duration_ns = 0;
+    uint64_t prompt_eval_duration_ns = 0;
+    uint64_t eval_duration_ns = 0;
+};
+
+// Decodes an /api/generate or /api/chat NDJSON stream as bytes arrive. Lines
+// may be split across network chunks in any way; each complete line hands
+// its "response" (or "message.content") to the token handler at once.
+class OllamaStreamParser {
+public:
+    explicit OllamaStreamParser(TokenHandler on_token);
+
+    // One streaming pass over a line that extracts the fields above without
+    // building a DOM; false unless the line is a valid JSON object. Reusing
+    // `out` across lines keeps its string capacity, so steady-state lines
+    // do not allocate.
+    static bool decode(std::string_view line, OllamaLine& out);
+
+    // false once the handler stopped, the stream reported an error or a line
+    // did not parse; feed nothing further after that
+    bool feed(std::string_view bytes);
+
+    // End of body: decodes an unterminated last line and checks the stream
+    // got as far as "done"
+    bool finish();
+
+    bool done() const { return done_; }
+    bool stopped() const { return stopped_; }   // by the token handler
+    const std::string& error() const { return error_; }
+    const GenerationStats& stats() const { return stats_; }
+
+private:
+    bool decode_line(std::string_view line);
+
+    TokenHandler on_token_;
+    std::string partial_;   // bytes of a line still waiting for its newline
+    OllamaLine line_;
+    GenerationStats stats_;
+    bool done_ = false;
+    bool stopped_ = false;
+    std::string error_;
+};
+
+// ============================================================================
+// Ollama Client
+// ============================================================================
+
+struct ChatMessage {
+    std::string role;   // "system", "user" or "assistant"
+    std::string content;
+};
+
+struct GenerateResult {
+    bool success = false;
+    std::string text;    // everything generated, also when stopped early
+    std::string error;
+    GenerationStats stats;
+};
+
+struct OllamaTimeouts {
+    // Longest wait for the first token (which includes loading the model and
+    // evaluating the prompt) and then between tokens. Each attempt is bounded
+    // by it; a stall before the first token is retried like any other
+    // failure (see ResilienceConfig).
+    std::chrono::seconds idle = std::chrono::seconds(120);
+    // Bounds each attempt at a generation, however steadily tokens arrive;
+    // zero for none
+    std::chrono::seconds generation = std::chrono::minutes(10);
+};
+
+// Talks to the Ollama HTTP API with "stream": true, so tokens reach the
+// caller while the model is still generating instead of after the whole
+// reply. Requests run on the HttpClient's runtime; nothing blocks a thread
+// per generation.
+//
+// Every call goes through a ResilientClient, so an Ollama server that is
+// down trips its circuit breaker and fails calls at once. A generation that
+// fails before its first bytes arrive is retried; once any part of the
+// reply has reached the token handler, a failure is reported as it is.
+class OllamaClient {
+public:
+    using ResultHandler = std::function<void(GenerateResult result)>;
+
+    explicit OllamaClient(std::string endpoint = "http://localhost:11434",
+                          std::shared_ptr<network::HttpClient> http = nullptr,
+                          OllamaTimeouts timeouts = {},
+                          network::ResilienceConfig resilience = {});
+    ~OllamaClient();
+
+    OllamaClient(const OllamaClient&) = delete;
+    OllamaClient& operator=(const OllamaClient&) = delete;
+
+    // Names from /api/tags; empty when the server cannot be reached
+    std::vector<std::string> list_models();
+
+    // Whole reply as {true, text} or {false, error}
+    std::future<std::pair<bool, std::string>> generate(const std::string& model, const std::string& prompt);
+
+    std::future<GenerateResult> generate(const std::string& model, std::string_view prompt, TokenHandler on_token);
+    std::future<GenerateResult> chat(const std::string& model,
+                                     const std::vector<ChatMessage>& messages,
+                                     TokenHandler on_token = {});
+
+    // Completion-handler forms; on_done runs on a runtime thread
+    void async_generate(const std::string& model, std::string_view prompt, TokenHandler on_token, ResultHandler on_done);
+    void async_chat(const std::string& model,
+                    const std::vector<ChatMessage>& messages,
+                    TokenHandler on_token,
+                    ResultHandler on_done);
+
+    const std::string& endpoint() const { return endpoint_; }
+    // Breaker state and retry counts: stats(endpoint())
+    const network::ResilientClient& http() const { return *http_; }
+
+private:
+    void stream(const std::string& path, std::string body, TokenHandler on_token, ResultHandler on_done);
+
+    std::string endpoint_;
+    std::unique_ptr<network::ResilientClient> http_;
+    OllamaTimeouts timeouts_;
+};
+
+} // namespace cortan::ai
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cortan/core/request_arena.hpp>
+
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cortan::ai {
+
+class ResponseAggregator {
+public:
+    ResponseAggregator();
+    ~ResponseAggregator();
+
+    void add_response(const std::string& task_id, const std::string& response);
+
+    // Responses joined in arrival order, separated by a blank line
+    std::string get_aggregated_response(const std::string& task_id) const;
+    std::pmr::string get_aggregated_response(const std::string& task_id, core::RequestArena& arena) const;
+
+    void clear_responses(const std::string& task_id);
+
+private:
+    template<typename String>
+    void aggregate_into(const std::string& task_id, String& output) const;
+
+    std::unordered_map<std::string, std::vector<std::string>> responses_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace cortan::ai
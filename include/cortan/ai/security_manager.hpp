@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cortan/ai/audit_log.hpp>
+#include <cortan/ai/security_policy.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace cortan::ai {
+
+// ============================================================================
+// Security Manager
+// ============================================================================
+
+struct RateLimitConfig {
+    // Token bucket per user: refills at this rate up to `burst` tokens
+    double requests_per_second = 5.0;
+    double burst = 20.0;
+
+    // Model requests a single user, and everyone together, may have running.
+    // Past either limit new requests are refused rather than queued.
+    size_t max_in_flight_per_user = 4;
+    size_t max_in_flight_global = 64;
+
+    // Idle buckets are forgotten past this many users; when every bucket is
+    // busy, requests from users not yet tracked are refused
+    size_t max_tracked_users = 64 * 1024;
+};
+
+// Decides whether a request may reach the model backend. Checks are O(1) and
+// take no global lock: users are spread over shards, and a bucket's state is
+// one atomic word updated by compare-and-swap under a shared shard lock.
+class SecurityManager {
+public:
+    enum class Admission {
+        Admitted,
+        RateLimited,   // the user's bucket is empty
+        UserBusy,      // max_in_flight_per_user reached
+        Overloaded     // max_in_flight_global reached, or too many users tracked
+    };
+
+    // Holds a user's and the global in-flight slot for one model request and
+    // gives both back when destroyed. Must not outlive the SecurityManager.
+    class RequestPermit {
+    public:
+        RequestPermit() = default;
+        RequestPermit(RequestPermit&& other) noexcept;
+        RequestPermit& operator=(RequestPermit&& other) noexcept;
+        ~RequestPermit();
+
+        RequestPermit(const RequestPermit&) = delete;
+        RequestPermit& operator=(const RequestPermit&) = delete;
+
+        // True while the permit holds its slots
+        explicit operator bool() const { return user_slots_ != nullptr; }
+        Admission admission() const { return admission_; }
+
+        // Gives the slots back early
+        void release();
+
+    private:
+        friend class SecurityManager;
+        RequestPermit(Admission admission, std::atomic<uint32_t>* user_slots,
+                      std::atomic<size_t>* global_slots)
+            : admission_(admission), user_slots_(user_slots), global_slots_(global_slots) {}
+
+        Admission admission_ = Admission::Overloaded;
+        std::atomic<uint32_t>* user_slots_ = nullptr;
+        std::atomic<size_t>* global_slots_ = nullptr;
+    };
+
+    struct Stats {
+        uint64_t admitted = 0;          // rate_limit_check passes and permits granted
+        uint64_t rate_limited = 0;
+        uint64_t user_busy = 0;
+        uint64_t overloaded = 0;
+        size_t in_flight = 0;
+        size_t tracked_users = 0;
+    };
+
+    // Throws std::invalid_argument for non-positive rates or zero limits
+    SecurityManager();
+    explicit SecurityManager(RateLimitConfig config);
+    ~SecurityManager();
+
+    SecurityManager(const SecurityManager&) = delete;
+    SecurityManager& operator=(const SecurityManager&) = delete;
+
+    // Whether the loaded policy lets the user perform the action. Decisions
+    // are cached per thread and keyed by policy epoch, so a repeated
+    // (user, action) pair costs a hash and two string compares, and a reload
+    // invalidates every cache at once without touching them.
+    bool authorize_request(const std::string& user_id, const std::string& action);
+
+    // For WebSocketServerConfig::authorize_subscription: a user may receive
+    // a topic when the policy allows the action "events.<topic>" ("events.*"
+    // for the all-topics subscription). Refusals go to the audit log. Must
+    // not outlive the SecurityManager.
+    std::function<bool(const std::string& user_id, const std::string& topic)> subscription_authorizer();
+
+    // Replaces the policy; until one is loaded every request is denied
+    void load_policy(SecurityPolicy policy);
+
+    // Loads the policy from a config file, keeping the current one on error
+    std::pair<bool, std::string> reload_policy(const std::string& path);
+
+    // Queues the event for the audit log without waiting on disk; a no-op
+    // until open_audit_log() succeeds
+    void log_security_event(const std::string& event_type, const std::string& details);
+
+    // Starts the audit log. {false, error} if the file cannot be opened or a
+    // log is already open.
+    std::pair<bool, std::string> open_audit_log(AuditLogConfig config);
+    AuditLog* audit_log() const;   // nullptr until opened
+
+    // Takes one token from the user's bucket; false when it is empty
+    bool rate_limit_check(const std::string& user_id);
+
+    // In-flight slots plus a token for one model request. The slots are
+    // checked first, so a request refused as busy or overloaded does not
+    // drain the user's bucket.
+    RequestPermit admit_request(const std::string& user_id);
+
+    Stats stats() const;
+    const RateLimitConfig& rate_limit_config() const;
+
+private:
+    class Limiter;
+    class Authorizer;
+    std::unique_ptr<Limiter> limiter_;
+    std::unique_ptr<Authorizer> authorizer_;
+
+    std::mutex audit_mutex_;   // serialises open_audit_log
+    std::unique_ptr<AuditLog> audit_owner_;
+    std::atomic<AuditLog*> audit_log_{nullptr};
+};
+
+} // namespace cortan::ai
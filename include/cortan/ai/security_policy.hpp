@@ -0,0 +1,73 @@
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace cortan::ai {
+
+// ============================================================================
+// Security Policy
+// ============================================================================
+
+// Which actions each user may perform, compiled from roles.
+//
+//   "security": {
+//     "roles": {
+//       "viewer":   ["status.read", "conversation.read"],
+//       "operator": {"inherits": ["viewer"], "actions": ["model.query"]},
+//       "admin":    ["*"]
+//     },
+//     "users": {"alice": ["operator"]},
+//     "default_roles": []
+//   }
+//
+// Every action named anywhere gets a bit; each role, with its inherited
+// roles folded in, and then each user becomes a bitset, so a check is one
+// lookup per name and a bit test. "*" grants every action, including ones
+// the policy never names. Users not listed get default_roles. A
+// default-constructed policy denies everything.
+//
+// User ids are taken as given, not authenticated, so the shipped
+// config/orchestrator.json names no users and grants no default roles.
+// Operators grant roles by listing the ids their front end authenticates
+// under "users" and calling SecurityManager::reload_policy(); keep
+// default_roles to read-only roles such as "viewer", if any, and "*" to
+// ids that only trusted callers can present.
+class SecurityPolicy {
+public:
+    static constexpr size_t kMaxActions = 256;
+    using ActionSet = std::bitset<kMaxActions>;
+
+    SecurityPolicy() = default;
+
+    // Parses the "security" object above, or a whole config file holding one.
+    // Throws std::invalid_argument for malformed JSON, unknown or cyclic
+    // roles, and more than kMaxActions - 1 distinct actions.
+    static SecurityPolicy parse(std::string_view json);
+    static SecurityPolicy load(const std::string& path);
+
+    bool allows(std::string_view user_id, std::string_view action) const;
+
+    size_t action_count() const { return actions_.size(); }
+    size_t user_count() const { return users_.size(); }
+
+private:
+    struct NameHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+    };
+    template<typename T>
+    using NameMap = std::unordered_map<std::string, T, NameHash, std::equal_to<>>;
+
+    static constexpr size_t kAnyAction = 0;   // the bit "*" sets
+
+    NameMap<size_t> actions_;    // action -> bit
+    NameMap<ActionSet> users_;
+    ActionSet default_actions_;
+};
+
+} // namespace cortan::ai
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cortan/core/workflow_engine.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cortan::ai {
+
+enum class WorkflowStatus {
+    CREATED,
+    RUNNING,
+    COMPLETED,
+    FAILED
+};
+
+// What a step sees when it runs: the input given to execute_workflow() and
+// the output of every step it depends on, keyed by step id.
+struct StepInputs {
+    std::string workflow_input;
+    std::unordered_map<std::string, std::string> dependencies;
+};
+
+// Steps are coroutines so model calls can suspend without holding a worker
+using StepHandler = std::function<core::WorkflowTask<std::string>(StepInputs)>;
+
+// Wraps a plain function as a StepHandler for CPU-bound transforms
+StepHandler make_step(std::function<std::string(const StepInputs&)> fn);
+
+struct WorkflowStep {
+    std::string id;
+    std::vector<std::string> depends_on;
+    StepHandler handler;
+};
+
+struct StepTiming {
+    std::string step_id;
+    std::chrono::nanoseconds started{0};    // offsets from the start of the run
+    std::chrono::nanoseconds finished{0};
+    bool executed = false;                  // false when skipped after a failure
+    std::string error;
+
+    std::chrono::nanoseconds duration() const { return finished - started; }
+};
+
+struct WorkflowRunReport {
+    WorkflowStatus status = WorkflowStatus::CREATED;
+    std::unordered_map<std::string, std::string> outputs;
+    std::vector<StepTiming> steps;          // in declaration order
+    std::string error;                      // first failure, if any
+
+    std::chrono::nanoseconds wall_time{0};
+    // Heaviest dependency chain by measured step duration; wall_time close to
+    // critical_path_time means the run was as parallel as the DAG allows.
+    std::chrono::nanoseconds critical_path_time{0};
+    std::vector<std::string> critical_path;
+};
+
+// Runs workflows declared as a DAG of steps. Each step starts on the engine's
+// pool as soon as its last dependency finishes, so independent branches run
+// concurrently. A failing step cancels the run: in-flight steps observe the
+// cancellation at their next await point and dependents are skipped.
+class WorkflowCoordinator {
+public:
+    WorkflowCoordinator();
+    explicit WorkflowCoordinator(std::shared_ptr<core::WorkflowEngine> engine);
+    ~WorkflowCoordinator();  // waits for in-flight runs
+
+    // Named handlers used by linear workflows
+    void register_step_handler(const std::string& name, StepHandler handler);
+
+    // Linear workflow: each step depends on the previous one. Step names must
+    // refer to registered handlers.
+    void create_workflow(const std::string& workflow_id, const std::vector<std::string>& steps);
+
+    // DAG workflow. Throws std::invalid_argument on duplicate ids, unknown
+    // dependencies, missing handlers or cycles.
+    void create_workflow(const std::string& workflow_id, std::vector<WorkflowStep> steps);
+
+    std::future<WorkflowRunReport> execute_workflow(const std::string& workflow_id,
+                                                    std::string input = {});
+
+    // Throws std::out_of_range for unknown workflows
+    WorkflowStatus get_workflow_status(const std::string& workflow_id) const;
+    std::optional<WorkflowRunReport> get_last_report(const std::string& workflow_id) const;
+
+private:
+    struct Definition;
+    struct Run;
+    struct Workflow {
+        std::shared_ptr<const Definition> definition;
+        WorkflowStatus status = WorkflowStatus::CREATED;
+        std::optional<WorkflowRunReport> last_report;
+    };
+
+    static std::shared_ptr<const Definition> compile(std::vector<WorkflowStep> steps);
+
+    void launch_step(const std::shared_ptr<Run>& run, size_t index);
+    core::WorkflowTask<void> run_step(std::shared_ptr<Run> run, size_t index);
+    void finish_step(const std::shared_ptr<Run>& run, size_t index);
+    void finish_run(const std::shared_ptr<Run>& run);
+
+    std::shared_ptr<core::WorkflowEngine> engine_;
+    std::unordered_map<std::string, StepHandler> handlers_;
+    std::unordered_map<std::string, Workflow> workflows_;
+    size_t active_runs_ = 0;
+    std::condition_variable runs_idle_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace cortan::ai
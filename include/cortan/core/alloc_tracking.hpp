@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+namespace cortan::core::alloc_tracking {
+
+// ============================================================================
+// Allocation Tracking (Opt-in heap instrumentation)
+// ============================================================================
+
+// Counting only happens in binaries that link the cortan_alloc_hook object
+// library, which replaces the global operator new/delete. Without it every
+// counter stays at zero and hook_installed() returns false.
+//
+// Allocations are attributed to the subsystem tagged on the allocating
+// thread (see AllocationScope); untagged allocations count as Untracked.
+// Scopes are per thread: work a scope hands to another thread (std::async,
+// thread pools) is not included in its counters.
+
+enum class Subsystem : uint8_t {
+    Untracked = 0,
+    Events,
+    Workflow,
+    Memory,
+    AI,
+    Network,
+    Terminal,
+    Count
+};
+
+inline constexpr size_t kSubsystemCount = static_cast<size_t>(Subsystem::Count);
+
+std::string_view subsystem_name(Subsystem subsystem);
+
+struct Counters {
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t bytes_allocated = 0;
+
+    Counters operator-(const Counters& other) const {
+        return {allocations - other.allocations,
+                deallocations - other.deallocations,
+                bytes_allocated - other.bytes_allocated};
+    }
+};
+
+bool hook_installed() noexcept;
+
+// Totals for the calling thread since it started
+Counters thread_counters() noexcept;
+
+// Process-wide totals per subsystem tag
+Counters subsystem_counters(Subsystem subsystem) noexcept;
+std::array<Counters, kSubsystemCount> all_subsystem_counters() noexcept;
+
+// Tags the calling thread with a subsystem for the lifetime of the scope and
+// measures the allocations it performs in the meantime. Scopes nest; the
+// innermost tag wins.
+class AllocationScope {
+public:
+    explicit AllocationScope(Subsystem subsystem) noexcept;
+    ~AllocationScope();
+
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+
+    Counters counters() const noexcept { return thread_counters() - start_; }
+    size_t allocations() const noexcept { return counters().allocations; }
+
+private:
+    Subsystem previous_;
+    Counters start_;
+};
+
+// Runs fn inside an AllocationScope and returns what it allocated, e.g.
+//     EXPECT_LE(measure(Subsystem::Events, [&] { bus.publish(...); }).allocations, 1u);
+template<typename Fn>
+Counters measure(Subsystem subsystem, Fn&& fn) {
+    AllocationScope scope(subsystem);
+    std::forward<Fn>(fn)();
+    return scope.counters();
+}
+
+namespace detail {
+
+// Called by the replacement operators in alloc_tracking_hook.cpp
+void record_allocation(size_t bytes) noexcept;
+void record_deallocation() noexcept;
+void mark_hook_installed() noexcept;
+
+} // namespace detail
+
+} // namespace cortan::core::alloc_tracking
+
+// Library-internal tagging; compiled out unless ENABLE_ALLOC_TRACKING is on
+#if defined(CORTAN_ALLOC_TRACKING_ENABLED)
+#define CORTAN_ALLOC_SCOPE_CONCAT_(a, b) a##b
+#define CORTAN_ALLOC_SCOPE_NAME_(line) CORTAN_ALLOC_SCOPE_CONCAT_(cortan_alloc_scope_, line)
+#define CORTAN_ALLOC_SCOPE(subsystem) \
+    ::cortan::core::alloc_tracking::AllocationScope CORTAN_ALLOC_SCOPE_NAME_(__LINE__){ \
+        ::cortan::core::alloc_tracking::Subsystem::subsystem}
+#else
+#define CORTAN_ALLOC_SCOPE(subsystem) static_cast<void>(0)
+#endif
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cortan/core/memory_pool.hpp>
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace cortan::core {
+
+// ============================================================================
+// Custom Allocator (Size-class segregated, pmr-compatible)
+// ============================================================================
+
+// Small requests (<= kMaxBlockSize) are rounded up to one of kNumSizeClasses
+// classes and served from MemoryPool slabs; larger or over-aligned requests go
+// to the upstream resource. Each thread is pinned to one of a handful of
+// shards, so concurrent allocations rarely touch the same mutex. Freed blocks
+// are recycled through the freeing thread's shard and slabs are only returned
+// when the allocator is destroyed.
+//
+// Opt in from pmr containers:
+//     std::pmr::vector<int> values{&CustomAllocator::shared()};
+class CustomAllocator : public std::pmr::memory_resource {
+public:
+    static constexpr size_t kMaxBlockSize = 4096;
+    static constexpr size_t kNumSizeClasses = 28;
+    static constexpr size_t kSlabBytes = 64 * 1024;
+    static constexpr size_t kMaxShards = 16;
+
+    struct Stats {
+        size_t bytes_requested = 0;     // Live size-class bytes as requested by callers
+        size_t bytes_in_blocks = 0;     // Same, after size-class rounding
+        size_t bytes_reserved = 0;      // Slab bytes obtained for size classes
+        size_t upstream_bytes = 0;      // Live bytes forwarded to upstream
+        size_t allocations = 0;         // Total allocations served
+        size_t slab_count = 0;
+
+        // Share of reserved slab memory not backing a live request
+        double fragmentation() const {
+            return bytes_reserved == 0
+                ? 0.0
+                : 1.0 - static_cast<double>(bytes_requested) / static_cast<double>(bytes_reserved);
+        }
+    };
+
+    explicit CustomAllocator(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+    ~CustomAllocator() override;
+
+    CustomAllocator(const CustomAllocator&) = delete;
+    CustomAllocator& operator=(const CustomAllocator&) = delete;
+
+    // Process-wide instance (never destroyed, safe to use from static destructors)
+    static CustomAllocator& shared();
+
+    // Size-class helpers, exposed for tests and benchmarks
+    static size_t size_class_index(size_t size) noexcept;
+    static size_t size_class_bytes(size_t index) noexcept;
+
+    Stats stats() const;
+    std::pmr::memory_resource* upstream() const noexcept { return upstream_; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct SizeClass {
+        FreeBlock* free_list = nullptr;
+        std::vector<std::unique_ptr<MemoryPool>> slabs;
+    };
+
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::array<SizeClass, kNumSizeClasses> classes;
+        Stats stats;
+    };
+
+    Shard& local_shard() noexcept;
+
+    std::pmr::memory_resource* upstream_;
+    size_t shard_mask_;
+    std::unique_ptr<Shard[]> shards_;
+};
+
+} // namespace cortan::core
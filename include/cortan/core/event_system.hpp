@@ -4,6 +4,7 @@
 #include <string>
 #include <functional>
 #include <memory>
+#include <memory_resource>
 #include <future>
 #include <variant>
 #include <unordered_map>
@@ -98,11 +99,17 @@ struct UserProfile {
 // ============================================================================
 
 struct EventContext {
+    EventContext() = default;
+
+    // Opt-in: metadata nodes come from the given resource (e.g. CustomAllocator).
+    // Copies fall back to the default resource, as for any pmr container.
+    explicit EventContext(std::pmr::memory_resource* resource) : metadata(resource) {}
+
     std::shared_ptr<UserProfile> user_profile;  // Dynamic user information
     std::string session_id;
     std::string location_context;  // "mission_control", "field_ops", "personal_time"
     std::string emotional_state;   // "focused", "concerned", "playful", "exhausted"
-    std::unordered_map<std::string, std::string> metadata;
+    std::pmr::unordered_map<std::string, std::string> metadata;
 
     // Cortana's personality traits (now context-aware)
     float urgency_level = 0.5f;        // 0.0 = casual, 1.0 = emergency
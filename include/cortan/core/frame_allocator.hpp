@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+
+namespace cortan::core::frame_allocator {
+
+// ============================================================================
+// Coroutine Frame Allocator
+// ============================================================================
+
+// Backs operator new/delete of WorkflowTask and the engine's driver
+// coroutines. Frames are rounded up to kBucketBytes and recycled through a
+// per-thread free list per bucket, so a frame freed on a worker is handed
+// straight to the next coroutine created there. Each thread keeps at most
+// kMaxCachedPerBucket frames per bucket; the rest, and frames larger than
+// kMaxFrameBytes, go to CustomAllocator::shared().
+//
+// Every frame carries a small header recording where it came from, so
+// pooling can be toggled at runtime (for benchmarks) while frames are live.
+
+inline constexpr size_t kBucketBytes = 64;
+inline constexpr size_t kMaxFrameBytes = 2048;
+inline constexpr size_t kMaxCachedPerBucket = 256;
+
+void* allocate(size_t bytes);
+void deallocate(void* ptr, size_t bytes) noexcept;
+
+// Pooling is on by default; when off, frames use global operator new
+void set_pooling_enabled(bool enabled) noexcept;
+bool pooling_enabled() noexcept;
+
+} // namespace cortan::core::frame_allocator
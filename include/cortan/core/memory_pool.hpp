@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+
+namespace cortan::core {
+
+// ============================================================================
+// Memory Pool (Fixed-size block slab)
+// ============================================================================
+
+// A single contiguous slab carved into equally sized blocks. Blocks are handed
+// out lazily (bump pointer first, then the intrusive free list), so a fresh
+// pool never touches pages it has not returned yet.
+//
+// MemoryPool is not internally synchronized: CustomAllocator serializes access
+// per shard, standalone users must do the same.
+class MemoryPool {
+public:
+    static constexpr size_t kBlockAlignment = alignof(std::max_align_t);
+
+    MemoryPool(size_t block_size, size_t num_blocks);
+    ~MemoryPool();
+
+    MemoryPool(const MemoryPool&) = delete;
+    MemoryPool& operator=(const MemoryPool&) = delete;
+
+    // Returns nullptr when every block is in use
+    void* allocate();
+    void deallocate(void* ptr);
+
+    bool owns(const void* ptr) const noexcept;
+
+    size_t block_size() const noexcept { return block_size_; }
+    size_t capacity() const noexcept { return num_blocks_; }
+    size_t available() const noexcept { return free_count_; }
+    size_t slab_bytes() const noexcept { return block_size_ * num_blocks_; }
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    size_t block_size_;
+    size_t num_blocks_;
+    std::byte* slab_ = nullptr;
+    FreeBlock* free_list_ = nullptr;
+    size_t next_unused_ = 0;   // Blocks past this index have never been handed out
+    size_t free_count_ = 0;
+};
+
+} // namespace cortan::core
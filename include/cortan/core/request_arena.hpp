@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+namespace cortan::core {
+
+// ============================================================================
+// Request Arena (Per-request monotonic allocation)
+// ============================================================================
+
+// Bump allocator that owns every transient allocation of one user request
+// (sanitized prompt, rendered context, HTTP request/response staging,
+// aggregated output). Deallocation is a no-op; everything is returned at once
+// when the arena is destroyed or released. The first kInlineBytes come from
+// storage inside the arena itself, so small requests never touch the heap.
+//
+// A request hands the arena from stage to stage, so it is never used by two
+// threads at the same time and needs no locking. Share it via shared_ptr when
+// a stage completes asynchronously.
+class RequestArena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t kInlineBytes = 4096;
+
+    explicit RequestArena(std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+    ~RequestArena() override;
+
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    std::pmr::string make_string(std::string_view text = {});
+
+    template<typename T>
+    std::pmr::polymorphic_allocator<T> allocator() noexcept {
+        return std::pmr::polymorphic_allocator<T>(this);
+    }
+
+    // Returns all memory; anything allocated from the arena is invalidated
+    void release();
+
+    size_t bytes_allocated() const noexcept { return bytes_allocated_; }
+    size_t allocation_count() const noexcept { return allocation_count_; }
+    size_t upstream_allocations() const noexcept { return upstream_.allocations; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+    // Counts the chunks the monotonic resource has to fetch beyond the inline buffer
+    class CountingUpstream : public std::pmr::memory_resource {
+    public:
+        explicit CountingUpstream(std::pmr::memory_resource* upstream) : upstream_(upstream) {}
+
+        size_t allocations = 0;
+
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    private:
+        std::pmr::memory_resource* upstream_;
+    };
+
+    alignas(std::max_align_t) std::array<std::byte, kInlineBytes> inline_buffer_;
+    CountingUpstream upstream_;
+    std::pmr::monotonic_buffer_resource arena_;
+    size_t bytes_allocated_ = 0;
+    size_t allocation_count_ = 0;
+};
+
+} // namespace cortan::core
@@ -1,30 +1,168 @@
 #pragma once
 
+#include <cortan/core/frame_allocator.hpp>
+#include <cortan/core/thread_pool.hpp>
+#include <any>
+#include <atomic>
 #include <coroutine>
-#include <string>
-#include <vector>
+#include <exception>
+#include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
 
 namespace cortan::core {
 
+// ============================================================================
+// Cancellation
+// ============================================================================
+
+class WorkflowCancelled : public std::runtime_error {
+public:
+    WorkflowCancelled() : std::runtime_error("Workflow cancelled") {}
+};
+
+// Cheap, copyable view of a CancellationSource. A default-constructed token
+// is never cancelled.
+class CancellationToken {
+public:
+    CancellationToken() = default;
+
+    bool is_cancelled() const noexcept {
+        return state_ && state_->load(std::memory_order_acquire);
+    }
+
+    void throw_if_cancelled() const {
+        if (is_cancelled()) throw WorkflowCancelled();
+    }
+
+private:
+    friend class CancellationSource;
+    explicit CancellationToken(std::shared_ptr<std::atomic<bool>> state) : state_(std::move(state)) {}
+
+    std::shared_ptr<std::atomic<bool>> state_;
+};
+
+class CancellationSource {
+public:
+    CancellationSource() : state_(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() noexcept { state_->store(true, std::memory_order_release); }
+    bool is_cancelled() const noexcept { return state_->load(std::memory_order_acquire); }
+    CancellationToken token() const { return CancellationToken(state_); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> state_;
+};
+
+// ============================================================================
+// WorkflowTask (lazy coroutine)
+// ============================================================================
+
+// A WorkflowTask does not run until it is awaited by another task or handed
+// to WorkflowEngine::start(). Awaiting a child transfers control to it
+// directly (symmetric transfer), and its completion transfers control back
+// to the awaiting parent, so long await chains do not nest resume() calls
+// (in optimized builds, where GCC emits the transfer as a tail call).
+// Exceptions thrown inside a task are rethrown at the co_await site.
+//
+// Cancellation is cooperative: the token given to start() is inherited by
+// every child on co_await, and each await point (child tasks,
+// WorkflowEngine::schedule()) throws WorkflowCancelled once it is set.
+
 template<typename T>
-struct WorkflowTask {
-    struct promise_type {
-        T value;
+struct WorkflowTask;
+
+namespace detail {
+
+// Coroutine frames come from the pooled frame allocator
+struct PooledFrame {
+    static void* operator new(size_t size) { return frame_allocator::allocate(size); }
+    static void operator delete(void* ptr, size_t size) noexcept { frame_allocator::deallocate(ptr, size); }
+};
 
-        WorkflowTask get_return_object() {
-            return WorkflowTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+struct WorkflowPromiseBase : PooledFrame {
+    std::coroutine_handle<> continuation;
+    CancellationToken cancellation;
+
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> self) noexcept {
+            if (auto next = self.promise().continuation) {
+                return next;
+            }
+            return std::noop_coroutine();
         }
 
-        std::suspend_never initial_suspend() { return {}; }
-        std::suspend_always final_suspend() noexcept { return {}; }
-        void unhandled_exception() {}
-        void return_value(T val) { value = std::move(val); }
+        void await_resume() const noexcept {}
     };
 
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+};
+
+template<typename T>
+struct WorkflowPromise : WorkflowPromiseBase {
+    std::variant<std::monostate, T, std::exception_ptr> outcome;
+
+    WorkflowTask<T> get_return_object();
+
+    void unhandled_exception() noexcept { outcome.template emplace<2>(std::current_exception()); }
+
+    template<typename U = T>
+        requires std::is_convertible_v<U&&, T>
+    void return_value(U&& value) {
+        outcome.template emplace<1>(std::forward<U>(value));
+    }
+
+    T take_result() {
+        if (outcome.index() == 2) std::rethrow_exception(std::get<2>(outcome));
+        if (outcome.index() == 0) throw std::runtime_error("Task not completed");
+        return std::move(std::get<1>(outcome));
+    }
+};
+
+template<>
+struct WorkflowPromise<void> : WorkflowPromiseBase {
+    std::exception_ptr exception;
+
+    WorkflowTask<void> get_return_object();
+
+    void unhandled_exception() noexcept { exception = std::current_exception(); }
+    void return_void() noexcept {}
+
+    void take_result() {
+        if (exception) std::rethrow_exception(exception);
+    }
+};
+
+// Propagates the awaiting coroutine's cancellation token, if it has one
+template<typename Promise>
+CancellationToken cancellation_of(std::coroutine_handle<Promise> handle) {
+    if constexpr (std::is_base_of_v<WorkflowPromiseBase, Promise>) {
+        return handle.promise().cancellation;
+    } else {
+        return {};
+    }
+}
+
+} // namespace detail
+
+template<typename T>
+struct WorkflowTask {
+    using promise_type = detail::WorkflowPromise<T>;
+
     std::coroutine_handle<promise_type> coro;
 
-    WorkflowTask(std::coroutine_handle<promise_type> handle) : coro(handle) {}
+    explicit WorkflowTask(std::coroutine_handle<promise_type> handle) : coro(handle) {}
     ~WorkflowTask() { if (coro) coro.destroy(); }
 
     // Move-only
@@ -42,20 +180,232 @@ struct WorkflowTask {
     bool ready() const { return coro && coro.done(); }
     T result() {
         if (!coro || !coro.done()) throw std::runtime_error("Task not completed");
-        return std::move(coro.promise().value);
+        return coro.promise().take_result();
     }
+
+    void set_cancellation(CancellationToken token) { coro.promise().cancellation = std::move(token); }
+
+    struct Awaiter {
+        std::coroutine_handle<promise_type> child;
+        bool cancelled = false;
+
+        bool await_ready() const noexcept { return child.done(); }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> parent) {
+            // Children of workflow tasks inherit the parent's token and are
+            // not started once it is set. Other awaiters (e.g. start()) keep
+            // the token set on the task and always start it.
+            if constexpr (std::is_base_of_v<detail::WorkflowPromiseBase, Promise>) {
+                child.promise().cancellation = parent.promise().cancellation;
+                if (child.promise().cancellation.is_cancelled()) {
+                    cancelled = true;
+                    return parent;
+                }
+            }
+            child.promise().continuation = parent;
+            return child;
+        }
+
+        T await_resume() {
+            if (cancelled) throw WorkflowCancelled();
+            return child.promise().take_result();
+        }
+    };
+
+    Awaiter operator co_await() && {
+        if (!coro) throw std::runtime_error("Awaiting an empty task");
+        return Awaiter{coro};
+    }
+};
+
+namespace detail {
+
+template<typename T>
+WorkflowTask<T> WorkflowPromise<T>::get_return_object() {
+    return WorkflowTask<T>{std::coroutine_handle<WorkflowPromise<T>>::from_promise(*this)};
+}
+
+inline WorkflowTask<void> WorkflowPromise<void>::get_return_object() {
+    return WorkflowTask<void>{std::coroutine_handle<WorkflowPromise<void>>::from_promise(*this)};
+}
+
+// Fire-and-forget coroutine used to drive a task from outside the
+// coroutine world; its frame frees itself when it finishes.
+struct DetachedTask {
+    struct promise_type : PooledFrame {
+        DetachedTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
 };
 
+} // namespace detail
+
+// ============================================================================
+// Completion (bridge from callbacks to co_await)
+// ============================================================================
+
+// One-shot result slot that a coroutine can co_await while some other
+// component (an I/O callback, another thread) produces the value. The
+// awaiting coroutine holds no thread while it waits; it is resumed on the
+// executor if one is given, otherwise inline on the completing thread.
+template<typename T>
+class Completion {
+public:
+    explicit Completion(ThreadPool* executor = nullptr)
+        : state_(std::make_shared<State>()) {
+        state_->executor = executor;
+    }
+
+    template<typename U = T>
+    void set_value(U&& value) {
+        complete([&](State& state) { state.value.emplace(std::forward<U>(value)); });
+    }
+
+    void set_exception(std::exception_ptr exception) {
+        complete([&](State& state) { state.exception = std::move(exception); });
+    }
+
+    bool await_ready() const noexcept {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return state_->done;
+    }
+
+    template<typename Promise>
+    bool await_suspend(std::coroutine_handle<Promise> waiter) {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (state_->done) return false;
+        state_->waiter = waiter;
+        return true;
+    }
+
+    T await_resume() {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (state_->exception) std::rethrow_exception(state_->exception);
+        return std::move(*state_->value);
+    }
+
+private:
+    struct State {
+        std::mutex mutex;
+        bool done = false;
+        std::optional<T> value;
+        std::exception_ptr exception;
+        std::coroutine_handle<> waiter;
+        ThreadPool* executor = nullptr;
+    };
+
+    template<typename Fill>
+    void complete(Fill&& fill) {
+        std::coroutine_handle<> waiter;
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            if (state_->done) throw std::logic_error("Completion already set");
+            fill(*state_);
+            state_->done = true;
+            waiter = std::exchange(state_->waiter, {});
+        }
+        if (!waiter) return;
+        if (state_->executor) {
+            state_->executor->enqueue([waiter] { waiter.resume(); });
+        } else {
+            waiter.resume();
+        }
+    }
+
+    std::shared_ptr<State> state_;
+};
+
+// ============================================================================
+// WorkflowEngine
+// ============================================================================
+
 class WorkflowEngine {
 public:
-    WorkflowEngine();
+    template<typename T>
+    using WorkflowFactory = std::function<WorkflowTask<T>(WorkflowEngine&)>;
+
+    explicit WorkflowEngine(size_t num_threads = std::thread::hardware_concurrency());
     ~WorkflowEngine();
 
+    WorkflowEngine(const WorkflowEngine&) = delete;
+    WorkflowEngine& operator=(const WorkflowEngine&) = delete;
+
+    ThreadPool& executor();
+
+    // co_await engine.schedule() moves the calling coroutine onto the pool
+    struct ScheduleAwaiter {
+        ThreadPool& pool;
+        CancellationToken cancellation;
+
+        bool await_ready() const noexcept { return false; }
+
+        template<typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> handle) {
+            cancellation = detail::cancellation_of(handle);
+            pool.enqueue([handle] { handle.resume(); });
+        }
+
+        void await_resume() const { cancellation.throw_if_cancelled(); }
+    };
+
+    ScheduleAwaiter schedule() { return ScheduleAwaiter{executor(), {}}; }
+
+    template<typename T>
+    void registerWorkflow(const std::string& workflow_id, WorkflowFactory<T> factory) {
+        storeWorkflow(workflow_id, std::any(std::move(factory)));
+    }
+
+    bool hasWorkflow(const std::string& workflow_id) const;
+
+    // Returns a lazy task that runs a registered workflow on the pool. The
+    // lookup is eager: throws std::out_of_range for unknown ids and
+    // std::bad_any_cast when T does not match the registered result type.
+    template<typename T>
+    WorkflowTask<T> executeWorkflow(const std::string& workflow_id) {
+        return runWorkflow(std::any_cast<WorkflowFactory<T>>(findWorkflow(workflow_id)));
+    }
+
+    // Starts a task on the pool and exposes its outcome as a future
     template<typename T>
-    WorkflowTask<T> executeWorkflow(const std::string& workflow_id);
+    std::future<T> start(WorkflowTask<T> task, CancellationToken cancellation = {}) {
+        std::promise<T> promise;
+        auto future = promise.get_future();
+        drive(std::move(task), std::move(promise), std::move(cancellation));
+        return future;
+    }
 
 private:
-    // Implementation details
+    template<typename T>
+    WorkflowTask<T> runWorkflow(WorkflowFactory<T> factory) {
+        co_await schedule();
+        co_return co_await factory(*this);
+    }
+
+    template<typename T>
+    detail::DetachedTask drive(WorkflowTask<T> task, std::promise<T> promise, CancellationToken cancellation) {
+        try {
+            co_await schedule();
+            task.set_cancellation(std::move(cancellation));
+            if constexpr (std::is_void_v<T>) {
+                co_await std::move(task);
+                promise.set_value();
+            } else {
+                promise.set_value(co_await std::move(task));
+            }
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+    }
+
+    void storeWorkflow(const std::string& workflow_id, std::any factory);
+    std::any findWorkflow(const std::string& workflow_id) const;
+
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
 };
 
 } // namespace cortan::core
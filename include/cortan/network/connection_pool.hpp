@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cortan/network/io_runtime.hpp>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/tcp_stream.hpp>
+#include <boost/beast/ssl/ssl_stream.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+
+namespace cortan::network {
+
+// ============================================================================
+// Connection
+// ============================================================================
+
+// Connections are pooled per origin: requests to the same scheme, host and
+// port may share a keep-alive connection.
+struct ConnectionKey {
+    std::string scheme;
+    std::string host;
+    std::string port;
+
+    bool is_tls() const { return scheme == "https"; }
+    std::string to_string() const { return scheme + "://" + host + ":" + port; }
+
+    bool operator<(const ConnectionKey& other) const {
+        return std::tie(scheme, host, port) < std::tie(other.scheme, other.host, other.port);
+    }
+    bool operator==(const ConnectionKey& other) const {
+        return std::tie(scheme, host, port) == std::tie(other.scheme, other.host, other.port);
+    }
+};
+
+// One HTTP/1.1 transport, plain or TLS. A fresh connection handed out by the
+// pool is not connected yet; the caller establishes it and marks it
+// reusable once a response has been read completely with keep-alive.
+class Connection {
+public:
+    using PlainStream = boost::beast::tcp_stream;
+    using TlsStream = boost::beast::ssl_stream<boost::beast::tcp_stream>;
+    using Clock = std::chrono::steady_clock;
+
+    Connection(ConnectionKey key, boost::asio::io_context& io_context);
+    ~Connection();
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    const ConnectionKey& key() const { return key_; }
+    bool is_tls() const { return key_.is_tls(); }
+
+    // TLS connections need a context before the stream can be created
+    void create_tls_stream(boost::asio::ssl::context& ssl_context);
+
+    PlainStream& plain_stream();
+    TlsStream& tls_stream();
+    PlainStream& tcp();   // lowest layer of either kind
+
+    // Bytes read past the end of the previous response belong to the next
+    // one, so the read buffer lives as long as the connection.
+    boost::beast::flat_buffer& buffer() { return buffer_; }
+
+    bool is_open() const;
+    void close();
+
+    // Open, not closed by the peer and with no unsolicited bytes waiting.
+    // Non-blocking; used when an idle connection is checked out.
+    bool is_healthy();
+
+    void set_reusable(bool reusable) { reusable_ = reusable; }
+    bool reusable() const { return reusable_; }
+
+    bool was_reused() const { return uses_ > 1; }
+    uint64_t uses() const { return uses_; }
+    Clock::time_point last_used() const { return last_used_; }
+
+private:
+    friend class ConnectionPool;
+
+    ConnectionKey key_;
+    boost::asio::io_context& io_context_;
+    std::optional<PlainStream> plain_;
+    std::unique_ptr<TlsStream> tls_;
+    boost::beast::flat_buffer buffer_;
+    bool reusable_ = false;
+    uint64_t uses_ = 0;
+    Clock::time_point last_used_ = Clock::now();
+};
+
+// ============================================================================
+// Connection Pool
+// ============================================================================
+
+struct ConnectionPoolConfig {
+    size_t max_connections = 64;       // open connections across all origins
+    size_t max_per_host = 8;           // open connections per origin
+    std::chrono::steady_clock::duration idle_timeout = std::chrono::seconds(30);
+    // How long a checkout waits for a slot when a limit is reached
+    std::chrono::steady_clock::duration acquire_timeout = std::chrono::seconds(30);
+};
+
+class ConnectionPool {
+public:
+    struct Stats {
+        size_t created = 0;        // connections handed out fresh
+        size_t reused = 0;         // idle connections handed out again
+        size_t evicted = 0;        // idle connections dropped (timeout, health, capacity)
+        size_t idle = 0;
+        size_t active = 0;
+        size_t waiting = 0;        // checkouts queued behind a limit
+    };
+
+    // Receives the connection, or nullptr and an error message
+    using AcquireHandler = std::function<void(std::shared_ptr<Connection> connection, std::string error)>;
+
+    // Sockets are created on the given runtime (IoRuntime::shared() by default)
+    explicit ConnectionPool(size_t max_connections);
+    explicit ConnectionPool(ConnectionPoolConfig config = {});
+    ConnectionPool(ConnectionPoolConfig config, IoRuntime& runtime);
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    // Hands out the most recently used healthy idle connection for the
+    // origin, or a new unconnected one. When the origin or the pool is at its
+    // limit the checkout queues (FIFO) until a slot frees up, failing after
+    // acquire_timeout. The handler always runs on the runtime's threads.
+    void async_get_connection(const ConnectionKey& key, AcquireHandler handler);
+
+    // Blocking forms for callers outside the runtime; throw
+    // std::runtime_error on timeout. Must not be called on a runtime thread.
+    std::shared_ptr<Connection> get_connection(const ConnectionKey& key);
+    std::shared_ptr<Connection> get_connection(const std::string& endpoint);   // "scheme://host:port"
+
+    // Reusable, open connections go back to the idle list (or straight to a
+    // queued checkout); anything else is closed and its slot released.
+    void return_connection(std::shared_ptr<Connection> connection);
+
+    // Closes idle connections past idle_timeout; also done lazily on checkout
+    size_t evict_idle();
+
+    Stats stats() const;
+    const ConnectionPoolConfig& config() const;
+    IoRuntime& runtime() const;
+
+private:
+    // Shared with queued checkouts' timers, which may fire after the pool
+    // itself is gone
+    class Impl;
+    std::shared_ptr<Impl> impl_;
+};
+
+} // namespace cortan::network
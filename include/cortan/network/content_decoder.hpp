@@ -0,0 +1,53 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace cortan::network {
+
+// ============================================================================
+// Content Decoding
+// ============================================================================
+
+// Corrupt or truncated encoded data
+class DecodeError : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+// Incremental decoder for one HTTP Content-Encoding: gzip and deflate always,
+// zstd when built with libzstd (CORTAN_HAS_ZSTD). The body can be fed in
+// pieces of any size as it comes off the socket; output is produced in
+// blocks of at most kOutputBlockBytes.
+class ContentDecoder {
+public:
+    // Receives decoded bytes, valid only during the call; return false to stop
+    using Sink = std::function<bool(std::string_view decoded)>;
+
+    static constexpr size_t kOutputBlockBytes = 16 * 1024;
+
+    virtual ~ContentDecoder() = default;
+
+    // Decoder for the Content-Encoding header value, or nullptr when it is
+    // empty or "identity". Throws DecodeError for encodings this build
+    // cannot decode (including stacked ones such as "gzip, br").
+    static std::unique_ptr<ContentDecoder> create(std::string_view encoding);
+
+    static bool supports(std::string_view encoding);
+
+    // Accept-Encoding value listing the supported encodings
+    static const std::string& accept_encoding();
+
+    // Decodes the next piece of the body. Returns false if the sink asked to
+    // stop; throws DecodeError on corrupt input.
+    virtual bool decode(std::string_view input, const Sink& sink) = 0;
+
+    // Call once the whole body has been fed; throws DecodeError if the
+    // encoded stream ended early
+    virtual void finish() = 0;
+};
+
+} // namespace cortan::network
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cortan/network/io_runtime.hpp>
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace cortan::network {
+
+// ============================================================================
+// DNS Cache
+// ============================================================================
+
+struct DnsCacheConfig {
+    // getaddrinfo() does not report record TTLs, so entries live for a fixed time
+    std::chrono::steady_clock::duration ttl = std::chrono::seconds(60);
+    // Failed lookups are remembered too, so a bad host does not cost a
+    // resolver round trip per request
+    std::chrono::steady_clock::duration negative_ttl = std::chrono::seconds(5);
+    // A hit later than this fraction of the TTL still returns the cached
+    // addresses but starts a background refresh, so hot hosts never expire
+    double refresh_ahead = 0.8;
+    size_t max_entries = 1024;
+};
+
+// Resolver cache shared by HttpClient instances (DnsCache::shared() unless
+// one is passed in). Concurrent misses for the same host:port share a single
+// lookup.
+class DnsCache {
+public:
+    using Results = boost::asio::ip::tcp::resolver::results_type;
+    using ResolveHandler = std::function<void(const boost::system::error_code& ec, Results results)>;
+
+    struct Stats {
+        size_t hits = 0;            // answered from a fresh entry
+        size_t negative_hits = 0;   // answered from a cached failure
+        size_t misses = 0;          // callers that waited for a lookup
+        size_t lookups = 0;         // resolver calls, including refreshes
+        size_t refreshes = 0;       // lookups started ahead of expiry
+        size_t entries = 0;
+    };
+
+    explicit DnsCache(DnsCacheConfig config = {});
+    DnsCache(DnsCacheConfig config, IoRuntime& runtime);
+    ~DnsCache();
+
+    DnsCache(const DnsCache&) = delete;
+    DnsCache& operator=(const DnsCache&) = delete;
+
+    static std::shared_ptr<DnsCache> shared();
+
+    // The handler runs on the runtime's threads, never inline
+    void async_resolve(const std::string& host, const std::string& port, ResolveHandler handler);
+
+    // Drops an entry, e.g. after its addresses stopped accepting connections
+    void invalidate(const std::string& host, const std::string& port);
+    void clear();
+
+    Stats stats() const;
+    const DnsCacheConfig& config() const;
+
+private:
+    // Shared with in-flight lookups, which may complete after the cache is gone
+    class Impl;
+    std::shared_ptr<Impl> impl_;
+};
+
+} // namespace cortan::network
@@ -1,18 +1,146 @@
 #pragma once
 
+#include <cortan/core/request_arena.hpp>
+#include <cortan/network/connection_pool.hpp>
+#include <cortan/network/dns_cache.hpp>
+#include <cortan/network/tls_session_cache.hpp>
+
 #include <string>
 #include <future>
 #include <utility>
 #include <memory>
 #include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
 
 namespace cortan::network {
 
+// Whether a request advertises Accept-Encoding (see ContentDecoder). Encoded
+// responses are decoded either way.
+enum class Compression {
+    Auto,   // for every host but localhost and loopback addresses
+    On,
+    Off,
+};
+
+struct RequestOptions {
+    // Bounds each wait: for a connection, for the response and, when
+    // streaming, for every chunk after it
+    std::chrono::steady_clock::duration timeout = std::chrono::seconds(30);
+    // Bounds the request as a whole, however steadily a stream delivers;
+    // zero for none
+    std::chrono::steady_clock::duration deadline{};
+    Compression compression = Compression::Auto;
+};
+
+// Why a request failed, so callers can tell an unhealthy endpoint from a
+// failure of their own making (see ResilientClient)
+enum class HttpError {
+    None,
+    Rejected,    // never sent: invalid URL or unsupported method
+    Connect,     // name lookup, TCP connect or TLS handshake
+    Transport,   // the connection failed while the request was under way
+    Timeout,     // the request, or the wait for a pooled connection, timed out
+    Status,      // the server answered with a status other than 200
+    Decode,      // the body could not be decompressed
+    Handler,     // the chunk handler threw
+    Cancelled,   // the caller cancelled it through its RequestHandle
+};
+
+// Everything known about a finished request
+struct HttpOutcome {
+    std::pair<bool, std::string> result;   // as the other calls report it
+    HttpError error = HttpError::None;     // None exactly when result.first
+    unsigned status = 0;                   // response status; 0 if none arrived
+    // For a Status failure, the (decoded) response body, cut at
+    // kMaxErrorBodyBytes. Streamed error bodies are collected here rather
+    // than handed to the chunk handler.
+    std::string error_body;
+
+    static constexpr size_t kMaxErrorBodyBytes = 64 * 1024;
+};
+
+// Refers to a request started with async_request or async_fetch. cancel()
+// closes whatever connection the request holds and completes it with
+// HttpError::Cancelled; once the request has completed it does nothing.
+// Safe to call from any thread. A default-constructed handle refers to no
+// request.
+class RequestHandle {
+public:
+    RequestHandle() = default;
+    explicit RequestHandle(std::function<void()> cancel) : cancel_(std::move(cancel)) {}
+
+    void cancel() const {
+        if (cancel_) cancel_();
+    }
+
+private:
+    std::function<void()> cancel_;
+};
+
+// One request of an HttpClient batch
+struct BatchRequest {
+    std::string method = "GET";   // any method async_request accepts
+    std::string url;
+    std::string body;
+};
+
+struct BatchOptions {
+    // Connections the batch opens per origin (still subject to the pool's
+    // per-host limit)
+    size_t connections_per_host = 4;
+    // Requests written ahead of the response being read on a connection;
+    // 1 sends the next request only once the previous response is in
+    size_t pipeline_depth = 8;
+    // Only idempotent methods (GET, HEAD, OPTIONS, PUT, DELETE) are
+    // pipelined by default: when a connection drops, a request whose
+    // response never arrived may or may not have been processed, and is sent
+    // again only if repeating it is harmless. Set this for POSTs that are
+    // safe to repeat, such as embeddings.
+    bool pipeline_posts = false;
+    // Bounds each wait for a response, like the timeout of a single request
+    std::chrono::steady_clock::duration timeout = std::chrono::seconds(30);
+    Compression compression = Compression::Auto;
+};
+
+// Requests run as async operations on the pool's IoRuntime; the returned
+// future is the only thing that blocks. A timeout cancels whatever I/O is in
+// flight and fails the request with "Request timed out after ...".
+// Compressed responses are decoded as they are read; remote hosts are asked
+// for them unless RequestOptions say otherwise.
 class HttpClient {
 public:
+    // Receives response body bytes as they arrive; return false to stop the
+    // stream early. The view is only valid during the call.
+    using ChunkHandler = std::function<bool(std::string_view chunk)>;
+
+    // Receives the result of async_request
+    using ResultHandler = std::function<void(std::pair<bool, std::string> result)>;
+
+    // Receives the outcome of async_fetch
+    using OutcomeHandler = std::function<void(HttpOutcome outcome)>;
+
+    // Receives each batch result as it arrives, with the request's index
+    using BatchResultHandler = std::function<void(size_t index, const std::pair<bool, std::string>& result)>;
+
     HttpClient();
+    // Clients sharing a pool share its keep-alive connections. Name lookups
+    // and TLS sessions go through DnsCache::shared() and
+    // TlsSessionCache::shared() unless caches are given.
+    explicit HttpClient(std::shared_ptr<ConnectionPool> pool,
+                        std::shared_ptr<DnsCache> dns = nullptr,
+                        std::shared_ptr<TlsSessionCache> tls = nullptr);
     ~HttpClient();
 
+    std::shared_ptr<ConnectionPool> connection_pool() const;
+
+    // Body bytes this client has copied: caller strings passed by const
+    // reference, and payloads staged in or copied out of a RequestArena.
+    // Socket reads and writes are not counted.
+    uint64_t payload_bytes_copied() const;
+
     // Methods with default timeout (30 seconds)
     std::future<std::pair<bool, std::string>> get(const std::string& url);
     std::future<std::pair<bool, std::string>> post(const std::string& url, const std::string& data);
@@ -24,6 +152,93 @@ public:
                                                    const std::string& data,
                                                    std::chrono::steady_clock::duration timeout);
 
+    // Moves the payload into the request instead of copying it. Without an
+    // arena the response body is likewise moved into the result, so large
+    // prompts and completions cross the client without a copy.
+    std::future<std::pair<bool, std::string>> post(const std::string& url,
+                                                   std::string&& data,
+                                                   std::chrono::steady_clock::duration timeout = std::chrono::seconds(30));
+
+    // Per-request options (timeout, compression)
+    std::future<std::pair<bool, std::string>> get(const std::string& url, const RequestOptions& options);
+    std::future<std::pair<bool, std::string>> post(const std::string& url,
+                                                   const std::string& data,
+                                                   const RequestOptions& options);
+    std::future<std::pair<bool, std::string>> post(const std::string& url,
+                                                   std::string&& data,
+                                                   const RequestOptions& options);
+
+    // Request-scoped variants: the request and response bodies are
+    // bump-allocated from the arena, which stays alive until the future is
+    // ready. Both bodies are copied (into and out of the arena).
+    std::future<std::pair<bool, std::string>> get(const std::string& url,
+                                                  std::shared_ptr<core::RequestArena> arena,
+                                                  std::chrono::steady_clock::duration timeout = std::chrono::seconds(30));
+    std::future<std::pair<bool, std::string>> post(const std::string& url,
+                                                   const std::string& data,
+                                                   std::shared_ptr<core::RequestArena> arena,
+                                                   std::chrono::steady_clock::duration timeout = std::chrono::seconds(30));
+
+    // Streaming variants for long-running responses such as token-by-token
+    // generation. Chunks are delivered from the runtime thread as they are
+    // parsed, and the next read is only issued once the handler returns, so a
+    // slow consumer throttles the server through TCP flow control instead of
+    // buffering. The timeout bounds each wait for data (time to first byte and
+    // the gaps between chunks), not the whole stream; RequestOptions::deadline
+    // bounds that. Encoded bodies are
+    // decoded on the way, so the handler only sees decoded bytes. The future yields
+    // {true, ""} once the body is complete or the handler stopped it, and
+    // {false, error} otherwise, including non-200 responses.
+    std::future<std::pair<bool, std::string>> get_stream(const std::string& url,
+                                                         ChunkHandler on_chunk,
+                                                         std::chrono::steady_clock::duration timeout = std::chrono::seconds(30));
+    std::future<std::pair<bool, std::string>> post_stream(const std::string& url,
+                                                          const std::string& data,
+                                                          ChunkHandler on_chunk,
+                                                          std::chrono::steady_clock::duration timeout = std::chrono::seconds(30));
+    std::future<std::pair<bool, std::string>> get_stream(const std::string& url,
+                                                         ChunkHandler on_chunk,
+                                                         const RequestOptions& options);
+    std::future<std::pair<bool, std::string>> post_stream(const std::string& url,
+                                                          const std::string& data,
+                                                          ChunkHandler on_chunk,
+                                                          const RequestOptions& options);
+
+    // Completion-handler form of the calls above, for code that composes
+    // requests (retries, hedging) without a thread blocked on each future.
+    // on_result runs on a runtime thread, never inline; with on_chunk set
+    // the body is streamed to it as in post_stream. The method is sent as
+    // given (an empty one is GET); one that is not a standard HTTP method
+    // fails with "Unsupported HTTP method: ...". GET and HEAD carry no body.
+    // The handle cancels the request; it is empty for one refused up front.
+    RequestHandle async_request(std::string_view method,
+                       const std::string& url,
+                       std::string body,
+                       const RequestOptions& options,
+                       ResultHandler on_result,
+                       ChunkHandler on_chunk = {});
+
+    // As async_request, reporting the whole outcome: why the request failed,
+    // the status, and the body of an error response
+    RequestHandle async_fetch(std::string_view method,
+                     const std::string& url,
+                     std::string body,
+                     const RequestOptions& options,
+                     OutcomeHandler on_outcome,
+                     ChunkHandler on_chunk = {});
+
+    // Sends many small requests (embeddings, health checks, model listings)
+    // over a few pooled connections per origin instead of one checkout and
+    // round trip each. Each connection keeps up to pipeline_depth requests in
+    // flight; a server that answers with Connection: close or HTTP/1.0 has
+    // the rest of the batch sent to it one request at a time. on_result runs
+    // on a runtime thread as each response arrives (responses on one
+    // connection arrive in the order sent). The future yields every result,
+    // in request order, once all have arrived.
+    std::future<std::vector<std::pair<bool, std::string>>> send_batch(std::vector<BatchRequest> requests,
+                                                                      BatchResultHandler on_result = {},
+                                                                      BatchOptions options = {});
+
 private:
     class Impl;
     std::unique_ptr<Impl> impl_;
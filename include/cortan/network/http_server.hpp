@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cortan/network/request_handler.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace cortan::network {
+
+// ============================================================================
+// HTTP Server
+// ============================================================================
+
+struct HttpServerConfig {
+    // Loopback by default: the server does no authentication of its own, so
+    // exposing it on other interfaces is an explicit choice
+    std::string address = "127.0.0.1";
+    unsigned short port = 8080;     // network.http_port; 0 picks a free port
+    size_t threads = 0;             // I/O threads, 0 for one per core
+
+    // A keep-alive connection with no request in progress for this long is closed
+    std::chrono::steady_clock::duration idle_timeout = std::chrono::seconds(30);
+
+    size_t max_header_bytes = 16 * 1024;
+    size_t max_body_bytes = 8 * 1024 * 1024;   // larger bodies get 413
+};
+
+// Embedded HTTP/1.1 server dispatching to a RequestHandler.
+//
+// Thread per core: each I/O thread runs its own io_context with its own
+// listening socket on the shared port (SO_REUSEPORT), so the kernel spreads
+// connections across threads and a connection lives on one thread for its
+// whole life, with no locks or strand hops on the request path. Without
+// SO_REUSEPORT one acceptor hands sockets to the threads in turn. The port is
+// first bound once without SO_REUSEPORT, so a port already held by another
+// process (even another instance of this one) makes start() fail.
+// Connections are kept alive and pipelined requests are answered in order.
+//
+// Handlers run on the connection's I/O thread and must not block; a
+// streamed response (HttpResponse::streamer) lets a handler return at once
+// and produce the body from elsewhere, sent as chunked transfer encoding.
+class HttpServer {
+public:
+    struct Stats {
+        uint64_t connections_accepted = 0;
+        uint64_t requests_handled = 0;
+        uint64_t responses_streamed = 0;
+        uint64_t bytes_received = 0;   // request bodies
+        uint64_t bytes_sent = 0;       // response bodies, including streamed chunks
+        size_t active_connections = 0;
+    };
+
+    // Throws std::invalid_argument for a null handler or bad limits
+    explicit HttpServer(std::shared_ptr<RequestHandler> handler, HttpServerConfig config = {});
+    ~HttpServer();   // stops the server
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    // Compiles the routes, binds and starts the I/O threads. {false, error}
+    // if the address cannot be bound or the server was already started.
+    std::pair<bool, std::string> start();
+
+    // Closes the listeners and every connection, then joins the threads.
+    // Streams still held by producers report write() == false afterwards.
+    void stop();
+
+    bool is_running() const;
+    // The bound port, once started (useful with port 0)
+    unsigned short port() const;
+    size_t thread_count() const;
+    Stats stats() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace cortan::network
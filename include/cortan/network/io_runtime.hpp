@@ -0,0 +1,52 @@
+#pragma once
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+
+#include <thread>
+#include <vector>
+
+namespace cortan::network {
+
+// ============================================================================
+// I/O Runtime
+// ============================================================================
+
+// Kernel interface behind the runtime's sockets and timers. Asio fixes it at
+// build time: ENABLE_IO_URING switches every component from epoll to
+// io_uring, which batches submissions and completions into far fewer
+// syscalls per request.
+enum class IoBackend { Epoll, IoUring, Other };
+
+// A multi-threaded io_context that all network components share. Every
+// socket, timer and resolver lives here and every operation is async, so a
+// handful of threads carries thousands of in-flight requests.
+class IoRuntime {
+public:
+    explicit IoRuntime(size_t num_threads);
+    ~IoRuntime();   // stops the context and joins its threads
+
+    IoRuntime(const IoRuntime&) = delete;
+    IoRuntime& operator=(const IoRuntime&) = delete;
+
+    // Process-wide runtime sized to the hardware (1 to 4 threads). Never
+    // destroyed, so pools and clients with static lifetime stay valid.
+    static IoRuntime& shared();
+
+    static IoBackend backend();
+    static const char* backend_name();
+
+    boost::asio::io_context& context() { return io_context_; }
+    size_t thread_count() const { return threads_.size(); }
+
+    // True when called from one of this runtime's threads; blocking waits
+    // there would stall the runtime
+    bool running_in_this_thread() const;
+
+private:
+    boost::asio::io_context io_context_;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work_guard_;
+    std::vector<std::thread> threads_;
+};
+
+} // namespace cortan::network
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace cortan::network {
+
+// ============================================================================
+// Requests and Responses
+// ============================================================================
+
+struct HttpRequest {
+    std::string method;   // upper case, as sent ("GET", "POST", ...)
+    std::string target;   // path and query, as sent
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+    bool keep_alive = true;
+
+    std::string_view path() const;    // target up to '?'
+    std::string_view query() const;   // after '?', empty if none
+    // First header with this name (case-insensitive), empty if absent
+    std::string_view header(std::string_view name) const;
+};
+
+// Body of a streamed response. Chunks may be written from any thread, for
+// instance from an HttpClient streaming callback relaying model tokens; they
+// go out as HTTP/1.1 chunks in the order written.
+class ResponseStream {
+public:
+    virtual ~ResponseStream() = default;
+
+    // False once the client has gone away (or after finish()); the producer
+    // should stop then
+    virtual bool write(std::string chunk) = 0;
+
+    // Ends the response. Dropping the last reference does the same.
+    virtual void finish() = 0;
+};
+
+struct HttpResponse {
+    using Streamer = std::function<void(std::shared_ptr<ResponseStream> stream)>;
+
+    int status = 200;
+    std::string content_type = "application/json";
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+
+    // When set, the body is ignored: the server sends the status and headers
+    // and calls the streamer with the response body stream
+    Streamer streamer;
+};
+
+// Values captured by ":name" and "*name" route segments. The views point
+// into the request target and the route table, valid during the handler call.
+class RouteParams {
+public:
+    std::string_view get(std::string_view name) const {
+        for (const auto& [key, value] : values_) {
+            if (key == name) return value;
+        }
+        return {};
+    }
+    size_t size() const { return values_.size(); }
+
+private:
+    friend class RequestHandler;
+    using Values = std::vector<std::pair<std::string_view, std::string_view>>;
+    Values values_;
+};
+
+// ============================================================================
+// Request Handler
+// ============================================================================
+
+// Routes requests to handlers by method and path. Patterns are literal paths
+// with optional ":name" segments (one path segment) and a trailing "*name"
+// (the rest of the path, possibly empty):
+//     handler.register_route("GET", "/api/models/:name", show_model);
+//     handler.register_route("GET", "/static/*file", serve_file);
+// Literal segments win over parameters, which win over "*". Routes are
+// registered up front and compiled into a flat radix tree on the first
+// request (or compile()); lookups then take no locks. Unmatched paths get
+// 404 and unregistered methods 405. HEAD falls back to GET.
+class RequestHandler {
+public:
+    using RouteHandler = std::function<void(const HttpRequest& request,
+                                            const RouteParams& params,
+                                            HttpResponse& response)>;
+
+    RequestHandler();
+    ~RequestHandler();
+
+    RequestHandler(const RequestHandler&) = delete;
+    RequestHandler& operator=(const RequestHandler&) = delete;
+
+    // Any method. Throws std::invalid_argument for malformed or conflicting
+    // patterns and std::logic_error once the routes are compiled.
+    void register_route(const std::string& path, RouteHandler handler);
+    void register_route(const std::string& method, const std::string& path, RouteHandler handler);
+
+    // Freezes the routes; thread-safe, later calls do nothing
+    void compile();
+
+    // Safe to call from many threads at once
+    void handle_request(const HttpRequest& request, HttpResponse& response);
+
+    size_t route_count() const;
+
+private:
+    class Tree;
+    struct Route {
+        std::string method;   // empty for any
+        std::string pattern;
+        RouteHandler handler;
+    };
+
+    std::vector<Route> routes_;
+    std::unique_ptr<Tree> tree_;
+    std::atomic<bool> compiled_{false};
+    mutable std::mutex mutex_;   // registration and compilation
+};
+
+} // namespace cortan::network
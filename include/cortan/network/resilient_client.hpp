@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cortan/network/http_client.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace cortan::network {
+
+// ============================================================================
+// Circuit Breaker
+// ============================================================================
+
+struct CircuitBreakerConfig {
+    // Consecutive failures (timeouts, connection and transport errors, 5xx,
+    // 429) that open the circuit; client errors such as 404, bodies that fail
+    // to decode and chunk handlers that throw do not count
+    size_t failure_threshold = 5;
+    // How long an open circuit fails calls at once before letting one probe
+    // through to see whether the endpoint has recovered
+    std::chrono::steady_clock::duration open_duration = std::chrono::seconds(5);
+};
+
+class CircuitBreaker {
+public:
+    enum class State { Closed, Open, HalfOpen };
+
+    explicit CircuitBreaker(CircuitBreakerConfig config = {});
+
+    // Whether a call may go out now. Past open_duration an open circuit
+    // turns half-open and admits exactly one probe until it reports back.
+    bool allow();
+    void record_success();
+    void record_failure();
+
+    State state() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    const CircuitBreakerConfig config_;
+    mutable std::mutex mutex_;
+    State state_ = State::Closed;
+    size_t consecutive_failures_ = 0;
+    Clock::time_point opened_at_;
+    bool probe_in_flight_ = false;
+};
+
+// ============================================================================
+// Resilient Client
+// ============================================================================
+
+struct RetryConfig {
+    size_t max_attempts = 3;   // including the first
+    // Full jitter: retry n waits uniform(0, min(max_backoff, base_backoff * 2^n))
+    std::chrono::steady_clock::duration base_backoff = std::chrono::milliseconds(50);
+    std::chrono::steady_clock::duration max_backoff = std::chrono::seconds(1);
+    // Retries and hedges come out of a per-endpoint budget: each first
+    // attempt adds budget_ratio, up to budget_cap (also the starting
+    // balance). When an endpoint fails everything, retries stop at about
+    // budget_ratio extra load instead of multiplying it by max_attempts.
+    double budget_ratio = 0.2;
+    double budget_cap = 10.0;
+};
+
+struct HedgeConfig {
+    bool enabled = false;
+    // A second attempt goes out once the first has run longer than this
+    // percentile of the endpoint's recent successful latencies; the first
+    // answer wins and the other attempt is cancelled
+    double percentile = 0.95;
+    size_t min_samples = 20;   // no hedging before the endpoint has this many
+    std::chrono::steady_clock::duration min_delay = std::chrono::milliseconds(5);
+};
+
+struct ResilienceConfig {
+    CircuitBreakerConfig breaker;
+    RetryConfig retry;
+    HedgeConfig hedge;
+};
+
+// Wraps HttpClient calls with a circuit breaker, a retry budget and latency
+// tracking per endpoint (scheme://host:port). Retries and hedges only apply
+// to idempotent requests: GET, HEAD, OPTIONS, PUT and DELETE, and other
+// methods the caller marks as such.
+// Everything runs on the client's runtime; nothing blocks a thread per
+// attempt.
+class ResilientClient {
+public:
+    struct EndpointStats {
+        CircuitBreaker::State state = CircuitBreaker::State::Closed;
+        uint64_t requests = 0;
+        uint64_t attempts = 0;
+        uint64_t retries = 0;
+        uint64_t hedges = 0;
+        uint64_t hedge_wins = 0;          // the hedge answered first
+        uint64_t short_circuited = 0;     // failed at once by an open circuit
+        uint64_t budget_exhausted = 0;    // retries or hedges refused by the budget
+        std::chrono::steady_clock::duration hedge_delay{};   // zero until enough samples
+    };
+
+    // Throws std::invalid_argument for zero attempts or thresholds, or a
+    // percentile outside (0, 1)
+    explicit ResilientClient(std::shared_ptr<HttpClient> client = nullptr, ResilienceConfig config = {});
+    ~ResilientClient();
+
+    ResilientClient(const ResilientClient&) = delete;
+    ResilientClient& operator=(const ResilientClient&) = delete;
+
+    // options.timeout bounds each attempt. An open circuit fails with
+    // "Circuit open for <endpoint>"; retries exhausted report the last error.
+    std::future<std::pair<bool, std::string>> get(const std::string& url, const RequestOptions& options = {});
+    std::future<std::pair<bool, std::string>> post(const std::string& url,
+                                                   std::string body,
+                                                   const RequestOptions& options = {},
+                                                   bool idempotent = false);
+
+    // Completion-handler form; the handler runs on a runtime thread
+    void async_request(std::string_view method,
+                       const std::string& url,
+                       std::string body,
+                       const RequestOptions& options,
+                       bool idempotent,
+                       HttpClient::ResultHandler on_result);
+
+    // As HttpClient::async_fetch. A streamed call (on_chunk set) is never
+    // hedged, and is retried only while no chunk has reached the handler:
+    // once part of a reply has been handed over, a failure is reported at
+    // once.
+    void async_fetch(std::string_view method,
+                     const std::string& url,
+                     std::string body,
+                     const RequestOptions& options,
+                     bool idempotent,
+                     HttpClient::OutcomeHandler on_outcome,
+                     HttpClient::ChunkHandler on_chunk = {});
+
+    EndpointStats stats(const std::string& url) const;
+    std::shared_ptr<HttpClient> client() const;
+
+private:
+    // Shared with calls in flight, which may outlive the client
+    class Impl;
+    std::shared_ptr<Impl> impl_;
+};
+
+} // namespace cortan::network
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <boost/asio/ssl/context.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace cortan::network {
+
+// ============================================================================
+// TLS Session Cache
+// ============================================================================
+
+struct TlsConfig {
+    bool verify_peer = true;
+    // PEM certificates trusted in addition to the system store (e.g. a
+    // self-signed certificate on a local model server)
+    std::string extra_ca_pem;
+    bool session_resumption = true;
+    size_t max_sessions = 256;
+};
+
+// One client ssl::context shared by every HttpClient (shared() unless one is
+// passed in), plus the sessions it negotiated, keyed by origin. A connection
+// to an origin seen before offers the cached session or ticket and, if the
+// server accepts it, skips the certificate exchange and key agreement of a
+// full handshake.
+class TlsSessionCache {
+public:
+    struct Stats {
+        size_t full_handshakes = 0;
+        size_t resumed_handshakes = 0;
+        size_t sessions = 0;        // origins with a resumable session
+    };
+
+    explicit TlsSessionCache(TlsConfig config = {});
+    ~TlsSessionCache();
+
+    TlsSessionCache(const TlsSessionCache&) = delete;
+    TlsSessionCache& operator=(const TlsSessionCache&) = delete;
+
+    static std::shared_ptr<TlsSessionCache> shared();
+
+    boost::asio::ssl::context& context();
+    const TlsConfig& config() const;
+
+    // Before the handshake: tags the connection with its origin and offers
+    // the cached session, if any. New sessions (TLS 1.3 tickets arrive after
+    // the handshake) are stored as the server issues them.
+    void prepare(SSL* ssl, const std::string& origin);
+
+    // After a successful handshake; counts it as full or resumed
+    void record_handshake(SSL* ssl);
+
+    void invalidate(const std::string& origin);
+    void clear();
+
+    Stats stats() const;
+
+private:
+    // Referenced weakly from connections, which can outlive the cache in a pool
+    class Impl;
+    std::shared_ptr<Impl> impl_;
+};
+
+} // namespace cortan::network
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cortan::network {
+
+// ============================================================================
+// URL Parsing
+// ============================================================================
+
+// Position of one component within the URL string
+struct UrlSpan {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+
+    std::string_view in(std::string_view url) const { return url.substr(offset, length); }
+    bool empty() const { return length == 0; }
+};
+
+// An absolute http(s) or ws(s) URL split into offsets, so parsing allocates nothing
+// and the result stays valid for any copy of the string it was parsed from.
+// Accessors take that string:
+//     auto parsed = ParsedUrl::parse(url);
+//     if (parsed) connect(parsed->host(url), parsed->port_or_default(url));
+class ParsedUrl {
+public:
+    // nullopt unless url is http://, https://, ws:// or wss:// with a host
+    // and, if given,
+    // a numeric port. IPv6 hosts are written in brackets, which host()
+    // leaves out.
+    static std::optional<ParsedUrl> parse(std::string_view url) noexcept;
+
+    bool is_secure() const { return secure_; }        // https or wss
+    bool is_websocket() const { return websocket_; }  // ws or wss
+
+    std::string_view scheme(std::string_view url) const { return scheme_.in(url); }
+    std::string_view userinfo(std::string_view url) const { return userinfo_.in(url); }
+    std::string_view host(std::string_view url) const { return host_.in(url); }
+    std::string_view port(std::string_view url) const { return port_.in(url); }   // as written, may be empty
+    std::string_view path(std::string_view url) const { return path_.in(url); }
+    std::string_view query(std::string_view url) const { return query_.in(url); }
+    std::string_view fragment(std::string_view url) const { return fragment_.in(url); }
+
+    // The explicit port, or 443 for https/wss and 80 for http/ws
+    std::string_view port_or_default(std::string_view url) const {
+        if (!port_.empty()) return port_.in(url);
+        return secure_ ? "443" : "80";
+    }
+
+    // Path and query as written, without the fragment. Nothing is added, so
+    // this is "" for "http://host" and "?x=1" for "http://host?x=1"; the
+    // caller puts the '/' in front before using it as a request target.
+    std::string_view target(std::string_view url) const { return target_.in(url); }
+
+private:
+    UrlSpan scheme_;
+    UrlSpan userinfo_;
+    UrlSpan host_;
+    UrlSpan port_;
+    UrlSpan path_;
+    UrlSpan query_;
+    UrlSpan fragment_;
+    UrlSpan target_;
+    bool secure_ = false;
+    bool websocket_ = false;
+};
+
+// ============================================================================
+// URL Cache
+// ============================================================================
+
+// Parse results for the handful of endpoints a client calls over and over
+// (generate, embeddings, model listing). A lookup compares against at most
+// `capacity` recent URLs; a miss parses and replaces the oldest entry.
+// Invalid URLs are not cached. Thread-safe.
+class UrlCache {
+public:
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t entries = 0;
+    };
+
+    explicit UrlCache(size_t capacity = 16);
+
+    UrlCache(const UrlCache&) = delete;
+    UrlCache& operator=(const UrlCache&) = delete;
+
+    // Same result as ParsedUrl::parse(url); the offsets apply to url
+    std::optional<ParsedUrl> parse(std::string_view url);
+
+    void clear();
+    Stats stats() const;
+
+private:
+    struct Entry {
+        std::string url;
+        ParsedUrl parsed;
+    };
+
+    const size_t capacity_;
+    std::vector<Entry> entries_;
+    size_t next_victim_ = 0;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+    mutable std::mutex mutex_;
+};
+
+} // namespace cortan::network
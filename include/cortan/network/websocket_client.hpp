@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cortan/network/dns_cache.hpp>
+#include <cortan/network/io_runtime.hpp>
+#include <cortan/network/tls_session_cache.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace cortan::network {
+
+// ============================================================================
+// WebSocket Client
+// ============================================================================
+
+struct WebSocketOptions {
+    // DNS lookup, TCP connect, TLS and WebSocket handshakes together
+    std::chrono::steady_clock::duration connect_timeout = std::chrono::seconds(10);
+
+    // Offer permessage-deflate (RFC 7692); used only if the server accepts
+    bool permessage_deflate = true;
+    int deflate_level = 6;   // zlib level, 1 (fastest) to 9
+
+    // Outgoing messages larger than this go out as several frames, so a
+    // large message never has to be masked or compressed in one piece
+    size_t fragment_bytes = 64 * 1024;
+
+    // Incoming messages larger than this close the connection
+    size_t max_message_bytes = 16 * 1024 * 1024;
+
+    // send() refuses new messages while this many payload bytes are queued
+    size_t max_queued_bytes = 8 * 1024 * 1024;
+
+    // Opt-in: text messages shorter than coalesce_below that queue up behind
+    // a write are joined with the delimiter into one message of at most
+    // max_coalesced_bytes. Only for receivers that split on the delimiter,
+    // such as NDJSON token streams.
+    bool coalesce = false;
+    size_t coalesce_below = 512;
+    size_t max_coalesced_bytes = 16 * 1024;
+    char coalesce_delimiter = '\n';
+};
+
+// Async WebSocket client (ws:// and wss://) on the shared IoRuntime, for
+// pushing token streams to dashboards and receiving live events.
+//
+// Outgoing messages are moved or shared into the send queue, never copied,
+// and framed straight from those buffers. The queue is drained in batches:
+// everything queued while a write is in flight goes out on the next pass
+// without a strand hop per message. Received messages are delivered to the
+// message handler on a runtime thread.
+class WebSocketClient {
+public:
+    // Valid only during the call
+    using MessageHandler = std::function<void(std::string_view message, bool is_text)>;
+    // Runs once when an open connection ends, with the reason
+    using CloseHandler = std::function<void(const std::string& reason)>;
+
+    struct Stats {
+        uint64_t messages_queued = 0;      // accepted by send()
+        uint64_t messages_sent = 0;        // written to the connection
+        uint64_t messages_coalesced = 0;   // joined into an earlier message
+        uint64_t frames_sent = 0;
+        uint64_t write_batches = 0;        // passes over the send queue
+        uint64_t bytes_sent = 0;           // payload, before compression
+        uint64_t messages_received = 0;
+        uint64_t bytes_received = 0;       // payload, after decompression
+    };
+
+    WebSocketClient();
+    // Name lookups and TLS sessions go through DnsCache::shared() and
+    // TlsSessionCache::shared() unless caches are given
+    explicit WebSocketClient(WebSocketOptions options,
+                             std::shared_ptr<DnsCache> dns = nullptr,
+                             std::shared_ptr<TlsSessionCache> tls = nullptr,
+                             IoRuntime& runtime = IoRuntime::shared());
+    ~WebSocketClient();   // closes the connection without waiting
+
+    WebSocketClient(const WebSocketClient&) = delete;
+    WebSocketClient& operator=(const WebSocketClient&) = delete;
+
+    // Set before connect()
+    void on_message(MessageHandler handler);
+    void on_close(CloseHandler handler);
+
+    // Yields {true, ""} once the handshake completes, {false, error}
+    // otherwise. Messages sent while connecting go out once it is open. A
+    // client connects once; use a new one to reconnect.
+    std::future<std::pair<bool, std::string>> connect(const std::string& url);
+
+    // Queues a message; false if the client is not connecting or open, or
+    // the queue is full. Failures after queueing end the connection.
+    bool send(std::string message, bool is_text = true);
+    // The same buffer can be queued on many clients, e.g. to broadcast
+    bool send(std::shared_ptr<const std::string> message, bool is_text = true);
+
+    // Completes once every message queued before the call has been written,
+    // or with the error that ended the connection
+    std::future<std::pair<bool, std::string>> flush();
+
+    // Sends a close frame after the queued messages and shuts down
+    void disconnect();
+
+    bool is_connected() const;
+    // Whether the server accepted permessage-deflate
+    bool compression_active() const;
+    Stats stats() const;
+
+private:
+    // Shared with in-flight operations, which may complete after the client is gone
+    class Impl;
+    std::shared_ptr<Impl> impl_;
+};
+
+} // namespace cortan::network
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cortan/core/event_system.hpp>
+#include <cortan/network/io_runtime.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace cortan::network {
+
+// ============================================================================
+// WebSocket Server
+// ============================================================================
+
+// What a full client queue does with the next message
+enum class SlowConsumerPolicy {
+    DropOldest,   // discard the oldest queued message
+    Coalesce      // replace the queued message of the same topic, else drop the oldest
+};
+
+struct WebSocketServerConfig {
+    // Loopback by default; events carry prompt content and user ids
+    std::string address = "127.0.0.1";
+    unsigned short port = 8081;   // network.websocket_port; 0 picks a free port
+
+    // Browsers send Origin with every handshake, so a web page can reach a
+    // server its visitor can (cross-site WebSocket hijacking). A handshake
+    // whose Origin is not listed here is refused with 403; clients that send
+    // no Origin, such as other services, are not affected.
+    std::vector<std::string> allowed_origins;
+
+    // Maps the handshake's bearer token (Authorization header, or the
+    // access_token query parameter for browsers) to a user id; nullopt
+    // refuses the connection with 401. Unset, clients connect as user "".
+    std::function<std::optional<std::string>(std::string_view token)> authenticate;
+
+    // Whether the user may receive a topic ("*" included). Handshake topics
+    // that fail refuse the connection with 403; failing topics in a later
+    // subscribe message are ignored. Unset, every topic is allowed.
+    // SecurityManager::subscription_authorizer() checks its policy.
+    std::function<bool(const std::string& user_id, const std::string& topic)> authorize_subscription;
+
+    // Per-client send queue. A client that reads slower than events arrive
+    // loses messages by the policy below instead of holding up the bus.
+    size_t max_queued_messages = 256;
+    size_t max_queued_bytes = 4 * 1024 * 1024;
+    SlowConsumerPolicy slow_consumer = SlowConsumerPolicy::Coalesce;
+
+    // Incoming (subscription) messages larger than this close the connection
+    size_t max_message_bytes = 64 * 1024;
+    std::chrono::steady_clock::duration handshake_timeout = std::chrono::seconds(10);
+
+    // Off by default: deflate runs per connection, so it would redo for
+    // every client the work that broadcasting one buffer saves
+    bool permessage_deflate = false;
+};
+
+// Pushes EventBus events to remote subscribers such as dashboards.
+//
+// Clients pick topics in the handshake URL ("/events?topics=ai.processing,
+// user.request", "*" for every topic) and change them later with text
+// messages {"subscribe": [...]} or {"unsubscribe": [...]}. A broadcast
+// message is serialized once and the same immutable buffer is queued on
+// every matching client; each client drains its own queue on its own
+// strand, so queueing never waits on a socket.
+class WebSocketServer {
+public:
+    struct Stats {
+        uint64_t connections_accepted = 0;
+        uint64_t events_serialized = 0;    // bridged events, once per event and topic
+        uint64_t messages_queued = 0;      // offered to clients, once per client
+        uint64_t messages_sent = 0;
+        uint64_t messages_dropped = 0;     // lost to a full queue
+        uint64_t messages_coalesced = 0;   // replaced by a newer one of the same topic
+        uint64_t handshakes_refused = 0;   // bad Origin, token or topics
+        uint64_t subscriptions_denied = 0; // topics dropped from subscribe messages
+        size_t clients = 0;
+    };
+
+    // Throws std::invalid_argument for zero queue limits
+    explicit WebSocketServer(WebSocketServerConfig config = {}, IoRuntime& runtime = IoRuntime::shared());
+    ~WebSocketServer();   // stops the server
+
+    WebSocketServer(const WebSocketServer&) = delete;
+    WebSocketServer& operator=(const WebSocketServer&) = delete;
+
+    // Binds and starts accepting. {false, error} if the address cannot be
+    // bound or the server was already started.
+    std::pair<bool, std::string> start();
+
+    // Stops accepting and closes every client connection
+    void stop();
+
+    // Forwards events published on the bus under these event types to the
+    // clients subscribed to them. Events nobody is subscribed to are not
+    // serialized. The bus may outlive the server.
+    void bridge(core::EventBus& bus, const std::vector<std::string>& topics);
+
+    // Queues the message on every client subscribed to the topic; returns
+    // how many clients took it. Callable from any thread.
+    size_t broadcast(const std::string& topic, std::shared_ptr<const std::string> message);
+
+    bool has_subscribers(const std::string& topic) const;
+    size_t client_count() const;
+    unsigned short port() const;   // the bound port, once started
+    Stats stats() const;
+
+    // The JSON object sent for a bridged event
+    static std::string serialize_event(const std::string& topic, const core::BaseEvent& event);
+
+private:
+    // Shared with connections and bus subscriptions, which may outlive the server
+    class Impl;
+    std::shared_ptr<Impl> impl_;
+};
+
+} // namespace cortan::network
@@ -0,0 +1,435 @@
+#include <cortan/ai/audit_log.hpp>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace cortan::ai {
+
+namespace {
+
+constexpr char kFileMagic[8] = {'C', 'T', 'N', 'A', 'U', 'D', 'I', 'T'};
+constexpr uint32_t kFileVersion = 1;
+constexpr size_t kFileHeaderBytes = sizeof(kFileMagic) + 4;
+
+constexpr uint32_t kRecordMarker = 0xA0D17E57;
+constexpr size_t kRecordHeaderBytes = 12;                 // marker, length, crc
+constexpr size_t kPayloadFixedBytes = 8 + 8 + 2 + 4;      // sequence, time, lengths
+
+constexpr size_t kMaxBatchEvents = 512;
+
+void put_u16(std::string& out, uint16_t value) {
+    out.push_back(static_cast<char>(value & 0xff));
+    out.push_back(static_cast<char>(value >> 8));
+}
+
+void put_u32(std::string& out, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) out.push_back(static_cast<char>((value >> shift) & 0xff));
+}
+
+void put_u64(std::string& out, uint64_t value) {
+    for (int shift = 0; shift < 64; shift += 8) out.push_back(static_cast<char>((value >> shift) & 0xff));
+}
+
+uint64_t get_le(const unsigned char* data, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) value |= static_cast<uint64_t>(data[i]) << (8 * i);
+    return value;
+}
+
+uint32_t checksum(const char* data, size_t size) {
+    return static_cast<uint32_t>(
+        crc32(0, reinterpret_cast<const Bytef*>(data), static_cast<uInt>(size)));
+}
+
+int64_t unix_ns_now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+AuditLogConfig validated(AuditLogConfig config) {
+    if (config.ring_capacity == 0 || (config.ring_capacity & (config.ring_capacity - 1)) != 0) {
+        throw std::invalid_argument("AuditLog: ring_capacity must be a power of two");
+    }
+    if (config.max_file_bytes <= kFileHeaderBytes || config.max_rotated_files == 0) {
+        throw std::invalid_argument("AuditLog: file limits must be non-zero");
+    }
+    return config;
+}
+
+} // namespace
+
+// ============================================================================
+// Impl
+// ============================================================================
+
+class AuditLog::Impl {
+public:
+    explicit Impl(AuditLogConfig config)
+        : config_(validated(std::move(config)))
+        , mask_(config_.ring_capacity - 1)
+        , slots_(std::make_unique<Slot[]>(config_.ring_capacity)) {
+        for (size_t i = 0; i < config_.ring_capacity; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~Impl() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        if (writer_.joinable()) writer_.join();
+    }
+
+    std::pair<bool, std::string> open() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (writer_.joinable()) return {false, "audit log already open"};
+        resume_sequence();
+        if (!open_file()) return {false, "cannot open " + config_.path};
+        stats_.file_open = true;
+        writer_ = std::thread([this] { run_writer(); });
+        return {true, ""};
+    }
+
+    // Bounded MPMC ring (Vyukov) used with a single consumer: each slot's
+    // sequence says whether it is free for position p (== p), filled for
+    // p (== p + 1), or still holds an older lap
+    bool append(std::string_view event_type, std::string_view details) {
+        uint64_t pos = tail_.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots_[pos & mask_];
+            uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+            auto lag = static_cast<int64_t>(sequence - pos);
+            if (lag == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (lag < 0) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->time_ns = unix_ns_now();
+        slot->event_type.assign(event_type.substr(0, std::numeric_limits<uint16_t>::max()));
+        slot->details.assign(details.substr(0, std::numeric_limits<uint32_t>::max()));
+        slot->sequence.store(pos + 1, std::memory_order_release);
+
+        // The writer polls every flush_interval; a nudge every half ring keeps
+        // bursts from overflowing it without a notify per event
+        if ((pos & (mask_ >> 1)) == 0) wake_.notify_one();
+        return true;
+    }
+
+    void flush() {
+        uint64_t target = tail_.load(std::memory_order_acquire);
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!writer_.joinable()) return;
+        flush_requested_ = true;
+        wake_.notify_one();
+        written_cv_.wait(lock, [&] { return written_ >= target || stopping_; });
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stats stats = stats_;
+        stats.events_appended = tail_.load(std::memory_order_relaxed);
+        stats.events_dropped = dropped_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    const AuditLogConfig& config() const { return config_; }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        int64_t time_ns = 0;
+        std::string event_type;
+        std::string details;
+    };
+
+    void run_writer() {
+        std::string batch;
+        uint64_t reported_drops = 0;
+        for (;;) {
+            size_t events = drain(batch);
+
+            // Drops are part of the audit trail too
+            uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+            if (dropped != reported_drops) {
+                encode(batch, next_sequence_++, unix_ns_now(), "audit.dropped",
+                       std::to_string(dropped - reported_drops) + " events dropped: ring full");
+                reported_drops = dropped;
+            }
+            if (!batch.empty()) write_batch(batch);
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            stats_.events_written += events;
+            written_ = head_;
+            written_cv_.notify_all();
+            if (stopping_ && !ready()) break;
+            if (events == kMaxBatchEvents || ready()) continue;   // more waiting
+            if (!flush_requested_) {
+                wake_.wait_for(lock, config_.flush_interval,
+                               [&] { return stopping_ || flush_requested_ || ready(); });
+            }
+            flush_requested_ = false;
+        }
+        file_.close();
+    }
+
+    bool ready() const {
+        return slots_[head_ & mask_].sequence.load(std::memory_order_acquire) == head_ + 1;
+    }
+
+    size_t drain(std::string& batch) {
+        size_t events = 0;
+        while (events < kMaxBatchEvents && ready()) {
+            Slot& slot = slots_[head_ & mask_];
+            encode(batch, next_sequence_++, slot.time_ns, slot.event_type, slot.details);
+            slot.sequence.store(head_ + config_.ring_capacity, std::memory_order_release);
+            ++head_;
+            ++events;
+        }
+        return events;
+    }
+
+    static void encode(std::string& out, uint64_t sequence, int64_t time_ns, std::string_view event_type,
+                       std::string_view details) {
+        size_t payload = kPayloadFixedBytes + event_type.size() + details.size();
+        put_u32(out, kRecordMarker);
+        put_u32(out, static_cast<uint32_t>(payload));
+        size_t crc_at = out.size();
+        put_u32(out, 0);
+        size_t payload_at = out.size();
+        put_u64(out, sequence);
+        put_u64(out, static_cast<uint64_t>(time_ns));
+        put_u16(out, static_cast<uint16_t>(event_type.size()));
+        put_u32(out, static_cast<uint32_t>(details.size()));
+        out.append(event_type);
+        out.append(details);
+        uint32_t crc = checksum(out.data() + payload_at, payload);
+        for (size_t i = 0; i < 4; ++i) out[crc_at + i] = static_cast<char>((crc >> (8 * i)) & 0xff);
+    }
+
+    void write_batch(std::string& batch) {
+        if (file_.is_open() && file_bytes_ + batch.size() > config_.max_file_bytes && file_bytes_ > kFileHeaderBytes) {
+            rotate();
+        }
+        // After rotation, or after a failed reopen, the next file is opened
+        // here; on failure the batch waits for the next attempt, up to a
+        // file's worth, so the trail resumes once the path is writable again
+        if (!file_.is_open() && !open_file()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++stats_.open_failures;
+            ++stats_.write_errors;
+            stats_.file_open = false;
+            if (batch.size() > config_.max_file_bytes) batch.clear();
+            return;
+        }
+        bool ok = file_.write(batch.data(), static_cast<std::streamsize>(batch.size())) && file_.flush();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.file_open = true;
+        if (ok) {
+            file_bytes_ += batch.size();
+            stats_.bytes_written += batch.size();
+            ++stats_.batches_written;
+        } else {
+            ++stats_.write_errors;
+            file_.clear();
+        }
+        batch.clear();
+    }
+
+    // Appending to an existing log continues its numbering after the last
+    // valid record, looking in the newest rotated file if the current one
+    // has none yet
+    void resume_sequence() {
+        for (const auto& path : {config_.path, config_.path + ".1"}) {
+            bool found = false;
+            uint64_t last = 0;
+            AuditLog::read_file(path, [&](const AuditRecord& record) {
+                last = found ? std::max(last, record.sequence) : record.sequence;
+                found = true;
+            });
+            if (found) {
+                next_sequence_ = last + 1;
+                return;
+            }
+        }
+    }
+
+    // security.audit -> security.audit.1 -> ... -> security.audit.N, oldest removed
+    void rotate() {
+        namespace fs = std::filesystem;
+        file_.close();
+        std::error_code ec;
+        auto rotated = [&](size_t index) { return config_.path + "." + std::to_string(index); };
+        fs::remove(rotated(config_.max_rotated_files), ec);
+        for (size_t index = config_.max_rotated_files; index > 1; --index) {
+            fs::rename(rotated(index - 1), rotated(index), ec);
+        }
+        fs::rename(config_.path, rotated(1), ec);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.files_rotated;
+    }
+
+    bool open_file() {
+        namespace fs = std::filesystem;
+        std::error_code ec;
+        fs::path path(config_.path);
+        if (path.has_parent_path()) fs::create_directories(path.parent_path(), ec);
+
+        auto existing = fs::file_size(path, ec);
+        file_bytes_ = ec ? 0 : existing;
+        file_.open(path, std::ios::binary | std::ios::app);
+        if (file_ && file_bytes_ == 0) {
+            std::string header(kFileMagic, sizeof(kFileMagic));
+            put_u32(header, kFileVersion);
+            file_.write(header.data(), static_cast<std::streamsize>(header.size()));
+            file_.flush();
+            file_bytes_ = header.size();
+        }
+        if (!file_) {
+            file_.close();
+            file_.clear();
+            return false;
+        }
+        return true;
+    }
+
+    const AuditLogConfig config_;
+    const uint64_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<uint64_t> tail_{0};
+    alignas(64) std::atomic<uint64_t> dropped_{0};
+
+    // Writer thread only
+    alignas(64) uint64_t head_ = 0;
+    uint64_t next_sequence_ = 0;   // of the next record written, events and drop records alike
+    std::ofstream file_;
+    size_t file_bytes_ = 0;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable written_cv_;
+    bool stopping_ = false;
+    bool flush_requested_ = false;
+    uint64_t written_ = 0;
+    Stats stats_;
+    std::thread writer_;
+};
+
+// ============================================================================
+// AuditLog
+// ============================================================================
+
+AuditLog::AuditLog(AuditLogConfig config) : impl_(std::make_unique<Impl>(std::move(config))) {}
+
+AuditLog::~AuditLog() = default;
+
+std::pair<bool, std::string> AuditLog::open() {
+    return impl_->open();
+}
+
+bool AuditLog::append(std::string_view event_type, std::string_view details) {
+    return impl_->append(event_type, details);
+}
+
+void AuditLog::flush() {
+    impl_->flush();
+}
+
+AuditLog::Stats AuditLog::stats() const {
+    return impl_->stats();
+}
+
+const AuditLogConfig& AuditLog::config() const {
+    return impl_->config();
+}
+
+AuditLog::ReadResult AuditLog::read_file(const std::string& path,
+                                         const std::function<void(const AuditRecord&)>& on_record) {
+    ReadResult result;
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        result.error = "cannot open " + path;
+        return result;
+    }
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (contents.size() < kFileHeaderBytes || std::memcmp(contents.data(), kFileMagic, sizeof(kFileMagic)) != 0) {
+        result.error = path + " is not an audit log";
+        return result;
+    }
+    auto bytes = reinterpret_cast<const unsigned char*>(contents.data());
+    if (get_le(bytes + sizeof(kFileMagic), 4) != kFileVersion) {
+        result.error = path + ": unsupported audit log version";
+        return result;
+    }
+
+    std::string marker;
+    put_u32(marker, kRecordMarker);
+    size_t pos = kFileHeaderBytes;
+    while (pos < contents.size()) {
+        if (contents.size() - pos < kRecordHeaderBytes) {
+            result.truncated = true;
+            break;
+        }
+        if (get_le(bytes + pos, 4) != kRecordMarker) {
+            ++pos;   // resynchronising after a damaged record
+            continue;
+        }
+        size_t length = get_le(bytes + pos + 4, 4);
+        auto crc = static_cast<uint32_t>(get_le(bytes + pos + 8, 4));
+        const size_t payload_at = pos + kRecordHeaderBytes;
+        if (contents.size() - payload_at < length) {
+            // Only a torn tail has no record after it; otherwise the length
+            // itself is damaged
+            if (contents.find(marker, pos + 4) == std::string::npos) {
+                result.truncated = true;
+                break;
+            }
+            ++result.corrupt;
+            pos += 4;
+            continue;
+        }
+        const unsigned char* payload = bytes + payload_at;
+        size_t type_length = length >= kPayloadFixedBytes ? get_le(payload + 16, 2) : 0;
+        size_t details_length = length >= kPayloadFixedBytes ? get_le(payload + 18, 4) : 0;
+        if (length < kPayloadFixedBytes || kPayloadFixedBytes + type_length + details_length != length ||
+            checksum(contents.data() + payload_at, length) != crc) {
+            ++result.corrupt;
+            pos += 4;
+            continue;
+        }
+
+        AuditRecord record;
+        record.sequence = get_le(payload, 8);
+        record.time = std::chrono::system_clock::time_point(std::chrono::duration_cast<
+            std::chrono::system_clock::duration>(std::chrono::nanoseconds(static_cast<int64_t>(get_le(payload + 8, 8)))));
+        record.event_type.assign(contents, payload_at + kPayloadFixedBytes, type_length);
+        record.details.assign(contents, payload_at + kPayloadFixedBytes + type_length, details_length);
+        on_record(record);
+        ++result.records;
+        pos = payload_at + length;
+    }
+    return result;
+}
+
+} // namespace cortan::ai
@@ -2,23 +2,45 @@
 
 namespace cortan::ai {
 
-ContextManager::ContextManager() {
-    // TODO: Initialize context manager
-}
+ContextManager::ContextManager() = default;
 
 ContextManager::~ContextManager() = default;
 
 void ContextManager::set_context(const std::string& key, const std::string& value) {
-    // TODO: Implement context setting
+    std::lock_guard<std::mutex> lock(mutex_);
+    context_[key] = value;
 }
 
 std::string ContextManager::get_context(const std::string& key) const {
-    // TODO: Implement context retrieval
-    return "";
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = context_.find(key);
+    return it != context_.end() ? it->second : "";
 }
 
 void ContextManager::clear_context() {
-    // TODO: Implement context clearing
+    std::lock_guard<std::mutex> lock(mutex_);
+    context_.clear();
+}
+
+std::pmr::string ContextManager::build_prompt(std::string_view prompt, core::RequestArena& arena) const {
+    auto rendered = arena.make_string();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    size_t size = prompt.size();
+    for (const auto& [key, value] : context_) {
+        size += key.size() + value.size() + 3;
+    }
+    rendered.reserve(size + 1);
+
+    for (const auto& [key, value] : context_) {
+        rendered.append(key).append(": ").append(value).push_back('\n');
+    }
+    if (!context_.empty()) {
+        rendered.push_back('\n');
+    }
+    rendered.append(prompt);
+    return rendered;
 }
 
 } // namespace cortan::ai
@@ -2,23 +2,41 @@
 
 namespace cortan::ai {
 
-ConversationManager::ConversationManager() {
-    // TODO: Initialize conversation manager
+ConversationManager::ConversationManager()
+    : ConversationManager(std::pmr::get_default_resource()) {
+}
+
+ConversationManager::ConversationManager(std::pmr::memory_resource* resource)
+    : resource_(resource), messages_(resource) {
 }
 
 ConversationManager::~ConversationManager() = default;
 
 void ConversationManager::add_message(const std::string& role, const std::string& content) {
-    // TODO: Implement message addition
+    StoredMessage message{
+        std::pmr::string(role, resource_),
+        std::pmr::string(content, resource_),
+        std::chrono::system_clock::now()
+    };
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    messages_.push_back(std::move(message));
 }
 
 std::vector<ConversationMessage> ConversationManager::get_history() const {
-    // TODO: Implement history retrieval
-    return {};
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<ConversationMessage> history;
+    history.reserve(messages_.size());
+    for (const auto& message : messages_) {
+        history.push_back({std::string(message.role), std::string(message.content), message.timestamp});
+    }
+    return history;
 }
 
 void ConversationManager::clear_history() {
-    // TODO: Implement history clearing
+    std::lock_guard<std::mutex> lock(mutex_);
+    messages_.clear();
 }
 
 } // namespace cortan::ai
@@ -2,25 +2,59 @@
 
 namespace cortan::ai {
 
+namespace {
+
+bool is_stripped_control(unsigned char ch) {
+    return (ch < 0x20 && ch != '\n' && ch != '\t') || ch == 0x7f;
+}
+
+bool is_space(unsigned char ch) {
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+template<typename String>
+void sanitize_into(std::string_view input, String& output) {
+    size_t begin = 0;
+    size_t end = input.size();
+    while (begin < end && is_space(static_cast<unsigned char>(input[begin]))) ++begin;
+    while (end > begin && is_space(static_cast<unsigned char>(input[end - 1]))) --end;
+
+    output.reserve(end - begin);
+    for (size_t i = begin; i < end; ++i) {
+        if (!is_stripped_control(static_cast<unsigned char>(input[i]))) {
+            output.push_back(input[i]);
+        }
+    }
+}
+
+} // namespace
+
 InputValidator::InputValidator() {
     // TODO: Initialize input validator
 }
 
 InputValidator::~InputValidator() = default;
 
-bool InputValidator::validate_prompt(const std::string& prompt) {
+bool InputValidator::validate_prompt(std::string_view prompt) {
     // TODO: Implement prompt validation
     return !prompt.empty();
 }
 
-bool InputValidator::validate_model_name(const std::string& model_name) {
+bool InputValidator::validate_model_name(std::string_view model_name) {
     // TODO: Implement model name validation
     return !model_name.empty();
 }
 
 std::string InputValidator::sanitize_input(const std::string& input) {
-    // TODO: Implement input sanitization
-    return input;
+    std::string sanitized;
+    sanitize_into(input, sanitized);
+    return sanitized;
+}
+
+std::pmr::string InputValidator::sanitize_input(std::string_view input, core::RequestArena& arena) {
+    auto sanitized = arena.make_string();
+    sanitize_into(input, sanitized);
+    return sanitized;
 }
 
 } // namespace cortan::ai
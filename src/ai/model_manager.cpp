@@ -1,10 +1,15 @@
 #include <cortan/ai/model_manager.hpp>
+#include <cortan/core/alloc_tracking.hpp>
 #include <algorithm>
 
 namespace cortan::ai {
 
 OllamaModel::OllamaModel(std::string name, std::string endpoint)
-    : name_(std::move(name)), endpoint_(std::move(endpoint)) {
+    : OllamaModel(std::move(name), std::make_shared<OllamaClient>(std::move(endpoint))) {
+}
+
+OllamaModel::OllamaModel(std::string name, std::shared_ptr<OllamaClient> client)
+    : name_(std::move(name)), client_(std::move(client)) {
 }
 
 std::string OllamaModel::getName() const {
@@ -12,14 +17,44 @@ std::string OllamaModel::getName() const {
 }
 
 bool OllamaModel::isLoaded() const {
-    return loaded_;
+    return loaded_->load(std::memory_order_relaxed);
 }
 
 std::future<std::pair<bool, std::string>> OllamaModel::processAsync(const std::string& prompt) {
-    return std::async(std::launch::async, [this, prompt]() -> std::pair<bool, std::string> {
-        // TODO: Implement actual Ollama API call
-        return {true, "Response from " + name_ + " to: " + prompt};
-    });
+    return processStream(prompt, {});
+}
+
+std::future<std::pair<bool, std::string>> OllamaModel::processAsync(
+    std::string_view prompt,
+    std::shared_ptr<core::RequestArena> arena) {
+
+    if (!arena) {
+        return processAsync(std::string(prompt));
+    }
+
+    // The request body is encoded before async_generate returns, so the
+    // prompt needs no copy; the arena is only held until the reply is in
+    auto promise = std::make_shared<std::promise<std::pair<bool, std::string>>>();
+    auto future = promise->get_future();
+    client_->async_generate(name_, prompt, {},
+        [promise, loaded = loaded_, arena = std::move(arena)](GenerateResult result) {
+            if (result.success) loaded->store(true, std::memory_order_relaxed);
+            promise->set_value(result.success ? std::pair{true, std::move(result.text)}
+                                              : std::pair{false, std::move(result.error)});
+        });
+    return future;
+}
+
+std::future<std::pair<bool, std::string>> OllamaModel::processStream(std::string_view prompt, TokenHandler on_token) {
+    auto promise = std::make_shared<std::promise<std::pair<bool, std::string>>>();
+    auto future = promise->get_future();
+    client_->async_generate(name_, prompt, std::move(on_token),
+        [promise, loaded = loaded_](GenerateResult result) {
+            if (result.success) loaded->store(true, std::memory_order_relaxed);
+            promise->set_value(result.success ? std::pair{true, std::move(result.text)}
+                                              : std::pair{false, std::move(result.error)});
+        });
+    return future;
 }
 
 ModelManager::ModelManager() = default;
@@ -49,6 +84,7 @@ std::vector<std::string> ModelManager::getAvailableModels() const {
 std::future<std::pair<bool, std::string>> ModelManager::processRequest(
     const std::string& model_name,
     const std::string& prompt) {
+    CORTAN_ALLOC_SCOPE(AI);
 
     auto* model = getModel(model_name);
     if (!model) {
@@ -60,4 +96,20 @@ std::future<std::pair<bool, std::string>> ModelManager::processRequest(
     return model->processAsync(prompt);
 }
 
+std::future<std::pair<bool, std::string>> ModelManager::processRequest(
+    const std::string& model_name,
+    std::string_view prompt,
+    std::shared_ptr<core::RequestArena> arena) {
+    CORTAN_ALLOC_SCOPE(AI);
+
+    auto* model = getModel(model_name);
+    if (!model) {
+        return std::async(std::launch::deferred, []() -> std::pair<bool, std::string> {
+            return {false, "Model not found"};
+        });
+    }
+
+    return model->processAsync(prompt, std::move(arena));
+}
+
 } // namespace cortan::ai
@@ -1,26 +1,535 @@
 #include <cortan/ai/ollama_client.hpp>
 
+#include <nlohmann/json.hpp>
+
+#include <cctype>
+
 namespace cortan::ai {
 
-OllamaClient::OllamaClient(std::string endpoint) : endpoint_(std::move(endpoint)) {
-    // TODO: Initialize Ollama client
+// ============================================================================
+// OllamaStreamParser
+// ============================================================================
+
+namespace {
+
+constexpr size_t kMaxQuotedLine = 120;   // of a malformed line in the error
+
+std::string_view trim_line(std::string_view line) {
+    while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t')) line.remove_suffix(1);
+    while (!line.empty() && (line.front() == ' ' || line.front() == '\t')) line.remove_prefix(1);
+    return line;
+}
+
+constexpr size_t kMaxDepth = 64;   // nesting skip_value will follow
+
+// Pull scanner for decode: checks the syntax of the whole line but only
+// decodes the strings and integers asked for, and writes decoded strings
+// straight into the caller's buffers. Keys without escapes (all of
+// Ollama's) are compared in place. Bytes above 0x7F are passed through
+// as they are.
+class LineScanner {
+public:
+    explicit LineScanner(std::string_view text) : p_(text.data()), end_(text.data() + text.size()) {}
+
+    char peek() {
+        skip_whitespace();
+        return p_ < end_ ? *p_ : '\0';
+    }
+
+    bool consume(char c) {
+        if (peek() != c) return false;
+        ++p_;
+        return true;
+    }
+
+    bool at_end() {
+        skip_whitespace();
+        return p_ == end_;
+    }
+
+    // A key and its colon. `name` points into the line, or into `scratch`
+    // when the key has escapes.
+    bool key(std::string_view& name, std::string& scratch) {
+        if (peek() != '"') return false;
+        const char* start = ++p_;
+        while (p_ < end_ && *p_ != '"' && *p_ != '\\' && static_cast<unsigned char>(*p_) >= 0x20) ++p_;
+        if (p_ < end_ && *p_ == '"') {
+            name = std::string_view(start, static_cast<size_t>(p_ - start));
+            ++p_;
+        } else {
+            p_ = start - 1;
+            scratch.clear();
+            if (!string(&scratch)) return false;
+            name = scratch;
+        }
+        return consume(':');
+    }
+
+    // Decodes into *out (replacing its contents) or, for nullptr, only
+    // checks the string
+    bool string(std::string* out) {
+        if (peek() != '"') return false;
+        ++p_;
+        if (out) out->clear();
+        while (p_ < end_) {
+            const char* run = p_;
+            while (p_ < end_ && *p_ != '"' && *p_ != '\\' && static_cast<unsigned char>(*p_) >= 0x20) ++p_;
+            if (out) out->append(run, static_cast<size_t>(p_ - run));
+            if (p_ == end_ || static_cast<unsigned char>(*p_) < 0x20) return false;
+            if (*p_++ == '"') return true;
+            if (!escape(out)) return false;
+        }
+        return false;
+    }
+
+    // Any JSON number. *out is set only for a non-negative integer that
+    // fits; fractions, exponents and negatives are checked and left alone.
+    bool number(uint64_t* out) {
+        skip_whitespace();
+        bool negative = p_ < end_ && *p_ == '-';
+        if (negative) ++p_;
+        if (p_ == end_ || !is_digit(*p_)) return false;
+
+        uint64_t value = 0;
+        bool fits = true;
+        if (*p_ == '0') {
+            ++p_;
+        } else {
+            for (; p_ < end_ && is_digit(*p_); ++p_) {
+                auto digit = static_cast<uint64_t>(*p_ - '0');
+                if (value > (UINT64_MAX - digit) / 10) fits = false;
+                value = value * 10 + digit;
+            }
+        }
+        bool integral = true;
+        if (p_ < end_ && *p_ == '.') {
+            integral = false;
+            if (!digits()) return false;
+        }
+        if (p_ < end_ && (*p_ == 'e' || *p_ == 'E')) {
+            integral = false;
+            if (p_ + 1 < end_ && (p_[1] == '+' || p_[1] == '-')) ++p_;
+            if (!digits()) return false;
+        }
+        if (out && integral && fits && !negative) *out = value;
+        return true;
+    }
+
+    bool literal(std::string_view word) {
+        skip_whitespace();
+        if (static_cast<size_t>(end_ - p_) < word.size() || std::string_view(p_, word.size()) != word) return false;
+        p_ += word.size();
+        return true;
+    }
+
+    bool skip_value(size_t depth = 0) {
+        switch (peek()) {
+        case '"': return string(nullptr);
+        case 't': return literal("true");
+        case 'f': return literal("false");
+        case 'n': return literal("null");
+        case '{': {
+            if (depth == kMaxDepth) return false;
+            ++p_;
+            if (consume('}')) return true;
+            std::string_view name;
+            std::string scratch;
+            do {
+                if (!key(name, scratch) || !skip_value(depth + 1)) return false;
+            } while (consume(','));
+            return consume('}');
+        }
+        case '[': {
+            if (depth == kMaxDepth) return false;
+            ++p_;
+            if (consume(']')) return true;
+            do {
+                if (!skip_value(depth + 1)) return false;
+            } while (consume(','));
+            return consume(']');
+        }
+        default: return number(nullptr);
+        }
+    }
+
+private:
+    static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+    // At least one digit after the current '.', 'e' or sign
+    bool digits() {
+        ++p_;
+        if (p_ == end_ || !is_digit(*p_)) return false;
+        while (p_ < end_ && is_digit(*p_)) ++p_;
+        return true;
+    }
+
+    void skip_whitespace() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r')) ++p_;
+    }
+
+    bool hex4(uint32_t& value) {
+        if (end_ - p_ < 4) return false;
+        value = 0;
+        for (int i = 0; i < 4; ++i, ++p_) {
+            char c = *p_;
+            uint32_t nibble;
+            if (c >= '0' && c <= '9') nibble = static_cast<uint32_t>(c - '0');
+            else if (c >= 'a' && c <= 'f') nibble = static_cast<uint32_t>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') nibble = static_cast<uint32_t>(c - 'A' + 10);
+            else return false;
+            value = value << 4 | nibble;
+        }
+        return true;
+    }
+
+    // After the backslash
+    bool escape(std::string* out) {
+        if (p_ == end_) return false;
+        char c = *p_++;
+        char decoded;
+        switch (c) {
+        case '"': decoded = '"'; break;
+        case '\\': decoded = '\\'; break;
+        case '/': decoded = '/'; break;
+        case 'b': decoded = '\b'; break;
+        case 'f': decoded = '\f'; break;
+        case 'n': decoded = '\n'; break;
+        case 'r': decoded = '\r'; break;
+        case 't': decoded = '\t'; break;
+        case 'u': return unicode_escape(out);
+        default: return false;
+        }
+        if (out) out->push_back(decoded);
+        return true;
+    }
+
+    bool unicode_escape(std::string* out) {
+        uint32_t code;
+        if (!hex4(code)) return false;
+        if (code >= 0xDC00 && code <= 0xDFFF) return false;   // lone low surrogate
+        if (code >= 0xD800 && code <= 0xDBFF) {
+            uint32_t low;
+            if (end_ - p_ < 2 || p_[0] != '\\' || p_[1] != 'u') return false;
+            p_ += 2;
+            if (!hex4(low) || low < 0xDC00 || low > 0xDFFF) return false;
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        }
+        if (!out) return true;
+
+        auto byte = [](uint32_t bits) { return static_cast<char>(bits); };
+        if (code < 0x80) {
+            out->push_back(byte(code));
+        } else if (code < 0x800) {
+            out->push_back(byte(0xC0 | code >> 6));
+            out->push_back(byte(0x80 | (code & 0x3F)));
+        } else if (code < 0x10000) {
+            out->push_back(byte(0xE0 | code >> 12));
+            out->push_back(byte(0x80 | (code >> 6 & 0x3F)));
+            out->push_back(byte(0x80 | (code & 0x3F)));
+        } else {
+            out->push_back(byte(0xF0 | code >> 18));
+            out->push_back(byte(0x80 | (code >> 12 & 0x3F)));
+            out->push_back(byte(0x80 | (code >> 6 & 0x3F)));
+            out->push_back(byte(0x80 | (code & 0x3F)));
+        }
+        return true;
+    }
+
+    const char* p_;
+    const char* end_;
+};
+
+uint64_t* counter_for(std::string_view name, OllamaLine& out) {
+    if (name == "eval_count") return &out.eval_count;
+    if (name == "prompt_eval_count") return &out.prompt_eval_count;
+    if (name == "total_duration") return &out.total_duration_ns;
+    if (name == "load_duration") return &out.load_duration_ns;
+    if (name == "prompt_eval_duration") return &out.prompt_eval_duration_ns;
+    if (name == "eval_duration") return &out.eval_duration_ns;
+    return nullptr;
+}
+
+// The value of a field we decode when it has the expected type, skipped
+// (but still checked) otherwise
+bool string_field(LineScanner& in, std::string& out) {
+    return in.peek() == '"' ? in.string(&out) : in.skip_value(1);
+}
+
+bool message_object(LineScanner& in, OllamaLine& out) {
+    if (in.peek() != '{') return in.skip_value(1);
+    in.consume('{');
+    if (in.consume('}')) return true;
+    std::string_view name;
+    std::string scratch;
+    do {
+        if (!in.key(name, scratch)) return false;
+        if (!(name == "content" ? string_field(in, out.token) : in.skip_value(2))) return false;
+    } while (in.consume(','));
+    return in.consume('}');
+}
+
+} // namespace
+
+OllamaStreamParser::OllamaStreamParser(TokenHandler on_token) : on_token_(std::move(on_token)) {}
+
+bool OllamaStreamParser::feed(std::string_view bytes) {
+    if (stopped_ || !error_.empty()) return false;
+
+    size_t start = 0;
+    for (auto newline = bytes.find('\n'); newline != std::string_view::npos; newline = bytes.find('\n', start)) {
+        auto piece = bytes.substr(start, newline - start);
+        start = newline + 1;
+
+        bool more;
+        if (partial_.empty()) {
+            more = decode_line(piece);   // the common case: no copy
+        } else {
+            partial_.append(piece);
+            more = decode_line(partial_);
+            partial_.clear();
+        }
+        if (!more) return false;
+    }
+    partial_.append(bytes.substr(start));
+    return true;
+}
+
+bool OllamaStreamParser::finish() {
+    if (!partial_.empty() && !stopped_ && error_.empty()) {
+        decode_line(partial_);
+        partial_.clear();
+    }
+    if (!error_.empty()) return false;
+    if (!done_ && !stopped_) {
+        error_ = "Stream ended before the final chunk";
+        return false;
+    }
+    return true;
+}
+
+bool OllamaStreamParser::decode(std::string_view line, OllamaLine& out) {
+    out.token.clear();
+    out.error.clear();
+    out.done = false;
+    out.prompt_eval_count = out.eval_count = 0;
+    out.total_duration_ns = out.load_duration_ns = out.prompt_eval_duration_ns = out.eval_duration_ns = 0;
+
+    LineScanner in(line);
+    if (!in.consume('{')) return false;
+    if (in.consume('}')) return in.at_end();
+
+    std::string_view name;
+    std::string scratch;
+    do {
+        if (!in.key(name, scratch)) return false;
+
+        bool ok;
+        if (name == "response") {
+            ok = string_field(in, out.token);
+        } else if (name == "message") {
+            ok = message_object(in, out);
+        } else if (name == "done") {
+            ok = in.peek() == 't' ? (out.done = in.literal("true")) : in.skip_value(1);
+        } else if (name == "error") {
+            ok = string_field(in, out.error);
+        } else if (auto* counter = counter_for(name, out); counter && (in.peek() == '-' || std::isdigit(static_cast<unsigned char>(in.peek())))) {
+            ok = in.number(counter);
+        } else {
+            ok = in.skip_value(1);
+        }
+        if (!ok) return false;
+    } while (in.consume(','));
+
+    return in.consume('}') && in.at_end();
+}
+
+bool OllamaStreamParser::decode_line(std::string_view line) {
+    line = trim_line(line);
+    if (line.empty() || done_) return true;
+
+    if (!decode(line, line_)) {
+        error_ = "Malformed stream line: " + std::string(line.substr(0, kMaxQuotedLine));
+        return false;
+    }
+    ++stats_.chunks;
+
+    if (!line_.error.empty()) {
+        error_ = line_.error;
+        return false;
+    }
+    if (!line_.token.empty() && on_token_ && !on_token_(line_.token)) {
+        stopped_ = true;
+    }
+
+    if (line_.done) {
+        done_ = true;
+        stats_.prompt_eval_count = line_.prompt_eval_count;
+        stats_.eval_count = line_.eval_count;
+        stats_.total_duration = std::chrono::nanoseconds(line_.total_duration_ns);
+        stats_.load_duration = std::chrono::nanoseconds(line_.load_duration_ns);
+        stats_.prompt_eval_duration = std::chrono::nanoseconds(line_.prompt_eval_duration_ns);
+        stats_.eval_duration = std::chrono::nanoseconds(line_.eval_duration_ns);
+    }
+    return !stopped_;
+}
+
+// ============================================================================
+// OllamaClient
+// ============================================================================
+
+namespace {
+
+// One generation in flight: the parser, the text so far and when it started
+struct StreamState {
+    explicit StreamState(TokenHandler on_token, OllamaClient::ResultHandler on_done)
+        : on_token(std::move(on_token))
+        , on_done(std::move(on_done))
+        , parser([this](std::string_view token) { return deliver(token); }) {}
+
+    bool deliver(std::string_view token) {
+        if (text.empty()) time_to_first_token = std::chrono::steady_clock::now() - started;
+        text.append(token);
+        return !on_token || on_token(token);
+    }
+
+    TokenHandler on_token;
+    OllamaClient::ResultHandler on_done;
+    OllamaStreamParser parser;
+    std::string text;
+    std::chrono::steady_clock::time_point started = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::duration time_to_first_token{};
+};
+
+// Ollama explains a failed status in an {"error": ...} body, such as an
+// unknown model's 404
+std::string error_of(network::HttpOutcome& outcome) {
+    if (outcome.error == network::HttpError::Status) {
+        auto body = nlohmann::json::parse(outcome.error_body, nullptr, false);
+        if (body.is_object()) {
+            if (auto error = body.find("error"); error != body.end() && error->is_string()) {
+                return error->get<std::string>() + " (" + outcome.result.second + ")";
+            }
+        }
+    }
+    return std::move(outcome.result.second);
+}
+
+// Prompts come from terminals and files and need not be valid UTF-8, which
+// dump() would otherwise throw on; bad bytes are sent as U+FFFD
+std::string to_body(const nlohmann::json& request) {
+    return request.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+}
+
+} // namespace
+
+OllamaClient::OllamaClient(std::string endpoint,
+                           std::shared_ptr<network::HttpClient> http,
+                           OllamaTimeouts timeouts,
+                           network::ResilienceConfig resilience)
+    : endpoint_(std::move(endpoint))
+    , http_(std::make_unique<network::ResilientClient>(std::move(http), resilience))
+    , timeouts_(timeouts) {
+    while (!endpoint_.empty() && endpoint_.back() == '/') endpoint_.pop_back();
 }
 
 OllamaClient::~OllamaClient() = default;
 
 std::vector<std::string> OllamaClient::list_models() {
-    // TODO: Implement model listing from Ollama
-    return {"llama3:8b", "codellama:latest"};
-}
+    network::RequestOptions options;
+    options.timeout = std::min<std::chrono::steady_clock::duration>(timeouts_.idle, std::chrono::seconds(10));
+    auto [ok, body] = http_->get(endpoint_ + "/api/tags", options).get();
+    if (!ok) return {};
 
-std::future<std::pair<bool, std::string>> OllamaClient::generate(
-    const std::string& model,
-    const std::string& prompt) {
+    std::vector<std::string> names;
+    auto json = nlohmann::json::parse(body, nullptr, false);
+    if (json.is_discarded() || !json.is_object()) return names;
+    auto models = json.find("models");
+    if (models == json.end() || !models->is_array()) return names;
+    for (const auto& model : *models) {
+        if (auto name = model.find("name"); name != model.end() && name->is_string()) {
+            names.push_back(name->get<std::string>());
+        }
+    }
+    return names;
+}
 
-    return std::async(std::launch::async, [model, prompt]() -> std::pair<bool, std::string> {
-        // TODO: Implement actual Ollama API call
-        return {true, "Generated response from " + model + " for prompt: " + prompt};
+std::future<std::pair<bool, std::string>> OllamaClient::generate(const std::string& model, const std::string& prompt) {
+    auto promise = std::make_shared<std::promise<std::pair<bool, std::string>>>();
+    auto future = promise->get_future();
+    async_generate(model, prompt, {}, [promise](GenerateResult result) {
+        promise->set_value(result.success ? std::pair{true, std::move(result.text)}
+                                          : std::pair{false, std::move(result.error)});
     });
+    return future;
+}
+
+std::future<GenerateResult> OllamaClient::generate(const std::string& model,
+                                                   std::string_view prompt,
+                                                   TokenHandler on_token) {
+    auto promise = std::make_shared<std::promise<GenerateResult>>();
+    auto future = promise->get_future();
+    async_generate(model, prompt, std::move(on_token),
+                   [promise](GenerateResult result) { promise->set_value(std::move(result)); });
+    return future;
+}
+
+std::future<GenerateResult> OllamaClient::chat(const std::string& model,
+                                               const std::vector<ChatMessage>& messages,
+                                               TokenHandler on_token) {
+    auto promise = std::make_shared<std::promise<GenerateResult>>();
+    auto future = promise->get_future();
+    async_chat(model, messages, std::move(on_token),
+               [promise](GenerateResult result) { promise->set_value(std::move(result)); });
+    return future;
+}
+
+void OllamaClient::async_generate(const std::string& model,
+                                  std::string_view prompt,
+                                  TokenHandler on_token,
+                                  ResultHandler on_done) {
+    nlohmann::json request = {{"model", model}, {"prompt", prompt}, {"stream", true}};
+    stream("/api/generate", to_body(request), std::move(on_token), std::move(on_done));
+}
+
+void OllamaClient::async_chat(const std::string& model,
+                              const std::vector<ChatMessage>& messages,
+                              TokenHandler on_token,
+                              ResultHandler on_done) {
+    auto history = nlohmann::json::array();
+    for (const auto& message : messages) {
+        history.push_back({{"role", message.role}, {"content", message.content}});
+    }
+    nlohmann::json request = {{"model", model}, {"messages", std::move(history)}, {"stream", true}};
+    stream("/api/chat", to_body(request), std::move(on_token), std::move(on_done));
+}
+
+void OllamaClient::stream(const std::string& path, std::string body, TokenHandler on_token, ResultHandler on_done) {
+    auto state = std::make_shared<StreamState>(std::move(on_token), std::move(on_done));
+
+    network::RequestOptions options;
+    options.timeout = timeouts_.idle;
+    options.deadline = timeouts_.generation;
+    // Safe to repeat while nothing has been generated, which is the only
+    // time ResilientClient retries a stream
+    http_->async_fetch(
+        "POST", endpoint_ + path, std::move(body), options, true,
+        [state](network::HttpOutcome outcome) {
+            GenerateResult result;
+            // A parse error or an "error" line also stops the HTTP stream,
+            // which then reports success; the parser knows better
+            if (!outcome.result.first) {
+                result.error = error_of(outcome);
+            } else if (!state->parser.finish()) {
+                result.error = state->parser.error();
+            } else {
+                result.success = true;
+            }
+            result.text = std::move(state->text);
+            result.stats = state->parser.stats();
+            result.stats.time_to_first_token = state->time_to_first_token;
+            state->on_done(std::move(result));
+        },
+        [state](std::string_view chunk) { return state->parser.feed(chunk); });
 }
 
 } // namespace cortan::ai
@@ -2,23 +2,62 @@
 
 namespace cortan::ai {
 
-ResponseAggregator::ResponseAggregator() {
-    // TODO: Initialize response aggregator
-}
+namespace {
+
+constexpr std::string_view kResponseSeparator = "\n\n";
+
+} // namespace
+
+ResponseAggregator::ResponseAggregator() = default;
 
 ResponseAggregator::~ResponseAggregator() = default;
 
 void ResponseAggregator::add_response(const std::string& task_id, const std::string& response) {
-    // TODO: Implement response addition
+    std::lock_guard<std::mutex> lock(mutex_);
+    responses_[task_id].push_back(response);
+}
+
+template<typename String>
+void ResponseAggregator::aggregate_into(const std::string& task_id, String& output) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = responses_.find(task_id);
+    if (it == responses_.end()) {
+        return;
+    }
+
+    size_t size = 0;
+    for (const auto& response : it->second) {
+        size += response.size() + kResponseSeparator.size();
+    }
+    output.reserve(size);
+
+    bool first = true;
+    for (const auto& response : it->second) {
+        if (!first) {
+            output.append(kResponseSeparator);
+        }
+        output.append(response);
+        first = false;
+    }
 }
 
 std::string ResponseAggregator::get_aggregated_response(const std::string& task_id) const {
-    // TODO: Implement aggregated response retrieval
-    return "";
+    std::string aggregated;
+    aggregate_into(task_id, aggregated);
+    return aggregated;
+}
+
+std::pmr::string ResponseAggregator::get_aggregated_response(const std::string& task_id,
+                                                             core::RequestArena& arena) const {
+    auto aggregated = arena.make_string();
+    aggregate_into(task_id, aggregated);
+    return aggregated;
 }
 
 void ResponseAggregator::clear_responses(const std::string& task_id) {
-    // TODO: Implement response clearing
+    std::lock_guard<std::mutex> lock(mutex_);
+    responses_.erase(task_id);
 }
 
 } // namespace cortan::ai
@@ -1,25 +1,375 @@
 #include <cortan/ai/security_manager.hpp>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+
 namespace cortan::ai {
 
-SecurityManager::SecurityManager() {
-    // TODO: Initialize security manager
+namespace {
+
+constexpr size_t kShards = 16;
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+RateLimitConfig validated(RateLimitConfig config) {
+    if (!(config.requests_per_second > 0.0) || !std::isfinite(config.requests_per_second)) {
+        throw std::invalid_argument("SecurityManager: requests_per_second must be positive");
+    }
+    if (!(config.burst >= 1.0) || !std::isfinite(config.burst)) {
+        throw std::invalid_argument("SecurityManager: burst must be at least 1");
+    }
+    if (config.max_in_flight_per_user == 0 || config.max_in_flight_global == 0 ||
+        config.max_tracked_users == 0) {
+        throw std::invalid_argument("SecurityManager: limits must be non-zero");
+    }
+    return config;
+}
+
+} // namespace
+
+// ============================================================================
+// Limiter
+// ============================================================================
+
+// The token bucket is kept in its GCRA form: instead of a token count and a
+// refill timestamp, each bucket stores the "theoretical arrival time" at
+// which it would be full again. Taking a token pushes that time one interval
+// further, and a request is refused when it would land more than `burst`
+// intervals in the future. One word means one CAS per check.
+class SecurityManager::Limiter {
+public:
+    struct Bucket {
+        explicit Bucket(int64_t now) : full_at(now) {}
+
+        std::atomic<int64_t> full_at;
+        std::atomic<uint32_t> in_flight{0};
+    };
+
+    struct alignas(64) Shard {
+        // Shared for checks, exclusive only to add or evict users
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, Bucket> buckets;
+        int64_t next_sweep = 0;   // guarded by the exclusive lock
+
+        std::atomic<uint64_t> admitted{0};
+        std::atomic<uint64_t> rate_limited{0};
+        std::atomic<uint64_t> user_busy{0};
+        std::atomic<uint64_t> overloaded{0};
+    };
+
+    explicit Limiter(RateLimitConfig config)
+        : config_(validated(config))
+        , interval_(std::max<int64_t>(1, std::llround(1e9 / config_.requests_per_second)))
+        , tolerance_(std::llround(config_.burst * static_cast<double>(interval_)))
+        , shard_capacity_((config_.max_tracked_users + kShards - 1) / kShards) {}
+
+    const RateLimitConfig& config() const { return config_; }
+
+    Admission check(const std::string& user_id, bool take_slots, RequestPermit& permit) {
+        Shard& shard = shards_[std::hash<std::string>{}(user_id) & (kShards - 1)];
+        int64_t now = now_ns();
+        auto decide = [&](Bucket& bucket) {
+            return take_slots ? admit(bucket, now, permit) : (take_token(bucket, now) ? Admission::Admitted
+                                                                                      : Admission::RateLimited);
+        };
+
+        Admission admission;
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.buckets.find(user_id);
+            if (it != shard.buckets.end()) {
+                admission = decide(it->second);
+                count(shard, admission);
+                return admission;
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.buckets.find(user_id);
+        if (it == shard.buckets.end()) {
+            if (shard.buckets.size() >= shard_capacity_ && now >= shard.next_sweep) {
+                sweep(shard, now);
+            }
+            if (shard.buckets.size() >= shard_capacity_) {
+                count(shard, Admission::Overloaded);
+                return Admission::Overloaded;
+            }
+            it = shard.buckets.try_emplace(user_id, now).first;
+        }
+        admission = decide(it->second);
+        count(shard, admission);
+        return admission;
+    }
+
+    Stats stats() const {
+        Stats stats;
+        for (const Shard& shard : shards_) {
+            stats.admitted += shard.admitted.load(std::memory_order_relaxed);
+            stats.rate_limited += shard.rate_limited.load(std::memory_order_relaxed);
+            stats.user_busy += shard.user_busy.load(std::memory_order_relaxed);
+            stats.overloaded += shard.overloaded.load(std::memory_order_relaxed);
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            stats.tracked_users += shard.buckets.size();
+        }
+        stats.in_flight = in_flight_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    bool take_token(Bucket& bucket, int64_t now) const {
+        int64_t full_at = bucket.full_at.load(std::memory_order_relaxed);
+        for (;;) {
+            int64_t next = std::max(full_at, now) + interval_;
+            if (next - now > tolerance_) return false;
+            if (bucket.full_at.compare_exchange_weak(full_at, next, std::memory_order_relaxed)) return true;
+        }
+    }
+
+    // Slots are claimed optimistically and handed back on refusal, so the
+    // common path is two fetch_adds and a CAS
+    Admission admit(Bucket& bucket, int64_t now, RequestPermit& permit) {
+        if (in_flight_.fetch_add(1, std::memory_order_relaxed) >= config_.max_in_flight_global) {
+            in_flight_.fetch_sub(1, std::memory_order_relaxed);
+            return Admission::Overloaded;
+        }
+        if (bucket.in_flight.fetch_add(1, std::memory_order_relaxed) >= config_.max_in_flight_per_user) {
+            bucket.in_flight.fetch_sub(1, std::memory_order_relaxed);
+            in_flight_.fetch_sub(1, std::memory_order_relaxed);
+            return Admission::UserBusy;
+        }
+        if (!take_token(bucket, now)) {
+            bucket.in_flight.fetch_sub(1, std::memory_order_relaxed);
+            in_flight_.fetch_sub(1, std::memory_order_relaxed);
+            return Admission::RateLimited;
+        }
+        permit = RequestPermit(Admission::Admitted, &bucket.in_flight, &in_flight_);
+        return Admission::Admitted;
+    }
+
+    // A bucket that is full again with nothing in flight is indistinguishable
+    // from a new one, so dropping it loses nothing. Permits only touch their
+    // bucket while holding a slot, which keeps the bucket here.
+    void sweep(Shard& shard, int64_t now) {
+        for (auto it = shard.buckets.begin(); it != shard.buckets.end();) {
+            const Bucket& bucket = it->second;
+            if (bucket.full_at.load(std::memory_order_relaxed) <= now &&
+                bucket.in_flight.load(std::memory_order_relaxed) == 0) {
+                it = shard.buckets.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        // A flood of new users then costs one scan per refill interval, not
+        // one per request
+        shard.next_sweep = now + interval_;
+    }
+
+    static void count(Shard& shard, Admission admission) {
+        switch (admission) {
+        case Admission::Admitted: shard.admitted.fetch_add(1, std::memory_order_relaxed); break;
+        case Admission::RateLimited: shard.rate_limited.fetch_add(1, std::memory_order_relaxed); break;
+        case Admission::UserBusy: shard.user_busy.fetch_add(1, std::memory_order_relaxed); break;
+        case Admission::Overloaded: shard.overloaded.fetch_add(1, std::memory_order_relaxed); break;
+        }
+    }
+
+    const RateLimitConfig config_;
+    const int64_t interval_;    // nanoseconds per token
+    const int64_t tolerance_;   // how far ahead of now full_at may run
+    const size_t shard_capacity_;
+
+    Shard shards_[kShards];
+    alignas(64) std::atomic<size_t> in_flight_{0};
+};
+
+// ============================================================================
+// Authorizer
+// ============================================================================
+
+namespace {
+
+// Epochs come from one process-wide counter, so an epoch also identifies the
+// SecurityManager it belongs to and per-thread caches can be shared by all
+// instances. Zero is never handed out and marks empty cache slots.
+std::atomic<uint64_t> next_policy_epoch{1};
+
+struct CachedDecision {
+    uint64_t epoch = 0;
+    std::string user_id;
+    std::string action;
+    bool allowed = false;
+};
+
+constexpr size_t kDecisionCacheSlots = 64;
+
+size_t decision_slot(const std::string& user_id, const std::string& action) {
+    size_t hash = std::hash<std::string>{}(user_id) * 31 + std::hash<std::string>{}(action);
+    return hash & (kDecisionCacheSlots - 1);
 }
 
+} // namespace
+
+class SecurityManager::Authorizer {
+public:
+    Authorizer() : policy_(std::make_shared<const SecurityPolicy>()), epoch_(next_policy_epoch++) {}
+
+    bool authorize(const std::string& user_id, const std::string& action) const {
+        // Direct-mapped and per thread: no locking, and entries are checked
+        // against the full key, so a hash collision only costs a miss
+        thread_local std::array<CachedDecision, kDecisionCacheSlots> cache;
+        CachedDecision& entry = cache[decision_slot(user_id, action)];
+        if (entry.epoch == epoch_.load(std::memory_order_acquire) && entry.user_id == user_id &&
+            entry.action == action) {
+            return entry.allowed;
+        }
+
+        uint64_t epoch;
+        bool allowed;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            allowed = policy_->allows(user_id, action);
+            epoch = epoch_.load(std::memory_order_relaxed);
+        }
+        entry.epoch = epoch;
+        entry.user_id.assign(user_id);
+        entry.action.assign(action);
+        entry.allowed = allowed;
+        return allowed;
+    }
+
+    void replace(SecurityPolicy policy) {
+        auto replacement = std::make_shared<const SecurityPolicy>(std::move(policy));
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        policy_.swap(replacement);
+        epoch_.store(next_policy_epoch++, std::memory_order_release);
+    }
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::shared_ptr<const SecurityPolicy> policy_;
+    std::atomic<uint64_t> epoch_;   // changes with policy_, under the exclusive lock
+};
+
+// ============================================================================
+// RequestPermit
+// ============================================================================
+
+SecurityManager::RequestPermit::RequestPermit(RequestPermit&& other) noexcept
+    : admission_(other.admission_)
+    , user_slots_(std::exchange(other.user_slots_, nullptr))
+    , global_slots_(std::exchange(other.global_slots_, nullptr)) {}
+
+SecurityManager::RequestPermit& SecurityManager::RequestPermit::operator=(RequestPermit&& other) noexcept {
+    if (this != &other) {
+        release();
+        admission_ = other.admission_;
+        user_slots_ = std::exchange(other.user_slots_, nullptr);
+        global_slots_ = std::exchange(other.global_slots_, nullptr);
+    }
+    return *this;
+}
+
+SecurityManager::RequestPermit::~RequestPermit() {
+    release();
+}
+
+void SecurityManager::RequestPermit::release() {
+    if (user_slots_) {
+        user_slots_->fetch_sub(1, std::memory_order_relaxed);
+        global_slots_->fetch_sub(1, std::memory_order_relaxed);
+        user_slots_ = nullptr;
+        global_slots_ = nullptr;
+    }
+}
+
+// ============================================================================
+// SecurityManager
+// ============================================================================
+
+SecurityManager::SecurityManager() : SecurityManager(RateLimitConfig{}) {}
+
+SecurityManager::SecurityManager(RateLimitConfig config)
+    : limiter_(std::make_unique<Limiter>(std::move(config)))
+    , authorizer_(std::make_unique<Authorizer>()) {}
+
 SecurityManager::~SecurityManager() = default;
 
 bool SecurityManager::authorize_request(const std::string& user_id, const std::string& action) {
-    // TODO: Implement request authorization
-    return true; // Allow all for now
+    return authorizer_->authorize(user_id, action);
+}
+
+std::function<bool(const std::string&, const std::string&)> SecurityManager::subscription_authorizer() {
+    return [this](const std::string& user_id, const std::string& topic) {
+        if (authorize_request(user_id, "events." + topic)) {
+            return true;
+        }
+        log_security_event("events.subscription_denied", "user=" + user_id + " topic=" + topic);
+        return false;
+    };
+}
+
+void SecurityManager::load_policy(SecurityPolicy policy) {
+    authorizer_->replace(std::move(policy));
+}
+
+std::pair<bool, std::string> SecurityManager::reload_policy(const std::string& path) {
+    try {
+        load_policy(SecurityPolicy::load(path));
+        return {true, ""};
+    } catch (const std::invalid_argument& e) {
+        return {false, e.what()};
+    }
 }
 
 void SecurityManager::log_security_event(const std::string& event_type, const std::string& details) {
-    // TODO: Implement security event logging
+    if (AuditLog* log = audit_log_.load(std::memory_order_acquire)) {
+        log->append(event_type, details);
+    }
+}
+
+std::pair<bool, std::string> SecurityManager::open_audit_log(AuditLogConfig config) {
+    std::lock_guard<std::mutex> lock(audit_mutex_);
+    if (audit_owner_) return {false, "audit log already open"};
+    auto log = std::make_unique<AuditLog>(std::move(config));
+    auto result = log->open();
+    if (!result.first) return result;
+    audit_owner_ = std::move(log);
+    audit_log_.store(audit_owner_.get(), std::memory_order_release);
+    return result;
+}
+
+AuditLog* SecurityManager::audit_log() const {
+    return audit_log_.load(std::memory_order_acquire);
 }
 
 bool SecurityManager::rate_limit_check(const std::string& user_id) {
-    // TODO: Implement rate limiting
-    return true; // Allow all for now
+    RequestPermit unused;
+    return limiter_->check(user_id, false, unused) == Admission::Admitted;
+}
+
+SecurityManager::RequestPermit SecurityManager::admit_request(const std::string& user_id) {
+    RequestPermit permit;
+    permit.admission_ = limiter_->check(user_id, true, permit);
+    return permit;
+}
+
+SecurityManager::Stats SecurityManager::stats() const {
+    return limiter_->stats();
+}
+
+const RateLimitConfig& SecurityManager::rate_limit_config() const {
+    return limiter_->config();
 }
 
 } // namespace cortan::ai
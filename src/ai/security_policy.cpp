@@ -0,0 +1,129 @@
+#include <cortan/ai/security_policy.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace cortan::ai {
+
+namespace {
+
+using nlohmann::json;
+
+std::vector<std::string> names(const json& value, const std::string& what) {
+    if (!value.is_array()) {
+        throw std::invalid_argument("SecurityPolicy: " + what + " must be an array of strings");
+    }
+    std::vector<std::string> result;
+    for (const auto& name : value) {
+        if (!name.is_string()) {
+            throw std::invalid_argument("SecurityPolicy: " + what + " must be an array of strings");
+        }
+        result.push_back(name.get<std::string>());
+    }
+    return result;
+}
+
+struct RoleSpec {
+    std::vector<std::string> actions;
+    std::vector<std::string> inherits;
+};
+
+} // namespace
+
+SecurityPolicy SecurityPolicy::parse(std::string_view text) {
+    json root = json::parse(text, nullptr, false);
+    if (root.is_discarded() || !root.is_object()) {
+        throw std::invalid_argument("SecurityPolicy: expected a JSON object");
+    }
+    const json& security = root.contains("security") ? root["security"] : root;
+    if (!security.is_object()) {
+        throw std::invalid_argument("SecurityPolicy: \"security\" must be an object");
+    }
+
+    SecurityPolicy policy;
+    policy.actions_.emplace("*", kAnyAction);
+    auto action_bit = [&](const std::string& action) {
+        auto [it, added] = policy.actions_.try_emplace(action, policy.actions_.size());
+        if (added && it->second >= kMaxActions) {
+            throw std::invalid_argument("SecurityPolicy: more than " + std::to_string(kMaxActions - 1) +
+                                        " actions");
+        }
+        return it->second;
+    };
+
+    // Roles, as written
+    NameMap<RoleSpec> specs;
+    if (security.contains("roles")) {
+        const json& roles = security["roles"];
+        if (!roles.is_object()) throw std::invalid_argument("SecurityPolicy: \"roles\" must be an object");
+        for (const auto& [role, value] : roles.items()) {
+            RoleSpec spec;
+            if (value.is_array()) {
+                spec.actions = names(value, "role " + role);
+            } else if (value.is_object()) {
+                if (value.contains("actions")) spec.actions = names(value["actions"], "role " + role + " actions");
+                if (value.contains("inherits")) spec.inherits = names(value["inherits"], "role " + role + " inherits");
+            } else {
+                throw std::invalid_argument("SecurityPolicy: role " + role + " must be an array or object");
+            }
+            specs.emplace(role, std::move(spec));
+        }
+    }
+
+    // Roles, compiled: each one's bitset with inherited roles folded in
+    NameMap<ActionSet> compiled;
+    NameMap<bool> visiting;
+    std::function<const ActionSet&(const std::string&)> compile = [&](const std::string& role) -> const ActionSet& {
+        if (auto done = compiled.find(role); done != compiled.end()) return done->second;
+        auto spec = specs.find(role);
+        if (spec == specs.end()) throw std::invalid_argument("SecurityPolicy: unknown role " + role);
+        if (!visiting.emplace(role, true).second) {
+            throw std::invalid_argument("SecurityPolicy: role " + role + " inherits itself");
+        }
+        ActionSet actions;
+        for (const auto& action : spec->second.actions) actions.set(action_bit(action));
+        for (const auto& parent : spec->second.inherits) actions |= compile(parent);
+        return compiled.emplace(role, actions).first->second;
+    };
+    for (const auto& [role, spec] : specs) compile(role);
+
+    auto user_actions = [&](const json& roles, const std::string& what) {
+        ActionSet actions;
+        for (const auto& role : names(roles, what)) actions |= compile(role);
+        return actions;
+    };
+
+    if (security.contains("users")) {
+        const json& users = security["users"];
+        if (!users.is_object()) throw std::invalid_argument("SecurityPolicy: \"users\" must be an object");
+        for (const auto& [user, roles] : users.items()) {
+            policy.users_.emplace(user, user_actions(roles, "user " + user));
+        }
+    }
+    if (security.contains("default_roles")) {
+        policy.default_actions_ = user_actions(security["default_roles"], "default_roles");
+    }
+    return policy;
+}
+
+SecurityPolicy SecurityPolicy::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) throw std::invalid_argument("SecurityPolicy: cannot open " + path);
+    std::ostringstream text;
+    text << file.rdbuf();
+    return parse(text.str());
+}
+
+bool SecurityPolicy::allows(std::string_view user_id, std::string_view action) const {
+    auto user = users_.find(user_id);
+    const ActionSet& granted = user != users_.end() ? user->second : default_actions_;
+    if (granted.test(kAnyAction)) return true;
+    auto bit = actions_.find(action);
+    return bit != actions_.end() && granted.test(bit->second);
+}
+
+} // namespace cortan::ai
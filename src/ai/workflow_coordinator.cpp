@@ -1,24 +1,346 @@
 #include <cortan/ai/workflow_coordinator.hpp>
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
 
 namespace cortan::ai {
 
-WorkflowCoordinator::WorkflowCoordinator() {
-    // TODO: Initialize workflow coordinator
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+core::WorkflowTask<std::string> run_sync_step(
+        std::shared_ptr<const std::function<std::string(const StepInputs&)>> fn,
+        StepInputs inputs) {
+    co_return (*fn)(inputs);
 }
 
-WorkflowCoordinator::~WorkflowCoordinator() = default;
+} // namespace
+
+StepHandler make_step(std::function<std::string(const StepInputs&)> fn) {
+    auto shared = std::make_shared<const std::function<std::string(const StepInputs&)>>(std::move(fn));
+    return [shared](StepInputs inputs) { return run_sync_step(shared, std::move(inputs)); };
+}
+
+// ============================================================================
+// Workflow definitions and runs
+// ============================================================================
+
+// Immutable once created; runs share it so a workflow can be redefined while
+// an older run is still in flight.
+struct WorkflowCoordinator::Definition {
+    std::vector<WorkflowStep> steps;
+    std::vector<std::vector<size_t>> dependencies;  // step -> steps it waits for
+    std::vector<std::vector<size_t>> dependents;    // step -> steps waiting for it
+    std::vector<size_t> topological_order;
+};
+
+struct WorkflowCoordinator::Run {
+    std::string workflow_id;
+    std::shared_ptr<const Definition> definition;
+    std::string input;
+    core::CancellationSource cancellation;
+    Clock::time_point started = Clock::now();
+
+    // Each step writes only its own slots; dependents read them after the
+    // acquire-release decrement of their pending counter.
+    std::unique_ptr<std::atomic<size_t>[]> pending;
+    std::atomic<size_t> remaining{0};
+    std::vector<std::string> outputs;
+    std::vector<StepTiming> timings;
+
+    std::mutex error_mutex;
+    std::string error;
+
+    std::promise<WorkflowRunReport> promise;
+
+    std::chrono::nanoseconds elapsed() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started);
+    }
+
+    void fail(std::string message) {
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (error.empty()) error = std::move(message);
+        }
+        cancellation.cancel();
+    }
+};
+
+WorkflowCoordinator::WorkflowCoordinator()
+    : WorkflowCoordinator(std::make_shared<core::WorkflowEngine>()) {
+}
+
+WorkflowCoordinator::WorkflowCoordinator(std::shared_ptr<core::WorkflowEngine> engine)
+    : engine_(std::move(engine)) {
+}
+
+WorkflowCoordinator::~WorkflowCoordinator() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    runs_idle_.wait(lock, [this] { return active_runs_ == 0; });
+}
+
+void WorkflowCoordinator::register_step_handler(const std::string& name, StepHandler handler) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    handlers_[name] = std::move(handler);
+}
 
 void WorkflowCoordinator::create_workflow(const std::string& workflow_id, const std::vector<std::string>& steps) {
-    // TODO: Implement workflow creation
+    std::vector<WorkflowStep> chain;
+    chain.reserve(steps.size());
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::unordered_map<std::string, size_t> occurrences;
+        for (const auto& name : steps) {
+            auto handler = handlers_.find(name);
+            if (handler == handlers_.end()) {
+                throw std::invalid_argument("No handler registered for step: " + name);
+            }
+
+            // Repeated steps get distinct ids: "refine", "refine#2", ...
+            size_t occurrence = ++occurrences[name];
+            std::string id = occurrence == 1 ? name : name + "#" + std::to_string(occurrence);
+
+            WorkflowStep step{std::move(id), {}, handler->second};
+            if (!chain.empty()) {
+                step.depends_on.push_back(chain.back().id);
+            }
+            chain.push_back(std::move(step));
+        }
+    }
+    create_workflow(workflow_id, std::move(chain));
 }
 
-void WorkflowCoordinator::execute_workflow(const std::string& workflow_id) {
-    // TODO: Implement workflow execution
+void WorkflowCoordinator::create_workflow(const std::string& workflow_id, std::vector<WorkflowStep> steps) {
+    auto definition = compile(std::move(steps));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& workflow = workflows_[workflow_id];
+    workflow.definition = std::move(definition);
+    workflow.status = WorkflowStatus::CREATED;
+    workflow.last_report.reset();
+}
+
+std::future<WorkflowRunReport> WorkflowCoordinator::execute_workflow(const std::string& workflow_id,
+                                                                     std::string input) {
+    auto run = std::make_shared<Run>();
+    run->workflow_id = workflow_id;
+    run->input = std::move(input);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = workflows_.find(workflow_id);
+        if (it == workflows_.end()) {
+            throw std::out_of_range("Unknown workflow: " + workflow_id);
+        }
+        run->definition = it->second.definition;
+        it->second.status = WorkflowStatus::RUNNING;
+        ++active_runs_;
+    }
+
+    const Definition& definition = *run->definition;
+    size_t count = definition.steps.size();
+    run->pending = std::make_unique<std::atomic<size_t>[]>(count);
+    run->remaining.store(count, std::memory_order_relaxed);
+    run->outputs.resize(count);
+    run->timings.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        run->pending[i].store(definition.dependencies[i].size(), std::memory_order_relaxed);
+        run->timings[i].step_id = definition.steps[i].id;
+    }
+
+    auto future = run->promise.get_future();
+    run->started = Clock::now();
+
+    if (count == 0) {
+        finish_run(run);
+        return future;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (definition.dependencies[i].empty()) {
+            launch_step(run, i);
+        }
+    }
+    return future;
 }
 
 WorkflowStatus WorkflowCoordinator::get_workflow_status(const std::string& workflow_id) const {
-    // TODO: Implement workflow status retrieval
-    return WorkflowStatus::CREATED;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = workflows_.find(workflow_id);
+    if (it == workflows_.end()) {
+        throw std::out_of_range("Unknown workflow: " + workflow_id);
+    }
+    return it->second.status;
+}
+
+std::optional<WorkflowRunReport> WorkflowCoordinator::get_last_report(const std::string& workflow_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = workflows_.find(workflow_id);
+    if (it == workflows_.end()) {
+        return std::nullopt;
+    }
+    return it->second.last_report;
+}
+
+// ============================================================================
+// Execution
+// ============================================================================
+
+void WorkflowCoordinator::launch_step(const std::shared_ptr<Run>& run, size_t index) {
+    // The step inherits the run's token, so handlers see a failure elsewhere
+    // in the DAG at their next await point.
+    engine_->start(run_step(run, index), run->cancellation.token());
+}
+
+core::WorkflowTask<void> WorkflowCoordinator::run_step(std::shared_ptr<Run> run, size_t index) {
+    const Definition& definition = *run->definition;
+    const WorkflowStep& step = definition.steps[index];
+    StepTiming& timing = run->timings[index];
+
+    timing.started = run->elapsed();
+    if (!run->cancellation.is_cancelled()) {
+        timing.executed = true;
+        try {
+            StepInputs inputs{run->input, {}};
+            for (size_t dependency : definition.dependencies[index]) {
+                inputs.dependencies.emplace(definition.steps[dependency].id, run->outputs[dependency]);
+            }
+            run->outputs[index] = co_await step.handler(std::move(inputs));
+        } catch (const std::exception& e) {
+            timing.error = e.what();
+        } catch (...) {
+            timing.error = "unknown error";
+        }
+        if (!timing.error.empty()) {
+            run->fail(step.id + ": " + timing.error);
+        }
+    }
+    timing.finished = run->elapsed();
+
+    finish_step(run, index);
+}
+
+void WorkflowCoordinator::finish_step(const std::shared_ptr<Run>& run, size_t index) {
+    // Dependents start the moment their last input lands; after a failure
+    // they still run through run_step, which skips the handler.
+    for (size_t dependent : run->definition->dependents[index]) {
+        if (run->pending[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            launch_step(run, dependent);
+        }
+    }
+    if (run->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        finish_run(run);
+    }
+}
+
+void WorkflowCoordinator::finish_run(const std::shared_ptr<Run>& run) {
+    const Definition& definition = *run->definition;
+    size_t count = definition.steps.size();
+
+    WorkflowRunReport report;
+    report.wall_time = run->elapsed();
+    report.error = run->error;
+    report.status = report.error.empty() ? WorkflowStatus::COMPLETED : WorkflowStatus::FAILED;
+    report.steps = run->timings;
+    for (size_t i = 0; i < count; ++i) {
+        if (run->timings[i].executed && run->timings[i].error.empty()) {
+            report.outputs.emplace(definition.steps[i].id, std::move(run->outputs[i]));
+        }
+    }
+
+    // Longest chain by measured duration, walking steps in dependency order
+    std::vector<std::chrono::nanoseconds> chain_time(count);
+    std::vector<size_t> predecessor(count, count);
+    size_t heaviest = count;
+    for (size_t i : definition.topological_order) {
+        std::chrono::nanoseconds inherited{0};
+        for (size_t dependency : definition.dependencies[i]) {
+            if (chain_time[dependency] > inherited || predecessor[i] == count) {
+                inherited = chain_time[dependency];
+                predecessor[i] = dependency;
+            }
+        }
+        chain_time[i] = inherited + run->timings[i].duration();
+        if (heaviest == count || chain_time[i] > chain_time[heaviest]) {
+            heaviest = i;
+        }
+    }
+    for (size_t i = heaviest; i != count; i = predecessor[i]) {
+        report.critical_path.push_back(definition.steps[i].id);
+    }
+    std::reverse(report.critical_path.begin(), report.critical_path.end());
+    if (heaviest != count) {
+        report.critical_path_time = chain_time[heaviest];
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = workflows_.find(run->workflow_id);
+        if (it != workflows_.end()) {
+            it->second.status = report.status;
+            it->second.last_report = report;
+        }
+    }
+    run->promise.set_value(std::move(report));
+
+    // Last touch of the coordinator: the destructor may proceed after this
+    std::lock_guard<std::mutex> lock(mutex_);
+    --active_runs_;
+    runs_idle_.notify_all();
+}
+
+// ============================================================================
+// Validation
+// ============================================================================
+
+std::shared_ptr<const WorkflowCoordinator::Definition> WorkflowCoordinator::compile(std::vector<WorkflowStep> steps) {
+    auto definition = std::make_shared<Definition>();
+    size_t count = steps.size();
+
+    std::unordered_map<std::string, size_t> index_of;
+    for (size_t i = 0; i < count; ++i) {
+        if (steps[i].id.empty()) {
+            throw std::invalid_argument("Workflow step without an id");
+        }
+        if (!steps[i].handler) {
+            throw std::invalid_argument("Workflow step without a handler: " + steps[i].id);
+        }
+        if (!index_of.emplace(steps[i].id, i).second) {
+            throw std::invalid_argument("Duplicate workflow step: " + steps[i].id);
+        }
+    }
+
+    definition->dependencies.resize(count);
+    definition->dependents.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        for (const auto& dependency : steps[i].depends_on) {
+            auto it = index_of.find(dependency);
+            if (it == index_of.end()) {
+                throw std::invalid_argument("Step " + steps[i].id + " depends on unknown step " + dependency);
+            }
+            definition->dependencies[i].push_back(it->second);
+            definition->dependents[it->second].push_back(i);
+        }
+    }
+
+    // Kahn's algorithm; anything left over sits on a cycle
+    std::vector<size_t> in_degree(count);
+    std::vector<size_t>& order = definition->topological_order;
+    for (size_t i = 0; i < count; ++i) {
+        in_degree[i] = definition->dependencies[i].size();
+        if (in_degree[i] == 0) order.push_back(i);
+    }
+    for (size_t next = 0; next < order.size(); ++next) {
+        for (size_t dependent : definition->dependents[order[next]]) {
+            if (--in_degree[dependent] == 0) order.push_back(dependent);
+        }
+    }
+    if (order.size() != count) {
+        throw std::invalid_argument("Workflow contains a dependency cycle");
+    }
+
+    definition->steps = std::move(steps);
+    return definition;
 }
 
 } // namespace cortan::ai
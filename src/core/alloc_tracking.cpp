@@ -0,0 +1,92 @@
+#include <cortan/core/alloc_tracking.hpp>
+#include <atomic>
+
+namespace cortan::core::alloc_tracking {
+
+namespace {
+
+struct alignas(64) SubsystemTotals {
+    std::atomic<size_t> allocations{0};
+    std::atomic<size_t> deallocations{0};
+    std::atomic<size_t> bytes_allocated{0};
+};
+
+// Constant-initialized: safe to touch from operator new during static init
+std::atomic<bool> g_hook_installed{false};
+SubsystemTotals g_subsystem_totals[kSubsystemCount];
+
+thread_local Counters t_counters;
+thread_local Subsystem t_subsystem = Subsystem::Untracked;
+
+} // namespace
+
+std::string_view subsystem_name(Subsystem subsystem) {
+    switch (subsystem) {
+        case Subsystem::Untracked: return "untracked";
+        case Subsystem::Events:    return "events";
+        case Subsystem::Workflow:  return "workflow";
+        case Subsystem::Memory:    return "memory";
+        case Subsystem::AI:        return "ai";
+        case Subsystem::Network:   return "network";
+        case Subsystem::Terminal:  return "terminal";
+        case Subsystem::Count:     break;
+    }
+    return "unknown";
+}
+
+bool hook_installed() noexcept {
+    return g_hook_installed.load(std::memory_order_relaxed);
+}
+
+Counters thread_counters() noexcept {
+    return t_counters;
+}
+
+Counters subsystem_counters(Subsystem subsystem) noexcept {
+    const auto& totals = g_subsystem_totals[static_cast<size_t>(subsystem)];
+    return {totals.allocations.load(std::memory_order_relaxed),
+            totals.deallocations.load(std::memory_order_relaxed),
+            totals.bytes_allocated.load(std::memory_order_relaxed)};
+}
+
+std::array<Counters, kSubsystemCount> all_subsystem_counters() noexcept {
+    std::array<Counters, kSubsystemCount> counters;
+    for (size_t i = 0; i < kSubsystemCount; ++i) {
+        counters[i] = subsystem_counters(static_cast<Subsystem>(i));
+    }
+    return counters;
+}
+
+AllocationScope::AllocationScope(Subsystem subsystem) noexcept
+    : previous_(t_subsystem), start_(t_counters) {
+    t_subsystem = subsystem;
+}
+
+AllocationScope::~AllocationScope() {
+    t_subsystem = previous_;
+}
+
+namespace detail {
+
+void record_allocation(size_t bytes) noexcept {
+    ++t_counters.allocations;
+    t_counters.bytes_allocated += bytes;
+
+    auto& totals = g_subsystem_totals[static_cast<size_t>(t_subsystem)];
+    totals.allocations.fetch_add(1, std::memory_order_relaxed);
+    totals.bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void record_deallocation() noexcept {
+    ++t_counters.deallocations;
+    g_subsystem_totals[static_cast<size_t>(t_subsystem)]
+        .deallocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void mark_hook_installed() noexcept {
+    g_hook_installed.store(true, std::memory_order_relaxed);
+}
+
+} // namespace detail
+
+} // namespace cortan::core::alloc_tracking
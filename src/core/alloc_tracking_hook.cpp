@@ -0,0 +1,94 @@
+#include <cortan/core/alloc_tracking.hpp>
+#include <cstdlib>
+#include <new>
+
+// Replacement global allocation functions that feed alloc_tracking. Built as
+// the cortan_alloc_hook object library and linked only into binaries that opt
+// in (tests, benchmarks, or cortan with ENABLE_ALLOC_TRACKING).
+
+namespace {
+
+namespace tracking = cortan::core::alloc_tracking;
+
+struct HookRegistration {
+    HookRegistration() { tracking::detail::mark_hook_installed(); }
+} g_hook_registration;
+
+void* tracked_malloc(std::size_t size) {
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr) {
+        tracking::detail::record_allocation(size);
+    }
+    return ptr;
+}
+
+void* tracked_aligned_alloc(std::size_t size, std::align_val_t alignment) {
+    auto align = static_cast<std::size_t>(alignment);
+    // aligned_alloc requires the size to be a multiple of the alignment
+    std::size_t rounded = (size + align - 1) & ~(align - 1);
+    void* ptr = std::aligned_alloc(align, rounded == 0 ? align : rounded);
+    if (ptr) {
+        tracking::detail::record_allocation(size);
+    }
+    return ptr;
+}
+
+void tracked_free(void* ptr) noexcept {
+    if (ptr) {
+        tracking::detail::record_deallocation();
+        std::free(ptr);
+    }
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (void* ptr = tracked_malloc(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return tracked_malloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return tracked_malloc(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* ptr = tracked_aligned_alloc(size, alignment)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return tracked_aligned_alloc(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return tracked_aligned_alloc(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept { tracked_free(ptr); }
+void operator delete[](void* ptr) noexcept { tracked_free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { tracked_free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { tracked_free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { tracked_free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { tracked_free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { tracked_free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { tracked_free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { tracked_free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { tracked_free(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { tracked_free(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { tracked_free(ptr); }
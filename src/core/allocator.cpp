@@ -1,22 +1,160 @@
 #include <cortan/core/allocator.hpp>
+#include <cortan/core/alloc_tracking.hpp>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <thread>
 
 namespace cortan::core {
 
-CustomAllocator::CustomAllocator() {
-    // TODO: Initialize custom allocator
+namespace {
+
+constexpr size_t kSmallClassStep = 16;
+constexpr size_t kSmallClassLimit = 128;   // 16-byte steps up to here, then 4 steps per power of two
+constexpr size_t kSmallClassCount = kSmallClassLimit / kSmallClassStep;
+
+size_t shard_count_for_hardware() {
+    size_t threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    return std::min(CustomAllocator::kMaxShards, std::bit_ceil(threads));
+}
+
+// Threads are spread round-robin over shards the first time they allocate
+size_t thread_shard_hint() noexcept {
+    static std::atomic<size_t> next_hint{0};
+    thread_local size_t hint = next_hint.fetch_add(1, std::memory_order_relaxed);
+    return hint;
+}
+
+} // namespace
+
+CustomAllocator::CustomAllocator(std::pmr::memory_resource* upstream)
+    : upstream_(upstream)
+    , shard_mask_(shard_count_for_hardware() - 1)
+    , shards_(std::make_unique<Shard[]>(shard_mask_ + 1)) {
 }
 
-CustomAllocator::~CustomAllocator() {
-    // TODO: Cleanup custom allocator
+CustomAllocator::~CustomAllocator() = default;
+
+CustomAllocator& CustomAllocator::shared() {
+    static auto* instance = new CustomAllocator();
+    return *instance;
+}
+
+size_t CustomAllocator::size_class_index(size_t size) noexcept {
+    if (size == 0) {
+        size = 1;
+    }
+    if (size <= kSmallClassLimit) {
+        return (size + kSmallClassStep - 1) / kSmallClassStep - 1;
+    }
+
+    // Four classes per power-of-two group: (2^(p-1), 2^p] split in 2^(p-3) steps
+    auto p = static_cast<size_t>(std::bit_width(size - 1));
+    size_t group_base = size_t{1} << (p - 1);
+    size_t step_shift = p - 3;
+    return kSmallClassCount + (p - 8) * 4 + ((size - 1 - group_base) >> step_shift);
+}
+
+size_t CustomAllocator::size_class_bytes(size_t index) noexcept {
+    if (index < kSmallClassCount) {
+        return (index + 1) * kSmallClassStep;
+    }
+
+    size_t group = (index - kSmallClassCount) / 4;
+    size_t step = (index - kSmallClassCount) % 4;
+    size_t p = 8 + group;
+    return (size_t{1} << (p - 1)) + (step + 1) * (size_t{1} << (p - 3));
+}
+
+CustomAllocator::Shard& CustomAllocator::local_shard() noexcept {
+    return shards_[thread_shard_hint() & shard_mask_];
+}
+
+void* CustomAllocator::do_allocate(size_t bytes, size_t alignment) {
+    CORTAN_ALLOC_SCOPE(Memory);
+
+    if (bytes > kMaxBlockSize || alignment > MemoryPool::kBlockAlignment) {
+        void* ptr = upstream_->allocate(bytes, alignment);
+        Shard& shard = local_shard();
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.stats.upstream_bytes += bytes;
+        ++shard.stats.allocations;
+        return ptr;
+    }
+
+    size_t index = size_class_index(bytes);
+    Shard& shard = local_shard();
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    SizeClass& size_class = shard.classes[index];
+
+    void* ptr = nullptr;
+    if (size_class.free_list) {
+        ptr = size_class.free_list;
+        size_class.free_list = size_class.free_list->next;
+    } else {
+        if (!size_class.slabs.empty()) {
+            ptr = size_class.slabs.back()->allocate();
+        }
+        if (!ptr) {
+            size_t block_size = size_class_bytes(index);
+            size_t num_blocks = std::max<size_t>(8, kSlabBytes / block_size);
+            size_class.slabs.push_back(std::make_unique<MemoryPool>(block_size, num_blocks));
+            shard.stats.bytes_reserved += size_class.slabs.back()->slab_bytes();
+            ++shard.stats.slab_count;
+            ptr = size_class.slabs.back()->allocate();
+        }
+    }
+
+    shard.stats.bytes_requested += bytes;
+    shard.stats.bytes_in_blocks += size_class_bytes(index);
+    ++shard.stats.allocations;
+    return ptr;
+}
+
+void CustomAllocator::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
+    if (!ptr) {
+        return;
+    }
+
+    Shard& shard = local_shard();
+    if (bytes > kMaxBlockSize || alignment > MemoryPool::kBlockAlignment) {
+        upstream_->deallocate(ptr, bytes, alignment);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.stats.upstream_bytes -= bytes;
+        return;
+    }
+
+    // Blocks may come from another shard's slab; they simply join this shard's
+    // free list, which keeps cross-thread frees lock-local.
+    size_t index = size_class_index(bytes);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto* block = static_cast<FreeBlock*>(ptr);
+    block->next = shard.classes[index].free_list;
+    shard.classes[index].free_list = block;
+
+    shard.stats.bytes_requested -= bytes;
+    shard.stats.bytes_in_blocks -= size_class_bytes(index);
 }
 
-void* CustomAllocator::allocate(size_t size) {
-    // TODO: Implement custom allocation
-    return nullptr;
+bool CustomAllocator::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
 }
 
-void CustomAllocator::deallocate(void* ptr) {
-    // TODO: Implement custom deallocation
+CustomAllocator::Stats CustomAllocator::stats() const {
+    // Per-shard counters may individually wrap (alloc on one shard, free on
+    // another); unsigned sums across all shards are still exact.
+    Stats total;
+    for (size_t i = 0; i <= shard_mask_; ++i) {
+        Shard& shard = shards_[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total.bytes_requested += shard.stats.bytes_requested;
+        total.bytes_in_blocks += shard.stats.bytes_in_blocks;
+        total.bytes_reserved += shard.stats.bytes_reserved;
+        total.upstream_bytes += shard.stats.upstream_bytes;
+        total.allocations += shard.stats.allocations;
+        total.slab_count += shard.stats.slab_count;
+    }
+    return total;
 }
 
 } // namespace cortan::core
@@ -1,4 +1,5 @@
 #include <cortan/core/event_system.hpp>
+#include <cortan/core/alloc_tracking.hpp>
 #include <atomic>
 #include <mutex>
 #include <map>
@@ -103,6 +104,8 @@ public:
     }
 
     std::future<void> publish(const std::string& event_type, std::shared_ptr<BaseEvent> event) {
+        CORTAN_ALLOC_SCOPE(Events);
+
         // Collect all relevant handlers
         std::vector<EventHandler> handlers_to_call;
         std::vector<FilteredHandler> filtered_handlers_to_call;
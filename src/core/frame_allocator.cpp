@@ -0,0 +1,132 @@
+#include <cortan/core/frame_allocator.hpp>
+#include <cortan/core/allocator.hpp>
+#include <atomic>
+#include <new>
+
+namespace cortan::core::frame_allocator {
+
+namespace {
+
+enum class FrameSource : size_t {
+    Global,
+    Pool
+};
+
+// Keeps the frame itself max-aligned behind the header
+struct alignas(std::max_align_t) FrameHeader {
+    FrameSource source;
+};
+
+constexpr size_t kHeaderBytes = sizeof(FrameHeader);
+constexpr size_t kBucketCount = kMaxFrameBytes / kBucketBytes;
+
+std::atomic<bool> g_pooling_enabled{true};
+
+struct FreeFrame {
+    FreeFrame* next;
+};
+
+size_t bucket_index(size_t total_bytes) noexcept {
+    return (total_bytes + kBucketBytes - 1) / kBucketBytes - 1;
+}
+
+size_t bucket_bytes(size_t index) noexcept {
+    return (index + 1) * kBucketBytes;
+}
+
+std::pmr::memory_resource& upstream() noexcept {
+    return CustomAllocator::shared();
+}
+
+class ThreadCache {
+public:
+    ~ThreadCache() {
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            while (FreeFrame* frame = buckets_[i].head) {
+                buckets_[i].head = frame->next;
+                upstream().deallocate(frame, bucket_bytes(i), alignof(std::max_align_t));
+            }
+        }
+    }
+
+    void* allocate(size_t index) {
+        Bucket& bucket = buckets_[index];
+        if (FreeFrame* frame = bucket.head) {
+            bucket.head = frame->next;
+            --bucket.count;
+            return frame;
+        }
+        return upstream().allocate(bucket_bytes(index), alignof(std::max_align_t));
+    }
+
+    void deallocate(void* ptr, size_t index) noexcept {
+        Bucket& bucket = buckets_[index];
+        if (bucket.count >= kMaxCachedPerBucket) {
+            upstream().deallocate(ptr, bucket_bytes(index), alignof(std::max_align_t));
+            return;
+        }
+        auto* frame = static_cast<FreeFrame*>(ptr);
+        frame->next = bucket.head;
+        bucket.head = frame;
+        ++bucket.count;
+    }
+
+private:
+    struct Bucket {
+        FreeFrame* head = nullptr;
+        size_t count = 0;
+    };
+
+    Bucket buckets_[kBucketCount];
+};
+
+ThreadCache& thread_cache() {
+    thread_local ThreadCache cache;
+    return cache;
+}
+
+} // namespace
+
+void* allocate(size_t bytes) {
+    size_t total = bytes + kHeaderBytes;
+    void* raw = nullptr;
+    FrameSource source = FrameSource::Global;
+
+    if (g_pooling_enabled.load(std::memory_order_relaxed)) {
+        source = FrameSource::Pool;
+        raw = total <= kMaxFrameBytes
+            ? thread_cache().allocate(bucket_index(total))
+            : upstream().allocate(total, alignof(std::max_align_t));
+    } else {
+        raw = ::operator new(total);
+    }
+
+    auto* header = ::new (raw) FrameHeader{source};
+    return header + 1;
+}
+
+void deallocate(void* ptr, size_t bytes) noexcept {
+    if (!ptr) {
+        return;
+    }
+
+    auto* header = static_cast<FrameHeader*>(ptr) - 1;
+    size_t total = bytes + kHeaderBytes;
+    if (header->source == FrameSource::Global) {
+        ::operator delete(header, total);
+    } else if (total <= kMaxFrameBytes) {
+        thread_cache().deallocate(header, bucket_index(total));
+    } else {
+        upstream().deallocate(header, total, alignof(std::max_align_t));
+    }
+}
+
+void set_pooling_enabled(bool enabled) noexcept {
+    g_pooling_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool pooling_enabled() noexcept {
+    return g_pooling_enabled.load(std::memory_order_relaxed);
+}
+
+} // namespace cortan::core::frame_allocator
@@ -1,23 +1,66 @@
 #include <cortan/core/memory_pool.hpp>
+#include <new>
+#include <stdexcept>
 
 namespace cortan::core {
 
+namespace {
+
+size_t round_up_block(size_t block_size) {
+    // Every block must hold a free-list link and keep max_align_t alignment
+    if (block_size < sizeof(void*)) {
+        block_size = sizeof(void*);
+    }
+    return (block_size + MemoryPool::kBlockAlignment - 1) & ~(MemoryPool::kBlockAlignment - 1);
+}
+
+} // namespace
+
 MemoryPool::MemoryPool(size_t block_size, size_t num_blocks)
-    : block_size_(block_size), num_blocks_(num_blocks) {
-    // TODO: Implement memory pool initialization
+    : block_size_(round_up_block(block_size)), num_blocks_(num_blocks), free_count_(num_blocks) {
+    if (num_blocks_ == 0) {
+        throw std::invalid_argument("MemoryPool requires at least one block");
+    }
+    slab_ = static_cast<std::byte*>(
+        ::operator new(block_size_ * num_blocks_, std::align_val_t{kBlockAlignment}));
 }
 
 MemoryPool::~MemoryPool() {
-    // TODO: Implement memory pool cleanup
+    ::operator delete(slab_, std::align_val_t{kBlockAlignment});
 }
 
 void* MemoryPool::allocate() {
-    // TODO: Implement memory allocation
+    if (free_list_) {
+        FreeBlock* block = free_list_;
+        free_list_ = block->next;
+        --free_count_;
+        return block;
+    }
+
+    if (next_unused_ < num_blocks_) {
+        void* block = slab_ + next_unused_ * block_size_;
+        ++next_unused_;
+        --free_count_;
+        return block;
+    }
+
     return nullptr;
 }
 
 void MemoryPool::deallocate(void* ptr) {
-    // TODO: Implement memory deallocation
+    if (!ptr) {
+        return;
+    }
+
+    auto* block = static_cast<FreeBlock*>(ptr);
+    block->next = free_list_;
+    free_list_ = block;
+    ++free_count_;
+}
+
+bool MemoryPool::owns(const void* ptr) const noexcept {
+    auto* p = static_cast<const std::byte*>(ptr);
+    return p >= slab_ && p < slab_ + slab_bytes();
 }
 
 } // namespace cortan::core
@@ -0,0 +1,49 @@
+#include <cortan/core/request_arena.hpp>
+
+namespace cortan::core {
+
+RequestArena::RequestArena(std::pmr::memory_resource* upstream)
+    : upstream_(upstream)
+    , arena_(inline_buffer_.data(), inline_buffer_.size(), &upstream_) {
+}
+
+RequestArena::~RequestArena() = default;
+
+std::pmr::string RequestArena::make_string(std::string_view text) {
+    return std::pmr::string(text, this);
+}
+
+void RequestArena::release() {
+    arena_.release();
+    bytes_allocated_ = 0;
+    allocation_count_ = 0;
+}
+
+void* RequestArena::do_allocate(size_t bytes, size_t alignment) {
+    bytes_allocated_ += bytes;
+    ++allocation_count_;
+    return arena_.allocate(bytes, alignment);
+}
+
+void RequestArena::do_deallocate(void*, size_t, size_t) {
+    // Monotonic: memory is reclaimed when the request finishes
+}
+
+bool RequestArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+void* RequestArena::CountingUpstream::do_allocate(size_t bytes, size_t alignment) {
+    ++allocations;
+    return upstream_->allocate(bytes, alignment);
+}
+
+void RequestArena::CountingUpstream::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
+    upstream_->deallocate(ptr, bytes, alignment);
+}
+
+bool RequestArena::CountingUpstream::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+} // namespace cortan::core
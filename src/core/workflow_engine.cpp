@@ -1,11 +1,50 @@
 #include <cortan/core/workflow_engine.hpp>
+#include <algorithm>
+#include <shared_mutex>
+#include <unordered_map>
 
 namespace cortan::core {
 
-WorkflowEngine::WorkflowEngine() {
-    // TODO: Initialize workflow engine
+class WorkflowEngine::Impl {
+public:
+    explicit Impl(size_t num_threads) : pool(std::max<size_t>(1, num_threads)) {}
+
+    mutable std::shared_mutex workflows_mutex;
+    std::unordered_map<std::string, std::any> workflows;
+
+    // Declared last so workers are joined while the registry is still alive
+    ThreadPool pool;
+};
+
+WorkflowEngine::WorkflowEngine(size_t num_threads)
+    : pImpl(std::make_unique<Impl>(num_threads)) {
 }
 
+// Joining the pool runs any already-scheduled resumptions; coroutines still
+// suspended on a Completion at this point are never resumed.
 WorkflowEngine::~WorkflowEngine() = default;
 
+ThreadPool& WorkflowEngine::executor() {
+    return pImpl->pool;
+}
+
+bool WorkflowEngine::hasWorkflow(const std::string& workflow_id) const {
+    std::shared_lock<std::shared_mutex> lock(pImpl->workflows_mutex);
+    return pImpl->workflows.count(workflow_id) > 0;
+}
+
+void WorkflowEngine::storeWorkflow(const std::string& workflow_id, std::any factory) {
+    std::unique_lock<std::shared_mutex> lock(pImpl->workflows_mutex);
+    pImpl->workflows[workflow_id] = std::move(factory);
+}
+
+std::any WorkflowEngine::findWorkflow(const std::string& workflow_id) const {
+    std::shared_lock<std::shared_mutex> lock(pImpl->workflows_mutex);
+    auto it = pImpl->workflows.find(workflow_id);
+    if (it == pImpl->workflows.end()) {
+        throw std::out_of_range("Unknown workflow: " + workflow_id);
+    }
+    return it->second;
+}
+
 } // namespace cortan::core
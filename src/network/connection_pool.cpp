@@ -1,20 +1,397 @@
 #include <cortan/network/connection_pool.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <deque>
+#include <future>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include <sys/socket.h>
 
 namespace cortan::network {
 
-ConnectionPool::ConnectionPool(size_t max_connections) : max_connections_(max_connections) {
-    // TODO: Initialize connection pool
+namespace beast = boost::beast;
+namespace net = boost::asio;
+
+// ============================================================================
+// Connection
+// ============================================================================
+
+Connection::Connection(ConnectionKey key, net::io_context& io_context)
+    : key_(std::move(key)), io_context_(io_context) {
+    if (!key_.is_tls()) {
+        plain_.emplace(io_context_);
+    }
+}
+
+Connection::~Connection() {
+    close();
+}
+
+void Connection::create_tls_stream(net::ssl::context& ssl_context) {
+    if (!tls_) {
+        tls_ = std::make_unique<TlsStream>(io_context_, ssl_context);
+    }
+}
+
+Connection::PlainStream& Connection::plain_stream() {
+    if (!plain_) throw std::logic_error("Not a plain connection: " + key_.to_string());
+    return *plain_;
+}
+
+Connection::TlsStream& Connection::tls_stream() {
+    if (!tls_) throw std::logic_error("TLS stream not created: " + key_.to_string());
+    return *tls_;
+}
+
+Connection::PlainStream& Connection::tcp() {
+    return tls_ ? tls_->next_layer() : plain_stream();
+}
+
+bool Connection::is_open() const {
+    if (tls_) return tls_->next_layer().socket().is_open();
+    return plain_ && plain_->socket().is_open();
+}
+
+void Connection::close() {
+    if (!is_open()) {
+        return;
+    }
+    // Pooled connections are dropped without a TLS close_notify; the peer
+    // sees a plain TCP close, as with any idle keep-alive timeout.
+    beast::error_code ec;
+    auto& socket = tcp().socket();
+    socket.cancel(ec);
+    socket.shutdown(net::ip::tcp::socket::shutdown_both, ec);
+    socket.close(ec);
+}
+
+bool Connection::is_healthy() {
+    if (!is_open()) {
+        return false;
+    }
+    auto handle = tcp().socket().native_handle();
+
+    // An idle HTTP/1.1 connection must have nothing to read. EOF means the
+    // server closed it; data means it sent something we cannot attribute to
+    // a request (e.g. a 408, or a TLS close_notify).
+    char byte;
+    ssize_t peeked = ::recv(handle, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (peeked >= 0) {
+        return false;
+    }
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+// ============================================================================
+// ConnectionPool
+// ============================================================================
+
+namespace {
+
+ConnectionKey parse_endpoint(const std::string& endpoint) {
+    ConnectionKey key;
+    size_t scheme_end = endpoint.find("://");
+    if (scheme_end == std::string::npos) {
+        throw std::invalid_argument("Endpoint must be scheme://host:port: " + endpoint);
+    }
+    key.scheme = endpoint.substr(0, scheme_end);
+
+    std::string host_port = endpoint.substr(scheme_end + 3);
+    size_t colon = host_port.rfind(':');
+    if (colon == std::string::npos || (host_port.front() == '[' && host_port.back() == ']')) {
+        key.host = host_port;
+        key.port = key.is_tls() ? "443" : "80";
+    } else {
+        key.host = host_port.substr(0, colon);
+        key.port = host_port.substr(colon + 1);
+    }
+    if (key.host.size() > 1 && key.host.front() == '[' && key.host.back() == ']') {
+        key.host = key.host.substr(1, key.host.size() - 2);
+    }
+    return key;
+}
+
+} // namespace
+
+// Bookkeeping lives here so queued checkouts can keep it alive
+class ConnectionPool::Impl : public std::enable_shared_from_this<ConnectionPool::Impl> {
+public:
+    Impl(ConnectionPoolConfig config, IoRuntime& runtime) : config(config), runtime(runtime) {}
+
+    struct Waiter {
+        uint64_t id;
+        AcquireHandler handler;
+        std::shared_ptr<net::steady_timer> timer;
+    };
+
+    struct HostEntry {
+        std::deque<std::shared_ptr<Connection>> idle;   // most recently used at the back
+        std::deque<Waiter> waiters;
+        size_t open = 0;                                 // idle + checked out
+    };
+
+    // Completed checkouts, run after the lock is released
+    using Ready = std::vector<std::pair<AcquireHandler, std::shared_ptr<Connection>>>;
+
+    void acquire(const ConnectionKey& key, AcquireHandler handler) {
+        std::shared_ptr<Connection> connection;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            evict_expired_locked(Connection::Clock::now());
+            HostEntry& host = hosts[key];
+            if (host.waiters.empty()) {
+                connection = try_acquire_locked(key, host);
+            }
+            if (!connection) {
+                enqueue_locked(key, host, std::move(handler));
+                return;
+            }
+        }
+        net::post(runtime.context(), [handler = std::move(handler), connection]() mutable {
+            handler(std::move(connection), {});
+        });
+    }
+
+    void release(std::shared_ptr<Connection> connection) {
+        bool keep = connection->reusable() && connection->is_open();
+        if (!keep) {
+            connection->close();
+        }
+
+        Ready ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = hosts.find(connection->key());
+            if (it == hosts.end()) {
+                return;
+            }
+            connection->last_used_ = Connection::Clock::now();
+            if (keep) {
+                it->second.idle.push_back(std::move(connection));
+            } else {
+                --it->second.open;
+                --open_total;
+            }
+            serve_waiters_locked(ready);
+        }
+        dispatch(std::move(ready));
+    }
+
+    size_t evict_idle() {
+        Ready ready;
+        size_t evicted;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            evicted = evict_expired_locked(Connection::Clock::now());
+            serve_waiters_locked(ready);
+        }
+        dispatch(std::move(ready));
+        return evicted;
+    }
+
+    std::shared_ptr<Connection> try_acquire_locked(const ConnectionKey& key, HostEntry& host) {
+        // Most recently used first: it is the least likely to have been
+        // closed by the server's own idle timeout
+        while (!host.idle.empty()) {
+            auto connection = std::move(host.idle.back());
+            host.idle.pop_back();
+            if (connection->is_healthy()) {
+                ++connection->uses_;
+                connection->reusable_ = false;
+                ++stats.reused;
+                return connection;
+            }
+            connection->close();
+            --host.open;
+            --open_total;
+            ++stats.evicted;
+        }
+
+        bool host_has_room = host.open < config.max_per_host;
+        if (!host_has_room) {
+            return nullptr;
+        }
+        bool pool_has_room = open_total < config.max_connections || evict_oldest_idle_locked();
+        if (!pool_has_room) {
+            return nullptr;
+        }
+
+        ++host.open;
+        ++open_total;
+        ++stats.created;
+        auto connection = std::make_shared<Connection>(key, runtime.context());
+        connection->uses_ = 1;
+        return connection;
+    }
+
+    void enqueue_locked(const ConnectionKey& key, HostEntry& host, AcquireHandler handler) {
+        uint64_t id = ++next_waiter_id;
+        auto timer = std::make_shared<net::steady_timer>(runtime.context(), config.acquire_timeout);
+        timer->async_wait([self = shared_from_this(), key, id](const boost::system::error_code& ec) {
+            if (!ec) self->expire_waiter(key, id);
+        });
+        host.waiters.push_back(Waiter{id, std::move(handler), std::move(timer)});
+    }
+
+    void expire_waiter(const ConnectionKey& key, uint64_t id) {
+        AcquireHandler handler;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto& waiters = hosts[key].waiters;
+            auto it = std::find_if(waiters.begin(), waiters.end(),
+                                   [id](const Waiter& waiter) { return waiter.id == id; });
+            if (it == waiters.end()) {
+                return;   // served in the meantime
+            }
+            handler = std::move(it->handler);
+            waiters.erase(it);
+        }
+        handler(nullptr, "Timed out waiting for a connection to " + key.to_string());
+    }
+
+    // Hands freed capacity to queued checkouts, oldest first per origin
+    void serve_waiters_locked(Ready& ready) {
+        for (auto& [key, host] : hosts) {
+            while (!host.waiters.empty()) {
+                auto connection = try_acquire_locked(key, host);
+                if (!connection) {
+                    break;
+                }
+                Waiter waiter = std::move(host.waiters.front());
+                host.waiters.pop_front();
+                waiter.timer->cancel();
+                ready.emplace_back(std::move(waiter.handler), std::move(connection));
+            }
+        }
+    }
+
+    void dispatch(Ready ready) {
+        for (auto& [handler, connection] : ready) {
+            net::post(runtime.context(), [handler = std::move(handler), connection = std::move(connection)]() mutable {
+                handler(std::move(connection), {});
+            });
+        }
+    }
+
+    size_t evict_expired_locked(Connection::Clock::time_point now) {
+        size_t evicted = 0;
+        for (auto& [key, host] : hosts) {
+            // Idle lists are ordered by last use, so expired entries sit at the front
+            while (!host.idle.empty() && now - host.idle.front()->last_used() >= config.idle_timeout) {
+                host.idle.front()->close();
+                host.idle.pop_front();
+                --host.open;
+                --open_total;
+                ++evicted;
+            }
+        }
+        stats.evicted += evicted;
+        return evicted;
+    }
+
+    bool evict_oldest_idle_locked() {
+        HostEntry* oldest = nullptr;
+        for (auto& [key, host] : hosts) {
+            if (!host.idle.empty() &&
+                (!oldest || host.idle.front()->last_used() < oldest->idle.front()->last_used())) {
+                oldest = &host;
+            }
+        }
+        if (!oldest) {
+            return false;
+        }
+        oldest->idle.front()->close();
+        oldest->idle.pop_front();
+        --oldest->open;
+        --open_total;
+        ++stats.evicted;
+        return true;
+    }
+
+    const ConnectionPoolConfig config;
+    IoRuntime& runtime;
+
+    std::map<ConnectionKey, HostEntry> hosts;
+    size_t open_total = 0;
+    uint64_t next_waiter_id = 0;
+    Stats stats;
+    mutable std::mutex mutex;
+};
+
+ConnectionPool::ConnectionPool(size_t max_connections)
+    : ConnectionPool(ConnectionPoolConfig{max_connections}) {
+}
+
+ConnectionPool::ConnectionPool(ConnectionPoolConfig config)
+    : ConnectionPool(config, IoRuntime::shared()) {
+}
+
+ConnectionPool::ConnectionPool(ConnectionPoolConfig config, IoRuntime& runtime) {
+    if (config.max_connections == 0 || config.max_per_host == 0) {
+        throw std::invalid_argument("Connection pool limits must be positive");
+    }
+    impl_ = std::make_shared<Impl>(config, runtime);
 }
 
 ConnectionPool::~ConnectionPool() = default;
 
+void ConnectionPool::async_get_connection(const ConnectionKey& key, AcquireHandler handler) {
+    impl_->acquire(key, std::move(handler));
+}
+
+std::shared_ptr<Connection> ConnectionPool::get_connection(const ConnectionKey& key) {
+    if (impl_->runtime.running_in_this_thread()) {
+        throw std::logic_error("Blocking checkout on an I/O runtime thread");
+    }
+
+    std::promise<std::pair<std::shared_ptr<Connection>, std::string>> result;
+    auto future = result.get_future();
+    impl_->acquire(key, [&result](std::shared_ptr<Connection> connection, std::string error) {
+        result.set_value({std::move(connection), std::move(error)});
+    });
+
+    auto [connection, error] = future.get();
+    if (!connection) {
+        throw std::runtime_error(error);
+    }
+    return connection;
+}
+
 std::shared_ptr<Connection> ConnectionPool::get_connection(const std::string& endpoint) {
-    // TODO: Implement connection retrieval
-    return nullptr;
+    return get_connection(parse_endpoint(endpoint));
 }
 
 void ConnectionPool::return_connection(std::shared_ptr<Connection> connection) {
-    // TODO: Implement connection return
+    if (connection) {
+        impl_->release(std::move(connection));
+    }
+}
+
+size_t ConnectionPool::evict_idle() {
+    return impl_->evict_idle();
+}
+
+ConnectionPool::Stats ConnectionPool::stats() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    Stats stats = impl_->stats;
+    for (const auto& [key, host] : impl_->hosts) {
+        stats.idle += host.idle.size();
+        stats.waiting += host.waiters.size();
+    }
+    stats.active = impl_->open_total - stats.idle;
+    return stats;
+}
+
+const ConnectionPoolConfig& ConnectionPool::config() const {
+    return impl_->config;
+}
+
+IoRuntime& ConnectionPool::runtime() const {
+    return impl_->runtime;
 }
 
 } // namespace cortan::network
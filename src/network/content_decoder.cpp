@@ -0,0 +1,230 @@
+#include <cortan/network/content_decoder.hpp>
+#include <zlib.h>
+#ifdef CORTAN_HAS_ZSTD
+#include <zstd.h>
+#endif
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <limits>
+#include <new>
+
+namespace cortan::network {
+
+namespace {
+
+std::string normalize(std::string_view encoding) {
+    while (!encoding.empty() && std::isspace(static_cast<unsigned char>(encoding.front()))) {
+        encoding.remove_prefix(1);
+    }
+    while (!encoding.empty() && std::isspace(static_cast<unsigned char>(encoding.back()))) {
+        encoding.remove_suffix(1);
+    }
+    std::string result(encoding);
+    std::transform(result.begin(), result.end(), result.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return result;
+}
+
+// gzip (possibly several members back to back) and deflate. RFC 9110 says
+// "deflate" is zlib-wrapped, but some servers send raw deflate data; the
+// wrapper is recognised from the first two bytes.
+class ZlibDecoder final : public ContentDecoder {
+public:
+    enum class Format { Gzip, Deflate };
+
+    explicit ZlibDecoder(Format format) : format_(format) {
+        if (format_ == Format::Gzip) {
+            init(16 + MAX_WBITS);
+        }
+    }
+
+    ~ZlibDecoder() override {
+        if (initialized_) {
+            inflateEnd(&stream_);
+        }
+    }
+
+    bool decode(std::string_view input, const Sink& sink) override {
+        if (input.empty()) {
+            return true;
+        }
+        received_ = true;
+        if (!initialized_) {
+            pending_.append(input);
+            if (pending_.size() < 2) {
+                return true;
+            }
+            auto first = static_cast<unsigned char>(pending_[0]);
+            auto second = static_cast<unsigned char>(pending_[1]);
+            bool zlib_header = (first & 0x0f) == Z_DEFLATED && ((first << 8) | second) % 31 == 0;
+            init(zlib_header ? MAX_WBITS : -MAX_WBITS);
+            std::string buffered = std::move(pending_);
+            return inflate_all(buffered, sink);
+        }
+        return inflate_all(input, sink);
+    }
+
+    void finish() override {
+        if (received_ && !ended_) {
+            throw DecodeError(std::string(name()) + ": truncated data");
+        }
+    }
+
+private:
+    const char* name() const { return format_ == Format::Gzip ? "gzip" : "deflate"; }
+
+    void init(int window_bits) {
+        if (inflateInit2(&stream_, window_bits) != Z_OK) {
+            throw std::bad_alloc();
+        }
+        initialized_ = true;
+    }
+
+    bool inflate_all(std::string_view input, const Sink& sink) {
+        // avail_in is a uInt; larger inputs go through in slices
+        constexpr size_t kMaxSlice = std::numeric_limits<uInt>::max();
+        while (!input.empty()) {
+            auto slice = input.substr(0, kMaxSlice);
+            input.remove_prefix(slice.size());
+            if (!inflate_slice(slice, sink)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool inflate_slice(std::string_view input, const Sink& sink) {
+        stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+        stream_.avail_in = static_cast<uInt>(input.size());
+        while (true) {
+            if (ended_) {
+                if (stream_.avail_in == 0) {
+                    return true;
+                }
+                if (format_ != Format::Gzip) {
+                    throw DecodeError("deflate: data after the end of the stream");
+                }
+                inflateReset(&stream_);   // next gzip member
+                ended_ = false;
+            }
+
+            stream_.next_out = reinterpret_cast<Bytef*>(output_.data());
+            stream_.avail_out = static_cast<uInt>(output_.size());
+            int rc = inflate(&stream_, Z_NO_FLUSH);
+            if (rc == Z_STREAM_END) {
+                ended_ = true;
+            } else if (rc != Z_OK && rc != Z_BUF_ERROR) {
+                throw DecodeError(std::string(name()) + ": " + (stream_.msg ? stream_.msg : "corrupt data"));
+            }
+
+            size_t produced = output_.size() - stream_.avail_out;
+            if (produced > 0 && !sink(std::string_view(output_.data(), produced))) {
+                return false;
+            }
+            // Input used up and nothing left buffered inside zlib
+            if (!ended_ && (stream_.avail_in == 0 || rc == Z_BUF_ERROR) && stream_.avail_out != 0) {
+                return true;
+            }
+        }
+    }
+
+    Format format_;
+    z_stream stream_{};
+    bool initialized_ = false;
+    bool received_ = false;
+    bool ended_ = false;
+    std::string pending_;   // deflate bytes seen before the wrapper is known
+    std::array<char, kOutputBlockBytes> output_;
+};
+
+#ifdef CORTAN_HAS_ZSTD
+class ZstdDecoder final : public ContentDecoder {
+public:
+    ZstdDecoder() : context_(ZSTD_createDCtx()) {
+        if (!context_) {
+            throw std::bad_alloc();
+        }
+        // RFC 9659 caps the window for HTTP at 8 MB, bounding decoder memory
+        ZSTD_DCtx_setParameter(context_, ZSTD_d_windowLogMax, 23);
+    }
+
+    ~ZstdDecoder() override { ZSTD_freeDCtx(context_); }
+
+    bool decode(std::string_view input, const Sink& sink) override {
+        if (input.empty()) {
+            return true;
+        }
+        received_ = true;
+        ZSTD_inBuffer in{input.data(), input.size(), 0};
+        while (true) {
+            ZSTD_outBuffer out{output_.data(), output_.size(), 0};
+            size_t rc = ZSTD_decompressStream(context_, &out, &in);
+            if (ZSTD_isError(rc)) {
+                throw DecodeError(std::string("zstd: ") + ZSTD_getErrorName(rc));
+            }
+            frame_done_ = rc == 0;
+            if (out.pos > 0 && !sink(std::string_view(output_.data(), out.pos))) {
+                return false;
+            }
+            if (in.pos == in.size && out.pos < out.size) {
+                return true;
+            }
+        }
+    }
+
+    void finish() override {
+        if (received_ && !frame_done_) {
+            throw DecodeError("zstd: truncated data");
+        }
+    }
+
+private:
+    ZSTD_DCtx* context_;
+    bool received_ = false;
+    bool frame_done_ = false;
+    std::array<char, kOutputBlockBytes> output_;
+};
+#endif
+
+} // namespace
+
+std::unique_ptr<ContentDecoder> ContentDecoder::create(std::string_view encoding) {
+    std::string name = normalize(encoding);
+    if (name.empty() || name == "identity") {
+        return nullptr;
+    }
+    if (name == "gzip" || name == "x-gzip") {
+        return std::make_unique<ZlibDecoder>(ZlibDecoder::Format::Gzip);
+    }
+    if (name == "deflate") {
+        return std::make_unique<ZlibDecoder>(ZlibDecoder::Format::Deflate);
+    }
+#ifdef CORTAN_HAS_ZSTD
+    if (name == "zstd") {
+        return std::make_unique<ZstdDecoder>();
+    }
+#endif
+    throw DecodeError("unsupported Content-Encoding: " + std::string(encoding));
+}
+
+bool ContentDecoder::supports(std::string_view encoding) {
+    std::string name = normalize(encoding);
+#ifdef CORTAN_HAS_ZSTD
+    if (name == "zstd") {
+        return true;
+    }
+#endif
+    return name.empty() || name == "identity" || name == "gzip" || name == "x-gzip" || name == "deflate";
+}
+
+const std::string& ContentDecoder::accept_encoding() {
+#ifdef CORTAN_HAS_ZSTD
+    static const std::string value = "zstd, gzip, deflate";
+#else
+    static const std::string value = "gzip, deflate";
+#endif
+    return value;
+}
+
+} // namespace cortan::network
@@ -0,0 +1,212 @@
+#include <cortan/network/dns_cache.hpp>
+#include <boost/asio/post.hpp>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace cortan::network {
+
+namespace net = boost::asio;
+using tcp = net::ip::tcp;
+
+class DnsCache::Impl : public std::enable_shared_from_this<DnsCache::Impl> {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Key = std::pair<std::string, std::string>;   // host, port
+
+    Impl(DnsCacheConfig config, IoRuntime& runtime) : config(config), runtime(runtime) {}
+
+    struct Entry {
+        bool has_answer = false;
+        boost::system::error_code error;   // set for negative entries
+        Results results;
+        Clock::time_point expires;
+        Clock::time_point refresh_at;
+
+        bool resolving = false;
+        std::vector<ResolveHandler> waiters;
+    };
+
+    void resolve(const std::string& host, const std::string& port, ResolveHandler handler) {
+        Key key{host, port};
+        bool answered = false;
+        bool start_lookup = false;
+        boost::system::error_code error;
+        Results results;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto now = Clock::now();
+            auto it = entries.find(key);
+            if (it == entries.end()) {
+                make_room_locked(now);
+                it = entries.emplace(key, Entry{}).first;
+            }
+
+            Entry& entry = it->second;
+            if (entry.has_answer && now < entry.expires) {
+                answered = true;
+                error = entry.error;
+                results = entry.results;
+                if (error) {
+                    ++stats.negative_hits;
+                } else {
+                    ++stats.hits;
+                    if (now >= entry.refresh_at && !entry.resolving) {
+                        entry.resolving = true;
+                        start_lookup = true;
+                        ++stats.refreshes;
+                    }
+                }
+            } else {
+                ++stats.misses;
+                entry.waiters.push_back(std::move(handler));
+                if (!entry.resolving) {
+                    entry.resolving = true;
+                    start_lookup = true;
+                }
+            }
+            if (start_lookup) {
+                ++stats.lookups;
+            }
+        }
+
+        if (start_lookup) {
+            lookup(key);
+        }
+        if (answered) {
+            net::post(runtime.context(), [handler = std::move(handler), error, results = std::move(results)] {
+                handler(error, results);
+            });
+        }
+    }
+
+    void lookup(const Key& key) {
+        auto resolver = std::make_shared<tcp::resolver>(runtime.context());
+        resolver->async_resolve(key.first, key.second,
+            [self = shared_from_this(), resolver, key](const boost::system::error_code& ec, Results results) {
+                self->complete(key, ec, std::move(results));
+            });
+    }
+
+    void complete(const Key& key, const boost::system::error_code& ec, Results results) {
+        std::vector<ResolveHandler> waiters;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto now = Clock::now();
+            Entry& entry = entries[key];
+            entry.resolving = false;
+            waiters.swap(entry.waiters);
+
+            // A failed refresh keeps serving the addresses it was meant to
+            // replace until they expire
+            bool keep_previous = ec && entry.has_answer && !entry.error && now < entry.expires;
+            if (!keep_previous && ec != net::error::operation_aborted) {
+                auto ttl = ec ? config.negative_ttl : config.ttl;
+                entry.has_answer = true;
+                entry.error = ec;
+                entry.results = ec ? Results{} : results;
+                entry.expires = now + ttl;
+                entry.refresh_at = now + std::chrono::duration_cast<Clock::duration>(ttl * config.refresh_ahead);
+            }
+        }
+        for (auto& waiter : waiters) {
+            waiter(ec, results);
+        }
+    }
+
+    // Entries with a lookup in flight hold waiters, so they are reset rather
+    // than erased
+    void invalidate_locked(std::map<Key, Entry>::iterator it) {
+        if (it->second.resolving) {
+            it->second.has_answer = false;
+        } else {
+            entries.erase(it);
+        }
+    }
+
+    void make_room_locked(Clock::time_point now) {
+        if (entries.size() < config.max_entries) {
+            return;
+        }
+        auto victim = entries.end();
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (it->second.resolving) {
+                ++it;
+            } else if (it->second.expires <= now) {
+                it = entries.erase(it);
+            } else {
+                if (victim == entries.end() || it->second.expires < victim->second.expires) {
+                    victim = it;
+                }
+                ++it;
+            }
+        }
+        if (entries.size() >= config.max_entries && victim != entries.end()) {
+            entries.erase(victim);
+        }
+    }
+
+    const DnsCacheConfig config;
+    IoRuntime& runtime;
+
+    std::map<Key, Entry> entries;
+    Stats stats;
+    mutable std::mutex mutex;
+};
+
+DnsCache::DnsCache(DnsCacheConfig config)
+    : DnsCache(config, IoRuntime::shared()) {
+}
+
+DnsCache::DnsCache(DnsCacheConfig config, IoRuntime& runtime) {
+    if (config.max_entries == 0) {
+        throw std::invalid_argument("DNS cache needs room for at least one entry");
+    }
+    if (config.refresh_ahead <= 0.0 || config.refresh_ahead > 1.0) {
+        throw std::invalid_argument("DNS refresh_ahead must be in (0, 1]");
+    }
+    impl_ = std::make_shared<Impl>(config, runtime);
+}
+
+DnsCache::~DnsCache() = default;
+
+std::shared_ptr<DnsCache> DnsCache::shared() {
+    static const auto instance = std::make_shared<DnsCache>();
+    return instance;
+}
+
+void DnsCache::async_resolve(const std::string& host, const std::string& port, ResolveHandler handler) {
+    impl_->resolve(host, port, std::move(handler));
+}
+
+void DnsCache::invalidate(const std::string& host, const std::string& port) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto it = impl_->entries.find({host, port});
+    if (it != impl_->entries.end()) {
+        impl_->invalidate_locked(it);
+    }
+}
+
+void DnsCache::clear() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    for (auto it = impl_->entries.begin(); it != impl_->entries.end();) {
+        auto next = std::next(it);
+        impl_->invalidate_locked(it);
+        it = next;
+    }
+}
+
+DnsCache::Stats DnsCache::stats() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    Stats stats = impl_->stats;
+    stats.entries = impl_->entries.size();
+    return stats;
+}
+
+const DnsCacheConfig& DnsCache::config() const {
+    return impl_->config;
+}
+
+} // namespace cortan::network
@@ -1,15 +1,31 @@
 #include <cortan/network/http_client.hpp>
+#include <cortan/network/content_decoder.hpp>
+#include <cortan/network/url.hpp>
+#include <cortan/core/alloc_tracking.hpp>
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl/stream.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/ssl/host_name_verification.hpp>
+#include <boost/asio/strand.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/beast/ssl.hpp>
 #include <boost/beast/version.hpp>
-#include <boost/asio/connect.hpp>
-#include <boost/asio/ip/tcp.hpp>
-#include <boost/asio/ssl/stream.hpp>
 #include <openssl/ssl.h>
-#include <iostream>
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <map>
+#include <atomic>
+#include <memory_resource>
+#include <type_traits>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <chrono>
+#include <vector>
 
 namespace cortan::network {
 
@@ -19,352 +35,1458 @@ namespace net = boost::asio;
 namespace ssl = boost::asio::ssl;
 using tcp = boost::asio::ip::tcp;
 
+using HttpResult = std::pair<bool, std::string>;
+
+// Message bodies drawing from a memory_resource, so requests issued with a
+// RequestArena stage payloads in the arena. (Header fields stay on
+// http::fields: basic_fields needs an assignable allocator.)
+using ArenaAllocator = std::pmr::polymorphic_allocator<char>;
+using ArenaStringBody = http::basic_string_body<char, std::char_traits<char>, ArenaAllocator>;
+using ArenaResponse = http::response<ArenaStringBody>;
+
+// Without an arena, bodies are plain strings: the caller's payload can be
+// moved into the request and the response body moved out into the result
+using OwnedBody = http::string_body;
+
+// Streaming responses are parsed into a fixed buffer instead of a body
+using StreamParser = http::response_parser<http::buffer_body>;
+constexpr size_t kStreamBufferBytes = 16 * 1024;
+
+// Size allowed for a collected (not streamed) response body, both as read
+// and once decoded, so a small compressed body cannot expand without bound.
+// Replaces Beast's default 8 MB parser limit.
+constexpr size_t kMaxDecodedBodyBytes = 256 * 1024 * 1024;
+
 class HttpClient::Impl {
 public:
-    Impl() : ssl_ctx_(ssl::context::tlsv12_client) {
-        // Configure SSL context
-        ssl_ctx_.set_verify_mode(ssl::verify_peer);
-        ssl_ctx_.set_default_verify_paths();
+    Impl(std::shared_ptr<ConnectionPool> pool, std::shared_ptr<DnsCache> dns, std::shared_ptr<TlsSessionCache> tls)
+        : tls_(std::move(tls))
+        , pool_(std::move(pool))
+        , dns_(std::move(dns))
+        , copied_(std::make_shared<std::atomic<uint64_t>>(0))
+        , urls_(std::make_shared<UrlCache>()) {
     }
 
     ~Impl() = default;
 
-    std::pair<bool, std::string> make_request(const std::string& url,
-                                             const std::string& method = "GET",
-                                             const std::string& data = "",
-                                             std::chrono::steady_clock::duration timeout = std::chrono::seconds(30)) {
-        try {
-            // Parse URL
-            std::string host, port, target;
-            bool is_https = parse_url(url, host, port, target);
+    // Starts the request on the pool's I/O runtime and returns at once. The
+    // body is moved into the request and the response body moved out into
+    // the result. With on_chunk set the body is streamed to it instead of
+    // being collected.
+    std::future<HttpResult> make_request(std::string_view url,
+                                         std::string_view method,
+                                         std::string data,
+                                         const RequestOptions& options,
+                                         ChunkHandler on_chunk = {});
+
+    // Same, reporting to on_outcome (on a runtime thread, never inline)
+    // instead of a future
+    RequestHandle make_request(std::string_view url,
+                      std::string_view method,
+                      std::string data,
+                      const RequestOptions& options,
+                      OutcomeHandler on_outcome,
+                      ChunkHandler on_chunk);
+
+    // As above, but request and response bodies live in the arena, which the
+    // operation keeps alive until it completes. Costs a copy each way.
+    std::future<HttpResult> make_arena_request(std::string_view url,
+                                               std::string_view method,
+                                               std::string_view data,
+                                               std::chrono::steady_clock::duration timeout,
+                                               std::shared_ptr<core::RequestArena> arena);
+
+    // Sends the requests over pipelined pooled connections; see Batch
+    std::future<std::vector<HttpResult>> make_batch(std::vector<BatchRequest> requests,
+                                                    BatchResultHandler on_result,
+                                                    BatchOptions options);
+
+    std::shared_ptr<ConnectionPool> pool() const { return pool_; }
+
+    static RequestOptions with_timeout(std::chrono::steady_clock::duration timeout) {
+        RequestOptions options;
+        options.timeout = timeout;
+        return options;
+    }
+
+    void count_copy(size_t bytes) { copied_->fetch_add(bytes, std::memory_order_relaxed); }
+    uint64_t bytes_copied() const { return copied_->load(std::memory_order_relaxed); }
+
+private:
+    using Strand = net::strand<net::io_context::executor_type>;
+
+    class Connector;
+
+    template<typename Body>
+    class Operation;
+
+    class Batch;
+
+    template<typename Body>
+    std::future<HttpResult> start(std::string_view url,
+                                  std::string_view method,
+                                  typename Body::value_type body,
+                                  const RequestOptions& options,
+                                  std::shared_ptr<core::RequestArena> arena,
+                                  ChunkHandler on_chunk,
+                                  OutcomeHandler on_outcome = {},
+                                  RequestHandle* handle = nullptr);
+
+    static ConnectionKey origin_of(const ParsedUrl& parsed, std::string_view url) {
+        return ConnectionKey{parsed.is_secure() ? "https" : "http", std::string(parsed.host(url)),
+                             std::string(parsed.port_or_default(url))};
+    }
 
-            // Create per-request io_context to ensure thread safety
-            net::io_context ioc;
+    // The verb for a method name; an empty name is GET and names Beast does
+    // not know are verb::unknown, which callers refuse
+    static http::verb verb_of(std::string_view method) {
+        if (method.empty()) {
+            return http::verb::get;
+        }
+        return http::string_to_verb(beast::string_view(method.data(), method.size()));
+    }
+
+    // Repeating these has the same effect as sending them once (RFC 9110 9.2.2)
+    static bool is_idempotent(http::verb verb) {
+        return verb == http::verb::get || verb == http::verb::head || verb == http::verb::options ||
+               verb == http::verb::put || verb == http::verb::delete_;
+    }
+
+    static HttpResult unsupported_method(std::string_view method) {
+        return {false, "Unsupported HTTP method: " + std::string(method)};
+    }
 
-            // Set up deadline timer for timeout
-            net::steady_timer deadline_timer{ioc};
-            deadline_timer.expires_after(timeout);
-            bool timed_out = false;
+    // Helper function to build HTTP request
+    template<typename Body>
+    static http::request<Body> build_request(http::verb verb,
+                               std::string_view target,
+                               const std::string& host,
+                               typename Body::value_type body,
+                               bool accept_compressed) {
+        if (verb == http::verb::get || verb == http::verb::head) {
+            body.clear();
+        }
+        bool has_body = !body.empty();
+        // ParsedUrl targets omit the '/' of an empty path ("http://host?x=1")
+        std::string rooted;
+        if (target.empty() || target.front() != '/') {
+            rooted = "/" + std::string(target);
+            target = rooted;
+        }
+        http::request<Body> req{verb, beast::string_view(target.data(), target.size()), 11, std::move(body)};
+                req.set(http::field::host, host);
+                req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+                req.set(http::field::accept, "*/*");
+                if (accept_compressed) {
+                    req.set(http::field::accept_encoding, ContentDecoder::accept_encoding());
+                }
 
-            deadline_timer.async_wait([&timed_out](const boost::system::error_code& ec) {
-                if (!ec) {
-                    timed_out = true;
+                if (has_body) {
+                    req.set(http::field::content_type, "application/json");
+                    req.prepare_payload();
                 }
-            });
 
-            // Process the request using appropriate helper
-            std::pair<bool, std::string> result;
-            if (is_https) {
-                result = process_https_request(ioc, host, port, target, method, data, deadline_timer);
+        return req;
+    }
+
+    template<typename Body>
+    static http::response<Body> make_response(std::pmr::memory_resource* resource) {
+        if constexpr (std::is_same_v<Body, ArenaStringBody>) {
+            return ArenaResponse{std::piecewise_construct, std::make_tuple(std::pmr::string(resource))};
+        } else {
+            return {};
+        }
+    }
+
+    // Helper function to handle response. Owned bodies are moved out; arena
+    // bodies must be copied before the arena goes away.
+    template<typename Body>
+    static std::pair<bool, std::string> handle_response(http::response<Body>& res,
+                                                const beast::error_code& shutdown_ec = {}) {
+        if (res.result() == http::status::ok) {
+            auto encoding = res[http::field::content_encoding];
+            if (!encoding.empty()) {
+                return decode_body(std::string_view(encoding.data(), encoding.size()), res.body());
+            }
+            if constexpr (std::is_same_v<Body, OwnedBody>) {
+                return {true, std::move(res.body())};
             } else {
-                result = process_http_request(ioc, host, port, target, method, data, deadline_timer);
+                return {true, std::string(res.body())};
+            }
+        } else {
+            std::string error_msg = status_error(res);
+            if (shutdown_ec) {
+                error_msg += " (Connection error: " + shutdown_ec.message() + ")";
             }
+            return {false, error_msg};
+        }
+    }
 
-            // Run the io_context to process all operations
-            ioc.run();
+    // Collected bodies are decoded in one pass once read; streamed ones
+    // chunk by chunk as they arrive
+    static HttpResult decode_body(std::string_view encoding, std::string_view body) {
+        try {
+            auto decoder = ContentDecoder::create(encoding);
+            if (!decoder) {
+                return {true, std::string(body)};   // identity
+            }
+            std::string decoded;
+            decoder->decode(body, [&decoded](std::string_view block) {
+                if (decoded.size() + block.size() > kMaxDecodedBodyBytes) {
+                    throw DecodeError("decoded body exceeds " + std::to_string(kMaxDecodedBodyBytes) + " bytes");
+                }
+                decoded.append(block);
+                return true;
+            });
+            decoder->finish();
+            return {true, std::move(decoded)};
+        } catch (const DecodeError& e) {
+            return {false, std::string("Decompression error: ") + e.what()};
+        }
+    }
 
-            // Check if we timed out
-            if (timed_out) {
-                return {false, "Request timed out after " +
-                       std::to_string(std::chrono::duration_cast<std::chrono::seconds>(timeout).count()) +
-                       " seconds"};
+    static HttpOutcome success() {
+        HttpOutcome outcome;
+        outcome.result = {true, {}};
+        return outcome;
+    }
+
+    static HttpOutcome failure(HttpError error, std::string message) {
+        HttpOutcome outcome;
+        outcome.result = {false, std::move(message)};
+        outcome.error = error;
+        return outcome;
+    }
+
+    // Classifies a collected response and keeps the start of an error body
+    template<typename Body>
+    static HttpOutcome outcome_of(http::response<Body>& res) {
+        HttpOutcome outcome;
+        outcome.status = res.result_int();
+        if (res.result() != http::status::ok) {
+            auto encoding = res[http::field::content_encoding];
+            std::string_view body(res.body().data(), res.body().size());
+            auto decoded = decode_body(std::string_view(encoding.data(), encoding.size()), body);
+            outcome.error_body = decoded.first ? std::move(decoded.second) : std::string(body);
+            if (outcome.error_body.size() > HttpOutcome::kMaxErrorBodyBytes) {
+                outcome.error_body.resize(HttpOutcome::kMaxErrorBodyBytes);
             }
+        }
+        outcome.result = handle_response(res);
+        if (!outcome.result.first) {
+            outcome.error = res.result() == http::status::ok ? HttpError::Decode : HttpError::Status;
+        }
+        return outcome;
+    }
 
-            return result;
+    // Loopback traffic is cheaper to send as is than to compress
+    static bool accepts_compression(Compression compression, const std::string& host) {
+        if (compression != Compression::Auto) {
+            return compression == Compression::On;
+        }
+        if (host == "localhost") {
+            return false;
+        }
+        beast::error_code ec;
+        auto address = net::ip::make_address(host, ec);
+        return ec || !address.is_loopback();
+    }
 
-        } catch (const std::exception& e) {
-            return {false, std::string("Network error: ") + e.what()};
+    template<typename Message>
+    static std::string status_error(const Message& res) {
+        return "HTTP " + std::to_string(static_cast<int>(res.result())) + " " + std::string(res.reason());
+    }
+
+    static bool is_stale_connection_error(const beast::error_code& ec) {
+        return ec == http::error::end_of_stream || ec == net::error::eof ||
+               ec == net::error::connection_reset || ec == net::error::broken_pipe ||
+               ec == ssl::error::stream_truncated;
+    }
+
+    static std::string timeout_message(std::chrono::steady_clock::duration timeout) {
+        if (timeout < std::chrono::seconds(1)) {
+            return "Request timed out after " +
+                   std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(timeout).count()) + " ms";
         }
+        return "Request timed out after " +
+               std::to_string(std::chrono::duration_cast<std::chrono::seconds>(timeout).count()) + " seconds";
     }
 
-private:
-    struct UrlComponents {
-        std::string scheme;
-        std::string userinfo;
-        std::string host;
-        std::string port;
-        std::string path;
-        std::string query;
-        std::string fragment;
-        bool is_https;
-    };
+    // Shared with in-flight operations, which may outlive the client
+    std::shared_ptr<TlsSessionCache> tls_;
+    std::shared_ptr<ConnectionPool> pool_;
+    std::shared_ptr<DnsCache> dns_;
+    std::shared_ptr<std::atomic<uint64_t>> copied_;
+    std::shared_ptr<UrlCache> urls_;   // parse results for this client's endpoints
+};
 
-    // Enhanced URL parser that handles query strings, fragments, IPv6, and userinfo
-    bool parse_url(const std::string& url, std::string& host, std::string& port, std::string& target) {
-        UrlComponents components;
-        if (!parse_url_components(url, components)) {
-            return false;
+// ============================================================================
+// Connection setup
+// ============================================================================
+
+// Establishes a fresh pooled connection: resolve through the DnsCache,
+// connect and, for https, the TLS handshake with session resumption. The
+// handler runs once, on the given strand. cancel(), called on that strand,
+// abandons a pending lookup (it may be shared with other requests) or aborts
+// the connect/handshake; either way the handler sees operation_aborted.
+class HttpClient::Impl::Connector : public std::enable_shared_from_this<Connector> {
+public:
+    using Handler = std::function<void(const beast::error_code&)>;
+
+    Connector(std::shared_ptr<Connection> connection,
+              ConnectionKey key,
+              Strand strand,
+              std::shared_ptr<DnsCache> dns,
+              std::shared_ptr<TlsSessionCache> tls)
+        : connection_(std::move(connection))
+        , key_(std::move(key))
+        , strand_(std::move(strand))
+        , dns_(std::move(dns))
+        , tls_(std::move(tls)) {
+    }
+
+    void start(Handler handler) {
+        handler_ = std::move(handler);
+        if (connection_->is_tls()) {
+            connection_->create_tls_stream(tls_->context());
         }
+        resolving_ = true;
+        dns_->async_resolve(key_.host, key_.port,
+            [self = shared_from_this()](const beast::error_code& ec, DnsCache::Results results) mutable {
+                auto& strand = self->strand_;
+                net::dispatch(strand, [self = std::move(self), ec, results = std::move(results)] {
+                    if (self->done_) {
+                        return;   // cancelled while the lookup was pending
+                    }
+                    self->resolving_ = false;
+                    if (ec) return self->complete(ec);
+                    self->connect(results);
+                });
+            });
+    }
 
-        host = components.host;
-        port = components.port;
-        // Compose target as path?query#fragment
-        target = components.path;
-        if (!components.query.empty()) {
-            target += "?" + components.query;
+    void cancel() {
+        if (done_) {
+            return;
         }
-        if (!components.fragment.empty()) {
-            target += "#" + components.fragment;
+        cancelled_ = true;
+        if (resolving_) {
+            complete(net::error::operation_aborted);
+        } else {
+            connection_->close();   // aborts the connect or handshake
         }
+    }
 
-        return components.is_https;
+private:
+    void connect(const DnsCache::Results& results) {
+        connection_->tcp().async_connect(results, net::bind_executor(strand_,
+            [self = shared_from_this()](const beast::error_code& ec, const tcp::endpoint&) {
+                if (ec) {
+                    // The cached addresses may be stale; look them up afresh next time
+                    if (!self->cancelled_) self->dns_->invalidate(self->key_.host, self->key_.port);
+                    return self->complete(ec);
+                }
+                beast::error_code ignored;
+                self->connection_->tcp().socket().set_option(tcp::no_delay(true), ignored);
+                if (self->connection_->is_tls()) {
+                    self->handshake();
+                } else {
+                    self->complete({});
+                }
+            }));
     }
 
-    bool parse_url_components(const std::string& url, UrlComponents& components) {
-        std::string url_copy = url;
+    void handshake() {
+        auto& stream = connection_->tls_stream();
+        // Set SNI hostname
+        if (!SSL_set_tlsext_host_name(stream.native_handle(), key_.host.c_str())) {
+            return complete(beast::error_code(static_cast<int>(::ERR_get_error()), net::error::get_ssl_category()));
+        }
+        if (tls_->config().verify_peer) {
+            stream.set_verify_callback(ssl::host_name_verification(key_.host));
+        }
+        // Offers the session from the last connection to this origin
+        tls_->prepare(stream.native_handle(), key_.to_string());
+
+        stream.async_handshake(ssl::stream_base::client, net::bind_executor(strand_,
+            [self = shared_from_this()](const beast::error_code& ec) {
+                if (ec) {
+                    self->tls_->invalidate(self->key_.to_string());
+                    return self->complete(ec);
+                }
+                self->tls_->record_handshake(self->connection_->tls_stream().native_handle());
+                self->complete({});
+            }));
+    }
 
-        // Parse scheme
-        size_t scheme_end = url_copy.find("://");
-        if (scheme_end == std::string::npos) {
-            return false; // Invalid URL format
+    void complete(const beast::error_code& ec) {
+        if (done_) {
+            return;
         }
+        done_ = true;
+        auto handler = std::move(handler_);
+        handler(ec);
+    }
+
+    std::shared_ptr<Connection> connection_;
+    ConnectionKey key_;
+    Strand strand_;
+    std::shared_ptr<DnsCache> dns_;
+    std::shared_ptr<TlsSessionCache> tls_;
+    Handler handler_;
 
-        components.scheme = url_copy.substr(0, scheme_end);
-        components.is_https = (components.scheme == "https");
+    bool resolving_ = false;
+    bool cancelled_ = false;
+    bool done_ = false;
+};
 
-        if (components.scheme != "http" && components.scheme != "https") {
-            return false; // Unsupported scheme
+// ============================================================================
+// Request operation
+// ============================================================================
+
+// One request from checkout to response. Every step is an async operation
+// whose handler runs on the operation's strand, which also serializes the
+// deadline: when it fires, the pending connection setup, write or read is
+// cancelled and the request completes as timed out. Streaming requests
+// re-arm the deadline whenever a chunk arrives, though never past the
+// request's overall deadline.
+template<typename Body>
+class HttpClient::Impl::Operation : public std::enable_shared_from_this<Operation<Body>> {
+public:
+    Operation(std::shared_ptr<core::RequestArena> arena,
+              std::shared_ptr<ConnectionPool> pool,
+              std::shared_ptr<DnsCache> dns,
+              std::shared_ptr<TlsSessionCache> tls,
+              std::shared_ptr<std::atomic<uint64_t>> copied,
+              ConnectionKey key,
+              http::verb verb,
+              std::string_view target,
+              typename Body::value_type body,
+              std::chrono::steady_clock::duration timeout,
+              std::chrono::steady_clock::duration deadline,
+              bool accept_compressed,
+              ChunkHandler on_chunk)
+        : arena_(std::move(arena))
+        , resource_(arena_ ? static_cast<std::pmr::memory_resource*>(arena_.get()) : std::pmr::get_default_resource())
+        , pool_(std::move(pool))
+        , dns_(std::move(dns))
+        , tls_(std::move(tls))
+        , copied_(std::move(copied))
+        , strand_(net::make_strand(pool_->runtime().context()))
+        , deadline_(strand_)
+        , key_(std::move(key))
+        , timeout_(timeout)
+        , overall_(deadline)
+        , request_(build_request<Body>(verb, target, key_.host, std::move(body), accept_compressed))
+        , response_(make_response<Body>(resource_))
+        , on_chunk_(std::move(on_chunk)) {
+    }
+
+    std::future<HttpResult> start() {
+        auto future = promise_.get_future();
+        net::dispatch(strand_, [self = this->shared_from_this()] {
+            self->start_clock();
+            self->arm_deadline();
+            self->acquire();
+        });
+        return future;
+    }
+
+    void start(OutcomeHandler on_outcome) {
+        on_outcome_ = std::move(on_outcome);
+        net::post(strand_, [self = this->shared_from_this()] {
+            self->start_clock();
+            self->arm_deadline();
+            self->acquire();
+        });
+    }
+
+    void cancel() {
+        net::dispatch(strand_, [self = this->shared_from_this()] {
+            if (self->finished_) {
+                return;
+            }
+            self->cancelled_ = true;
+            self->abort();
+        });
+    }
+
+private:
+    template<typename Handler>
+    auto on_strand(Handler&& handler) {
+        return net::bind_executor(strand_, std::forward<Handler>(handler));
+    }
+
+    // Calls fn with the connection's top-level stream, plain or TLS
+    template<typename Fn>
+    void with_stream(Fn&& fn) {
+        if (connection_->is_tls()) {
+            fn(connection_->tls_stream());
+        } else {
+            fn(connection_->plain_stream());
         }
+    }
 
-        url_copy = url_copy.substr(scheme_end + 3);
+    void start_clock() {
+        if (overall_ > std::chrono::steady_clock::duration::zero()) {
+            overall_at_ = net::steady_timer::clock_type::now() + overall_;
+        }
+    }
+
+    void arm_deadline() {
+        // Re-arming cancels the previous wait, whose handler then sees
+        // operation_aborted
+        deadline_.expires_at(std::min(net::steady_timer::clock_type::now() + timeout_, overall_at_));
+        deadline_.async_wait([self = this->shared_from_this()](const beast::error_code& ec) {
+            if (!ec) self->on_deadline();
+        });
+    }
+
+    void acquire() {
+        pool_->async_get_connection(key_, [self = this->shared_from_this()](std::shared_ptr<Connection> connection,
+                                                                      std::string error) mutable {
+            auto& strand = self->strand_;
+            net::dispatch(strand, [self = std::move(self), connection = std::move(connection),
+                                   error = std::move(error)]() mutable {
+                self->on_connection(std::move(connection), std::move(error));
+            });
+        });
+    }
 
-        // Parse userinfo (if present)
-        size_t at_pos = url_copy.find('@');
-        if (at_pos != std::string::npos) {
-            components.userinfo = url_copy.substr(0, at_pos);
-            url_copy = url_copy.substr(at_pos + 1);
+    void on_connection(std::shared_ptr<Connection> connection, std::string error) {
+        if (finished_) {
+            // Timed out while queued; hand the connection back untouched
+            if (connection) {
+                connection->set_reusable(connection->is_open());
+                pool_->return_connection(std::move(connection));
+            }
+            return;
+        }
+        if (!connection) {
+            complete(failure(HttpError::Timeout, error_prefix() + error));   // the pool's wait timed out
+            return;
         }
 
-        // Parse host and port
-        size_t path_start = url_copy.find('/');
-        if (path_start == std::string::npos) {
-            path_start = url_copy.length();
+        connection_ = std::move(connection);
+        reused_ = connection_->was_reused();
+        if (connection_->is_open()) {
+            write();
+        } else {
+            connect();
         }
+    }
+
+    void connect() {
+        connector_ = std::make_shared<Connector>(connection_, key_, strand_, dns_, tls_);
+        connector_->start([self = this->shared_from_this()](const beast::error_code& ec) {
+            self->connector_.reset();
+            if (ec) {
+                self->connect_failed_ = true;
+                return self->finish(ec);
+            }
+            self->write();
+        });
+    }
+
+    void write() {
+        with_stream([this](auto& stream) {
+            http::async_write(stream, request_, on_strand(
+                [self = this->shared_from_this()](const beast::error_code& ec, size_t) {
+                    if (ec) return self->retry_or_finish(ec);
+                    if (self->on_chunk_) {
+                        self->read_stream_header();
+                    } else {
+                        self->read();
+                    }
+                }));
+        });
+    }
 
-        std::string host_port = url_copy.substr(0, path_start);
+    void read() {
+        reader_.emplace(std::move(response_));
+        reader_->body_limit(kMaxDecodedBodyBytes);
+        reader_->skip(request_.method() == http::verb::head);   // headers only, whatever Content-Length says
+        with_stream([this](auto& stream) {
+            http::async_read(stream, connection_->buffer(), *reader_, on_strand(
+                [self = this->shared_from_this()](const beast::error_code& ec, size_t) {
+                    self->response_ = self->reader_->release();
+                    self->reader_.reset();
+                    if (ec) return self->retry_or_finish(ec);
+                    self->finish({});
+                }));
+        });
+    }
 
-        // Handle IPv6 addresses in brackets
-        if (!host_port.empty() && host_port[0] == '[') {
-            size_t bracket_end = host_port.find(']');
-            if (bracket_end == std::string::npos) {
-                return false; // Malformed IPv6
+    // ------------------------------------------------------------------------
+    // Streaming
+    // ------------------------------------------------------------------------
+
+    void read_stream_header() {
+        parser_.emplace();
+        // Streams may run indefinitely. (Beast 1.74 compares Content-Length
+        // against an unset optional limit, so boost::none rejects every body.)
+        parser_->body_limit(std::numeric_limits<std::uint64_t>::max());
+        parser_->skip(request_.method() == http::verb::head);
+        // Chunked bodies are handed over straight from the read buffer;
+        // returning the full size tells the parser they were consumed. The
+        // parser keeps a reference, so the callback is a member.
+        on_chunk_body_ = [this](std::uint64_t, beast::string_view body, beast::error_code& ec) {
+            if (!deliver(std::string_view(body.data(), body.size()))) {
+                ec = net::error::operation_aborted;
             }
-            components.host = host_port.substr(1, bracket_end - 1);
+            return body.size();
+        };
+        parser_->on_chunk_body(on_chunk_body_);
+
+        with_stream([this](auto& stream) {
+            http::async_read_header(stream, connection_->buffer(), *parser_, on_strand(
+                [self = this->shared_from_this()](const beast::error_code& ec, size_t) {
+                    if (ec) return self->retry_or_finish(ec);
+                    auto& header = self->parser_->get();
+                    self->stream_outcome_.status = header.result_int();
+                    if (header.result() != http::status::ok) {
+                        // The error body is read (up to a bound) for the
+                        // outcome instead of being streamed to the handler
+                        self->stream_outcome_.result = {false, status_error(header)};
+                        self->stream_outcome_.error = HttpError::Status;
+                        self->error_status_ = true;
+                    }
+                    auto encoding = header[http::field::content_encoding];
+                    try {
+                        self->decoder_ = ContentDecoder::create(std::string_view(encoding.data(), encoding.size()));
+                    } catch (const DecodeError& e) {
+                        self->decode_failed(e);
+                        return self->finish({});
+                    }
+                    self->read_stream_body();
+                }));
+        });
+    }
 
-            // Check for port after IPv6
-            if (bracket_end + 1 < host_port.length() && host_port[bracket_end + 1] == ':') {
-                components.port = host_port.substr(bracket_end + 2);
+    void read_stream_body() {
+        if (parser_->is_done()) {
+            if (decoder_) {
+                try {
+                    decoder_->finish();
+                } catch (const DecodeError& e) {
+                    decode_failed(e);
+                }
             }
-        } else {
-            // Regular hostname or IPv4
-            size_t colon_pos = host_port.find(':');
-            if (colon_pos != std::string::npos) {
-                components.host = host_port.substr(0, colon_pos);
-                components.port = host_port.substr(colon_pos + 1);
+            return finish({});
+        }
+        // Content-Length and close-delimited bodies land in the buffer
+        if (!stream_buffer_) {
+            stream_buffer_ = std::make_unique<char[]>(kStreamBufferBytes);
+        }
+        auto& body = parser_->get().body();
+        body.data = stream_buffer_.get();
+        body.size = kStreamBufferBytes;
+
+        with_stream([this](auto& stream) {
+            http::async_read_some(stream, connection_->buffer(), *parser_, on_strand(
+                [self = this->shared_from_this()](beast::error_code ec, size_t) {
+                    if (ec == http::error::need_buffer) {
+                        ec = {};   // buffer full; drained below
+                    }
+                    size_t filled = kStreamBufferBytes - self->parser_->get().body().size;
+                    if (!self->stopped_ && filled > 0) {
+                        self->deliver(std::string_view(self->stream_buffer_.get(), filled));
+                    }
+                    if (self->stopped_) return self->finish({});
+                    if (ec) return self->finish(ec);
+                    self->read_stream_body();
+                }));
+        });
+    }
+
+    // Decodes the chunk if needed and runs the consumer's handler; false
+    // once the stream should stop
+    bool deliver(std::string_view chunk) {
+        if (chunk.empty()) {
+            return true;
+        }
+        try {
+            if (decoder_) {
+                decoder_->decode(chunk, [this](std::string_view decoded) { return hand_over(decoded); });
             } else {
-                components.host = host_port;
+                hand_over(chunk);
             }
+        } catch (const DecodeError& e) {
+            decode_failed(e);
+            stopped_ = true;
+        } catch (const std::exception& e) {
+            auto status = stream_outcome_.status;
+            stream_outcome_ = failure(HttpError::Handler, std::string("Stream handler error: ") + e.what());
+            stream_outcome_.status = status;
+            stopped_ = true;
+        }
+        if (!stopped_) {
+            arm_deadline();
         }
+        return !stopped_;
+    }
 
-        // Set default port if not specified
-        if (components.port.empty()) {
-            components.port = components.is_https ? "443" : "80";
+    bool hand_over(std::string_view data) {
+        if (error_status_) {
+            auto& kept = stream_outcome_.error_body;
+            kept.append(data.substr(0, HttpOutcome::kMaxErrorBodyBytes - kept.size()));
+            stopped_ = kept.size() == HttpOutcome::kMaxErrorBodyBytes;
+            return !stopped_;
         }
+        delivered_ = true;
+        stopped_ = !on_chunk_(data);
+        return !stopped_;
+    }
 
-        // Parse path, query, and fragment
-        if (path_start < url_copy.length()) {
-            std::string path_query_fragment = url_copy.substr(path_start);
+    // An error response keeps its status failure; the body is best effort
+    void decode_failed(const DecodeError& e) {
+        if (!error_status_) {
+            auto status = stream_outcome_.status;
+            stream_outcome_ = failure(HttpError::Decode, std::string("Decompression error: ") + e.what());
+            stream_outcome_.status = status;
+        }
+    }
 
-            // Parse fragment
-            size_t fragment_pos = path_query_fragment.find('#');
-            if (fragment_pos != std::string::npos) {
-                components.fragment = path_query_fragment.substr(fragment_pos + 1);
-                path_query_fragment = path_query_fragment.substr(0, fragment_pos);
-            }
+    // A kept-alive connection can be closed by the server just as we pick it
+    // up; retry once on a fresh connection, unless part of a stream has
+    // already been delivered
+    void retry_or_finish(const beast::error_code& ec) {
+        if (reused_ && attempt_ == 0 && !timed_out_ && !cancelled_ && !delivered_ && is_stale_connection_error(ec)) {
+            ++attempt_;
+            connection_->set_reusable(false);
+            pool_->return_connection(std::move(connection_));
+            response_ = make_response<Body>(resource_);
+            acquire();
+            return;
+        }
+        finish(ec);
+    }
 
-            // Parse query
-            size_t query_pos = path_query_fragment.find('?');
-            if (query_pos != std::string::npos) {
-                components.query = path_query_fragment.substr(query_pos + 1);
-                components.path = path_query_fragment.substr(0, query_pos);
-            } else {
-                components.path = path_query_fragment;
-            }
+    void on_deadline() {
+        // A wait that completed just before being re-armed is stale
+        if (finished_ || deadline_.expiry() > net::steady_timer::clock_type::now()) {
+            return;
+        }
+        timed_out_ = true;
+        abort();
+    }
+
+    // Stops whatever step is pending; its handler then finishes the request
+    void abort() {
+        if (connector_) {
+            connector_->cancel();
+        } else if (connection_) {
+            connection_->close();   // aborts the pending operation
         } else {
-            components.path = "/";
+            finish({});             // queued for a connection
         }
+    }
 
-        // Basic validation
-        if (components.host.empty()) {
-            return false;
+    void finish(const beast::error_code& ec) {
+        if (finished_) {
+            return;
+        }
+        if (connection_) {
+            // A stream stopped early or refused leaves unread bytes behind
+            bool complete_message = !on_chunk_ || (parser_ && parser_->is_done());
+            bool keep_alive = on_chunk_ ? parser_ && parser_->keep_alive() : response_.keep_alive();
+            connection_->set_reusable(!ec && !timed_out_ && !cancelled_ && complete_message && keep_alive);
+            pool_->return_connection(std::move(connection_));
+        }
+
+        if (cancelled_) {
+            complete(failure(HttpError::Cancelled, "Request cancelled"));
+        } else if (timed_out_) {
+            bool overdue = net::steady_timer::clock_type::now() >= overall_at_;
+            complete(failure(HttpError::Timeout, timeout_message(overdue ? overall_ : timeout_)));
+        } else if (ec) {
+            complete(failure(connect_failed_ ? HttpError::Connect : HttpError::Transport,
+                             error_prefix() + ec.message()));
+        } else if (on_chunk_) {
+            complete(std::move(stream_outcome_));
+        } else {
+            if (!std::is_same_v<Body, OwnedBody> && response_.result() == http::status::ok) {
+                copied_->fetch_add(response_.body().size(), std::memory_order_relaxed);
+            }
+            complete(outcome_of(response_));
         }
+    }
 
-        return true;
+    void complete(HttpOutcome outcome) {
+        finished_ = true;
+        deadline_.cancel();
+        if (on_outcome_) {
+            std::exchange(on_outcome_, nullptr)(std::move(outcome));
+        } else {
+            promise_.set_value(std::move(outcome.result));
+        }
     }
 
-    ssl::context ssl_ctx_;
+    std::string error_prefix() const {
+        return key_.is_tls() ? "HTTPS request error: " : "HTTP request error: ";
+    }
 
-    // Helper function to build HTTP request
-    template<typename BodyType>
-    http::request<BodyType> build_request(const std::string& method,
-                                         const std::string& target,
-                                         const std::string& host,
-                                         const std::string& data = "") {
-        http::request<BodyType> req{method == "POST" ? http::verb::post : http::verb::get, target, 11};
-                req.set(http::field::host, host);
-                req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
-                req.set(http::field::accept, "*/*");
+    // Declared first: request/response bodies are allocated from it
+    std::shared_ptr<core::RequestArena> arena_;
+    std::pmr::memory_resource* resource_;
+
+    std::shared_ptr<ConnectionPool> pool_;
+    std::shared_ptr<DnsCache> dns_;
+    std::shared_ptr<TlsSessionCache> tls_;
+    std::shared_ptr<std::atomic<uint64_t>> copied_;
+    Strand strand_;
+    net::steady_timer deadline_;
+
+    ConnectionKey key_;
+    std::chrono::steady_clock::duration timeout_;
+    std::chrono::steady_clock::duration overall_;   // zero for none
+    net::steady_timer::time_point overall_at_ = net::steady_timer::time_point::max();
+    http::request<Body> request_;
+    http::response<Body> response_;
+    std::optional<http::response_parser<Body>> reader_;   // holds response_ while it is read
+    std::shared_ptr<Connection> connection_;
+    std::shared_ptr<Connector> connector_;
+    std::promise<HttpResult> promise_;
+    OutcomeHandler on_outcome_;   // replaces the promise when set
+
+    ChunkHandler on_chunk_;
+    std::function<size_t(std::uint64_t, beast::string_view, beast::error_code&)> on_chunk_body_;
+    std::optional<StreamParser> parser_;
+    std::unique_ptr<ContentDecoder> decoder_;
+    std::unique_ptr<char[]> stream_buffer_;
+    HttpOutcome stream_outcome_ = success();
+    bool error_status_ = false;   // non-200: the body goes to stream_outcome_
+    bool delivered_ = false;      // no retries once the consumer has seen data
+    bool stopped_ = false;        // the handler ended the stream
+
+    int attempt_ = 0;
+    bool reused_ = false;
+    bool connect_failed_ = false;
+    bool timed_out_ = false;
+    bool cancelled_ = false;
+    bool finished_ = false;
+};
 
-                if (method == "POST" && !data.empty()) {
-                    req.set(http::field::content_type, "application/json");
-                    req.body() = data;
-                    req.prepare_payload();
-                }
+// ============================================================================
+// Batches
+// ============================================================================
 
-        return req;
+// Requests are grouped by origin and each origin's queue is served by a few
+// lanes. A lane holds one pooled connection and writes queued requests ahead
+// of the response it is reading, up to the pipeline depth; HTTP/1.1 answers
+// them in order, so each response belongs to the oldest request in flight on
+// its lane. The whole batch runs on one strand.
+class HttpClient::Impl::Batch : public std::enable_shared_from_this<Batch> {
+public:
+    Batch(std::shared_ptr<ConnectionPool> pool,
+          std::shared_ptr<DnsCache> dns,
+          std::shared_ptr<TlsSessionCache> tls,
+          std::shared_ptr<UrlCache> urls,
+          std::vector<BatchRequest> requests,
+          BatchResultHandler on_result,
+          BatchOptions options)
+        : pool_(std::move(pool))
+        , dns_(std::move(dns))
+        , tls_(std::move(tls))
+        , urls_(std::move(urls))
+        , strand_(net::make_strand(pool_->runtime().context()))
+        , requests_(std::move(requests))
+        , on_result_(std::move(on_result))
+        , options_(options)
+        , items_(requests_.size())
+        , results_(requests_.size())
+        , remaining_(requests_.size()) {
+        options_.connections_per_host = std::max<size_t>(options_.connections_per_host, 1);
+        options_.pipeline_depth = std::max<size_t>(options_.pipeline_depth, 1);
     }
 
-    // Helper function to handle response
-    std::pair<bool, std::string> handle_response(const http::response<http::dynamic_body>& res,
-                                                const beast::error_code& shutdown_ec = {}) {
-        if (res.result() == http::status::ok) {
-            return {true, std::string(beast::buffers_to_string(res.body().data()))};
+    std::future<std::vector<HttpResult>> start() {
+        auto future = promise_.get_future();
+        if (requests_.empty()) {
+            promise_.set_value({});
         } else {
-            std::string error_msg = "HTTP " + std::to_string(static_cast<int>(res.result())) + " " +
-                                    std::string(res.reason());
-            if (shutdown_ec) {
-                error_msg += " (Connection error: " + shutdown_ec.message() + ")";
-            }
-            return {false, error_msg};
+            net::dispatch(strand_, [self = shared_from_this()] { self->begin(); });
         }
+        return future;
     }
 
-    // Helper function for HTTPS request processing
-    std::pair<bool, std::string> process_https_request(net::io_context& ioc,
-                                                      const std::string& host,
-                                                      const std::string& port,
-                                                      const std::string& target,
-                                                      const std::string& method,
-                                                      const std::string& data,
-                                                      net::steady_timer& deadline_timer) {
-        try {
-            // Create SSL stream
-            ssl::stream<tcp::socket> stream{ioc, ssl_ctx_};
+private:
+    struct Item {
+        size_t origin = 0;
+        http::request<OwnedBody> request;
+        bool idempotent = false;   // safe to send again after a dropped connection
+        int attempts = 0;
+    };
 
-            // Look up the domain name
-            tcp::resolver resolver{ioc};
-            auto const results = resolver.resolve(host, port);
+    struct Origin {
+        ConnectionKey key;
+        std::deque<size_t> queue;
+        bool pipelining = true;    // cleared once the server shows it does not keep up
+        size_t lanes = 0;          // lanes still serving the queue
+    };
 
-            // Make the connection
-            net::connect(stream.next_layer(), results.begin(), results.end());
+    struct Lane {
+        Lane(size_t origin, Strand& strand) : origin(origin), deadline(strand) {}
+
+        size_t origin;
+        std::shared_ptr<Connection> connection;
+        std::shared_ptr<Connector> connector;
+        std::deque<size_t> in_flight;   // written or being written, oldest first
+        std::optional<http::response_parser<OwnedBody>> response;
+        net::steady_timer deadline;
+        size_t answered = 0;            // responses read on this connection
+        bool reused = false;
+        bool writing = false;
+        bool reading = false;
+        bool closing = false;           // nothing more is sent on this connection
+        bool timed_out = false;
+        bool done = false;
+    };
 
-            // Set SNI hostname
-            if(!SSL_set_tlsext_host_name(stream.native_handle(), host.c_str())) {
-                return {false, "Failed to set SNI hostname"};
-            }
+    template<typename Fn>
+    static void with_stream(Connection& connection, Fn&& fn) {
+        if (connection.is_tls()) {
+            fn(connection.tls_stream());
+        } else {
+            fn(connection.plain_stream());
+        }
+    }
 
-            // Perform the SSL handshake
-            stream.handshake(ssl::stream_base::client);
+    static std::string error_prefix(const ConnectionKey& key) {
+        return key.is_tls() ? "HTTPS request error: " : "HTTP request error: ";
+    }
 
-            // Send the HTTP request
-            auto req = build_request<http::string_body>(method, target, host, data);
-                http::write(stream, req);
+    void begin() {
+        std::map<ConnectionKey, size_t> origin_index;
+        for (size_t i = 0; i < requests_.size(); ++i) {
+            auto& request = requests_[i];
+            auto parsed = urls_->parse(request.url);
+            if (!parsed || parsed->is_websocket()) {
+                report(i, {false, "Invalid URL: " + request.url});
+                continue;
+            }
+            auto verb = verb_of(request.method);
+            if (verb == http::verb::unknown) {
+                report(i, unsupported_method(request.method));
+                continue;
+            }
+            ConnectionKey key = origin_of(*parsed, request.url);
+            auto [it, inserted] = origin_index.emplace(key, origins_.size());
+            if (inserted) {
+                origins_.push_back(Origin{std::move(key), {}, true, 0});
+            }
 
-                // Receive the HTTP response
-                beast::flat_buffer buffer;
-                http::response<http::dynamic_body> res;
-                http::read(stream, buffer, res);
+            Item& item = items_[i];
+            item.origin = it->second;
+            const std::string& host = origins_[item.origin].key.host;
+            item.request = build_request<OwnedBody>(verb, parsed->target(request.url), host,
+                                                    std::move(request.body),
+                                                    accepts_compression(options_.compression, host));
+            item.idempotent = is_idempotent(verb) || options_.pipeline_posts;
+            origins_[item.origin].queue.push_back(i);
+        }
 
-            // Cancel the deadline timer since we completed successfully
-            deadline_timer.cancel();
+        for (size_t o = 0; o < origins_.size(); ++o) {
+            size_t lanes = std::min(options_.connections_per_host, origins_[o].queue.size());
+            for (size_t n = 0; n < lanes; ++n) {
+                lanes_.push_back(std::make_unique<Lane>(o, strand_));
+                ++origins_[o].lanes;
+                acquire(*lanes_.back());
+            }
+        }
+    }
 
-                // Close the connection
-                beast::error_code ec;
-                stream.shutdown(ec);
+    void arm_deadline(Lane& lane) {
+        lane.deadline.expires_after(options_.timeout);
+        lane.deadline.async_wait([self = shared_from_this(), &lane](const beast::error_code& ec) {
+            if (!ec) self->on_deadline(lane);
+        });
+    }
 
-            if (ec) {
-                std::cerr << "SSL shutdown error: " << ec.message() << std::endl;
+    void acquire(Lane& lane) {
+        lane.answered = 0;
+        lane.closing = false;
+        lane.timed_out = false;
+        arm_deadline(lane);
+        pool_->async_get_connection(origins_[lane.origin].key,
+            [self = shared_from_this(), &lane](std::shared_ptr<Connection> connection, std::string error) mutable {
+                auto& strand = self->strand_;
+                net::dispatch(strand, [self = std::move(self), &lane, connection = std::move(connection),
+                                       error = std::move(error)]() mutable {
+                    self->on_connection(lane, std::move(connection), std::move(error));
+                });
+            });
+    }
+
+    void on_connection(Lane& lane, std::shared_ptr<Connection> connection, std::string error) {
+        if (lane.done) {
+            // Timed out while queued; hand the connection back untouched
+            if (connection) {
+                connection->set_reusable(connection->is_open());
+                pool_->return_connection(std::move(connection));
             }
+            return;
+        }
+        const ConnectionKey& key = origins_[lane.origin].key;
+        if (!connection) {
+            return retire(lane, error_prefix(key) + error);
+        }
 
-            return handle_response(res, ec);
+        lane.connection = std::move(connection);
+        lane.reused = lane.connection->was_reused();
+        if (lane.connection->is_open()) {
+            return pump(lane);
+        }
+        lane.connector = std::make_shared<Connector>(lane.connection, key, strand_, dns_, tls_);
+        lane.connector->start([self = shared_from_this(), &lane](const beast::error_code& ec) {
+            lane.connector.reset();
+            if (!ec) return self->pump(lane);
+            self->release(lane, false);
+            self->retire(lane, lane.timed_out ? timeout_message(self->options_.timeout)
+                                              : error_prefix(self->origins_[lane.origin].key) + ec.message());
+        });
+    }
 
-        } catch (const std::exception& e) {
-            return {false, std::string("HTTPS request error: ") + e.what()};
+    // Writes while the lane has room and reads while requests are in
+    // flight; once the lane is idle its connection goes back to the pool
+    void pump(Lane& lane) {
+        Origin& origin = origins_[lane.origin];
+        if (!lane.closing && !lane.writing && !origin.queue.empty() && has_room(lane, origin)) {
+            write(lane, origin);
         }
+        if (!lane.reading && !lane.in_flight.empty()) {
+            read(lane);
+        }
+        if (lane.writing || lane.reading || !lane.in_flight.empty()) {
+            return;
+        }
+
+        release(lane, !lane.closing);
+        if (!origin.queue.empty()) {
+            return acquire(lane);   // the connection closed with requests left to send
+        }
+        retire(lane, {});
     }
 
-    // Helper function for HTTP request processing
-    std::pair<bool, std::string> process_http_request(net::io_context& ioc,
-                                                     const std::string& host,
-                                                     const std::string& port,
-                                                     const std::string& target,
-                                                     const std::string& method,
-                                                     const std::string& data,
-                                                     net::steady_timer& deadline_timer) {
-        try {
-            // Create socket
-            tcp::socket socket{ioc};
+    bool has_room(const Lane& lane, const Origin& origin) const {
+        if (lane.in_flight.empty()) {
+            return true;
+        }
+        if (!origin.pipelining || lane.in_flight.size() >= options_.pipeline_depth) {
+            return false;
+        }
+        return items_[origin.queue.front()].idempotent && items_[lane.in_flight.back()].idempotent;
+    }
 
-                // Look up the domain name
-            tcp::resolver resolver{ioc};
-                auto const results = resolver.resolve(host, port);
+    void write(Lane& lane, Origin& origin) {
+        size_t index = origin.queue.front();
+        origin.queue.pop_front();
+        if (lane.in_flight.empty()) {
+            arm_deadline(lane);
+        }
+        lane.in_flight.push_back(index);
+        lane.writing = true;
+
+        with_stream(*lane.connection, [&](auto& stream) {
+            http::async_write(stream, items_[index].request, net::bind_executor(strand_,
+                [self = shared_from_this(), &lane](const beast::error_code& ec, size_t) {
+                    lane.writing = false;
+                    if (ec) return self->on_error(lane, ec);
+                    self->pump(lane);
+                }));
+        });
+    }
 
-            // Make the connection
-                net::connect(socket, results.begin(), results.end());
+    void read(Lane& lane) {
+        lane.reading = true;
+        lane.response.emplace();
+        lane.response->body_limit(kMaxDecodedBodyBytes);
+        lane.response->skip(items_[lane.in_flight.front()].request.method() == http::verb::head);
+        with_stream(*lane.connection, [&](auto& stream) {
+            http::async_read(stream, lane.connection->buffer(), *lane.response, net::bind_executor(strand_,
+                [self = shared_from_this(), &lane](const beast::error_code& ec, size_t) {
+                    lane.reading = false;
+                    if (ec) return self->on_error(lane, ec);
+                    self->on_response(lane);
+                }));
+        });
+    }
 
-            // Send the HTTP request
-            auto req = build_request<http::string_body>(method, target, host, data);
-                http::write(socket, req);
+    void on_response(Lane& lane) {
+        size_t index = lane.in_flight.front();
+        lane.in_flight.pop_front();
+        ++lane.answered;
 
-                // Receive the HTTP response
-                beast::flat_buffer buffer;
-                http::response<http::dynamic_body> res;
-                http::read(socket, buffer, res);
+        auto& response = lane.response->get();
+        if (response.version() < 11) {
+            origins_[lane.origin].pipelining = false;
+        }
+        if (!response.keep_alive()) {
+            // The server drops whatever was sent after this request; those
+            // go out again on another connection, one at a time
+            if (!lane.in_flight.empty()) {
+                origins_[lane.origin].pipelining = false;
+            }
+            lane.closing = true;
+            lane.connection->close();   // aborts a write still in progress
+            requeue_in_flight(lane);
+        }
 
-            // Cancel the deadline timer since we completed successfully
-            deadline_timer.cancel();
+        if (lane.in_flight.empty()) {
+            lane.deadline.cancel();
+        } else {
+            arm_deadline(lane);
+        }
+        // Reported once the lane has moved on, so by the time the last
+        // result is in every connection is back in the pool
+        HttpResult result = handle_response(response);
+        pump(lane);
+        report(index, std::move(result));
+    }
 
-                // Close the connection
-                beast::error_code ec;
-                socket.shutdown(tcp::socket::shutdown_both, ec);
+    // The connection failed or timed out with requests in flight. Those that
+    // can be sent again are queued for a fresh connection; the rest fail.
+    void on_error(Lane& lane, const beast::error_code& ec) {
+        std::vector<std::pair<size_t, HttpResult>> failed;
+        if (!lane.closing) {
+            lane.closing = true;
+            lane.connection->close();   // aborts the other pending write or read
+
+            Origin& origin = origins_[lane.origin];
+            bool stale = is_stale_connection_error(ec);
+            if (stale && lane.answered > 0 && lane.in_flight.size() > 1) {
+                origin.pipelining = false;   // closed on us mid-pipeline
+            }
+            // A kept-alive connection closed before answering anything never
+            // saw the requests, as with a single request
+            bool unseen = stale && lane.reused && lane.answered == 0;
+            for (auto it = lane.in_flight.rbegin(); it != lane.in_flight.rend(); ++it) {
+                Item& item = items_[*it];
+                if (!lane.timed_out && stale && item.attempts == 0 && (unseen || item.idempotent)) {
+                    ++item.attempts;
+                    origin.queue.push_front(*it);
+                } else if (lane.timed_out) {
+                    failed.emplace_back(*it, HttpResult{false, timeout_message(options_.timeout)});
+                } else {
+                    failed.emplace_back(*it, HttpResult{false, error_prefix(origin.key) + ec.message()});
+                }
+            }
+            lane.in_flight.clear();
+            lane.deadline.cancel();
+        }
+        pump(lane);
+        for (auto it = failed.rbegin(); it != failed.rend(); ++it) {
+            report(it->first, std::move(it->second));
+        }
+    }
 
-            return handle_response(res);
+    void requeue_in_flight(Lane& lane) {
+        auto& queue = origins_[lane.origin].queue;
+        queue.insert(queue.begin(), lane.in_flight.begin(), lane.in_flight.end());
+        lane.in_flight.clear();
+    }
 
-        } catch (const std::exception& e) {
-            return {false, std::string("HTTP request error: ") + e.what()};
+    void on_deadline(Lane& lane) {
+        // A wait that completed just before being re-armed is stale
+        if (lane.done || lane.deadline.expiry() > net::steady_timer::clock_type::now()) {
+            return;
+        }
+        lane.timed_out = true;
+        if (lane.connector) {
+            lane.connector->cancel();
+        } else if (lane.connection) {
+            if (!lane.in_flight.empty()) on_error(lane, net::error::timed_out);
+        } else {
+            retire(lane, timeout_message(options_.timeout));   // queued for a connection
         }
     }
+
+    void release(Lane& lane, bool reusable) {
+        if (lane.connection) {
+            lane.connection->set_reusable(reusable && lane.connection->is_open());
+            pool_->return_connection(std::move(lane.connection));
+        }
+    }
+
+    // The lane stops serving its origin. When it was the last one, whatever
+    // is still queued fails with the lane's error.
+    void retire(Lane& lane, const std::string& error) {
+        lane.done = true;
+        lane.deadline.cancel();
+        Origin& origin = origins_[lane.origin];
+        if (--origin.lanes > 0) {
+            return;
+        }
+        while (!origin.queue.empty()) {
+            size_t index = origin.queue.front();
+            origin.queue.pop_front();
+            report(index, {false, error});
+        }
+    }
+
+    void report(size_t index, HttpResult result) {
+        results_[index] = std::move(result);
+        if (on_result_) {
+            try {
+                on_result_(index, results_[index]);
+            } catch (...) {
+                // Must not escape into the runtime's event loop
+            }
+        }
+        if (--remaining_ == 0) {
+            promise_.set_value(std::move(results_));
+        }
+    }
+
+    std::shared_ptr<ConnectionPool> pool_;
+    std::shared_ptr<DnsCache> dns_;
+    std::shared_ptr<TlsSessionCache> tls_;
+    std::shared_ptr<UrlCache> urls_;
+    Strand strand_;
+
+    std::vector<BatchRequest> requests_;
+    BatchResultHandler on_result_;
+    BatchOptions options_;
+
+    std::vector<Item> items_;
+    std::vector<Origin> origins_;
+    std::vector<std::unique_ptr<Lane>> lanes_;
+
+    std::vector<HttpResult> results_;
+    size_t remaining_;
+    std::promise<std::vector<HttpResult>> promise_;
 };
 
-HttpClient::HttpClient() : impl_(std::make_unique<Impl>()) {}
+template<typename Body>
+std::future<HttpResult> HttpClient::Impl::start(std::string_view url,
+                                                std::string_view method,
+                                                typename Body::value_type body,
+                                                const RequestOptions& options,
+                                                std::shared_ptr<core::RequestArena> arena,
+                                                ChunkHandler on_chunk,
+                                                OutcomeHandler on_outcome,
+                                                RequestHandle* handle) {
+    CORTAN_ALLOC_SCOPE(Network);
+
+    // Nothing was sent
+    auto fail = [&](HttpResult result) {
+        if (on_outcome) {
+            net::post(pool_->runtime().context(),
+                      [on_outcome = std::move(on_outcome), outcome = failure(HttpError::Rejected,
+                                                                             std::move(result.second))]() mutable {
+                          on_outcome(std::move(outcome));
+                      });
+            return std::future<HttpResult>{};
+        }
+        std::promise<HttpResult> failed;
+        failed.set_value(std::move(result));
+        return failed.get_future();
+    };
+
+    try {
+        auto parsed = urls_->parse(url);
+        if (!parsed || parsed->is_websocket()) {
+            return fail({false, "Invalid URL: " + std::string(url)});
+        }
+        auto verb = verb_of(method);
+        if (verb == http::verb::unknown) {
+            return fail(unsupported_method(method));
+        }
+
+        ConnectionKey key = origin_of(*parsed, url);
+        bool accept_compressed = accepts_compression(options.compression, key.host);
+        auto operation = std::make_shared<Operation<Body>>(std::move(arena), pool_, dns_, tls_, copied_,
+                                                           std::move(key), verb, parsed->target(url),
+                                                           std::move(body), options.timeout, options.deadline,
+                                                           accept_compressed, std::move(on_chunk));
+        if (handle) {
+            *handle = RequestHandle([weak = std::weak_ptr<Operation<Body>>(operation)] {
+                if (auto operation = weak.lock()) operation->cancel();
+            });
+        }
+        if (on_outcome) {
+            operation->start(std::move(on_outcome));
+            return {};
+        }
+        return operation->start();
+
+    } catch (const std::exception& e) {
+        return fail({false, std::string("Network error: ") + e.what()});
+    }
+}
+
+std::future<HttpResult> HttpClient::Impl::make_request(std::string_view url,
+                                                       std::string_view method,
+                                                       std::string data,
+                                                       const RequestOptions& options,
+                                                       ChunkHandler on_chunk) {
+    return start<OwnedBody>(url, method, std::move(data), options, nullptr, std::move(on_chunk));
+}
+
+RequestHandle HttpClient::Impl::make_request(std::string_view url,
+                                             std::string_view method,
+                                             std::string data,
+                                             const RequestOptions& options,
+                                             OutcomeHandler on_outcome,
+                                             ChunkHandler on_chunk) {
+    RequestHandle handle;
+    start<OwnedBody>(url, method, std::move(data), options, nullptr, std::move(on_chunk), std::move(on_outcome),
+                     &handle);
+    return handle;
+}
+
+std::future<HttpResult> HttpClient::Impl::make_arena_request(std::string_view url,
+                                                             std::string_view method,
+                                                             std::string_view data,
+                                                             std::chrono::steady_clock::duration timeout,
+                                                             std::shared_ptr<core::RequestArena> arena) {
+    std::pmr::memory_resource* resource = arena.get();
+    count_copy(data.size());
+    return start<ArenaStringBody>(url, method, std::pmr::string(data, resource), with_timeout(timeout),
+                                  std::move(arena), {});
+}
+
+std::future<std::vector<HttpResult>> HttpClient::Impl::make_batch(std::vector<BatchRequest> requests,
+                                                                  BatchResultHandler on_result,
+                                                                  BatchOptions options) {
+    CORTAN_ALLOC_SCOPE(Network);
+    auto batch = std::make_shared<Batch>(pool_, dns_, tls_, urls_, std::move(requests), std::move(on_result), options);
+    return batch->start();
+}
+
+// ============================================================================
+// HttpClient
+// ============================================================================
+
+HttpClient::HttpClient() : HttpClient(std::make_shared<ConnectionPool>()) {}
+
+HttpClient::HttpClient(std::shared_ptr<ConnectionPool> pool,
+                       std::shared_ptr<DnsCache> dns,
+                       std::shared_ptr<TlsSessionCache> tls)
+    : impl_(std::make_unique<Impl>(pool ? std::move(pool) : std::make_shared<ConnectionPool>(),
+                                   dns ? std::move(dns) : DnsCache::shared(),
+                                   tls ? std::move(tls) : TlsSessionCache::shared())) {}
 
 HttpClient::~HttpClient() = default;
 
+std::shared_ptr<ConnectionPool> HttpClient::connection_pool() const {
+    return impl_->pool();
+}
+
+uint64_t HttpClient::payload_bytes_copied() const {
+    return impl_->bytes_copied();
+}
+
 std::future<std::pair<bool, std::string>> HttpClient::get(const std::string& url) {
-    return std::async(std::launch::async, [this, url]() -> std::pair<bool, std::string> {
-        return impl_->make_request(url, "GET", "", std::chrono::seconds(30));
-    });
+    return impl_->make_request(url, "GET", "", RequestOptions{});
 }
 
 std::future<std::pair<bool, std::string>> HttpClient::post(const std::string& url, const std::string& data) {
-    return std::async(std::launch::async, [this, url, data]() -> std::pair<bool, std::string> {
-        return impl_->make_request(url, "POST", data, std::chrono::seconds(30));
-    });
+    impl_->count_copy(data.size());
+    return impl_->make_request(url, "POST", data, RequestOptions{});
 }
 
 std::future<std::pair<bool, std::string>> HttpClient::get(const std::string& url,
                                                           std::chrono::steady_clock::duration timeout) {
-    return std::async(std::launch::async, [this, url, timeout]() -> std::pair<bool, std::string> {
-        return impl_->make_request(url, "GET", "", timeout);
-    });
+    return impl_->make_request(url, "GET", "", Impl::with_timeout(timeout));
 }
 
 std::future<std::pair<bool, std::string>> HttpClient::post(const std::string& url,
                                                            const std::string& data,
                                                            std::chrono::steady_clock::duration timeout) {
-    return std::async(std::launch::async, [this, url, data, timeout]() -> std::pair<bool, std::string> {
-        return impl_->make_request(url, "POST", data, timeout);
-    });
+    impl_->count_copy(data.size());
+    return impl_->make_request(url, "POST", data, Impl::with_timeout(timeout));
+}
+
+std::future<std::pair<bool, std::string>> HttpClient::post(const std::string& url,
+                                                           std::string&& data,
+                                                           std::chrono::steady_clock::duration timeout) {
+    return impl_->make_request(url, "POST", std::move(data), Impl::with_timeout(timeout));
+}
+
+std::future<std::pair<bool, std::string>> HttpClient::get(const std::string& url, const RequestOptions& options) {
+    return impl_->make_request(url, "GET", "", options);
+}
+
+std::future<std::pair<bool, std::string>> HttpClient::post(const std::string& url,
+                                                           const std::string& data,
+                                                           const RequestOptions& options) {
+    impl_->count_copy(data.size());
+    return impl_->make_request(url, "POST", data, options);
+}
+
+std::future<std::pair<bool, std::string>> HttpClient::post(const std::string& url,
+                                                           std::string&& data,
+                                                           const RequestOptions& options) {
+    return impl_->make_request(url, "POST", std::move(data), options);
+}
+
+std::future<std::pair<bool, std::string>> HttpClient::get(const std::string& url,
+                                                          std::shared_ptr<core::RequestArena> arena,
+                                                          std::chrono::steady_clock::duration timeout) {
+    return impl_->make_arena_request(url, "GET", "", timeout, std::move(arena));
+}
+
+std::future<std::pair<bool, std::string>> HttpClient::post(const std::string& url,
+                                                           const std::string& data,
+                                                           std::shared_ptr<core::RequestArena> arena,
+                                                           std::chrono::steady_clock::duration timeout) {
+    return impl_->make_arena_request(url, "POST", data, timeout, std::move(arena));
+}
+
+std::future<std::pair<bool, std::string>> HttpClient::get_stream(const std::string& url,
+                                                                 ChunkHandler on_chunk,
+                                                                 std::chrono::steady_clock::duration timeout) {
+    return impl_->make_request(url, "GET", "", Impl::with_timeout(timeout), std::move(on_chunk));
+}
+
+std::future<std::pair<bool, std::string>> HttpClient::post_stream(const std::string& url,
+                                                                  const std::string& data,
+                                                                  ChunkHandler on_chunk,
+                                                                  std::chrono::steady_clock::duration timeout) {
+    impl_->count_copy(data.size());
+    return impl_->make_request(url, "POST", data, Impl::with_timeout(timeout), std::move(on_chunk));
+}
+
+std::future<std::pair<bool, std::string>> HttpClient::get_stream(const std::string& url,
+                                                                 ChunkHandler on_chunk,
+                                                                 const RequestOptions& options) {
+    return impl_->make_request(url, "GET", "", options, std::move(on_chunk));
+}
+
+std::future<std::pair<bool, std::string>> HttpClient::post_stream(const std::string& url,
+                                                                  const std::string& data,
+                                                                  ChunkHandler on_chunk,
+                                                                  const RequestOptions& options) {
+    impl_->count_copy(data.size());
+    return impl_->make_request(url, "POST", data, options, std::move(on_chunk));
+}
+
+RequestHandle HttpClient::async_request(std::string_view method,
+                                        const std::string& url,
+                                        std::string body,
+                                        const RequestOptions& options,
+                                        ResultHandler on_result,
+                                        ChunkHandler on_chunk) {
+    return async_fetch(method, url, std::move(body), options,
+                [on_result = std::move(on_result)](HttpOutcome outcome) { on_result(std::move(outcome.result)); },
+                std::move(on_chunk));
+}
+
+RequestHandle HttpClient::async_fetch(std::string_view method,
+                                      const std::string& url,
+                                      std::string body,
+                                      const RequestOptions& options,
+                                      OutcomeHandler on_outcome,
+                                      ChunkHandler on_chunk) {
+    return impl_->make_request(url, method.empty() ? "GET" : method, std::move(body), options, std::move(on_outcome),
+                        std::move(on_chunk));
+}
+
+std::future<std::vector<std::pair<bool, std::string>>> HttpClient::send_batch(std::vector<BatchRequest> requests,
+                                                                              BatchResultHandler on_result,
+                                                                              BatchOptions options) {
+    return impl_->make_batch(std::move(requests), std::move(on_result), options);
 }
 
 } // namespace cortan::network
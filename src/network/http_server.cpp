@@ -0,0 +1,625 @@
+#include <cortan/network/http_server.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace cortan::network {
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace net = boost::asio;
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+
+#ifdef SO_REUSEPORT
+using reuse_port = net::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+constexpr bool kHasReusePort = true;
+#else
+constexpr bool kHasReusePort = false;
+#endif
+
+// State every connection needs, shared so that a connection kept alive by a
+// producer's ResponseStream never points into a destroyed server
+struct ServerShared {
+    HttpServerConfig config;
+    std::shared_ptr<RequestHandler> handler;
+    std::atomic<bool> stopping{false};
+
+    std::atomic<uint64_t> connections_accepted{0};
+    std::atomic<uint64_t> requests_handled{0};
+    std::atomic<uint64_t> responses_streamed{0};
+    std::atomic<uint64_t> bytes_received{0};
+    std::atomic<uint64_t> bytes_sent{0};
+    std::atomic<size_t> active_connections{0};
+};
+
+// ============================================================================
+// Session
+// ============================================================================
+
+// One connection, confined to the I/O thread that accepted it. Requests are
+// read, dispatched and answered one after another; pipelined requests wait
+// in the read buffer. Streamed bodies arrive from producer threads through a
+// small locked queue and are written as one HTTP chunk per drain, so a fast
+// producer costs one write per batch rather than one per token.
+class Session : public std::enable_shared_from_this<Session> {
+public:
+    Session(std::shared_ptr<ServerShared> shared, std::shared_ptr<net::io_context> io, tcp::socket socket)
+        : io_(std::move(io))
+        , shared_(std::move(shared))
+        , stream_(std::move(socket)) {
+        ++shared_->active_connections;
+    }
+
+    ~Session() { --shared_->active_connections; }
+
+    void start() { read_request(); }
+
+    // I/O thread. Ends the connection and refuses further stream writes.
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+            pending_.clear();
+        }
+        beast::error_code ec;
+        stream_.socket().shutdown(tcp::socket::shutdown_both, ec);
+        stream_.socket().close(ec);
+    }
+
+    // Any thread: queue a body chunk or the end of a streamed response. A
+    // stream kept past its own response (the connection has moved on to the
+    // next one) is refused.
+    bool enqueue_chunk(uint64_t generation, std::string chunk) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_ || finish_requested_ || generation != stream_generation_) {
+            return false;
+        }
+        if (chunk.empty()) {
+            return true;   // an empty chunk would end the body
+        }
+        pending_.push_back(std::move(chunk));
+        schedule_drain();
+        return true;
+    }
+
+    void enqueue_finish(uint64_t generation) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_ || finish_requested_ || generation != stream_generation_) {
+            return;
+        }
+        finish_requested_ = true;
+        schedule_drain();
+    }
+
+private:
+    // ========================================================================
+    // Requests
+    // ========================================================================
+
+    void read_request() {
+        const auto& config = shared_->config;
+        parser_.emplace();
+        parser_->header_limit(static_cast<uint32_t>(std::min<size_t>(config.max_header_bytes, UINT32_MAX)));
+        parser_->body_limit(config.max_body_bytes);
+        stream_.expires_after(config.idle_timeout);
+        http::async_read(stream_, buffer_, *parser_,
+            [self = shared_from_this()](const beast::error_code& ec, size_t) { self->on_read(ec); });
+    }
+
+    void on_read(const beast::error_code& ec) {
+        if (ec == http::error::end_of_stream) {
+            beast::error_code ignored;
+            stream_.socket().shutdown(tcp::socket::shutdown_send, ignored);
+            return;
+        }
+        if (ec == http::error::body_limit) {
+            return reject(413, "Payload Too Large");
+        }
+        if (ec == http::error::header_limit) {
+            return reject(431, "Request Header Fields Too Large");
+        }
+        if (ec) {
+            // Malformed requests get an answer; network errors and timeouts don't
+            if (&ec.category() == &http::make_error_code(http::error::bad_method).category()) {
+                return reject(400, "Bad Request");
+            }
+            return close();
+        }
+
+        auto message = parser_->release();
+        parser_.reset();
+
+        HttpRequest request;
+        request.method = std::string(message.method_string());
+        request.target = std::string(message.target());
+        request.headers.reserve(static_cast<size_t>(std::distance(message.begin(), message.end())));
+        for (const auto& field : message) {
+            request.headers.emplace_back(std::string(field.name_string()), std::string(field.value()));
+        }
+        request.body = std::move(message.body());
+        request.keep_alive = message.keep_alive();
+        version_ = message.version();
+        head_ = message.method() == http::verb::head;
+        keep_alive_ = request.keep_alive && !shared_->stopping.load(std::memory_order_relaxed);
+
+        ++shared_->requests_handled;
+        shared_->bytes_received += request.body.size();
+
+        HttpResponse response;
+        shared_->handler->handle_request(request, response);
+        if (response.streamer) {
+            start_stream(response);
+        } else {
+            send_response(response);
+        }
+    }
+
+    void reject(int status, const char* reason) {
+        HttpResponse response;
+        response.status = status;
+        response.content_type = "text/plain";
+        response.body = reason;
+        keep_alive_ = false;
+        version_ = 11;
+        head_ = false;
+        send_response(response);
+    }
+
+    void send_response(HttpResponse& response) {
+        response_ = {};
+        response_.version(version_);
+        response_.result(static_cast<unsigned>(response.status));
+        response_.set(http::field::server, "cortan");
+        if (!response.content_type.empty()) {
+            response_.set(http::field::content_type, response.content_type);
+        }
+        for (const auto& [name, value] : response.headers) {
+            response_.insert(name, value);
+        }
+        response_.keep_alive(keep_alive_);
+        response_.body() = std::move(response.body);
+        response_.prepare_payload();
+        if (head_) {
+            response_.body().clear();   // Content-Length still describes the GET body
+        }
+        shared_->bytes_sent += response_.body().size();
+
+        stream_.expires_after(shared_->config.idle_timeout);
+        http::async_write(stream_, response_,
+            [self = shared_from_this()](const beast::error_code& ec, size_t) { self->on_response_written(ec); });
+    }
+
+    void on_response_written(const beast::error_code& ec) {
+        if (ec) {
+            return close();
+        }
+        response_ = {};
+        if (!keep_alive_) {
+            beast::error_code ignored;
+            stream_.socket().shutdown(tcp::socket::shutdown_send, ignored);
+            return;
+        }
+        read_request();
+    }
+
+    // ========================================================================
+    // Streamed responses
+    // ========================================================================
+
+    // Bound to the response it was created for
+    class Stream : public ResponseStream {
+    public:
+        Stream(std::shared_ptr<Session> session, uint64_t generation)
+            : session_(std::move(session)), generation_(generation) {}
+        ~Stream() override { session_->enqueue_finish(generation_); }
+
+        bool write(std::string chunk) override { return session_->enqueue_chunk(generation_, std::move(chunk)); }
+        void finish() override { session_->enqueue_finish(generation_); }
+
+    private:
+        std::shared_ptr<Session> session_;
+        const uint64_t generation_;
+    };
+
+    void start_stream(HttpResponse& response) {
+        uint64_t generation;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_.clear();
+            finish_requested_ = false;
+            generation = ++stream_generation_;
+        }
+        last_chunk_sent_ = false;
+
+        stream_header_.emplace();
+        auto& header = *stream_header_;
+        header.version(version_);
+        header.result(static_cast<unsigned>(response.status));
+        header.set(http::field::server, "cortan");
+        if (!response.content_type.empty()) {
+            header.set(http::field::content_type, response.content_type);
+        }
+        for (const auto& [name, value] : response.headers) {
+            header.insert(name, value);
+        }
+        header.keep_alive(keep_alive_);
+        header.chunked(true);
+        serializer_.emplace(header);
+
+        if (head_) {
+            // The headers a GET would get; the streamer is not run
+            writing_ = true;
+            stream_.expires_after(shared_->config.idle_timeout);
+            http::async_write_header(stream_, *serializer_,
+                [self = shared_from_this()](const beast::error_code& ec, size_t) {
+                    self->on_chunk_written(ec, true);
+                });
+            return;
+        }
+
+        ++shared_->responses_streamed;
+        writing_ = true;
+        stream_.expires_after(shared_->config.idle_timeout);
+        http::async_write_header(stream_, *serializer_,
+            [self = shared_from_this()](const beast::error_code& ec, size_t) {
+                self->writing_ = false;
+                if (ec) return self->close();
+                self->drain();
+            });
+
+        try {
+            response.streamer(std::make_shared<Stream>(shared_from_this(), generation));
+        } catch (...) {
+            enqueue_finish(generation);   // whatever was written stays; the body just ends
+        }
+    }
+
+    // Called with mutex_ held
+    void schedule_drain() {
+        if (drain_scheduled_) {
+            return;
+        }
+        drain_scheduled_ = true;
+        net::post(*io_, [self = shared_from_this()] { self->drain(); });
+    }
+
+    // I/O thread: writes everything queued so far as one chunk, and the
+    // terminating chunk once the producer has finished
+    void drain() {
+        if (writing_ || last_chunk_sent_ || !serializer_) {
+            return;   // the write in flight drains again when it completes
+        }
+        bool finishing = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            drain_scheduled_ = false;
+            if (closed_) return;
+            batch_.swap(pending_);
+            finishing = finish_requested_;
+        }
+
+        chunk_.clear();
+        for (auto& piece : batch_) {
+            chunk_ += piece;
+        }
+        batch_.clear();
+        if (chunk_.empty() && !finishing) {
+            return;
+        }
+        shared_->bytes_sent += chunk_.size();
+
+        writing_ = true;
+        last_chunk_sent_ = finishing;
+        stream_.expires_after(shared_->config.idle_timeout);
+        auto on_written = [self = shared_from_this(), finishing](const beast::error_code& ec, size_t) {
+            self->on_chunk_written(ec, finishing);
+        };
+        if (chunk_.empty()) {
+            net::async_write(stream_, http::make_chunk_last(), std::move(on_written));
+        } else if (finishing) {
+            net::async_write(stream_,
+                             beast::buffers_cat(http::make_chunk(net::buffer(chunk_)), http::make_chunk_last()),
+                             std::move(on_written));
+        } else {
+            net::async_write(stream_, http::make_chunk(net::buffer(chunk_)), std::move(on_written));
+        }
+    }
+
+    void on_chunk_written(const beast::error_code& ec, bool finished) {
+        writing_ = false;
+        if (ec) {
+            return close();
+        }
+        if (!finished) {
+            return drain();
+        }
+        serializer_.reset();
+        stream_header_.reset();
+        if (!keep_alive_) {
+            beast::error_code ignored;
+            stream_.socket().shutdown(tcp::socket::shutdown_send, ignored);
+            return;
+        }
+        read_request();
+    }
+
+    // Declared first so the context outlives the socket
+    std::shared_ptr<net::io_context> io_;
+    std::shared_ptr<ServerShared> shared_;
+    beast::tcp_stream stream_;
+    beast::flat_buffer buffer_;
+    std::optional<http::request_parser<http::string_body>> parser_;
+    http::response<http::string_body> response_;
+    unsigned version_ = 11;
+    bool head_ = false;
+    bool keep_alive_ = true;
+
+    // Streaming, I/O thread side
+    std::optional<http::response<http::empty_body>> stream_header_;
+    std::optional<http::response_serializer<http::empty_body>> serializer_;
+    std::vector<std::string> batch_;
+    std::string chunk_;
+    bool writing_ = false;
+    bool last_chunk_sent_ = false;
+
+    // Streaming, shared with producers
+    std::mutex mutex_;
+    std::vector<std::string> pending_;
+    bool finish_requested_ = false;
+    uint64_t stream_generation_ = 0;   // of the current streamed response
+    bool drain_scheduled_ = false;
+    bool closed_ = false;
+};
+
+} // namespace
+
+// ============================================================================
+// HttpServer::Impl
+// ============================================================================
+
+class HttpServer::Impl {
+public:
+    Impl(std::shared_ptr<RequestHandler> handler, HttpServerConfig config)
+        : shared_(std::make_shared<ServerShared>()) {
+        if (!handler) {
+            throw std::invalid_argument("HttpServer needs a request handler");
+        }
+        if (config.max_header_bytes == 0 || config.max_body_bytes == 0 ||
+            config.idle_timeout <= std::chrono::steady_clock::duration::zero()) {
+            throw std::invalid_argument("HttpServer limits and idle timeout must be positive");
+        }
+        if (config.threads == 0) {
+            config.threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        shared_->config = std::move(config);
+        shared_->handler = std::move(handler);
+    }
+
+    ~Impl() { stop(); }
+
+    std::pair<bool, std::string> start() {
+        std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+        if (started_) {
+            return {false, "HttpServer was already started"};
+        }
+        started_ = true;
+        shared_->handler->compile();
+
+        const auto& config = shared_->config;
+        beast::error_code ec;
+        auto address = net::ip::make_address(config.address, ec);
+        if (ec) {
+            return {false, "Invalid listen address " + config.address + ": " + ec.message()};
+        }
+
+        for (size_t i = 0; i < config.threads; ++i) {
+            workers_.push_back(std::make_unique<Worker>());
+        }
+
+        // With SO_REUSEPORT every worker listens; otherwise the first accepts for all
+        tcp::endpoint endpoint(address, config.port);
+        size_t listeners = kHasReusePort ? workers_.size() : 1;
+        if (kHasReusePort) {
+            // SO_REUSEPORT would let a second instance under the same uid
+            // share the port and take half the connections. Bind it once
+            // without the option first so a port conflict fails start().
+            endpoint.port(probe_port(endpoint, ec));
+            if (ec) {
+                workers_.clear();
+                return {false, "Cannot listen on " + config.address + ":" +
+                                   std::to_string(config.port) + ": " + ec.message()};
+            }
+        }
+        for (size_t i = 0; i < listeners; ++i) {
+            auto& acceptor = workers_[i]->acceptor.emplace(*workers_[i]->io);
+            acceptor.open(endpoint.protocol(), ec);
+            if (!ec) acceptor.set_option(net::socket_base::reuse_address(true), ec);
+#ifdef SO_REUSEPORT
+            if (!ec) acceptor.set_option(reuse_port(true), ec);
+#endif
+            if (!ec) acceptor.bind(endpoint, ec);
+            if (!ec) acceptor.listen(net::socket_base::max_listen_connections, ec);
+            if (ec) {
+                workers_.clear();
+                return {false, "Cannot listen on " + config.address + ":" +
+                                   std::to_string(endpoint.port()) + ": " + ec.message()};
+            }
+            endpoint.port(acceptor.local_endpoint().port());   // later listeners share a port picked for 0
+        }
+        port_ = endpoint.port();
+
+        for (size_t i = 0; i < listeners; ++i) {
+            accept_next(i);
+        }
+        for (auto& worker : workers_) {
+            worker->thread = std::thread([io = worker->io] { io->run(); });
+        }
+        running_ = true;
+        return {true, ""};
+    }
+
+    // Binds a plain socket to the endpoint and releases it, returning the
+    // port it got (the chosen one for port 0)
+    unsigned short probe_port(const tcp::endpoint& endpoint, beast::error_code& ec) {
+        tcp::acceptor probe(*workers_.front()->io);
+        probe.open(endpoint.protocol(), ec);
+        if (!ec) probe.set_option(net::socket_base::reuse_address(true), ec);
+        if (!ec) probe.bind(endpoint, ec);
+        if (ec) {
+            return endpoint.port();
+        }
+        unsigned short port = probe.local_endpoint(ec).port();
+        beast::error_code ignored;
+        probe.close(ignored);
+        return port;
+    }
+
+    void stop() {
+        std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+        shared_->stopping = true;
+        for (auto& worker : workers_) {
+            net::post(*worker->io, [w = worker.get()] {
+                beast::error_code ec;
+                if (w->acceptor) w->acceptor->close(ec);
+                for (auto& weak : w->sessions) {
+                    if (auto session = weak.lock()) session->close();
+                }
+                w->sessions.clear();
+            });
+            worker->guard.reset();
+        }
+        for (auto& worker : workers_) {
+            worker->thread.join();
+        }
+    }
+
+    bool is_running() const {
+        std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+        return running_;
+    }
+
+    unsigned short port() const {
+        std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+        return port_;
+    }
+
+    size_t thread_count() const { return shared_->config.threads; }
+
+    Stats stats() const {
+        Stats stats;
+        stats.connections_accepted = shared_->connections_accepted.load();
+        stats.requests_handled = shared_->requests_handled.load();
+        stats.responses_streamed = shared_->responses_streamed.load();
+        stats.bytes_received = shared_->bytes_received.load();
+        stats.bytes_sent = shared_->bytes_sent.load();
+        stats.active_connections = shared_->active_connections.load();
+        return stats;
+    }
+
+private:
+    struct Worker {
+        // Shared with its connections, which may outlive the server
+        std::shared_ptr<net::io_context> io = std::make_shared<net::io_context>(1);
+        std::optional<net::executor_work_guard<net::io_context::executor_type>> guard{io->get_executor()};
+        std::optional<tcp::acceptor> acceptor;
+        std::thread thread;
+        std::vector<std::weak_ptr<Session>> sessions;   // its own thread only
+        size_t prune_at = 64;
+    };
+
+    void accept_next(size_t index) {
+        Worker& listener = *workers_[index];
+        Worker& target = kHasReusePort ? listener : *workers_[next_worker_++ % workers_.size()];
+        listener.acceptor->async_accept(*target.io,
+            [this, index, &target](const beast::error_code& ec, tcp::socket socket) {
+                if (ec == net::error::operation_aborted || !workers_[index]->acceptor->is_open()) {
+                    return;
+                }
+                if (!ec) {
+                    ++shared_->connections_accepted;
+                    net::dispatch(*target.io, [this, &target, socket = std::move(socket)]() mutable {
+                        start_session(target, std::move(socket));
+                    });
+                }
+                accept_next(index);   // also after transient errors such as EMFILE
+            });
+    }
+
+    // On the target worker's thread
+    void start_session(Worker& worker, tcp::socket socket) {
+        if (shared_->stopping) {
+            return;
+        }
+        beast::error_code ignored;
+        socket.set_option(tcp::no_delay(true), ignored);
+        auto session = std::make_shared<Session>(shared_, worker.io, std::move(socket));
+        if (worker.sessions.size() >= worker.prune_at) {
+            worker.sessions.erase(std::remove_if(worker.sessions.begin(), worker.sessions.end(),
+                                                 [](const auto& weak) { return weak.expired(); }),
+                                  worker.sessions.end());
+            worker.prune_at = std::max<size_t>(64, worker.sessions.size() * 2);
+        }
+        worker.sessions.push_back(session);
+        session->start();
+    }
+
+    std::shared_ptr<ServerShared> shared_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<size_t> next_worker_{0};
+    unsigned short port_ = 0;
+    bool started_ = false;
+    bool running_ = false;
+    mutable std::mutex lifecycle_mutex_;
+};
+
+// ============================================================================
+// HttpServer
+// ============================================================================
+
+HttpServer::HttpServer(std::shared_ptr<RequestHandler> handler, HttpServerConfig config)
+    : impl_(std::make_unique<Impl>(std::move(handler), std::move(config))) {}
+
+HttpServer::~HttpServer() = default;
+
+std::pair<bool, std::string> HttpServer::start() {
+    return impl_->start();
+}
+
+void HttpServer::stop() {
+    impl_->stop();
+}
+
+bool HttpServer::is_running() const {
+    return impl_->is_running();
+}
+
+unsigned short HttpServer::port() const {
+    return impl_->port();
+}
+
+size_t HttpServer::thread_count() const {
+    return impl_->thread_count();
+}
+
+HttpServer::Stats HttpServer::stats() const {
+    return impl_->stats();
+}
+
+} // namespace cortan::network
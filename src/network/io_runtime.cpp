@@ -0,0 +1,53 @@
+#include <cortan/network/io_runtime.hpp>
+#include <algorithm>
+
+namespace cortan::network {
+
+IoRuntime::IoRuntime(size_t num_threads)
+    : io_context_(static_cast<int>(std::max<size_t>(1, num_threads)))
+    , work_guard_(boost::asio::make_work_guard(io_context_)) {
+    num_threads = std::max<size_t>(1, num_threads);
+    threads_.reserve(num_threads);
+    for (size_t i = 0; i < num_threads; ++i) {
+        threads_.emplace_back([this] { io_context_.run(); });
+    }
+}
+
+IoRuntime::~IoRuntime() {
+    work_guard_.reset();
+    io_context_.stop();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+IoRuntime& IoRuntime::shared() {
+    static auto* instance = new IoRuntime(
+        std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 4));
+    return *instance;
+}
+
+IoBackend IoRuntime::backend() {
+#if defined(BOOST_ASIO_HAS_IO_URING) && defined(BOOST_ASIO_DISABLE_EPOLL)
+    return IoBackend::IoUring;
+#elif defined(BOOST_ASIO_HAS_EPOLL)
+    return IoBackend::Epoll;
+#else
+    return IoBackend::Other;
+#endif
+}
+
+const char* IoRuntime::backend_name() {
+    switch (backend()) {
+        case IoBackend::IoUring: return "io_uring";
+        case IoBackend::Epoll: return "epoll";
+        case IoBackend::Other: break;
+    }
+    return "other";
+}
+
+bool IoRuntime::running_in_this_thread() const {
+    return work_guard_.get_executor().running_in_this_thread();
+}
+
+} // namespace cortan::network
@@ -1,19 +1,320 @@
 #include <cortan/network/request_handler.hpp>
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
 
 namespace cortan::network {
 
-RequestHandler::RequestHandler() {
-    // TODO: Initialize request handler
+namespace {
+
+bool iequals(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+        return (x | 0x20) == (y | 0x20);
+    });
+}
+
+void plain_error(HttpResponse& response, int status, std::string message) {
+    response.status = status;
+    response.content_type = "text/plain";
+    response.body = std::move(message);
+    response.streamer = nullptr;
+}
+
+} // namespace
+
+// ============================================================================
+// HttpRequest
+// ============================================================================
+
+std::string_view HttpRequest::path() const {
+    std::string_view view(target);
+    return view.substr(0, view.find('?'));
+}
+
+std::string_view HttpRequest::query() const {
+    auto mark = target.find('?');
+    return mark == std::string::npos ? std::string_view() : std::string_view(target).substr(mark + 1);
 }
 
+std::string_view HttpRequest::header(std::string_view name) const {
+    for (const auto& [key, value] : headers) {
+        if (iequals(key, name)) return value;
+    }
+    return {};
+}
+
+// ============================================================================
+// Route Tree
+// ============================================================================
+
+// Radix tree over route patterns, kept in one vector and linked by index.
+// Static nodes hold a run of literal characters shared by every route below
+// them; their static children are found by first character through a
+// parallel string, so a lookup is a memchr and a prefix compare per level.
+// Parameter and catch-all nodes hang off the node before them. Matching
+// backtracks, so "/models/:name/info" still matches when a static sibling
+// such as "/models/list" shares a prefix with the request.
+class RequestHandler::Tree {
+public:
+    enum class Kind : uint8_t { Static, Param, CatchAll };
+
+    struct Node {
+        Kind kind = Kind::Static;
+        std::string text;              // literal prefix, or the parameter name
+        std::string child_chars;       // first character of each static child
+        std::vector<uint32_t> children;
+        int32_t param_child = -1;
+        int32_t catch_all_child = -1;
+        // Route indices by method; an empty method matches any
+        std::vector<std::pair<std::string, uint32_t>> methods;
+    };
+
+    Tree() { nodes_.emplace_back(); }
+
+    void insert(const std::string& method, const std::string& pattern, uint32_t route) {
+        if (pattern.empty() || pattern[0] != '/') {
+            throw std::invalid_argument("Route pattern must start with '/': " + pattern);
+        }
+
+        uint32_t node = 0;
+        size_t pos = 0;
+        while (pos < pattern.size()) {
+            char c = pattern[pos];
+            bool segment_start = pos > 0 && pattern[pos - 1] == '/';
+            if (segment_start && (c == ':' || c == '*')) {
+                size_t end = std::min(pattern.find('/', pos), pattern.size());
+                std::string name = pattern.substr(pos + 1, end - pos - 1);
+                if (name.empty()) {
+                    throw std::invalid_argument("Unnamed parameter in route pattern: " + pattern);
+                }
+                if (c == '*' && end != pattern.size()) {
+                    throw std::invalid_argument("Catch-all must end the route pattern: " + pattern);
+                }
+                node = dynamic_child(node, c == ':' ? Kind::Param : Kind::CatchAll, name, pattern);
+                pos = end;
+                continue;
+            }
+
+            // Literal run up to the next parameter
+            size_t end = pos;
+            while (end < pattern.size() &&
+                   !((pattern[end] == ':' || pattern[end] == '*') && pattern[end - 1] == '/')) {
+                ++end;
+            }
+            node = static_path(node, std::string_view(pattern).substr(pos, end - pos));
+            pos = end;
+        }
+
+        auto& methods = nodes_[node].methods;
+        for (const auto& [existing, index] : methods) {
+            if (existing == method) {
+                throw std::invalid_argument("Route already registered: " +
+                                            (method.empty() ? std::string("*") : method) + " " + pattern);
+            }
+        }
+        methods.emplace_back(method, route);
+    }
+
+    // Node whose routes cover the path, with the captured parameters
+    const Node* find(std::string_view path, RouteParams::Values& params) const {
+        return match_children(0, path, params);
+    }
+
+private:
+    // Walks or extends the static path from `node` so that it spells `text`,
+    // splitting nodes whose prefix only partly matches
+    uint32_t static_path(uint32_t node, std::string_view text) {
+        while (!text.empty()) {
+            auto slot = nodes_[node].child_chars.find(text[0]);
+            if (slot == std::string::npos) {
+                uint32_t child = add_node(Kind::Static, std::string(text));
+                nodes_[node].child_chars.push_back(text[0]);
+                nodes_[node].children.push_back(child);
+                return child;
+            }
+
+            uint32_t child = nodes_[node].children[slot];
+            const std::string& prefix = nodes_[child].text;
+            size_t common = 0;
+            while (common < prefix.size() && common < text.size() && prefix[common] == text[common]) {
+                ++common;
+            }
+            if (common < prefix.size()) {
+                split(child, common);
+            }
+            text.remove_prefix(common);
+            node = child;
+        }
+        return node;
+    }
+
+    // Moves everything past `at` in the node's prefix into a new child
+    void split(uint32_t node, size_t at) {
+        uint32_t tail = add_node(Kind::Static, nodes_[node].text.substr(at));
+        Node& head = nodes_[node];
+        Node& moved = nodes_[tail];
+        moved.child_chars = std::move(head.child_chars);
+        moved.children = std::move(head.children);
+        moved.param_child = head.param_child;
+        moved.catch_all_child = head.catch_all_child;
+        moved.methods = std::move(head.methods);
+
+        head.text.resize(at);
+        head.child_chars.assign(1, moved.text[0]);
+        head.children.assign(1, tail);
+        head.param_child = -1;
+        head.catch_all_child = -1;
+        head.methods.clear();
+    }
+
+    uint32_t dynamic_child(uint32_t node, Kind kind, const std::string& name, const std::string& pattern) {
+        int32_t existing = kind == Kind::Param ? nodes_[node].param_child : nodes_[node].catch_all_child;
+        if (existing >= 0) {
+            if (nodes_[static_cast<size_t>(existing)].text != name) {
+                throw std::invalid_argument("Route pattern conflicts with an existing parameter name: " + pattern);
+            }
+            return static_cast<uint32_t>(existing);
+        }
+        uint32_t child = add_node(kind, name);
+        (kind == Kind::Param ? nodes_[node].param_child : nodes_[node].catch_all_child) =
+            static_cast<int32_t>(child);
+        return child;
+    }
+
+    uint32_t add_node(Kind kind, std::string text) {
+        nodes_.emplace_back();
+        nodes_.back().kind = kind;
+        nodes_.back().text = std::move(text);
+        return static_cast<uint32_t>(nodes_.size() - 1);
+    }
+
+    // `rest` is what remains after the node itself matched
+    const Node* match_children(uint32_t index, std::string_view rest, RouteParams::Values& params) const {
+        const Node& node = nodes_[index];
+        if (rest.empty() && !node.methods.empty()) {
+            return &node;
+        }
+
+        if (!rest.empty() && !node.child_chars.empty()) {
+            const void* hit = std::memchr(node.child_chars.data(), rest[0], node.child_chars.size());
+            if (hit) {
+                auto slot = static_cast<size_t>(static_cast<const char*>(hit) - node.child_chars.data());
+                uint32_t child = node.children[slot];
+                const std::string& prefix = nodes_[child].text;
+                if (rest.size() >= prefix.size() && rest.compare(0, prefix.size(), prefix) == 0) {
+                    if (auto found = match_children(child, rest.substr(prefix.size()), params)) {
+                        return found;
+                    }
+                }
+            }
+        }
+
+        if (node.param_child >= 0 && !rest.empty() && rest[0] != '/') {
+            auto child = static_cast<uint32_t>(node.param_child);
+            size_t end = std::min(rest.find('/'), rest.size());
+            params.emplace_back(nodes_[child].text, rest.substr(0, end));
+            if (auto found = match_children(child, rest.substr(end), params)) {
+                return found;
+            }
+            params.pop_back();
+        }
+
+        if (node.catch_all_child >= 0) {
+            const Node& child = nodes_[static_cast<size_t>(node.catch_all_child)];
+            params.emplace_back(child.text, rest);
+            return &child;
+        }
+        return nullptr;
+    }
+
+    std::vector<Node> nodes_;
+};
+
+// ============================================================================
+// RequestHandler
+// ============================================================================
+
+RequestHandler::RequestHandler() = default;
+
 RequestHandler::~RequestHandler() = default;
 
+void RequestHandler::register_route(const std::string& path, RouteHandler handler) {
+    register_route("", path, std::move(handler));
+}
+
+void RequestHandler::register_route(const std::string& method, const std::string& path, RouteHandler handler) {
+    if (!handler) {
+        throw std::invalid_argument("Route handler is empty: " + path);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (compiled_.load(std::memory_order_relaxed)) {
+        throw std::logic_error("Routes are compiled; register them before the first request: " + path);
+    }
+    if (!tree_) {
+        tree_ = std::make_unique<Tree>();
+    }
+    // Inserting now reports bad patterns at the call that made them
+    tree_->insert(method, path, static_cast<uint32_t>(routes_.size()));
+    routes_.push_back({method, path, std::move(handler)});
+}
+
+void RequestHandler::compile() {
+    if (compiled_.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!tree_) {
+        tree_ = std::make_unique<Tree>();
+    }
+    compiled_.store(true, std::memory_order_release);
+}
+
 void RequestHandler::handle_request(const HttpRequest& request, HttpResponse& response) {
-    // TODO: Implement request handling
+    compile();
+
+    RouteParams params;
+    const Tree::Node* node = tree_->find(request.path(), params.values_);
+    if (!node) {
+        return plain_error(response, 404, "Not Found");
+    }
+
+    const Route* route = nullptr;
+    const Route* any = nullptr;
+    const Route* get = nullptr;
+    for (const auto& [method, index] : node->methods) {
+        const Route& candidate = routes_[index];
+        if (method == request.method) route = &candidate;
+        if (method.empty()) any = &candidate;
+        if (method == "GET") get = &candidate;
+    }
+    if (!route) route = request.method == "HEAD" && get ? get : any;
+
+    if (!route) {
+        std::string allow;
+        for (const auto& [method, index] : node->methods) {
+            allow += (allow.empty() ? "" : ", ") + method;
+            if (method == "GET") allow += ", HEAD";
+        }
+        plain_error(response, 405, "Method Not Allowed");
+        response.headers.emplace_back("Allow", std::move(allow));
+        return;
+    }
+
+    try {
+        route->handler(request, params, response);
+    } catch (const std::exception& e) {
+        // The message may carry internals; it goes to the log, not the client
+        std::cerr << "Request handler error (" << request.method << " " << request.target << "): " << e.what()
+                  << std::endl;
+        plain_error(response, 500, "Internal Server Error");
+    }
 }
 
-void RequestHandler::register_route(const std::string& path, RouteHandler handler) {
-    // TODO: Implement route registration
+size_t RequestHandler::route_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return routes_.size();
 }
 
 } // namespace cortan::network
@@ -0,0 +1,468 @@
+#include <cortan/network/resilient_client.hpp>
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/beast/http/verb.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace cortan::network {
+
+namespace net = boost::asio;
+namespace http = boost::beast::http;
+
+using Clock = std::chrono::steady_clock;
+using HttpResult = std::pair<bool, std::string>;
+
+// ============================================================================
+// Circuit Breaker
+// ============================================================================
+
+CircuitBreaker::CircuitBreaker(CircuitBreakerConfig config) : config_(config) {
+    if (config_.failure_threshold == 0) {
+        throw std::invalid_argument("CircuitBreaker: failure_threshold must be non-zero");
+    }
+}
+
+bool CircuitBreaker::allow() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    switch (state_) {
+    case State::Closed:
+        return true;
+    case State::Open:
+        if (Clock::now() - opened_at_ < config_.open_duration) return false;
+        state_ = State::HalfOpen;
+        probe_in_flight_ = true;
+        return true;
+    case State::HalfOpen:
+        if (probe_in_flight_) return false;
+        probe_in_flight_ = true;
+        return true;
+    }
+    return false;
+}
+
+void CircuitBreaker::record_success() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    state_ = State::Closed;
+    consecutive_failures_ = 0;
+    probe_in_flight_ = false;
+}
+
+void CircuitBreaker::record_failure() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    probe_in_flight_ = false;
+    if (state_ == State::HalfOpen || ++consecutive_failures_ >= config_.failure_threshold) {
+        state_ = State::Open;
+        opened_at_ = Clock::now();
+    }
+}
+
+CircuitBreaker::State CircuitBreaker::state() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_;
+}
+
+// ============================================================================
+// Endpoint state
+// ============================================================================
+
+namespace {
+
+constexpr size_t kLatencySamples = 256;
+constexpr size_t kPercentileEvery = 16;   // samples between recomputations
+
+// scheme://host:port, the unit breakers and budgets are kept for
+std::string endpoint_of(std::string_view url) {
+    auto authority = url.find("://");
+    if (authority == std::string_view::npos) return std::string(url);
+    auto path = url.find_first_of("/?#", authority + 3);
+    return std::string(url.substr(0, path));
+}
+
+// Timeouts, connection and transport errors, 5xx and 429 say the endpoint
+// is unwell and a retry may help. Other statuses, bodies that fail to decode
+// and handlers that throw are the caller's problem.
+bool is_endpoint_failure(const HttpOutcome& outcome) {
+    switch (outcome.error) {
+    case HttpError::Connect:
+    case HttpError::Transport:
+    case HttpError::Timeout:
+        return true;
+    case HttpError::Status:
+        return outcome.status >= 500 || outcome.status == 429;
+    default:
+        return false;
+    }
+}
+
+// As HttpClient reads method names: empty is GET
+http::verb verb_of(std::string_view method) {
+    return method.empty() ? http::verb::get
+                          : http::string_to_verb(boost::beast::string_view(method.data(), method.size()));
+}
+
+bool is_idempotent(http::verb verb) {
+    return verb == http::verb::get || verb == http::verb::head || verb == http::verb::options ||
+           verb == http::verb::put || verb == http::verb::delete_;
+}
+
+Clock::duration jittered_backoff(const RetryConfig& config, size_t retry) {
+    auto ceiling = config.base_backoff * (int64_t{1} << std::min<size_t>(retry, 20));
+    ceiling = std::min(ceiling, config.max_backoff);
+    thread_local std::mt19937_64 random{std::random_device{}()};
+    std::uniform_int_distribution<Clock::rep> pick(0, std::max<Clock::rep>(0, ceiling.count()));
+    return Clock::duration(pick(random));
+}
+
+ResilienceConfig validated(ResilienceConfig config) {
+    if (config.retry.max_attempts == 0) {
+        throw std::invalid_argument("ResilientClient: max_attempts must be non-zero");
+    }
+    if (config.breaker.failure_threshold == 0) {
+        throw std::invalid_argument("ResilientClient: failure_threshold must be non-zero");
+    }
+    if (!(config.hedge.percentile > 0.0 && config.hedge.percentile < 1.0)) {
+        throw std::invalid_argument("ResilientClient: hedge percentile must be in (0, 1)");
+    }
+    if (config.retry.budget_ratio < 0.0 || config.retry.budget_cap < 0.0) {
+        throw std::invalid_argument("ResilientClient: retry budget must not be negative");
+    }
+    return config;
+}
+
+struct Endpoint {
+    Endpoint(std::string name, const ResilienceConfig& config)
+        : name(std::move(name)), breaker(config.breaker), budget(config.retry.budget_cap) {}
+
+    const std::string name;
+    CircuitBreaker breaker;
+
+    std::mutex mutex;
+    double budget;
+    std::array<Clock::rep, kLatencySamples> latencies{};
+    size_t samples = 0;
+    Clock::duration hedge_delay{};
+    ResilientClient::EndpointStats stats;
+
+    void deposit(const RetryConfig& config) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.requests;
+        budget = std::min(config.budget_cap, budget + config.budget_ratio);
+    }
+
+    bool try_spend() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (budget < 1.0) {
+            ++stats.budget_exhausted;
+            return false;
+        }
+        budget -= 1.0;
+        return true;
+    }
+
+    void record_latency(Clock::duration latency, const HedgeConfig& config) {
+        std::lock_guard<std::mutex> lock(mutex);
+        latencies[samples++ % kLatencySamples] = latency.count();
+        if (samples < config.min_samples || (samples != config.min_samples && samples % kPercentileEvery != 0)) return;
+
+        size_t count = std::min(samples, kLatencySamples);
+        std::vector<Clock::rep> window(latencies.begin(), latencies.begin() + static_cast<std::ptrdiff_t>(count));
+        auto rank = static_cast<size_t>(config.percentile * static_cast<double>(count - 1));
+        std::nth_element(window.begin(), window.begin() + static_cast<std::ptrdiff_t>(rank), window.end());
+        hedge_delay = std::max<Clock::duration>(config.min_delay, Clock::duration(window[rank]));
+    }
+
+    Clock::duration current_hedge_delay() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return hedge_delay;
+    }
+
+    template<typename Fn>
+    void count(Fn&& fn) {
+        std::lock_guard<std::mutex> lock(mutex);
+        fn(stats);
+    }
+};
+
+} // namespace
+
+// ============================================================================
+// Impl
+// ============================================================================
+
+class ResilientClient::Impl : public std::enable_shared_from_this<Impl> {
+public:
+    Impl(std::shared_ptr<HttpClient> client, ResilienceConfig config)
+        : client_(client ? std::move(client) : std::make_shared<HttpClient>())
+        , config_(validated(config)) {}
+
+    void request(std::string_view method, const std::string& url, std::string body, const RequestOptions& options,
+                 bool idempotent, HttpClient::OutcomeHandler on_outcome, HttpClient::ChunkHandler on_chunk = {});
+
+    EndpointStats stats(const std::string& url) {
+        auto ep = endpoint(url);
+        EndpointStats stats;
+        {
+            std::lock_guard<std::mutex> lock(ep->mutex);
+            stats = ep->stats;
+            stats.hedge_delay = ep->hedge_delay;
+        }
+        stats.state = ep->breaker.state();
+        return stats;
+    }
+
+    std::shared_ptr<HttpClient> client() const { return client_; }
+
+private:
+    class Call;
+
+    std::shared_ptr<Endpoint> endpoint(const std::string& url) {
+        auto name = endpoint_of(url);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& ep = endpoints_[name];
+        if (!ep) ep = std::make_shared<Endpoint>(name, config_);
+        return ep;
+    }
+
+    std::shared_ptr<HttpClient> client_;
+    const ResilienceConfig config_;
+    std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<Endpoint>> endpoints_;
+};
+
+// One logical request: its attempts, the backoff between them and the hedge
+// timer all run on the call's strand
+class ResilientClient::Impl::Call : public std::enable_shared_from_this<Call> {
+public:
+    Call(std::shared_ptr<Impl> owner, std::shared_ptr<Endpoint> endpoint, std::string method, std::string url,
+         std::string body, RequestOptions options, bool idempotent, HttpClient::OutcomeHandler on_outcome,
+         HttpClient::ChunkHandler on_chunk)
+        : owner_(std::move(owner))
+        , endpoint_(std::move(endpoint))
+        , strand_(net::make_strand(owner_->client_->connection_pool()->runtime().context()))
+        , backoff_timer_(strand_)
+        , hedge_timer_(strand_)
+        , method_(std::move(method))
+        , url_(std::move(url))
+        , body_(std::move(body))
+        , options_(options)
+        , retryable_(idempotent || is_idempotent(verb_of(method_)))
+        , on_outcome_(std::move(on_outcome))
+        , on_chunk_(std::move(on_chunk)) {}
+
+    void start() {
+        endpoint_->deposit(config().retry);
+        net::post(strand_, [self = shared_from_this()] {
+            if (!self->endpoint_->breaker.allow()) return self->short_circuit();
+            self->launch(false);
+        });
+    }
+
+private:
+    const ResilienceConfig& config() const { return owner_->config_; }
+
+    void launch(bool hedge) {
+        ++attempts_;
+        ++in_flight_;
+        endpoint_->count([&](EndpointStats& stats) {
+            ++stats.attempts;
+            if (hedge) ++stats.hedges;
+        });
+
+        HttpClient::ChunkHandler on_chunk;
+        if (on_chunk_) {
+            on_chunk = [self = shared_from_this()](std::string_view chunk) {
+                self->delivered_ = true;
+                return self->on_chunk_(chunk);
+            };
+        }
+
+        auto started = Clock::now();
+        running_[hedge ? 1 : 0] = owner_->client_->async_fetch(
+            method_, url_, body_, options_, [self = shared_from_this(), started, hedge](HttpOutcome outcome) mutable {
+                auto& strand = self->strand_;
+                net::post(strand, [self = std::move(self), outcome = std::move(outcome), started, hedge]() mutable {
+                    self->on_attempt(std::move(outcome), Clock::now() - started, hedge);
+                });
+            },
+            std::move(on_chunk));
+
+        // Two streams would hand the consumer the reply twice
+        if (!hedge && !hedged_ && retryable_ && !on_chunk_ && config().hedge.enabled) arm_hedge();
+    }
+
+    void arm_hedge() {
+        auto delay = endpoint_->current_hedge_delay();
+        if (delay == Clock::duration::zero()) return;   // not enough samples yet
+        hedge_timer_.expires_after(delay);
+        hedge_timer_.async_wait([self = shared_from_this()](const boost::system::error_code& ec) {
+            if (ec || self->done_ || self->hedged_ || self->in_flight_ == 0) return;
+            if (!self->endpoint_->try_spend() || !self->endpoint_->breaker.allow()) return;
+            self->hedged_ = true;
+            self->launch(true);
+        });
+    }
+
+    void on_attempt(HttpOutcome outcome, Clock::duration latency, bool hedge) {
+        --in_flight_;
+        if (outcome.error == HttpError::Cancelled) return;   // lost the race; says nothing of the endpoint
+        bool endpoint_failure = is_endpoint_failure(outcome);
+        if (endpoint_failure) {
+            endpoint_->breaker.record_failure();
+        } else {
+            endpoint_->breaker.record_success();
+        }
+        bool ok = outcome.result.first;
+        if (ok && !on_chunk_) endpoint_->record_latency(latency, config().hedge);   // streams run as long as they run
+
+        if (done_) return;   // the other attempt already answered
+        if (ok) {
+            if (hedge) endpoint_->count([](EndpointStats& stats) { ++stats.hedge_wins; });
+            return finish(std::move(outcome));
+        }
+        if (in_flight_ > 0) return;   // the other attempt may still succeed
+
+        if (!endpoint_failure || !retryable_ || delivered_ || attempts_ >= config().retry.max_attempts ||
+            !endpoint_->try_spend()) {
+            return finish(std::move(outcome));
+        }
+
+        last_error_ = std::move(outcome.result.second);
+        endpoint_->count([](EndpointStats& stats) { ++stats.retries; });
+        hedge_timer_.cancel();
+        backoff_timer_.expires_after(jittered_backoff(config().retry, attempts_ - 1));
+        backoff_timer_.async_wait([self = shared_from_this()](const boost::system::error_code& ec) {
+            if (ec || self->done_) return;
+            if (!self->endpoint_->breaker.allow()) return self->short_circuit();
+            self->launch(false);
+        });
+    }
+
+    void short_circuit() {
+        endpoint_->count([](EndpointStats& stats) { ++stats.short_circuited; });
+        std::string error = "Circuit open for " + endpoint_->name;
+        if (!last_error_.empty()) error += " (last error: " + last_error_ + ")";
+        HttpOutcome outcome;
+        outcome.result = {false, std::move(error)};
+        outcome.error = HttpError::Rejected;
+        finish(std::move(outcome));
+    }
+
+    void finish(HttpOutcome outcome) {
+        done_ = true;
+        backoff_timer_.cancel();
+        hedge_timer_.cancel();
+        // Frees the connection of an attempt still racing the one that answered
+        for (const auto& attempt : running_) attempt.cancel();
+        std::exchange(on_outcome_, nullptr)(std::move(outcome));
+    }
+
+    std::shared_ptr<Impl> owner_;
+    std::shared_ptr<Endpoint> endpoint_;
+    net::strand<net::io_context::executor_type> strand_;
+    net::steady_timer backoff_timer_;
+    net::steady_timer hedge_timer_;
+
+    const std::string method_;
+    const std::string url_;
+    const std::string body_;   // copied into each attempt
+    const RequestOptions options_;
+    const bool retryable_;
+    HttpClient::OutcomeHandler on_outcome_;
+    HttpClient::ChunkHandler on_chunk_;
+    // Set from the attempt's strand; read here once the attempt has completed
+    std::atomic<bool> delivered_{false};
+    std::array<RequestHandle, 2> running_;   // latest first attempt and hedge
+
+    size_t attempts_ = 0;
+    size_t in_flight_ = 0;
+    bool hedged_ = false;
+    bool done_ = false;
+    std::string last_error_;
+};
+
+void ResilientClient::Impl::request(std::string_view method, const std::string& url, std::string body,
+                                    const RequestOptions& options, bool idempotent,
+                                    HttpClient::OutcomeHandler on_outcome, HttpClient::ChunkHandler on_chunk) {
+    // Refused before it reaches an endpoint, so it counts against no breaker
+    if (verb_of(method) == http::verb::unknown) {
+        HttpOutcome outcome;
+        outcome.result = {false, "Unsupported HTTP method: " + std::string(method)};
+        outcome.error = HttpError::Rejected;
+        net::post(client_->connection_pool()->runtime().context(),
+                  [on_outcome = std::move(on_outcome), outcome = std::move(outcome)]() mutable {
+                      on_outcome(std::move(outcome));
+                  });
+        return;
+    }
+    auto call = std::make_shared<Call>(shared_from_this(), endpoint(url), std::string(method), url, std::move(body),
+                                       options, idempotent, std::move(on_outcome), std::move(on_chunk));
+    call->start();
+}
+
+// ============================================================================
+// ResilientClient
+// ============================================================================
+
+ResilientClient::ResilientClient(std::shared_ptr<HttpClient> client, ResilienceConfig config)
+    : impl_(std::make_shared<Impl>(std::move(client), std::move(config))) {}
+
+ResilientClient::~ResilientClient() = default;
+
+std::future<std::pair<bool, std::string>> ResilientClient::get(const std::string& url,
+                                                               const RequestOptions& options) {
+    auto promise = std::make_shared<std::promise<HttpResult>>();
+    auto future = promise->get_future();
+    impl_->request("GET", url, "", options, true,
+                   [promise](HttpOutcome outcome) { promise->set_value(std::move(outcome.result)); });
+    return future;
+}
+
+std::future<std::pair<bool, std::string>> ResilientClient::post(const std::string& url,
+                                                                std::string body,
+                                                                const RequestOptions& options,
+                                                                bool idempotent) {
+    auto promise = std::make_shared<std::promise<HttpResult>>();
+    auto future = promise->get_future();
+    impl_->request("POST", url, std::move(body), options, idempotent,
+                   [promise](HttpOutcome outcome) { promise->set_value(std::move(outcome.result)); });
+    return future;
+}
+
+void ResilientClient::async_request(std::string_view method,
+                                    const std::string& url,
+                                    std::string body,
+                                    const RequestOptions& options,
+                                    bool idempotent,
+                                    HttpClient::ResultHandler on_result) {
+    impl_->request(method, url, std::move(body), options, idempotent,
+                   [on_result = std::move(on_result)](HttpOutcome outcome) { on_result(std::move(outcome.result)); });
+}
+
+void ResilientClient::async_fetch(std::string_view method,
+                                  const std::string& url,
+                                  std::string body,
+                                  const RequestOptions& options,
+                                  bool idempotent,
+                                  HttpClient::OutcomeHandler on_outcome,
+                                  HttpClient::ChunkHandler on_chunk) {
+    impl_->request(method, url, std::move(body), options, idempotent, std::move(on_outcome), std::move(on_chunk));
+}
+
+ResilientClient::EndpointStats ResilientClient::stats(const std::string& url) const {
+    return impl_->stats(url);
+}
+
+std::shared_ptr<HttpClient> ResilientClient::client() const {
+    return impl_->client();
+}
+
+} // namespace cortan::network
@@ -0,0 +1,173 @@
+#include <cortan/network/tls_session_cache.hpp>
+#include <boost/asio/buffer.hpp>
+#include <openssl/ssl.h>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+namespace cortan::network {
+
+namespace net = boost::asio;
+namespace ssl = boost::asio::ssl;
+
+namespace {
+
+struct SessionFree {
+    void operator()(SSL_SESSION* session) const { SSL_SESSION_free(session); }
+};
+using SessionPtr = std::unique_ptr<SSL_SESSION, SessionFree>;
+
+} // namespace
+
+class TlsSessionCache::Impl : public std::enable_shared_from_this<TlsSessionCache::Impl> {
+public:
+    // Attached to each SSL object; freed with it
+    struct OriginTag {
+        std::weak_ptr<Impl> cache;
+        std::string origin;
+    };
+
+    explicit Impl(TlsConfig config) : config(std::move(config)), context(ssl::context::tls_client) {
+        SSL_CTX* handle = context.native_handle();
+        SSL_CTX_set_min_proto_version(handle, TLS1_2_VERSION);
+
+        if (this->config.verify_peer) {
+            context.set_verify_mode(ssl::verify_peer);
+            context.set_default_verify_paths();
+            if (!this->config.extra_ca_pem.empty()) {
+                context.add_certificate_authority(net::buffer(this->config.extra_ca_pem));
+            }
+        } else {
+            context.set_verify_mode(ssl::verify_none);
+        }
+
+        if (this->config.session_resumption) {
+            // Sessions are kept here, keyed by origin, rather than in
+            // OpenSSL's internal cache, which clients cannot look up
+            SSL_CTX_set_session_cache_mode(handle, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+            SSL_CTX_sess_set_new_cb(handle, &Impl::on_new_session);
+        } else {
+            SSL_CTX_set_session_cache_mode(handle, SSL_SESS_CACHE_OFF);
+            SSL_CTX_set_options(handle, SSL_OP_NO_TICKET);
+        }
+    }
+
+    static int tag_index() {
+        static const int index = SSL_get_ex_new_index(
+            0, nullptr, nullptr, nullptr,
+            [](void*, void* tag, CRYPTO_EX_DATA*, int, long, void*) { delete static_cast<OriginTag*>(tag); });
+        return index;
+    }
+
+    // Stores a copy: pooled connections are dropped without a TLS
+    // close_notify, and freeing such a connection marks its current session
+    // (the last ticket received) as not resumable
+    static int on_new_session(SSL* ssl, SSL_SESSION* session) {
+        auto* tag = static_cast<OriginTag*>(SSL_get_ex_data(ssl, tag_index()));
+        if (!tag) {
+            return 0;
+        }
+        auto cache = tag->cache.lock();
+        if (cache) {
+            if (SessionPtr copy{SSL_SESSION_dup(session)}) {
+                cache->store(tag->origin, std::move(copy));
+            }
+        }
+        return 0;   // OpenSSL keeps its own reference
+    }
+
+    void store(const std::string& origin, SessionPtr session) {
+        std::lock_guard<std::mutex> lock(mutex);
+        sessions[origin] = {std::move(session), ++clock};
+        if (sessions.size() > config.max_sessions) {
+            auto oldest = std::min_element(sessions.begin(), sessions.end(), [](const auto& a, const auto& b) {
+                return a.second.stamp < b.second.stamp;
+            });
+            sessions.erase(oldest);
+        }
+    }
+
+    struct CachedSession {
+        SessionPtr session;
+        uint64_t stamp = 0;   // insertion order, for eviction
+    };
+
+    const TlsConfig config;
+    ssl::context context;
+
+    std::map<std::string, CachedSession> sessions;
+    uint64_t clock = 0;
+    Stats stats;
+    mutable std::mutex mutex;
+};
+
+TlsSessionCache::TlsSessionCache(TlsConfig config) {
+    if (config.max_sessions == 0) {
+        config.session_resumption = false;
+    }
+    impl_ = std::make_shared<Impl>(std::move(config));
+}
+
+TlsSessionCache::~TlsSessionCache() = default;
+
+std::shared_ptr<TlsSessionCache> TlsSessionCache::shared() {
+    static const auto instance = std::make_shared<TlsSessionCache>();
+    return instance;
+}
+
+ssl::context& TlsSessionCache::context() {
+    return impl_->context;
+}
+
+const TlsConfig& TlsSessionCache::config() const {
+    return impl_->config;
+}
+
+void TlsSessionCache::prepare(SSL* ssl, const std::string& origin) {
+    if (!impl_->config.session_resumption) {
+        return;
+    }
+    if (!SSL_get_ex_data(ssl, Impl::tag_index())) {
+        SSL_set_ex_data(ssl, Impl::tag_index(), new Impl::OriginTag{impl_, origin});
+    }
+
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto it = impl_->sessions.find(origin);
+    if (it == impl_->sessions.end()) {
+        return;
+    }
+    if (!SSL_SESSION_is_resumable(it->second.session.get())) {
+        impl_->sessions.erase(it);
+        return;
+    }
+    SSL_set_session(ssl, it->second.session.get());
+}
+
+void TlsSessionCache::record_handshake(SSL* ssl) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    if (SSL_session_reused(ssl)) {
+        ++impl_->stats.resumed_handshakes;
+    } else {
+        ++impl_->stats.full_handshakes;
+    }
+}
+
+void TlsSessionCache::invalidate(const std::string& origin) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->sessions.erase(origin);
+}
+
+void TlsSessionCache::clear() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->sessions.clear();
+}
+
+TlsSessionCache::Stats TlsSessionCache::stats() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    Stats stats = impl_->stats;
+    stats.sessions = impl_->sessions.size();
+    return stats;
+}
+
+} // namespace cortan::network
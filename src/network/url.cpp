@@ -0,0 +1,178 @@
+#include <cortan/network/url.hpp>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace cortan::network {
+
+namespace {
+
+UrlSpan span(size_t begin, size_t end) {
+    return {static_cast<uint32_t>(begin), static_cast<uint32_t>(end - begin)};
+}
+
+bool equals_ignoring_case(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+        return (x >= 'A' && x <= 'Z' ? x - 'A' + 'a' : x) == y;
+    });
+}
+
+bool valid_port(std::string_view port) {
+    if (port.size() > 5) {
+        return false;
+    }
+    uint32_t value = 0;
+    for (char c : port) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + static_cast<uint32_t>(c - '0');
+    }
+    return value <= 65535;
+}
+
+} // namespace
+
+// ============================================================================
+// ParsedUrl
+// ============================================================================
+
+std::optional<ParsedUrl> ParsedUrl::parse(std::string_view url) noexcept {
+    if (url.size() > std::numeric_limits<uint32_t>::max()) {
+        return std::nullopt;
+    }
+    size_t scheme_end = url.find("://");
+    if (scheme_end == std::string_view::npos) {
+        return std::nullopt;
+    }
+
+    ParsedUrl parsed;
+    std::string_view scheme = url.substr(0, scheme_end);
+    if (equals_ignoring_case(scheme, "https")) {
+        parsed.secure_ = true;
+    } else if (equals_ignoring_case(scheme, "ws")) {
+        parsed.websocket_ = true;
+    } else if (equals_ignoring_case(scheme, "wss")) {
+        parsed.secure_ = true;
+        parsed.websocket_ = true;
+    } else if (!equals_ignoring_case(scheme, "http")) {
+        return std::nullopt;
+    }
+    parsed.scheme_ = span(0, scheme_end);
+
+    // Authority: [userinfo@]host[:port], up to the path, query or fragment
+    size_t authority = scheme_end + 3;
+    size_t authority_end = std::min(url.find_first_of("/?#", authority), url.size());
+    size_t host_begin = authority;
+    size_t at = url.substr(authority, authority_end - authority).rfind('@');
+    if (at != std::string_view::npos) {
+        parsed.userinfo_ = span(authority, authority + at);
+        host_begin = authority + at + 1;
+    }
+
+    size_t port_begin = std::string_view::npos;
+    if (host_begin < authority_end && url[host_begin] == '[') {
+        size_t close = url.find(']', host_begin);
+        if (close == std::string_view::npos || close >= authority_end) {
+            return std::nullopt;   // malformed IPv6 literal
+        }
+        parsed.host_ = span(host_begin + 1, close);
+        if (close + 1 < authority_end) {
+            if (url[close + 1] != ':') {
+                return std::nullopt;
+            }
+            port_begin = close + 2;
+        }
+    } else {
+        size_t colon = url.find(':', host_begin);
+        if (colon < authority_end) {
+            parsed.host_ = span(host_begin, colon);
+            port_begin = colon + 1;
+        } else {
+            parsed.host_ = span(host_begin, authority_end);
+        }
+    }
+    if (parsed.host_.empty()) {
+        return std::nullopt;
+    }
+    if (port_begin != std::string_view::npos) {
+        // "host:" leaves the port empty, meaning the scheme default
+        if (!valid_port(url.substr(port_begin, authority_end - port_begin))) {
+            return std::nullopt;
+        }
+        parsed.port_ = span(port_begin, authority_end);
+    }
+
+    // path[?query][#fragment]
+    size_t fragment_at = url.find('#', authority_end);
+    size_t target_end = std::min(fragment_at, url.size());
+    if (fragment_at != std::string_view::npos) {
+        parsed.fragment_ = span(fragment_at + 1, url.size());
+    }
+    size_t query_at = url.find('?', authority_end);
+    if (query_at < target_end) {
+        parsed.path_ = span(authority_end, query_at);
+        parsed.query_ = span(query_at + 1, target_end);
+    } else {
+        parsed.path_ = span(authority_end, target_end);
+    }
+    parsed.target_ = span(authority_end, target_end);
+    return parsed;
+}
+
+// ============================================================================
+// UrlCache
+// ============================================================================
+
+UrlCache::UrlCache(size_t capacity) : capacity_(capacity) {
+    if (capacity_ == 0) {
+        throw std::invalid_argument("URL cache needs room for at least one entry");
+    }
+    entries_.reserve(capacity_);
+}
+
+std::optional<ParsedUrl> UrlCache::parse(std::string_view url) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& entry : entries_) {
+            if (entry.url == url) {
+                ++hits_;
+                return entry.parsed;
+            }
+        }
+        ++misses_;
+    }
+
+    auto parsed = ParsedUrl::parse(url);
+    if (!parsed) {
+        return parsed;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : entries_) {
+        if (entry.url == url) {
+            return parsed;   // another thread missed on it too
+        }
+    }
+    if (entries_.size() < capacity_) {
+        entries_.push_back({std::string(url), *parsed});
+    } else {
+        Entry& victim = entries_[next_victim_];
+        victim.url.assign(url);
+        victim.parsed = *parsed;
+        next_victim_ = (next_victim_ + 1) % capacity_;
+    }
+    return parsed;
+}
+
+void UrlCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    next_victim_ = 0;
+}
+
+UrlCache::Stats UrlCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return {hits_, misses_, entries_.size()};
+}
+
+} // namespace cortan::network
@@ -1,25 +1,716 @@
 #include <cortan/network/websocket_client.hpp>
+#include <cortan/network/url.hpp>
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/ssl/host_name_verification.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/version.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+#include <openssl/ssl.h>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
 
 namespace cortan::network {
 
-WebSocketClient::WebSocketClient() {
-    // TODO: Initialize WebSocket client
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+namespace ssl = boost::asio::ssl;
+using tcp = boost::asio::ip::tcp;
+
+using WsResult = std::pair<bool, std::string>;
+using PlainWebSocket = websocket::stream<beast::tcp_stream>;
+using TlsWebSocket = websocket::stream<beast::ssl_stream<beast::tcp_stream>>;
+
+namespace {
+
+// One queued message, moved or shared in by the caller and framed straight
+// from that buffer
+struct Outgoing {
+    std::string owned;
+    std::shared_ptr<const std::string> shared;
+    bool text = true;
+    size_t count = 1;   // caller messages this one carries (more once coalesced)
+    size_t queued_bytes = 0;
+
+    std::string_view payload() const { return shared ? std::string_view(*shared) : std::string_view(owned); }
+};
+
+std::string timeout_message(std::chrono::steady_clock::duration timeout) {
+    if (timeout < std::chrono::seconds(1)) {
+        return "Connection timed out after " +
+               std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(timeout).count()) + " ms";
+    }
+    return "Connection timed out after " +
+           std::to_string(std::chrono::duration_cast<std::chrono::seconds>(timeout).count()) + " seconds";
 }
 
-WebSocketClient::~WebSocketClient() = default;
+std::future<WsResult> ready(WsResult result) {
+    std::promise<WsResult> promise;
+    promise.set_value(std::move(result));
+    return promise.get_future();
+}
+
+} // namespace
+
+// ============================================================================
+// Session state
+// ============================================================================
+
+// Connection setup, the read loop and the write passes all run on one
+// strand. send() and flush() come from any thread and meet the strand at
+// the queue, under mutex_.
+class WebSocketClient::Impl : public std::enable_shared_from_this<WebSocketClient::Impl> {
+public:
+    enum class State { Idle, Connecting, Open, Closing, Closed };
+
+    Impl(WebSocketOptions options,
+         std::shared_ptr<DnsCache> dns,
+         std::shared_ptr<TlsSessionCache> tls,
+         IoRuntime& runtime)
+        : options_(options)
+        , dns_(std::move(dns))
+        , tls_(std::move(tls))
+        , strand_(net::make_strand(runtime.context()))
+        , deadline_(strand_) {
+    }
+
+    void set_message_handler(MessageHandler handler) {
+        std::lock_guard<std::mutex> lock(handler_mutex_);
+        on_message_ = std::move(handler);
+    }
+
+    void set_close_handler(CloseHandler handler) {
+        std::lock_guard<std::mutex> lock(handler_mutex_);
+        on_close_ = std::move(handler);
+    }
+
+    // No handler runs once this returns
+    void detach_handlers() {
+        std::lock_guard<std::mutex> lock(handler_mutex_);
+        on_message_ = nullptr;
+        on_close_ = nullptr;
+    }
+
+    std::future<WsResult> connect(const std::string& url) {
+        auto parsed = ParsedUrl::parse(url);
+        if (!parsed || !parsed->is_websocket()) {
+            return ready({false, "Invalid WebSocket URL: " + url});
+        }
+
+        std::future<WsResult> result;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (state_ != State::Idle) {
+                return ready({false, "WebSocket client already connected once"});
+            }
+            state_ = State::Connecting;
+            result = connect_promise_.get_future();
+        }
+
+        secure_ = parsed->is_secure();
+        host_ = std::string(parsed->host(url));
+        port_ = std::string(parsed->port_or_default(url));
+        target_ = std::string(parsed->target(url));
+        if (target_.empty() || target_.front() != '/') {
+            target_.insert(0, "/");
+        }
+        // The Host header keeps IPv6 brackets and any explicit port
+        host_header_ = host_.find(':') != std::string::npos ? "[" + host_ + "]" : host_;
+        if (!parsed->port(url).empty()) {
+            host_header_ += ":" + port_;
+        }
+
+        net::dispatch(strand_, [self = shared_from_this()] { self->start_connect(); });
+        return result;
+    }
+
+    bool send(Outgoing message) {
+        bool start = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (state_ != State::Connecting && state_ != State::Open) {
+                return false;
+            }
+            message.queued_bytes = message.payload().size();
+            if (queued_bytes_ + message.queued_bytes > options_.max_queued_bytes && queued_bytes_ > 0) {
+                return false;
+            }
+            queued_bytes_ += message.queued_bytes;
+            ++queued_messages_;
+            ++stats_.messages_queued;
+            queue_.push_back(std::move(message));
+            if (state_ == State::Open && !writing_) {
+                writing_ = true;
+                start = true;
+            }
+        }
+        if (start) {
+            net::post(strand_, [self = shared_from_this()] { self->write_pass(); });
+        }
+        return true;
+    }
+
+    std::future<WsResult> flush() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (written_messages_ == queued_messages_) {
+            if (state_ == State::Closed && !flushed_clean_) {
+                return ready({false, close_reason_});
+            }
+            return ready({true, ""});
+        }
+        flushes_.push_back({queued_messages_, std::promise<WsResult>()});
+        return flushes_.back().promise.get_future();
+    }
+
+    void disconnect() {
+        net::dispatch(strand_, [self = shared_from_this()] { self->begin_close(); });
+    }
+
+    bool is_open() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return state_ == State::Open;
+    }
+
+    bool compression_active() const { return compression_.load(); }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+private:
+    struct FlushWaiter {
+        uint64_t target;   // queued_messages_ when flush() was called
+        std::promise<WsResult> promise;
+    };
+
+    // Runs f on whichever kind of stream this connection uses
+    template<typename F>
+    void with_stream(F&& f) {
+        if (secure_) {
+            f(*tls_ws_);
+        } else {
+            f(*plain_ws_);
+        }
+    }
+
+    beast::tcp_stream& lowest_layer() {
+        return secure_ ? beast::get_lowest_layer(*tls_ws_) : beast::get_lowest_layer(*plain_ws_);
+    }
+
+    // ------------------------------------------------------------------------
+    // Connection setup
+    // ------------------------------------------------------------------------
+
+    void start_connect() {
+        compression_ = false;
+        if (secure_) {
+            plain_ws_.reset();
+            tls_ws_ = std::make_unique<TlsWebSocket>(strand_, tls_->context());
+        } else {
+            tls_ws_.reset();
+            plain_ws_ = std::make_unique<PlainWebSocket>(strand_);
+        }
+
+        deadline_.expires_after(options_.connect_timeout);
+        deadline_.async_wait([self = shared_from_this()](const beast::error_code& ec) {
+            if (!ec) {
+                self->fail(timeout_message(self->options_.connect_timeout));
+            }
+        });
+
+        dns_->async_resolve(host_, port_,
+            [self = shared_from_this()](const beast::error_code& ec, DnsCache::Results results) mutable {
+                auto& strand = self->strand_;
+                net::dispatch(strand, [self = std::move(self), ec, results = std::move(results)] {
+                    if (!self->connecting()) {
+                        return;   // timed out or disconnected while the lookup was pending
+                    }
+                    if (ec) {
+                        return self->fail("Resolve error: " + ec.message());
+                    }
+                    self->lowest_layer().async_connect(results,
+                        [self](const beast::error_code& ec, const tcp::endpoint&) { self->on_connect(ec); });
+                });
+            });
+    }
+
+    void on_connect(const beast::error_code& ec) {
+        if (!connecting()) {
+            return;
+        }
+        if (ec) {
+            dns_->invalidate(host_, port_);   // the cached addresses may be stale
+            return fail("Connect error: " + ec.message());
+        }
+        beast::error_code ignored;
+        lowest_layer().socket().set_option(tcp::no_delay(true), ignored);
+        if (!secure_) {
+            return websocket_handshake();
+        }
+
+        auto& stream = tls_ws_->next_layer();
+        if (!SSL_set_tlsext_host_name(stream.native_handle(), host_.c_str())) {
+            return fail("TLS error: could not set SNI host name");
+        }
+        if (tls_->config().verify_peer) {
+            stream.set_verify_callback(ssl::host_name_verification(host_));
+        }
+        const std::string origin = "wss://" + host_ + ":" + port_;
+        tls_->prepare(stream.native_handle(), origin);
+        stream.async_handshake(ssl::stream_base::client,
+            [self = shared_from_this(), origin](const beast::error_code& ec) {
+                if (!self->connecting()) {
+                    return;
+                }
+                if (ec) {
+                    self->tls_->invalidate(origin);
+                    return self->fail("TLS handshake error: " + ec.message());
+                }
+                self->tls_->record_handshake(self->tls_ws_->next_layer().native_handle());
+                self->websocket_handshake();
+            });
+    }
+
+    void websocket_handshake() {
+        with_stream([this](auto& ws) {
+            websocket::stream_base::timeout timeout{};
+            timeout.handshake_timeout = options_.connect_timeout;
+            timeout.idle_timeout = websocket::stream_base::none();
+            timeout.keep_alive_pings = false;
+            ws.set_option(timeout);
+
+            websocket::permessage_deflate deflate;
+            deflate.client_enable = options_.permessage_deflate;
+            deflate.compLevel = options_.deflate_level;
+            ws.set_option(deflate);
+
+            ws.set_option(websocket::stream_base::decorator([](websocket::request_type& req) {
+                req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+            }));
+            ws.read_message_max(options_.max_message_bytes);
+            // Frames are cut by write_next(); one write buffer holds a whole
+            // masked frame, so each frame is a single socket write
+            ws.auto_fragment(false);
+            ws.write_buffer_bytes(std::max<size_t>(options_.fragment_bytes, 8));
+
+            ws.async_handshake(handshake_response_, host_header_, target_,
+                [self = shared_from_this()](const beast::error_code& ec) { self->on_handshake(ec); });
+        });
+    }
+
+    void on_handshake(const beast::error_code& ec) {
+        if (!connecting()) {
+            return;
+        }
+        if (ec) {
+            return fail("WebSocket handshake error: " + ec.message());
+        }
+        deadline_.cancel();
+        auto extensions = handshake_response_[http::field::sec_websocket_extensions];
+        compression_ = options_.permessage_deflate &&
+                       std::string_view(extensions.data(), extensions.size()).find("permessage-deflate") !=
+                           std::string_view::npos;
+
+        bool start_writing = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            state_ = State::Open;
+            connect_promise_.set_value({true, ""});
+            if (!queue_.empty() && !writing_) {
+                writing_ = true;
+                start_writing = true;
+            }
+        }
+        read_next();
+        if (start_writing) {
+            write_pass();
+        }
+    }
+
+    bool connecting() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return state_ == State::Connecting;
+    }
+
+    // ------------------------------------------------------------------------
+    // Reading
+    // ------------------------------------------------------------------------
+
+    void read_next() {
+        with_stream([this](auto& ws) {
+            ws.async_read(read_buffer_, [self = shared_from_this()](const beast::error_code& ec, size_t bytes) {
+                self->on_read(ec, bytes);
+            });
+        });
+    }
 
-bool WebSocketClient::connect(const std::string& url) {
-    // TODO: Implement WebSocket connection
-    return false;
+    void on_read(const beast::error_code& ec, size_t bytes) {
+        if (ec) {
+            if (ec == websocket::error::closed) {
+                std::string reason = "Closed by server";
+                with_stream([&reason](auto& ws) {
+                    const auto& close = ws.reason();
+                    reason += " (code " + std::to_string(close.code);
+                    reason += close.reason.empty() ? ")" : ": " + std::string(close.reason.c_str()) + ")";
+                });
+                return fail(reason);
+            }
+            return fail("Read error: " + ec.message());
+        }
+
+        bool is_text = false;
+        with_stream([&is_text](auto& ws) { is_text = ws.got_text(); });
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++stats_.messages_received;
+            stats_.bytes_received += bytes;
+        }
+        {
+            std::lock_guard<std::mutex> lock(handler_mutex_);
+            if (on_message_) {
+                auto data = read_buffer_.cdata();
+                on_message_(std::string_view(static_cast<const char*>(data.data()), data.size()), is_text);
+            }
+        }
+        read_buffer_.consume(read_buffer_.size());
+        read_next();
+    }
+
+    // ------------------------------------------------------------------------
+    // Writing
+    // ------------------------------------------------------------------------
+
+    // Takes everything queued so far and writes it message by message. The
+    // next pass starts when this one is done; passes end once the queue is
+    // found empty.
+    void write_pass() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (state_ != State::Open && state_ != State::Closing) {
+                writing_ = false;
+                return;
+            }
+            if (queue_.empty()) {
+                if (state_ != State::Closing) {
+                    writing_ = false;
+                    return;
+                }
+            } else {
+                batch_.swap(queue_);
+                ++stats_.write_batches;
+            }
+        }
+        if (batch_.empty()) {
+            return send_close();   // disconnect() asked for a close after the queue
+        }
+        if (options_.coalesce) {
+            coalesce_batch();
+        }
+        batch_position_ = 0;
+        fragment_offset_ = 0;
+        write_next();
+    }
+
+    // Joins runs of short text messages into one message each
+    void coalesce_batch() {
+        std::deque<Outgoing> merged;
+        size_t joined = 0;
+        bool last_joinable = false;
+        for (auto& message : batch_) {
+            auto payload = message.payload();
+            bool joinable = message.text && payload.size() < options_.coalesce_below;
+            if (joinable && last_joinable &&
+                merged.back().payload().size() + 1 + payload.size() <= options_.max_coalesced_bytes) {
+                Outgoing& into = merged.back();
+                if (into.shared) {
+                    into.owned.assign(*into.shared);
+                    into.shared.reset();
+                }
+                into.owned += options_.coalesce_delimiter;
+                into.owned.append(payload);
+                into.count += message.count;
+                into.queued_bytes += message.queued_bytes;
+                ++joined;
+                continue;
+            }
+            merged.push_back(std::move(message));
+            last_joinable = joinable;
+        }
+        batch_.swap(merged);
+        if (joined > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.messages_coalesced += joined;
+        }
+    }
+
+    void write_next() {
+        if (batch_position_ == batch_.size()) {
+            batch_.clear();
+            return write_pass();
+        }
+
+        const Outgoing& message = batch_[batch_position_];
+        auto payload = message.payload();
+        size_t length = std::min(options_.fragment_bytes, payload.size() - fragment_offset_);
+        bool fin = fragment_offset_ + length == payload.size();
+        auto buffer = net::buffer(payload.data() + fragment_offset_, length);
+        with_stream([&](auto& ws) {
+            if (fragment_offset_ == 0) {
+                ws.text(message.text);
+            }
+            ws.async_write_some(fin, buffer,
+                [self = shared_from_this(), length, fin](const beast::error_code& ec, size_t) {
+                    self->on_written(ec, length, fin);
+                });
+        });
+    }
+
+    void on_written(const beast::error_code& ec, size_t length, bool fin) {
+        if (ec) {
+            return fail("Write error: " + ec.message());
+        }
+        fragment_offset_ += length;
+
+        std::vector<FlushWaiter> done;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++stats_.frames_sent;
+            if (fin) {
+                const Outgoing& message = batch_[batch_position_];
+                ++stats_.messages_sent;
+                stats_.bytes_sent += message.payload().size();
+                queued_bytes_ -= message.queued_bytes;
+                written_messages_ += message.count;
+                auto split = std::stable_partition(flushes_.begin(), flushes_.end(),
+                    [this](const FlushWaiter& waiter) { return waiter.target > written_messages_; });
+                std::move(split, flushes_.end(), std::back_inserter(done));
+                flushes_.erase(split, flushes_.end());
+            }
+        }
+        for (auto& waiter : done) {
+            waiter.promise.set_value({true, ""});
+        }
+
+        if (fin) {
+            ++batch_position_;
+            fragment_offset_ = 0;
+        }
+        write_next();
+    }
+
+    // ------------------------------------------------------------------------
+    // Closing
+    // ------------------------------------------------------------------------
+
+    void begin_close() {
+        bool close_now = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (state_ == State::Connecting) {
+                close_now = true;   // handled by fail() below
+            } else if (state_ == State::Open) {
+                state_ = State::Closing;
+                if (!writing_) {
+                    writing_ = true;
+                    close_now = true;
+                }
+            }
+        }
+        if (!close_now) {
+            return;   // idle, already closing, or the running write pass closes
+        }
+        if (connecting()) {
+            return fail("Disconnected");
+        }
+        send_close();
+    }
+
+    void send_close() {
+        with_stream([this](auto& ws) {
+            ws.async_close(websocket::close_code::normal, [self = shared_from_this()](const beast::error_code& ec) {
+                self->fail(ec ? "Close error: " + ec.message() : "Disconnected");
+            });
+        });
+    }
+
+    // Ends the connection (on the strand): pending flushes and a pending
+    // connect fail with the reason, and the close handler runs if the
+    // connection had opened
+    void fail(const std::string& reason) {
+        bool was_open = false;
+        bool was_connecting = false;
+        std::string final_reason;
+        std::vector<FlushWaiter> waiters;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (state_ == State::Closed || state_ == State::Idle) {
+                return;
+            }
+            was_connecting = state_ == State::Connecting;
+            was_open = !was_connecting;
+            close_reason_ = state_ == State::Closing ? "Disconnected" : reason;
+            final_reason = close_reason_;
+            state_ = State::Closed;
+            flushed_clean_ = written_messages_ == queued_messages_;
+            waiters = std::move(flushes_);
+            flushes_.clear();
+            queue_.clear();
+            queued_bytes_ = 0;
+            // Messages that never went out count as settled, so a later
+            // flush() does not wait for them
+            queued_messages_ = written_messages_;
+            if (was_connecting) {
+                connect_promise_.set_value({false, reason});
+            }
+        }
+        deadline_.cancel();
+        batch_.clear();
+        beast::error_code ignored;
+        lowest_layer().socket().close(ignored);
+
+        for (auto& waiter : waiters) {
+            waiter.promise.set_value({false, final_reason});
+        }
+        if (was_open) {
+            std::lock_guard<std::mutex> lock(handler_mutex_);
+            if (on_close_) {
+                on_close_(final_reason);
+            }
+        }
+    }
+
+    const WebSocketOptions options_;
+    std::shared_ptr<DnsCache> dns_;
+    std::shared_ptr<TlsSessionCache> tls_;
+    net::strand<net::io_context::executor_type> strand_;
+    net::steady_timer deadline_;
+
+    // Set by connect() before the strand takes over
+    bool secure_ = false;
+    std::string host_;
+    std::string port_;
+    std::string host_header_;
+    std::string target_;
+
+    // Strand only
+    std::unique_ptr<PlainWebSocket> plain_ws_;
+    std::unique_ptr<TlsWebSocket> tls_ws_;
+    websocket::response_type handshake_response_;
+    beast::flat_buffer read_buffer_;
+    std::deque<Outgoing> batch_;
+    size_t batch_position_ = 0;
+    size_t fragment_offset_ = 0;
+    std::atomic<bool> compression_{false};
+
+    // Shared with send() and flush()
+    mutable std::mutex mutex_;
+    State state_ = State::Idle;
+    std::string close_reason_;
+    std::promise<WsResult> connect_promise_;
+    std::deque<Outgoing> queue_;
+    size_t queued_bytes_ = 0;
+    bool writing_ = false;   // a write pass is scheduled or running
+    uint64_t queued_messages_ = 0;
+    uint64_t written_messages_ = 0;
+    bool flushed_clean_ = true;
+    std::vector<FlushWaiter> flushes_;
+    Stats stats_;
+
+    std::mutex handler_mutex_;
+    MessageHandler on_message_;
+    CloseHandler on_close_;
+};
+
+// ============================================================================
+// WebSocketClient
+// ============================================================================
+
+WebSocketClient::WebSocketClient() : WebSocketClient(WebSocketOptions{}) {}
+
+WebSocketClient::WebSocketClient(WebSocketOptions options,
+                                 std::shared_ptr<DnsCache> dns,
+                                 std::shared_ptr<TlsSessionCache> tls,
+                                 IoRuntime& runtime) {
+    if (options.fragment_bytes == 0) {
+        throw std::invalid_argument("WebSocket fragment_bytes must be positive");
+    }
+    if (options.deflate_level < 1 || options.deflate_level > 9) {
+        throw std::invalid_argument("WebSocket deflate_level must be between 1 and 9");
+    }
+    if (options.max_message_bytes == 0 || options.max_queued_bytes == 0) {
+        throw std::invalid_argument("WebSocket message and queue limits must be positive");
+    }
+    impl_ = std::make_shared<Impl>(options,
+                                   dns ? std::move(dns) : DnsCache::shared(),
+                                   tls ? std::move(tls) : TlsSessionCache::shared(),
+                                   runtime);
+}
+
+WebSocketClient::~WebSocketClient() {
+    impl_->detach_handlers();
+    impl_->disconnect();
+}
+
+void WebSocketClient::on_message(MessageHandler handler) {
+    impl_->set_message_handler(std::move(handler));
+}
+
+void WebSocketClient::on_close(CloseHandler handler) {
+    impl_->set_close_handler(std::move(handler));
+}
+
+std::future<std::pair<bool, std::string>> WebSocketClient::connect(const std::string& url) {
+    return impl_->connect(url);
+}
+
+bool WebSocketClient::send(std::string message, bool is_text) {
+    Outgoing outgoing;
+    outgoing.owned = std::move(message);
+    outgoing.text = is_text;
+    return impl_->send(std::move(outgoing));
+}
+
+bool WebSocketClient::send(std::shared_ptr<const std::string> message, bool is_text) {
+    if (!message) {
+        return false;
+    }
+    Outgoing outgoing;
+    outgoing.shared = std::move(message);
+    outgoing.text = is_text;
+    return impl_->send(std::move(outgoing));
+}
+
+std::future<std::pair<bool, std::string>> WebSocketClient::flush() {
+    return impl_->flush();
 }
 
 void WebSocketClient::disconnect() {
-    // TODO: Implement WebSocket disconnection
+    impl_->disconnect();
+}
+
+bool WebSocketClient::is_connected() const {
+    return impl_->is_open();
+}
+
+bool WebSocketClient::compression_active() const {
+    return impl_->compression_active();
 }
 
-bool WebSocketClient::send(const std::string& message) {
-    // TODO: Implement WebSocket message sending
-    return false;
+WebSocketClient::Stats WebSocketClient::stats() const {
+    return impl_->stats();
 }
 
 } // namespace cortan::network
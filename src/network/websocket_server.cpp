@@ -0,0 +1,707 @@
+#include <cortan/network/websocket_server.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/version.hpp>
+#include <boost/beast/websocket.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace cortan::network {
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace websocket = beast::websocket;
+namespace net = boost::asio;
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+
+constexpr const char* kAllTopics = "*";
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+std::string percent_decode(std::string_view text) {
+    std::string decoded;
+    decoded.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '%' && i + 2 < text.size() && hex_value(text[i + 1]) >= 0 && hex_value(text[i + 2]) >= 0) {
+            decoded.push_back(static_cast<char>(hex_value(text[i + 1]) * 16 + hex_value(text[i + 2])));
+            i += 2;
+        } else {
+            decoded.push_back(text[i] == '+' ? ' ' : text[i]);
+        }
+    }
+    return decoded;
+}
+
+// Decoded values of every "name=value" in the query of a request target
+std::vector<std::string> query_values(std::string_view target, std::string_view name) {
+    std::vector<std::string> values;
+    auto mark = target.find('?');
+    if (mark == std::string_view::npos) {
+        return values;
+    }
+    std::string_view query = target.substr(mark + 1);
+    while (!query.empty()) {
+        auto amp = query.find('&');
+        std::string_view pair = query.substr(0, amp);
+        query = amp == std::string_view::npos ? std::string_view() : query.substr(amp + 1);
+        if (pair.size() > name.size() && pair.substr(0, name.size()) == name && pair[name.size()] == '=') {
+            values.push_back(percent_decode(pair.substr(name.size() + 1)));
+        }
+    }
+    return values;
+}
+
+// Topics from "topics=a,b" in the query of a request target
+std::vector<std::string> topics_from_target(std::string_view target) {
+    std::vector<std::string> topics;
+    for (const auto& value : query_values(target, "topics")) {
+        size_t start = 0;
+        while (start <= value.size()) {
+            size_t comma = std::min(value.find(',', start), value.size());
+            if (comma > start) topics.push_back(value.substr(start, comma - start));
+            start = comma + 1;
+        }
+    }
+    return topics;
+}
+
+// One queued message; the buffer is shared by every client it went to
+struct Outgoing {
+    std::string topic;
+    std::shared_ptr<const std::string> message;
+};
+
+} // namespace
+
+// ============================================================================
+// WebSocketServer::Impl
+// ============================================================================
+
+class WebSocketServer::Impl : public std::enable_shared_from_this<WebSocketServer::Impl> {
+public:
+    class Session;
+
+    Impl(WebSocketServerConfig config, IoRuntime& runtime)
+        : config_(std::move(config))
+        , runtime_(runtime)
+        , strand_(net::make_strand(runtime.context()))
+        , acceptor_(strand_) {}
+
+    std::pair<bool, std::string> start() {
+        std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+        if (started_) {
+            return {false, "WebSocketServer was already started"};
+        }
+        started_ = true;
+
+        beast::error_code ec;
+        auto address = net::ip::make_address(config_.address, ec);
+        if (ec) {
+            return {false, "Invalid listen address " + config_.address + ": " + ec.message()};
+        }
+        tcp::endpoint endpoint(address, config_.port);
+        acceptor_.open(endpoint.protocol(), ec);
+        if (!ec) acceptor_.set_option(net::socket_base::reuse_address(true), ec);
+        if (!ec) acceptor_.bind(endpoint, ec);
+        if (!ec) acceptor_.listen(net::socket_base::max_listen_connections, ec);
+        if (ec) {
+            beast::error_code ignored;
+            acceptor_.close(ignored);
+            return {false, "Cannot listen on " + config_.address + ":" + std::to_string(config_.port) + ": " +
+                               ec.message()};
+        }
+        port_ = acceptor_.local_endpoint().port();
+        net::dispatch(strand_, [self = shared_from_this()] { self->accept_next(); });
+        return {true, ""};
+    }
+
+    void stop();
+
+    void bridge(core::EventBus& bus, const std::vector<std::string>& topics) {
+        for (const auto& topic : topics) {
+            // The bus has no unsubscribe, so the handler only holds the server weakly
+            bus.subscribe(topic, [weak = weak_from_this(), topic](const core::BaseEvent& event) {
+                if (auto self = weak.lock(); self && self->has_subscribers(topic)) {
+                    auto message = std::make_shared<const std::string>(serialize_event(topic, event));
+                    ++self->events_serialized_;
+                    self->broadcast(topic, message);
+                }
+                std::promise<void> done;
+                done.set_value();
+                return done.get_future();
+            });
+        }
+    }
+
+    size_t broadcast(const std::string& topic, const std::shared_ptr<const std::string>& message);
+
+    bool has_subscribers(const std::string& topic) const {
+        std::shared_lock<std::shared_mutex> lock(registry_mutex_);
+        auto it = by_topic_.find(topic);
+        if (it != by_topic_.end() && !it->second.empty()) return true;
+        it = by_topic_.find(kAllTopics);
+        return it != by_topic_.end() && !it->second.empty();
+    }
+
+    size_t client_count() const {
+        std::shared_lock<std::shared_mutex> lock(registry_mutex_);
+        return sessions_.size();
+    }
+
+    unsigned short port() const {
+        std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+        return port_;
+    }
+
+    Stats stats() const {
+        Stats stats;
+        stats.connections_accepted = connections_accepted_.load();
+        stats.events_serialized = events_serialized_.load();
+        stats.messages_queued = messages_queued_.load();
+        stats.messages_sent = messages_sent_.load();
+        stats.messages_dropped = messages_dropped_.load();
+        stats.messages_coalesced = messages_coalesced_.load();
+        stats.handshakes_refused = handshakes_refused_.load();
+        stats.subscriptions_denied = subscriptions_denied_.load();
+        stats.clients = client_count();
+        return stats;
+    }
+
+    // Registry, called from session strands
+    void add_session(const std::shared_ptr<Session>& session, const std::vector<std::string>& topics);
+    void subscribe(const std::shared_ptr<Session>& session, const std::vector<std::string>& topics);
+    void unsubscribe(const std::shared_ptr<Session>& session, const std::vector<std::string>& topics);
+    void remove_session(const std::shared_ptr<Session>& session);
+    void unsubscribe_locked(const std::shared_ptr<Session>& session, const std::vector<std::string>& topics);
+
+    const WebSocketServerConfig config_;
+
+    std::atomic<uint64_t> messages_queued_{0};
+    std::atomic<uint64_t> messages_sent_{0};
+    std::atomic<uint64_t> messages_dropped_{0};
+    std::atomic<uint64_t> messages_coalesced_{0};
+    std::atomic<uint64_t> handshakes_refused_{0};
+    std::atomic<uint64_t> subscriptions_denied_{0};
+
+private:
+    void accept_next();
+
+    IoRuntime& runtime_;
+    net::strand<net::io_context::executor_type> strand_;   // the acceptor's
+    tcp::acceptor acceptor_;
+
+    mutable std::mutex lifecycle_mutex_;
+    bool started_ = false;
+    bool stopped_ = false;
+    unsigned short port_ = 0;
+
+    // Sessions by topic; broadcasts take it shared, (un)subscribing exclusive
+    mutable std::shared_mutex registry_mutex_;
+    std::unordered_map<std::string, std::vector<std::shared_ptr<Session>>> by_topic_;
+    std::vector<std::shared_ptr<Session>> sessions_;
+
+    std::atomic<uint64_t> connections_accepted_{0};
+    std::atomic<uint64_t> events_serialized_{0};
+};
+
+// ============================================================================
+// Session
+// ============================================================================
+
+// One client on its own strand. Broadcasts append to its queue from any
+// thread under a short lock; the strand writes the queue out one message at
+// a time.
+class WebSocketServer::Impl::Session : public std::enable_shared_from_this<Session> {
+public:
+    Session(std::shared_ptr<Impl> server, tcp::socket socket)
+        : server_(std::move(server))
+        , ws_(std::move(socket)) {}
+
+    void run() {
+        beast::get_lowest_layer(ws_).expires_after(server_->config_.handshake_timeout);
+        http::async_read(beast::get_lowest_layer(ws_), buffer_, upgrade_,
+            [self = shared_from_this()](const beast::error_code& ec, size_t) { self->on_upgrade_request(ec); });
+    }
+
+    // Any thread; false if the connection is gone
+    bool enqueue(const std::string& topic, const std::shared_ptr<const std::string>& message) {
+        const auto& config = server_->config_;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) {
+            return false;
+        }
+        ++server_->messages_queued_;
+        if (message->size() > config.max_queued_bytes) {
+            ++server_->messages_dropped_;
+            return true;
+        }
+
+        if (queue_.size() >= config.max_queued_messages ||
+            queued_bytes_ + message->size() > config.max_queued_bytes) {
+            if (config.slow_consumer == SlowConsumerPolicy::Coalesce) {
+                auto same = std::find_if(queue_.begin(), queue_.end(),
+                                         [&](const Outgoing& queued) { return queued.topic == topic; });
+                if (same != queue_.end()) {
+                    queued_bytes_ = queued_bytes_ - same->message->size() + message->size();
+                    same->message = message;
+                    ++server_->messages_coalesced_;
+                    return true;
+                }
+            }
+            while (!queue_.empty() && (queue_.size() >= config.max_queued_messages ||
+                                       queued_bytes_ + message->size() > config.max_queued_bytes)) {
+                queued_bytes_ -= queue_.front().message->size();
+                queue_.pop_front();
+                ++server_->messages_dropped_;
+            }
+        }
+
+        queue_.push_back({topic, message});
+        queued_bytes_ += message->size();
+        if (open_ && !writing_) {
+            writing_ = true;
+            net::post(ws_.get_executor(), [self = shared_from_this()] { self->write_next(); });
+        }
+        return true;
+    }
+
+    // Any thread
+    void close() {
+        net::dispatch(ws_.get_executor(), [self = shared_from_this()] { self->shut_down(); });
+    }
+
+    std::vector<std::string> topics;   // registry lock
+
+private:
+    void on_upgrade_request(const beast::error_code& ec) {
+        if (ec || !websocket::is_upgrade(upgrade_.get())) {
+            return shut_down();
+        }
+        if (auto refusal = check_handshake(); refusal != http::status::ok) {
+            ++server_->handshakes_refused_;
+            return refuse(refusal);
+        }
+        beast::get_lowest_layer(ws_).expires_never();
+
+        ws_.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
+        websocket::permessage_deflate deflate;
+        deflate.server_enable = server_->config_.permessage_deflate;
+        ws_.set_option(deflate);
+        ws_.set_option(websocket::stream_base::decorator([](websocket::response_type& res) {
+            res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+        }));
+        ws_.read_message_max(server_->config_.max_message_bytes);
+
+        ws_.async_accept(upgrade_.get(), [self = shared_from_this()](const beast::error_code& ec) {
+            self->on_accept(ec);
+        });
+    }
+
+    // Origin, then the user, then every requested topic; ok to accept
+    http::status check_handshake() {
+        const auto& config = server_->config_;
+        const auto& request = upgrade_.get();
+        if (auto origin = request.find(http::field::origin); origin != request.end()) {
+            std::string_view value(origin->value().data(), origin->value().size());
+            if (std::find(config.allowed_origins.begin(), config.allowed_origins.end(), value) ==
+                config.allowed_origins.end()) {
+                return http::status::forbidden;
+            }
+        }
+
+        std::string_view target(request.target().data(), request.target().size());
+        if (config.authenticate) {
+            std::string token;
+            if (auto header = request.find(http::field::authorization); header != request.end()) {
+                std::string_view value(header->value().data(), header->value().size());
+                if (value.substr(0, 7) == "Bearer ") token = std::string(value.substr(7));
+            } else if (auto tokens = query_values(target, "access_token"); !tokens.empty()) {
+                token = std::move(tokens.front());
+            }
+            auto user = config.authenticate(token);
+            if (!user) {
+                return http::status::unauthorized;
+            }
+            user_id_ = std::move(*user);
+        }
+
+        requested_ = topics_from_target(target);
+        for (const auto& topic : requested_) {
+            if (!allowed(topic)) {
+                return http::status::forbidden;
+            }
+        }
+        return http::status::ok;
+    }
+
+    bool allowed(const std::string& topic) const {
+        const auto& authorize = server_->config_.authorize_subscription;
+        return !authorize || authorize(user_id_, topic);
+    }
+
+    void refuse(http::status status) {
+        auto response = std::make_shared<http::response<http::empty_body>>(status, upgrade_.get().version());
+        response->set(http::field::server, BOOST_BEAST_VERSION_STRING);
+        response->keep_alive(false);
+        response->prepare_payload();
+        http::async_write(beast::get_lowest_layer(ws_), *response,
+            [self = shared_from_this(), response](const beast::error_code&, size_t) { self->shut_down(); });
+    }
+
+    void on_accept(const beast::error_code& ec) {
+        if (ec) {
+            return shut_down();
+        }
+        upgrade_.release();
+        server_->add_session(shared_from_this(), requested_);
+        requested_.clear();
+
+        bool start_writing = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_) return;
+            open_ = true;
+            start_writing = !queue_.empty() && !writing_;
+            writing_ = writing_ || start_writing;
+        }
+        read_next();
+        if (start_writing) {
+            write_next();
+        }
+    }
+
+    void read_next() {
+        ws_.async_read(read_buffer_, [self = shared_from_this()](const beast::error_code& ec, size_t) {
+            if (ec) return self->shut_down();
+            self->on_message();
+            self->read_next();
+        });
+    }
+
+    // {"subscribe": ["topic", ...]} or {"unsubscribe": [...]}; a single
+    // string works too. Anything else is ignored.
+    void on_message() {
+        auto data = read_buffer_.cdata();
+        std::string_view text(static_cast<const char*>(data.data()), data.size());
+        auto json = nlohmann::json::parse(text, nullptr, false);
+        read_buffer_.consume(read_buffer_.size());
+        if (!json.is_object()) {
+            return;
+        }
+        auto topics_of = [&](const char* key) {
+            std::vector<std::string> topics;
+            auto it = json.find(key);
+            if (it == json.end()) return topics;
+            if (it->is_string()) topics.push_back(it->get<std::string>());
+            if (it->is_array()) {
+                for (const auto& item : *it) {
+                    if (item.is_string()) topics.push_back(item.get<std::string>());
+                }
+            }
+            return topics;
+        };
+        auto add = topics_of("subscribe");
+        auto denied = std::remove_if(add.begin(), add.end(), [&](const std::string& topic) { return !allowed(topic); });
+        server_->subscriptions_denied_ += static_cast<uint64_t>(add.end() - denied);
+        add.erase(denied, add.end());
+        if (!add.empty()) {
+            server_->subscribe(shared_from_this(), add);
+        }
+        if (auto remove = topics_of("unsubscribe"); !remove.empty()) {
+            server_->unsubscribe(shared_from_this(), remove);
+        }
+    }
+
+    void write_next() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_ || queue_.empty()) {
+                writing_ = false;
+                return;
+            }
+            in_flight_ = std::move(queue_.front());
+            queue_.pop_front();
+            queued_bytes_ -= in_flight_.message->size();
+        }
+        ws_.text(true);
+        ws_.async_write(net::buffer(*in_flight_.message), [self = shared_from_this()](const beast::error_code& ec,
+                                                                                     size_t) {
+            self->in_flight_ = {};
+            if (ec) return self->shut_down();
+            ++self->server_->messages_sent_;
+            self->write_next();
+        });
+    }
+
+    // Strand only
+    void shut_down() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_) return;
+            closed_ = true;
+            queue_.clear();
+            queued_bytes_ = 0;
+        }
+        server_->remove_session(shared_from_this());
+        beast::error_code ignored;
+        beast::get_lowest_layer(ws_).socket().shutdown(tcp::socket::shutdown_both, ignored);
+        beast::get_lowest_layer(ws_).close();
+    }
+
+    std::shared_ptr<Impl> server_;
+    websocket::stream<beast::tcp_stream> ws_;
+
+    // Strand only
+    beast::flat_buffer buffer_;
+    http::request_parser<http::empty_body> upgrade_;
+    std::string user_id_;
+    std::vector<std::string> requested_;   // handshake topics, until accepted
+    beast::flat_buffer read_buffer_;
+    Outgoing in_flight_;
+
+    // Shared with broadcasters
+    std::mutex mutex_;
+    std::deque<Outgoing> queue_;
+    size_t queued_bytes_ = 0;
+    bool open_ = false;
+    bool writing_ = false;   // a write is scheduled or running
+    bool closed_ = false;
+};
+
+// ============================================================================
+// WebSocketServer::Impl
+// ============================================================================
+
+void WebSocketServer::Impl::accept_next() {
+    // Each connection gets a strand of its own
+    acceptor_.async_accept(net::make_strand(runtime_.context()),
+        [self = shared_from_this()](const beast::error_code& ec, tcp::socket socket) {
+            if (ec == net::error::operation_aborted || !self->acceptor_.is_open()) {
+                return;
+            }
+            if (!ec) {
+                ++self->connections_accepted_;
+                beast::error_code ignored;
+                socket.set_option(tcp::no_delay(true), ignored);
+                std::make_shared<Session>(self, std::move(socket))->run();
+            }
+            self->accept_next();
+        });
+}
+
+void WebSocketServer::Impl::stop() {
+    {
+        std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+        if (!started_ || stopped_) {
+            return;
+        }
+        stopped_ = true;
+    }
+    net::dispatch(strand_, [self = shared_from_this()] {
+        beast::error_code ignored;
+        self->acceptor_.close(ignored);
+    });
+
+    std::vector<std::shared_ptr<Session>> open;
+    {
+        std::shared_lock<std::shared_mutex> lock(registry_mutex_);
+        open = sessions_;
+    }
+    for (auto& session : open) {
+        session->close();
+    }
+}
+
+size_t WebSocketServer::Impl::broadcast(const std::string& topic, const std::shared_ptr<const std::string>& message) {
+    size_t delivered = 0;
+    std::shared_lock<std::shared_mutex> lock(registry_mutex_);
+    if (auto it = by_topic_.find(topic); it != by_topic_.end()) {
+        for (const auto& session : it->second) {
+            if (session->enqueue(topic, message)) ++delivered;
+        }
+    }
+    if (topic == kAllTopics) {
+        return delivered;
+    }
+    if (auto it = by_topic_.find(kAllTopics); it != by_topic_.end()) {
+        for (const auto& session : it->second) {
+            // A client on both the topic and "*" gets the message once
+            const auto& mine = session->topics;
+            if (std::find(mine.begin(), mine.end(), topic) == mine.end()) {
+                if (session->enqueue(topic, message)) ++delivered;
+            }
+        }
+    }
+    return delivered;
+}
+
+void WebSocketServer::Impl::add_session(const std::shared_ptr<Session>& session,
+                                        const std::vector<std::string>& topics) {
+    {
+        std::unique_lock<std::shared_mutex> lock(registry_mutex_);
+        sessions_.push_back(session);
+    }
+    subscribe(session, topics);
+    std::lock_guard<std::mutex> lock(lifecycle_mutex_);
+    if (stopped_) {
+        session->close();   // accepted while stopping
+    }
+}
+
+void WebSocketServer::Impl::subscribe(const std::shared_ptr<Session>& session,
+                                      const std::vector<std::string>& topics) {
+    std::unique_lock<std::shared_mutex> lock(registry_mutex_);
+    if (std::find(sessions_.begin(), sessions_.end(), session) == sessions_.end()) {
+        return;   // already closed
+    }
+    for (const auto& topic : topics) {
+        if (std::find(session->topics.begin(), session->topics.end(), topic) != session->topics.end()) {
+            continue;
+        }
+        session->topics.push_back(topic);
+        by_topic_[topic].push_back(session);
+    }
+}
+
+void WebSocketServer::Impl::unsubscribe(const std::shared_ptr<Session>& session,
+                                        const std::vector<std::string>& topics) {
+    std::unique_lock<std::shared_mutex> lock(registry_mutex_);
+    unsubscribe_locked(session, topics);
+}
+
+void WebSocketServer::Impl::unsubscribe_locked(const std::shared_ptr<Session>& session,
+                                               const std::vector<std::string>& topics) {
+    for (const auto& topic : topics) {
+        auto& mine = session->topics;
+        auto it = std::find(mine.begin(), mine.end(), topic);
+        if (it == mine.end()) continue;
+        mine.erase(it);
+        auto list = by_topic_.find(topic);
+        list->second.erase(std::remove(list->second.begin(), list->second.end(), session), list->second.end());
+        if (list->second.empty()) by_topic_.erase(list);
+    }
+}
+
+void WebSocketServer::Impl::remove_session(const std::shared_ptr<Session>& session) {
+    std::unique_lock<std::shared_mutex> lock(registry_mutex_);
+    unsubscribe_locked(session, std::vector<std::string>(session->topics));
+    sessions_.erase(std::remove(sessions_.begin(), sessions_.end(), session), sessions_.end());
+}
+
+// ============================================================================
+// WebSocketServer
+// ============================================================================
+
+WebSocketServer::WebSocketServer(WebSocketServerConfig config, IoRuntime& runtime) {
+    if (config.max_queued_messages == 0 || config.max_queued_bytes == 0 || config.max_message_bytes == 0) {
+        throw std::invalid_argument("WebSocketServer queue and message limits must be positive");
+    }
+    impl_ = std::make_shared<Impl>(std::move(config), runtime);
+}
+
+WebSocketServer::~WebSocketServer() {
+    impl_->stop();
+}
+
+std::pair<bool, std::string> WebSocketServer::start() {
+    return impl_->start();
+}
+
+void WebSocketServer::stop() {
+    impl_->stop();
+}
+
+void WebSocketServer::bridge(core::EventBus& bus, const std::vector<std::string>& topics) {
+    impl_->bridge(bus, topics);
+}
+
+size_t WebSocketServer::broadcast(const std::string& topic, std::shared_ptr<const std::string> message) {
+    if (!message) {
+        return 0;
+    }
+    return impl_->broadcast(topic, message);
+}
+
+bool WebSocketServer::has_subscribers(const std::string& topic) const {
+    return impl_->has_subscribers(topic);
+}
+
+size_t WebSocketServer::client_count() const {
+    return impl_->client_count();
+}
+
+unsigned short WebSocketServer::port() const {
+    return impl_->port();
+}
+
+WebSocketServer::Stats WebSocketServer::stats() const {
+    return impl_->stats();
+}
+
+// ============================================================================
+// Event Serialization
+// ============================================================================
+
+std::string WebSocketServer::serialize_event(const std::string& topic, const core::BaseEvent& event) {
+    using namespace core;
+    nlohmann::json json;
+    json["topic"] = topic;
+    json["type"] = event.getEventType();
+    json["priority"] = static_cast<int>(event.getPriority());
+    json["correlation_id"] = event.getCorrelationId();
+    json["timestamp_ms"] = std::chrono::duration_cast<std::chrono::milliseconds>(
+                               event.timestamp().time_since_epoch()).count();
+
+    const auto& context = event.getContext();
+    json["user_id"] = context.getUserId();
+    if (!context.session_id.empty()) json["session_id"] = context.session_id;
+    if (!context.metadata.empty()) {
+        auto& metadata = json["metadata"];
+        for (const auto& [key, value] : context.metadata) {
+            metadata[key] = value;
+        }
+    }
+
+    if (auto* request = dynamic_cast<const UserRequestEvent*>(&event)) {
+        json["content"] = request->getContent();
+        json["request_type"] = static_cast<int>(request->getRequestType());
+    } else if (auto* processing = dynamic_cast<const AIProcessingEvent*>(&event)) {
+        static const char* const kStages[] = {"started", "progress", "completed", "failed"};
+        json["task_id"] = processing->getTaskId();
+        json["stage"] = kStages[static_cast<int>(processing->getStage())];
+        json["details"] = processing->getDetails();
+    } else if (auto* environment = dynamic_cast<const EnvironmentalEvent*>(&event)) {
+        json["environment_type"] = static_cast<int>(environment->getEnvironmentType());
+        json["description"] = environment->getDescription();
+        json["sensor_data"] = environment->getSensorData();
+    } else if (auto* learning = dynamic_cast<const LearningEvent*>(&event)) {
+        json["learning_type"] = static_cast<int>(learning->getLearningType());
+        json["insight"] = learning->getInsight();
+        json["confidence"] = learning->getConfidenceLevel();
+    } else if (auto* welcome = dynamic_cast<const WelcomeEvent*>(&event)) {
+        json["welcome_type"] = static_cast<int>(welcome->getWelcomeType());
+        json["message"] = welcome->getMessage();
+        json["target_user_id"] = welcome->getTargetUserId();
+    }
+    return json.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+}
+
+} // namespace cortan::network
@@ -0,0 +1,298 @@
+#include <gtest/gtest.h>
+#include <cortan/ai/audit_log.hpp>
+#include <cortan/ai/security_manager.hpp>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace cortan::ai;
+using namespace std::chrono_literals;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// A fresh directory per test, removed afterwards
+class AuditLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir = fs::temp_directory_path() /
+              ("cortan_audit_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()) + "_" +
+               std::to_string(::getpid()));
+        fs::remove_all(dir);
+    }
+    void TearDown() override { fs::remove_all(dir); }
+
+    AuditLogConfig config() const {
+        AuditLogConfig config;
+        config.path = (dir / "security.audit").string();
+        config.flush_interval = 5ms;
+        return config;
+    }
+
+    static std::vector<AuditRecord> read_all(const std::string& path, AuditLog::ReadResult* result = nullptr) {
+        std::vector<AuditRecord> records;
+        auto read = AuditLog::read_file(path, [&](const AuditRecord& record) { records.push_back(record); });
+        if (result) *result = read;
+        return records;
+    }
+
+    fs::path dir;
+};
+
+} // namespace
+
+TEST_F(AuditLogTest, WritesRecordsTheReaderDecodes) {
+    auto before = std::chrono::system_clock::now();
+    {
+        AuditLog log(config());
+        ASSERT_TRUE(log.open().first);
+        EXPECT_FALSE(log.open().first);
+        EXPECT_TRUE(log.append("auth.denied", "user=guest action=model.query"));
+        EXPECT_TRUE(log.append("rate_limited", ""));
+        EXPECT_TRUE(log.append("binary", std::string("a\0b\n", 4)));
+        log.flush();
+
+        auto stats = log.stats();
+        EXPECT_EQ(stats.events_appended, 3u);
+        EXPECT_EQ(stats.events_written, 3u);
+        EXPECT_GE(stats.batches_written, 1u);
+    }
+
+    AuditLog::ReadResult result;
+    auto records = read_all(config().path, &result);
+    EXPECT_TRUE(result.error.empty());
+    EXPECT_EQ(result.records, 3u);
+    EXPECT_EQ(result.corrupt, 0u);
+    EXPECT_FALSE(result.truncated);
+    ASSERT_EQ(records.size(), 3u);
+    EXPECT_EQ(records[0].sequence, 0u);
+    EXPECT_EQ(records[0].event_type, "auth.denied");
+    EXPECT_EQ(records[0].details, "user=guest action=model.query");
+    EXPECT_EQ(records[1].details, "");
+    EXPECT_EQ(records[2].details, std::string("a\0b\n", 4));
+    EXPECT_GE(records[0].time, before - 1s);
+    EXPECT_LE(records[2].time, std::chrono::system_clock::now() + 1s);
+
+    // Reopening appends to the same file and carries on the numbering
+    {
+        AuditLog log(config());
+        ASSERT_TRUE(log.open().first);
+        log.append("restart", "");
+    }
+    records = read_all(config().path);
+    ASSERT_EQ(records.size(), 4u);
+    EXPECT_EQ(records[3].event_type, "restart");
+    EXPECT_EQ(records[3].sequence, 3u);
+}
+
+TEST_F(AuditLogTest, ConcurrentProducersLoseNothingWhileTheRingHasRoom) {
+    auto cfg = config();
+    cfg.ring_capacity = 1 << 16;
+    constexpr int kThreads = 4;
+    constexpr int kEvents = 5000;
+    {
+        AuditLog log(cfg);
+        ASSERT_TRUE(log.open().first);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&, t] {
+                for (int i = 0; i < kEvents; ++i) {
+                    log.append("thread." + std::to_string(t), std::to_string(i));
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        log.flush();
+        EXPECT_EQ(log.stats().events_dropped, 0u);
+    }
+
+    auto records = read_all(cfg.path);
+    ASSERT_EQ(records.size(), size_t{kThreads * kEvents});
+    std::vector<int> next(kThreads, 0);
+    for (size_t i = 0; i < records.size(); ++i) {
+        EXPECT_EQ(records[i].sequence, i);
+        int thread = std::stoi(records[i].event_type.substr(7));
+        // Each producer's events stay in its own order
+        EXPECT_EQ(std::stoi(records[i].details), next[static_cast<size_t>(thread)]++);
+    }
+}
+
+TEST_F(AuditLogTest, FullRingDropsAndRecordsTheDrop) {
+    auto cfg = config();
+    cfg.ring_capacity = 8;
+    AuditLog log(cfg);
+
+    // Not opened yet, so nothing drains the ring
+    size_t accepted = 0;
+    for (int i = 0; i < 20; ++i) {
+        if (log.append("burst", std::to_string(i))) ++accepted;
+    }
+    EXPECT_EQ(accepted, 8u);
+    EXPECT_EQ(log.stats().events_dropped, 12u);
+
+    ASSERT_TRUE(log.open().first);
+    log.flush();
+    auto records = read_all(cfg.path);
+    ASSERT_EQ(records.size(), 9u);
+    EXPECT_EQ(records.back().event_type, "audit.dropped");
+    EXPECT_EQ(records.back().details, "12 events dropped: ring full");
+
+    // The drop record has a sequence of its own; the next event follows it
+    log.append("after", "");
+    log.flush();
+    records = read_all(cfg.path);
+    ASSERT_EQ(records.size(), 10u);
+    for (size_t i = 0; i < records.size(); ++i) {
+        EXPECT_EQ(records[i].sequence, i);
+    }
+    EXPECT_EQ(records[9].event_type, "after");
+}
+
+TEST_F(AuditLogTest, RotatesAndKeepsTheNewestFiles) {
+    auto cfg = config();
+    cfg.max_file_bytes = 4096;
+    cfg.max_rotated_files = 2;
+    {
+        AuditLog log(cfg);
+        ASSERT_TRUE(log.open().first);
+        const std::string details(500, 'd');
+        for (int i = 0; i < 40; ++i) {
+            log.append("event", details);
+            log.flush();   // one batch each, so rotation happens between events
+        }
+        EXPECT_GT(log.stats().files_rotated, 2u);
+    }
+
+    EXPECT_TRUE(fs::exists(cfg.path));
+    EXPECT_TRUE(fs::exists(cfg.path + ".1"));
+    EXPECT_TRUE(fs::exists(cfg.path + ".2"));
+    EXPECT_FALSE(fs::exists(cfg.path + ".3"));
+
+    // Sequences run on across files: .2 holds older ones than .1, then the live file
+    uint64_t previous = 0;
+    bool first = true;
+    for (const auto& path : {cfg.path + ".2", cfg.path + ".1", cfg.path}) {
+        EXPECT_LE(fs::file_size(path), cfg.max_file_bytes);
+        for (const auto& record : read_all(path)) {
+            if (!first) {
+                EXPECT_EQ(record.sequence, previous + 1);
+            }
+            previous = record.sequence;
+            first = false;
+        }
+    }
+    EXPECT_EQ(previous, 39u);
+}
+
+TEST_F(AuditLogTest, FailedReopenAfterRotationIsRetried) {
+    auto cfg = config();
+    cfg.max_file_bytes = 256;
+    const std::string details(150, 'd');
+    AuditLog log(cfg);
+    ASSERT_TRUE(log.open().first);
+    log.append("event", details);
+    log.flush();
+    EXPECT_TRUE(log.stats().file_open);
+
+    // A plain file where the log directory was: rotation cannot reopen
+    fs::remove_all(dir);
+    std::ofstream(dir.string()) << "in the way";
+    log.append("event", details);
+    log.flush();
+    auto stats = log.stats();
+    EXPECT_EQ(stats.files_rotated, 1u);
+    EXPECT_GE(stats.open_failures, 1u);
+    EXPECT_FALSE(stats.file_open);
+
+    // Once the path is usable again the held-back event is written too
+    fs::remove(dir);
+    log.append("event", details);
+    log.flush();
+    EXPECT_TRUE(log.stats().file_open);
+    auto records = read_all(cfg.path);
+    ASSERT_EQ(records.size(), 2u);
+    EXPECT_EQ(records[0].sequence, 1u);
+    EXPECT_EQ(records[1].sequence, 2u);
+}
+
+TEST_F(AuditLogTest, ReaderSkipsDamagedRecordsAndReportsTornTail) {
+    {
+        AuditLog log(config());
+        ASSERT_TRUE(log.open().first);
+        for (int i = 0; i < 5; ++i) log.append("event", "details " + std::to_string(i));
+    }
+    auto path = config().path;
+    auto size = fs::file_size(path);
+
+    // Flip a byte inside the second record's details, then cut the last record short
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        const size_t record_bytes = (size - 12) / 5;
+        file.seekp(static_cast<std::streamoff>(12 + record_bytes + record_bytes - 2));
+        file.put('X');
+    }
+    fs::resize_file(path, size - 3);
+
+    AuditLog::ReadResult result;
+    auto records = read_all(path, &result);
+    EXPECT_EQ(result.corrupt, 1u);
+    EXPECT_TRUE(result.truncated);
+    ASSERT_EQ(records.size(), 3u);
+    EXPECT_EQ(records[0].details, "details 0");
+    EXPECT_EQ(records[1].details, "details 2");
+    EXPECT_EQ(records[2].details, "details 3");
+
+    EXPECT_FALSE(AuditLog::read_file((dir / "missing").string(), [](const AuditRecord&) {}).error.empty());
+}
+
+TEST_F(AuditLogTest, DamagedLengthMidFileIsNotATornTail) {
+    {
+        AuditLog log(config());
+        ASSERT_TRUE(log.open().first);
+        for (int i = 0; i < 5; ++i) log.append("event", "details " + std::to_string(i));
+    }
+    auto path = config().path;
+    const size_t record_bytes = (fs::file_size(path) - 12) / 5;
+
+    // The second record's length now points past the end of the file
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(static_cast<std::streamoff>(12 + record_bytes + 4 + 3));
+        file.put('\x7f');
+    }
+
+    AuditLog::ReadResult result;
+    auto records = read_all(path, &result);
+    EXPECT_EQ(result.corrupt, 1u);
+    EXPECT_FALSE(result.truncated);
+    ASSERT_EQ(records.size(), 4u);
+    EXPECT_EQ(records[0].details, "details 0");
+    EXPECT_EQ(records[1].details, "details 2");
+    EXPECT_EQ(records[3].details, "details 4");
+}
+
+TEST_F(AuditLogTest, SecurityManagerLogsThroughTheAuditLog) {
+    SecurityManager security;
+    security.log_security_event("ignored", "no log open yet");
+    EXPECT_EQ(security.audit_log(), nullptr);
+
+    ASSERT_TRUE(security.open_audit_log(config()).first);
+    EXPECT_FALSE(security.open_audit_log(config()).first);
+    security.log_security_event("auth.denied", "user=guest");
+    security.audit_log()->flush();
+
+    auto records = read_all(config().path);
+    ASSERT_EQ(records.size(), 1u);
+    EXPECT_EQ(records[0].event_type, "auth.denied");
+
+    auto bad = config();
+    bad.ring_capacity = 12;
+    EXPECT_THROW(AuditLog{bad}, std::invalid_argument);
+}
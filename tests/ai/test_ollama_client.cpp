@@ -0,0 +1,361 @@
+#include <gtest/gtest.h>
+#include <cortan/ai/model_manager.hpp>
+#include <cortan/ai/ollama_client.hpp>
+#include "mock_ollama_server.hpp"
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cortan::ai;
+using test_support::MockOllamaServer;
+using namespace std::chrono_literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Collects tokens from the runtime thread with their arrival times
+struct TokenLog {
+    std::mutex mutex;
+    std::vector<std::string> tokens;
+    std::vector<Clock::time_point> arrivals;
+
+    TokenHandler handler(size_t stop_after = 0) {
+        return [this, stop_after](std::string_view token) {
+            std::lock_guard<std::mutex> lock(mutex);
+            tokens.emplace_back(token);
+            arrivals.push_back(Clock::now());
+            return stop_after == 0 || tokens.size() < stop_after;
+        };
+    }
+};
+
+} // namespace
+
+// ============================================================================
+// OllamaStreamParser
+// ============================================================================
+
+TEST(OllamaStreamParserTest, DecodesLinesSplitAtAnyByte) {
+    MockOllamaServer::Script script;
+    script.tokens = {"Hel", "lo \"quoted\"", " \\ wörld", "\n"};
+    const auto stream = MockOllamaServer::generate_stream(script);
+
+    for (size_t piece : {size_t{1}, size_t{7}, size_t{64}, stream.size()}) {
+        std::vector<std::string> tokens;
+        OllamaStreamParser parser([&](std::string_view token) {
+            tokens.emplace_back(token);
+            return true;
+        });
+        for (size_t at = 0; at < stream.size(); at += piece) {
+            ASSERT_TRUE(parser.feed(std::string_view(stream).substr(at, piece))) << parser.error();
+        }
+        ASSERT_TRUE(parser.finish()) << parser.error();
+
+        EXPECT_EQ(tokens, script.tokens) << "piece size " << piece;
+        EXPECT_TRUE(parser.done());
+        EXPECT_EQ(parser.stats().chunks, 5u);
+        EXPECT_EQ(parser.stats().eval_count, 4u);
+        EXPECT_EQ(parser.stats().prompt_eval_count, 26u);
+        EXPECT_EQ(parser.stats().eval_duration, 4'900'000'000ns);
+        EXPECT_EQ(parser.stats().total_duration, 5'250'000'000ns);
+    }
+}
+
+TEST(OllamaStreamParserTest, DecodeOnlyPicksTopLevelFields) {
+    OllamaLine line;
+    ASSERT_TRUE(OllamaStreamParser::decode(
+        R"({"model":"m","options":{"response":"nested","done":true},"context":[1,{"eval_count":9}],)"
+        R"("response":"caf\u00e9 \"ok\"","done":true,"eval_count":42,"eval_duration":7e3})",
+        line));
+    EXPECT_EQ(line.token, "caf\u00e9 \"ok\"");
+    EXPECT_TRUE(line.done);
+    EXPECT_EQ(line.eval_count, 42u);
+    EXPECT_EQ(line.eval_duration_ns, 0u);   // not an integer
+
+    // The same object is reset for the next line
+    ASSERT_TRUE(OllamaStreamParser::decode(
+        R"({"message":{"role":"assistant","content":"hi","images":[{"content":"no"}]},"done":false})", line));
+    EXPECT_EQ(line.token, "hi");
+    EXPECT_FALSE(line.done);
+    EXPECT_EQ(line.eval_count, 0u);
+
+    ASSERT_TRUE(OllamaStreamParser::decode(R"({"content":"not in a message"})", line));
+    EXPECT_TRUE(line.token.empty());
+
+    EXPECT_FALSE(OllamaStreamParser::decode("[1,2]", line));
+    EXPECT_FALSE(OllamaStreamParser::decode("\"text\"", line));
+    EXPECT_FALSE(OllamaStreamParser::decode(R"({"response":"a"} trailing)", line));
+}
+
+TEST(OllamaStreamParserTest, DecodeAgreesWithTheDomParser) {
+    const std::vector<std::string> lines = {
+        R"({"response":"plain"})",
+        R"( { "response" : "spaced" , "done" : false } )",
+        R"({"response":"\ud83d\ude00 \u00e9\/\b\f\n\r\t\\"})",
+        R"({"response":"x","n":[-0,0.5,1e10,-2.5E-3,{"a":[[],{}]}],"z":null})",
+        R"({"resp\u006fnse":"escaped key"})",
+        R"({"message":{"content":"a","extra":{"content":"b"}}})",
+        R"({"eval_count":18446744073709551615})",
+        R"({"eval_count":18446744073709551616})",
+        R"({"eval_count":"12","done":true})",
+        R"({})",
+        // Invalid
+        R"({"response":"\ud83d"})",
+        R"({"response":"\ude00"})",
+        R"({"response":"\x"})",
+        "{\"response\":\"tab\there\"}",
+        R"({"response":"unterminated})",
+        R"({"a":01})",
+        R"({"a":1.})",
+        R"({"a":1e})",
+        R"({"a":-})",
+        R"({"a":tru})",
+        R"({"a":[1,]})",
+        R"({"a":1,})",
+        R"({"a" 1})",
+        R"({"a":1}})",
+        R"({'a':1})",
+        "",
+    };
+    for (const auto& text : lines) {
+        OllamaLine line;
+        bool ours = OllamaStreamParser::decode(text, line);
+        auto dom = nlohmann::json::parse(text, nullptr, false);
+        bool valid = !dom.is_discarded() && dom.is_object();
+        EXPECT_EQ(ours, valid) << text;
+        if (!ours || !valid) continue;
+
+        std::string token;
+        if (dom.contains("response") && dom["response"].is_string()) token = dom["response"];
+        if (dom.contains("message") && dom["message"].is_object() && dom["message"].contains("content")) {
+            token = dom["message"]["content"];
+        }
+        EXPECT_EQ(line.token, token) << text;
+        if (dom.contains("eval_count") && dom["eval_count"].is_number_unsigned()) {
+            EXPECT_EQ(line.eval_count, dom["eval_count"].get<uint64_t>()) << text;
+        }
+    }
+}
+
+TEST(OllamaStreamParserTest, ReportsErrorsMalformedLinesAndTruncation) {
+    OllamaStreamParser failed({});
+    EXPECT_FALSE(failed.feed("{\"error\":\"model \\\"x\\\" not found\"}\n"));
+    EXPECT_EQ(failed.error(), "model \"x\" not found");
+    EXPECT_FALSE(failed.finish());
+
+    OllamaStreamParser malformed({});
+    EXPECT_TRUE(malformed.feed("{\"response\":\"a\",\"done\":false}\r\n\n"));
+    EXPECT_FALSE(malformed.feed("{\"response\":\n"));
+    EXPECT_EQ(malformed.error().rfind("Malformed stream line", 0), 0u);
+
+    // Cut off before the final line
+    OllamaStreamParser truncated({});
+    EXPECT_TRUE(truncated.feed("{\"response\":\"a\",\"done\":false}\n{\"respo"));
+    EXPECT_FALSE(truncated.finish());
+    EXPECT_FALSE(truncated.done());
+
+    // An unterminated final line still counts
+    OllamaStreamParser unterminated({});
+    EXPECT_TRUE(unterminated.feed("{\"response\":\"\",\"done\":true,\"eval_count\":3}"));
+    EXPECT_TRUE(unterminated.finish());
+    EXPECT_EQ(unterminated.stats().eval_count, 3u);
+}
+
+TEST(OllamaStreamParserTest, StopsWhenTheHandlerSaysSo) {
+    const auto stream = MockOllamaServer::generate_stream({});
+    size_t seen = 0;
+    OllamaStreamParser parser([&](std::string_view) { return ++seen < 2; });
+    EXPECT_FALSE(parser.feed(stream));
+    EXPECT_TRUE(parser.stopped());
+    EXPECT_EQ(seen, 2u);
+    EXPECT_TRUE(parser.finish());
+}
+
+// ============================================================================
+// OllamaClient against the mock server
+// ============================================================================
+
+TEST(OllamaClientTest, ListsModelsFromTags) {
+    MockOllamaServer::Script script;
+    script.models = {"llama3:8b", "codellama:latest", "qwen2.5:7b"};
+    MockOllamaServer server(script);
+    OllamaClient client(server.endpoint());
+
+    EXPECT_EQ(client.list_models(), script.models);
+
+    OllamaClient unreachable("http://127.0.0.1:1");
+    EXPECT_TRUE(unreachable.list_models().empty());
+}
+
+TEST(OllamaClientTest, TokensArriveWhileTheModelIsStillGenerating) {
+    MockOllamaServer::Script script;
+    script.tokens = {"one", " two", " three", " four"};
+    script.token_interval = 100ms;
+    script.split_every = 5;
+    MockOllamaServer server(script);
+    OllamaClient client(server.endpoint());
+
+    TokenLog log;
+    auto started = Clock::now();
+    auto result = client.generate("llama3:8b", "Count to four", log.handler()).get();
+    auto finished = Clock::now();
+
+    ASSERT_TRUE(result.success) << result.error;
+    EXPECT_EQ(result.text, "one two three four");
+    EXPECT_EQ(log.tokens, script.tokens);
+    EXPECT_EQ(result.stats.eval_count, 4u);
+
+    // The first token was handed over long before the stream ended
+    ASSERT_EQ(log.arrivals.size(), 4u);
+    EXPECT_LT(log.arrivals.front() - started, 100ms);
+    EXPECT_GE(finished - log.arrivals.front(), 250ms);
+    EXPECT_LT(result.stats.time_to_first_token, 100ms);
+    EXPECT_GT(result.stats.time_to_first_token, 0ns);
+
+    auto request = nlohmann::json::parse(server.last_request_body());
+    EXPECT_EQ(request["model"], "llama3:8b");
+    EXPECT_EQ(request["prompt"], "Count to four");
+    EXPECT_EQ(request["stream"], true);
+}
+
+TEST(OllamaClientTest, ChatSendsTheHistoryAndStreamsMessageContent) {
+    MockOllamaServer server;
+    OllamaClient client(server.endpoint());
+
+    TokenLog log;
+    auto result = client.chat("llama3:8b",
+                              {{"system", "Be brief."}, {"user", "Say hello"}},
+                              log.handler()).get();
+    ASSERT_TRUE(result.success) << result.error;
+    EXPECT_EQ(result.text, "Hello, world!");
+    EXPECT_EQ(log.tokens.size(), 4u);
+
+    auto request = nlohmann::json::parse(server.last_request_body());
+    ASSERT_EQ(request["messages"].size(), 2u);
+    EXPECT_EQ(request["messages"][0]["role"], "system");
+    EXPECT_EQ(request["messages"][1]["content"], "Say hello");
+}
+
+TEST(OllamaClientTest, InvalidUtf8IsReplacedRatherThanThrown) {
+    MockOllamaServer server;
+    OllamaClient client(server.endpoint());
+
+    std::string prompt = "caf\xe9 \xff!";   // Latin-1 bytes, not UTF-8
+    auto result = client.generate("llama3:8b", prompt, {}).get();
+    ASSERT_TRUE(result.success) << result.error;
+    auto request = nlohmann::json::parse(server.last_request_body());
+    EXPECT_EQ(request["prompt"], "caf\xEF\xBF\xBD \xEF\xBF\xBD!");
+
+    auto chat = client.chat("llama3:8b", {{"user", prompt}}).get();
+    ASSERT_TRUE(chat.success) << chat.error;
+    EXPECT_EQ(nlohmann::json::parse(server.last_request_body())["messages"][0]["content"],
+              "caf\xEF\xBF\xBD \xEF\xBF\xBD!");
+}
+
+TEST(OllamaClientTest, ReportsServerErrorsAndStopsEarly) {
+    MockOllamaServer::Script script;
+    script.tokens = {"a", "b", "c", "d", "e"};
+    script.token_interval = 200ms;
+    MockOllamaServer server(script);
+    OllamaClient client(server.endpoint());
+
+    // Ollama's own explanation comes through with the status
+    auto missing = client.generate("mistral", "hi").get();
+    EXPECT_FALSE(missing.first);
+    EXPECT_EQ(missing.second, "model \"mistral\" not found, try pulling it first (HTTP 404 Not Found)");
+    auto missing_chat = client.chat("mistral", {{"user", "hi"}}).get();
+    EXPECT_FALSE(missing_chat.success);
+    EXPECT_EQ(missing_chat.error, missing.second);
+
+    // Stopping after the first token ends the request without waiting for the rest
+    TokenLog log;
+    auto started = Clock::now();
+    auto result = client.generate("llama3:8b", "letters", log.handler(1)).get();
+    EXPECT_TRUE(result.success) << result.error;
+    EXPECT_EQ(result.text, "a");
+    EXPECT_LT(Clock::now() - started, 400ms);
+
+    OllamaClient unreachable("http://127.0.0.1:1");
+    auto refused = unreachable.generate("llama3:8b", "hi").get();
+    EXPECT_FALSE(refused.first);
+    EXPECT_FALSE(refused.second.empty());
+}
+
+TEST(OllamaClientTest, AnUnreachableServerOpensTheCircuit) {
+    cortan::network::ResilienceConfig resilience;
+    resilience.retry.max_attempts = 1;
+    resilience.breaker.failure_threshold = 2;
+    resilience.breaker.open_duration = 10s;
+    OllamaClient client("http://127.0.0.1:1", nullptr, {}, resilience);
+
+    EXPECT_FALSE(client.generate("llama3:8b", "hi").get().first);
+    EXPECT_TRUE(client.list_models().empty());
+    auto refused = client.generate("llama3:8b", "hi").get();
+    EXPECT_FALSE(refused.first);
+    EXPECT_EQ(refused.second.rfind("Circuit open for http://127.0.0.1:1", 0), 0u) << refused.second;
+
+    auto stats = client.http().stats(client.endpoint());
+    EXPECT_EQ(stats.state, cortan::network::CircuitBreaker::State::Open);
+    EXPECT_EQ(stats.short_circuited, 1u);
+}
+
+TEST(OllamaClientTest, IdleTimeoutAndGenerationDeadlineAreSeparate) {
+    MockOllamaServer::Script script;
+    script.tokens = std::vector<std::string>(10, "x");
+    script.token_interval = 300ms;
+    MockOllamaServer server(script);
+
+    // Tokens every 300ms never trip a 1s idle timeout, but the 1s
+    // generation deadline ends the reply part way
+    OllamaTimeouts timeouts;
+    timeouts.idle = 1s;
+    timeouts.generation = 1s;
+    cortan::network::ResilienceConfig once;   // a stall would otherwise be retried
+    once.retry.max_attempts = 1;
+    OllamaClient bounded(server.endpoint(), nullptr, timeouts, once);
+    auto started = Clock::now();
+    auto result = bounded.generate("llama3:8b", "x", {}).get();
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.error, "Request timed out after 1 seconds");
+    EXPECT_LT(Clock::now() - started, 1800ms);
+    EXPECT_FALSE(result.text.empty());
+    EXPECT_LT(result.text.size(), 10u);
+
+    // A model that never produces its first token fails after the idle timeout
+    script.first_token_delay = 1500ms;
+    server.set_script(script);
+    timeouts.generation = 0s;
+    OllamaClient stalled(server.endpoint(), nullptr, timeouts, once);
+    started = Clock::now();
+    result = stalled.generate("llama3:8b", "x", {}).get();
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.error, "Request timed out after 1 seconds");
+    EXPECT_LT(Clock::now() - started, 1400ms);
+    EXPECT_TRUE(result.text.empty());
+}
+
+TEST(OllamaClientTest, OllamaModelGeneratesThroughTheClient) {
+    MockOllamaServer server;
+    ModelManager models;
+    models.addModel(std::make_unique<OllamaModel>("llama3:8b", server.endpoint()));
+
+    auto* model = models.getModel("llama3:8b");
+    ASSERT_NE(model, nullptr);
+    EXPECT_FALSE(model->isLoaded());
+
+    auto [ok, text] = models.processRequest("llama3:8b", "Say hello").get();
+    ASSERT_TRUE(ok) << text;
+    EXPECT_EQ(text, "Hello, world!");
+    EXPECT_TRUE(model->isLoaded());
+
+    auto arena = std::make_shared<cortan::core::RequestArena>();
+    EXPECT_EQ(models.processRequest("llama3:8b", "Say hello", arena).get().second, "Hello, world!");
+
+    TokenLog log;
+    EXPECT_TRUE(model->processStream("Say hello", log.handler()).get().first);
+    EXPECT_EQ(log.tokens.size(), 4u);
+}
@@ -0,0 +1,265 @@
+#include <gtest/gtest.h>
+#include <cortan/ai/security_manager.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cortan::ai;
+using namespace std::chrono_literals;
+
+using Admission = SecurityManager::Admission;
+
+namespace {
+
+RateLimitConfig limits(double per_second, double burst) {
+    RateLimitConfig config;
+    config.requests_per_second = per_second;
+    config.burst = burst;
+    return config;
+}
+
+} // namespace
+
+TEST(SecurityManagerTest, BurstThenRefusesUntilRefilled) {
+    SecurityManager security(limits(50.0, 3.0));
+
+    EXPECT_TRUE(security.rate_limit_check("alice"));
+    EXPECT_TRUE(security.rate_limit_check("alice"));
+    EXPECT_TRUE(security.rate_limit_check("alice"));
+    EXPECT_FALSE(security.rate_limit_check("alice"));
+    EXPECT_TRUE(security.rate_limit_check("bob"));   // buckets are per user
+
+    // One token every 20ms
+    std::this_thread::sleep_for(30ms);
+    EXPECT_TRUE(security.rate_limit_check("alice"));
+
+    auto stats = security.stats();
+    EXPECT_EQ(stats.admitted, 5u);
+    EXPECT_EQ(stats.rate_limited, 1u);
+    EXPECT_EQ(stats.tracked_users, 2u);
+}
+
+TEST(SecurityManagerTest, ConcurrentChecksNeverExceedTheBurst) {
+    SecurityManager security(limits(0.001, 100.0));   // effectively no refill
+    std::atomic<int> allowed{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 1000; ++i) {
+                if (security.rate_limit_check("shared")) allowed.fetch_add(1);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    EXPECT_EQ(allowed.load(), 100);
+    EXPECT_EQ(security.stats().rate_limited, 7900u);
+}
+
+TEST(SecurityManagerTest, PermitsEnforceInFlightLimits) {
+    auto config = limits(1000.0, 1000.0);
+    config.max_in_flight_per_user = 2;
+    config.max_in_flight_global = 3;
+    SecurityManager security(config);
+
+    auto a1 = security.admit_request("alice");
+    auto a2 = security.admit_request("alice");
+    auto a3 = security.admit_request("alice");
+    ASSERT_TRUE(a1);
+    ASSERT_TRUE(a2);
+    EXPECT_FALSE(a3);
+    EXPECT_EQ(a3.admission(), Admission::UserBusy);
+
+    auto b1 = security.admit_request("bob");
+    auto c1 = security.admit_request("carol");
+    ASSERT_TRUE(b1);
+    EXPECT_EQ(c1.admission(), Admission::Overloaded);
+    EXPECT_EQ(security.stats().in_flight, 3u);
+
+    // Finished requests give their slots back, moved permits only once
+    a1.release();
+    auto moved = std::move(a2);
+    EXPECT_FALSE(a2);
+    EXPECT_TRUE(security.admit_request("carol"));   // released again right away
+    {
+        auto a4 = security.admit_request("alice");
+        EXPECT_TRUE(a4);
+        EXPECT_EQ(security.stats().in_flight, 3u);
+    }
+    moved = SecurityManager::RequestPermit();
+    b1.release();
+    EXPECT_EQ(security.stats().in_flight, 0u);
+
+    auto stats = security.stats();
+    EXPECT_EQ(stats.user_busy, 1u);
+    EXPECT_EQ(stats.overloaded, 1u);
+}
+
+TEST(SecurityManagerTest, RefusalsForConcurrencyKeepTokens) {
+    auto config = limits(0.001, 2.0);
+    config.max_in_flight_per_user = 1;
+    SecurityManager security(config);
+
+    auto first = security.admit_request("alice");
+    ASSERT_TRUE(first);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(security.admit_request("alice").admission(), Admission::UserBusy);
+    }
+    first.release();
+
+    // Second token is still there, third never was
+    EXPECT_TRUE(security.admit_request("alice"));
+    EXPECT_EQ(security.admit_request("alice").admission(), Admission::RateLimited);
+    EXPECT_EQ(security.stats().in_flight, 0u);
+}
+
+TEST(SecurityManagerTest, TrackedUsersAreBoundedAndIdleOnesForgotten) {
+    auto config = limits(1000.0, 1.0);
+    config.max_tracked_users = 16;   // one per shard
+    config.max_in_flight_global = 100;
+    SecurityManager security(config);
+
+    // Seventeen busy users cannot all be tracked
+    std::vector<SecurityManager::RequestPermit> permits;
+    size_t refused = 0;
+    for (int i = 0; i < 17; ++i) {
+        auto permit = security.admit_request("user-" + std::to_string(i));
+        if (permit) {
+            permits.push_back(std::move(permit));
+        } else {
+            EXPECT_EQ(permit.admission(), Admission::Overloaded);
+            ++refused;
+        }
+    }
+    EXPECT_GE(refused, 1u);
+    EXPECT_LE(security.stats().tracked_users, 16u);
+
+    // Once idle and refilled, their buckets make room for new users
+    permits.clear();
+    std::this_thread::sleep_for(5ms);
+    for (int i = 0; i < 17; ++i) {
+        EXPECT_TRUE(security.admit_request("user-" + std::to_string(i))) << i;
+        std::this_thread::sleep_for(2ms);
+    }
+}
+
+TEST(SecurityManagerTest, RejectsInvalidLimits) {
+    EXPECT_THROW(SecurityManager{limits(0.0, 1.0)}, std::invalid_argument);
+    EXPECT_THROW(SecurityManager{limits(1.0, 0.5)}, std::invalid_argument);
+    auto config = limits(1.0, 1.0);
+    config.max_in_flight_global = 0;
+    EXPECT_THROW(SecurityManager{config}, std::invalid_argument);
+    EXPECT_NO_THROW(SecurityManager{});
+}
+
+namespace {
+
+constexpr const char* kPolicy = R"({
+    "security": {
+        "roles": {
+            "viewer": ["status.read"],
+            "operator": {"inherits": ["viewer"], "actions": ["model.query"]},
+            "admin": ["*"]
+        },
+        "users": {"root": ["admin"], "ops": ["operator"], "nobody": []},
+        "default_roles": ["viewer"]
+    }
+})";
+
+} // namespace
+
+TEST(SecurityPolicyTest, CompilesRolesIntoUserGrants) {
+    auto policy = SecurityPolicy::parse(kPolicy);
+    EXPECT_EQ(policy.action_count(), 3u);   // "*", status.read, model.query
+    EXPECT_EQ(policy.user_count(), 3u);
+
+    EXPECT_TRUE(policy.allows("ops", "model.query"));
+    EXPECT_TRUE(policy.allows("ops", "status.read"));   // inherited
+    EXPECT_FALSE(policy.allows("ops", "workflow.run"));
+    EXPECT_TRUE(policy.allows("root", "workflow.run"));   // "*" covers unnamed actions
+    EXPECT_TRUE(policy.allows("guest", "status.read"));   // default_roles
+    EXPECT_FALSE(policy.allows("guest", "model.query"));
+    EXPECT_FALSE(policy.allows("nobody", "status.read"));
+
+    EXPECT_FALSE(SecurityPolicy().allows("root", "status.read"));
+}
+
+TEST(SecurityPolicyTest, RejectsMalformedPolicies) {
+    EXPECT_THROW(SecurityPolicy::parse("{"), std::invalid_argument);
+    EXPECT_THROW(SecurityPolicy::parse(R"({"roles": {"a": "status.read"}})"), std::invalid_argument);
+    EXPECT_THROW(SecurityPolicy::parse(R"({"users": {"u": ["missing"]}})"), std::invalid_argument);
+    EXPECT_THROW(SecurityPolicy::parse(R"({"roles": {"a": {"inherits": ["b"]}, "b": {"inherits": ["a"]}}})"),
+                 std::invalid_argument);
+
+    std::string many = R"({"roles": {"all": [)";
+    for (size_t i = 0; i < SecurityPolicy::kMaxActions; ++i) {
+        many += (i ? ",\"a" : "\"a") + std::to_string(i) + "\"";
+    }
+    EXPECT_THROW(SecurityPolicy::parse(many + "]}}"), std::invalid_argument);
+}
+
+TEST(SecurityManagerTest, AuthorizationFollowsPolicyReloads) {
+    SecurityManager security;
+    EXPECT_FALSE(security.authorize_request("ops", "model.query"));   // no policy yet
+
+    security.load_policy(SecurityPolicy::parse(kPolicy));
+    for (int i = 0; i < 3; ++i) {   // cached after the first call
+        EXPECT_TRUE(security.authorize_request("ops", "model.query"));
+        EXPECT_FALSE(security.authorize_request("guest", "model.query"));
+    }
+
+    // Another manager's decisions never leak through the per-thread cache
+    SecurityManager other;
+    EXPECT_FALSE(other.authorize_request("ops", "model.query"));
+
+    security.load_policy(SecurityPolicy::parse(R"({"roles": {"r": ["model.query"]}, "default_roles": ["r"]})"));
+    EXPECT_FALSE(security.authorize_request("ops", "status.read"));
+    EXPECT_TRUE(security.authorize_request("guest", "model.query"));
+
+    auto [ok, error] = security.reload_policy("/nonexistent/orchestrator.json");
+    EXPECT_FALSE(ok);
+    EXPECT_FALSE(error.empty());
+    EXPECT_TRUE(security.authorize_request("guest", "model.query"));   // kept
+}
+
+TEST(SecurityManagerTest, SubscriptionAuthorizerChecksEventActions) {
+    SecurityManager security;
+    security.load_policy(SecurityPolicy::parse(R"({
+        "roles": {"dashboard": ["events.ai.processing"], "admin": ["*"]},
+        "users": {"root": ["admin"], "board": ["dashboard"]}
+    })"));
+    auto authorize = security.subscription_authorizer();
+
+    EXPECT_TRUE(authorize("board", "ai.processing"));
+    EXPECT_FALSE(authorize("board", "user.request"));
+    EXPECT_FALSE(authorize("board", "*"));
+    EXPECT_TRUE(authorize("root", "*"));
+    EXPECT_FALSE(authorize("", "ai.processing"));   // anonymous, no default roles
+}
+
+TEST(SecurityManagerTest, ConcurrentAuthorizationSeesReloads) {
+    SecurityManager security;
+    security.load_policy(SecurityPolicy::parse(R"({"default_roles": []})"));
+    std::atomic<bool> reloaded{false};
+    std::atomic<int> stale_after_reload{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 20000; ++i) {
+                bool was_reloaded = reloaded.load();
+                bool allowed = security.authorize_request("user-" + std::to_string(t), "model.query");
+                if (was_reloaded && !allowed) stale_after_reload.fetch_add(1);
+            }
+        });
+    }
+    std::this_thread::sleep_for(5ms);
+    security.load_policy(SecurityPolicy::parse(R"({"roles": {"r": ["*"]}, "default_roles": ["r"]})"));
+    reloaded = true;
+    for (auto& thread : threads) thread.join();
+
+    EXPECT_EQ(stale_after_reload.load(), 0);
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include <cortan/ai/workflow_coordinator.hpp>
+#include <cctype>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+
+using namespace cortan;
+using namespace cortan::ai;
+using namespace std::chrono_literals;
+
+class WorkflowCoordinatorTest : public ::testing::Test {
+protected:
+    std::shared_ptr<core::WorkflowEngine> engine = std::make_shared<core::WorkflowEngine>(4);
+    WorkflowCoordinator coordinator{engine};
+};
+
+namespace {
+
+StepHandler sleeping_step(std::chrono::milliseconds delay, std::string output) {
+    return make_step([delay, output](const StepInputs&) {
+        std::this_thread::sleep_for(delay);
+        return output;
+    });
+}
+
+// Records when each branch started and finished, so overlap can be checked
+// without depending on how fast the machine is
+struct BranchTimes {
+    using Clock = std::chrono::steady_clock;
+    std::mutex mutex;
+    std::map<std::string, std::pair<Clock::time_point, Clock::time_point>> spans;
+
+    StepHandler step(std::chrono::milliseconds delay, std::string output) {
+        return make_step([this, delay, output](const StepInputs&) {
+            auto start = Clock::now();
+            std::this_thread::sleep_for(delay);
+            std::lock_guard<std::mutex> lock(mutex);
+            spans[output] = {start, Clock::now()};
+            return output;
+        });
+    }
+};
+
+} // namespace
+
+TEST_F(WorkflowCoordinatorTest, LinearWorkflowChainsOutputs) {
+    coordinator.register_step_handler("upper", make_step([](const StepInputs& in) {
+        std::string text = in.dependencies.empty() ? in.workflow_input : in.dependencies.begin()->second;
+        for (auto& c : text) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        return text;
+    }));
+    coordinator.register_step_handler("exclaim", make_step([](const StepInputs& in) {
+        return in.dependencies.begin()->second + "!";
+    }));
+
+    coordinator.create_workflow("shout", std::vector<std::string>{"upper", "exclaim", "exclaim"});
+    EXPECT_EQ(coordinator.get_workflow_status("shout"), WorkflowStatus::CREATED);
+
+    auto report = coordinator.execute_workflow("shout", "hi").get();
+    EXPECT_EQ(report.status, WorkflowStatus::COMPLETED);
+    EXPECT_EQ(report.outputs.at("exclaim#2"), "HI!!");
+    EXPECT_EQ(coordinator.get_workflow_status("shout"), WorkflowStatus::COMPLETED);
+}
+
+TEST_F(WorkflowCoordinatorTest, IndependentBranchesRunConcurrently) {
+    BranchTimes times;
+    std::vector<WorkflowStep> steps;
+    steps.push_back({"a", {}, times.step(50ms, "a")});
+    steps.push_back({"b", {}, times.step(50ms, "b")});
+    steps.push_back({"c", {}, times.step(50ms, "c")});
+    steps.push_back({"join", {"a", "b", "c"}, make_step([](const StepInputs& in) {
+        return in.dependencies.at("a") + in.dependencies.at("b") + in.dependencies.at("c");
+    })});
+    coordinator.create_workflow("fan_in", std::move(steps));
+
+    auto report = coordinator.execute_workflow("fan_in").get();
+    ASSERT_EQ(report.status, WorkflowStatus::COMPLETED);
+    EXPECT_EQ(report.outputs.at("join"), "abc");
+
+    // Three branches on four workers: every branch starts before the others end
+    ASSERT_EQ(times.spans.size(), 3u);
+    for (const auto& [name, span] : times.spans) {
+        for (const auto& [other, other_span] : times.spans) {
+            if (name != other) {
+                EXPECT_LT(span.first, other_span.second) << name << " started after " << other << " finished";
+            }
+        }
+    }
+    EXPECT_GE(report.critical_path_time, 50ms);
+    ASSERT_EQ(report.critical_path.size(), 2u);
+    EXPECT_EQ(report.critical_path.back(), "join");
+}
+
+TEST_F(WorkflowCoordinatorTest, CriticalPathFollowsSlowestBranch) {
+    std::vector<WorkflowStep> steps;
+    steps.push_back({"fetch", {}, sleeping_step(5ms, "x")});
+    steps.push_back({"fast", {"fetch"}, sleeping_step(5ms, "f")});
+    steps.push_back({"slow", {"fetch"}, sleeping_step(60ms, "s")});
+    steps.push_back({"merge", {"fast", "slow"}, sleeping_step(5ms, "m")});
+    coordinator.create_workflow("diamond", std::move(steps));
+
+    auto report = coordinator.execute_workflow("diamond").get();
+    EXPECT_EQ(report.critical_path, (std::vector<std::string>{"fetch", "slow", "merge"}));
+    EXPECT_LE(report.critical_path_time, report.wall_time);
+}
+
+TEST_F(WorkflowCoordinatorTest, FailureSkipsDependents) {
+    std::vector<WorkflowStep> steps;
+    steps.push_back({"ok", {}, sleeping_step(1ms, "ok")});
+    steps.push_back({"broken", {}, make_step([](const StepInputs&) -> std::string {
+        throw std::runtime_error("model unavailable");
+    })});
+    steps.push_back({"after", {"ok", "broken"}, sleeping_step(1ms, "after")});
+    coordinator.create_workflow("failing", std::move(steps));
+
+    auto report = coordinator.execute_workflow("failing").get();
+    EXPECT_EQ(report.status, WorkflowStatus::FAILED);
+    EXPECT_EQ(report.error, "broken: model unavailable");
+    EXPECT_FALSE(report.steps[2].executed);
+    EXPECT_EQ(report.outputs.count("after"), 0u);
+    EXPECT_EQ(coordinator.get_workflow_status("failing"), WorkflowStatus::FAILED);
+}
+
+TEST_F(WorkflowCoordinatorTest, RejectsInvalidGraphs) {
+    auto step = sleeping_step(0ms, "");
+    EXPECT_THROW(coordinator.create_workflow("cycle", std::vector<WorkflowStep>{
+                     {"a", {"b"}, step}, {"b", {"a"}, step}}),
+                 std::invalid_argument);
+    EXPECT_THROW(coordinator.create_workflow("dangling", std::vector<WorkflowStep>{
+                     {"a", {"missing"}, step}}),
+                 std::invalid_argument);
+    EXPECT_THROW(coordinator.create_workflow("dup", std::vector<WorkflowStep>{
+                     {"a", {}, step}, {"a", {}, step}}),
+                 std::invalid_argument);
+    EXPECT_THROW(coordinator.create_workflow("unknown", std::vector<std::string>{"nope"}),
+                 std::invalid_argument);
+    EXPECT_THROW(coordinator.execute_workflow("never_created"), std::out_of_range);
+}
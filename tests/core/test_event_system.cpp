@@ -1,6 +1,10 @@
 #include <gtest/gtest.h>
+#include <cortan/core/alloc_tracking.hpp>
 #include <cortan/core/event_system.hpp>
 
+using namespace cortan::core;
+using alloc_tracking::Subsystem;
+
 class EventSystemTest : public ::testing::Test {
 protected:
     void SetUp() override {}
@@ -11,3 +15,40 @@ TEST_F(EventSystemTest, BaseEventCreation) {
     // TODO: Implement event system tests
     EXPECT_TRUE(true);
 }
+
+// ============================================================================
+// Allocation budgets (guard against regressions on the publish path)
+// ============================================================================
+
+TEST_F(EventSystemTest, PublishWithoutSubscribersAllocationBudget) {
+    ASSERT_TRUE(alloc_tracking::hook_installed());
+
+    EventBus bus;
+    auto event = BaseEvent::create("test.unhandled");
+
+    // Shared state and result slot of the returned (already ready) future
+    auto counters = alloc_tracking::measure(Subsystem::Events, [&] {
+        bus.publish("test.unhandled", event).get();
+    });
+    EXPECT_LE(counters.allocations, 2u);
+}
+
+TEST_F(EventSystemTest, PublishWithOneHandlerAllocationBudget) {
+    ASSERT_TRUE(alloc_tracking::hook_installed());
+
+    EventBus bus;
+    bus.subscribe("test.handled", [](const BaseEvent&) {
+        std::promise<void> done;
+        done.set_value();
+        return done.get_future();
+    });
+    auto event = BaseEvent::create("test.handled");
+
+    // Counted on the publishing thread only: handler snapshot, async state,
+    // its result slot and the dispatch thread. Lower this budget when
+    // publish gets cheaper.
+    auto counters = alloc_tracking::measure(Subsystem::Events, [&] {
+        bus.publish("test.handled", event).get();
+    });
+    EXPECT_LE(counters.allocations, 4u);
+}
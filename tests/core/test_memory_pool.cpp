@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <cortan/core/allocator.hpp>
+#include <cortan/core/memory_pool.hpp>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace cortan::core;
+
+TEST(MemoryPoolTest, HandsOutEveryBlockOnce) {
+    MemoryPool pool(24, 8);
+    EXPECT_EQ(pool.block_size(), 32u);
+
+    std::set<void*> blocks;
+    for (size_t i = 0; i < pool.capacity(); ++i) {
+        void* ptr = pool.allocate();
+        ASSERT_NE(ptr, nullptr);
+        EXPECT_TRUE(pool.owns(ptr));
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % MemoryPool::kBlockAlignment, 0u);
+        blocks.insert(ptr);
+    }
+    EXPECT_EQ(blocks.size(), pool.capacity());
+    EXPECT_EQ(pool.allocate(), nullptr);
+
+    pool.deallocate(*blocks.begin());
+    EXPECT_EQ(pool.available(), 1u);
+    EXPECT_EQ(pool.allocate(), *blocks.begin());
+}
+
+TEST(CustomAllocatorTest, SizeClassesCoverRange) {
+    size_t previous = 0;
+    for (size_t index = 0; index < CustomAllocator::kNumSizeClasses; ++index) {
+        size_t bytes = CustomAllocator::size_class_bytes(index);
+        EXPECT_GT(bytes, previous);
+        EXPECT_EQ(CustomAllocator::size_class_index(bytes), index);
+        EXPECT_EQ(CustomAllocator::size_class_index(previous + 1), index);
+        previous = bytes;
+    }
+    EXPECT_EQ(previous, CustomAllocator::kMaxBlockSize);
+}
+
+TEST(CustomAllocatorTest, ServesPmrContainers) {
+    CustomAllocator allocator;
+    {
+        std::pmr::vector<int> values{&allocator};
+        for (int i = 0; i < 100; ++i) {
+            values.push_back(i);
+        }
+        EXPECT_EQ(values[99], 99);
+        EXPECT_GT(allocator.stats().bytes_requested, 0u);
+    }
+    EXPECT_EQ(allocator.stats().bytes_requested, 0u);
+    EXPECT_EQ(allocator.stats().upstream_bytes, 0u);
+}
+
+TEST(CustomAllocatorTest, LargeAndOveralignedGoUpstream) {
+    CustomAllocator allocator;
+    void* large = allocator.allocate(CustomAllocator::kMaxBlockSize + 1);
+    void* aligned = allocator.allocate(64, 64);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 64, 0u);
+    EXPECT_EQ(allocator.stats().upstream_bytes, CustomAllocator::kMaxBlockSize + 1 + 64);
+
+    allocator.deallocate(large, CustomAllocator::kMaxBlockSize + 1);
+    allocator.deallocate(aligned, 64, 64);
+    EXPECT_EQ(allocator.stats().upstream_bytes, 0u);
+}
+
+TEST(CustomAllocatorTest, CrossThreadFreesBalance) {
+    CustomAllocator allocator;
+    std::vector<void*> blocks;
+    for (int i = 0; i < 1000; ++i) {
+        blocks.push_back(allocator.allocate(48));
+    }
+
+    std::thread releaser([&] {
+        for (void* ptr : blocks) {
+            allocator.deallocate(ptr, 48);
+        }
+    });
+    releaser.join();
+
+    auto stats = allocator.stats();
+    EXPECT_EQ(stats.bytes_requested, 0u);
+    EXPECT_EQ(stats.allocations, 1000u);
+}
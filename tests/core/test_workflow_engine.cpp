@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <cortan/core/alloc_tracking.hpp>
+#include <cortan/core/frame_allocator.hpp>
+#include <cortan/core/workflow_engine.hpp>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace cortan::core;
+using namespace std::chrono_literals;
+
+class WorkflowEngineTest : public ::testing::Test {
+protected:
+    WorkflowEngine engine{4};
+};
+
+namespace {
+
+WorkflowTask<int> add(int a, int b) {
+    co_return a + b;
+}
+
+WorkflowTask<int> sum_chain(int depth) {
+    if (depth == 0) co_return 0;
+    co_return 1 + co_await sum_chain(depth - 1);
+}
+
+WorkflowTask<int> failing_step() {
+    throw std::runtime_error("step failed");
+    co_return 0;
+}
+
+WorkflowTask<void> record(std::atomic<int>& counter) {
+    counter.fetch_add(1);
+    co_return;
+}
+
+} // namespace
+
+TEST_F(WorkflowEngineTest, TasksAreLazy) {
+    std::atomic<int> counter{0};
+    auto task = record(counter);
+    EXPECT_FALSE(task.ready());
+    EXPECT_EQ(counter.load(), 0);
+
+    engine.start(std::move(task)).get();
+    EXPECT_EQ(counter.load(), 1);
+}
+
+TEST_F(WorkflowEngineTest, AwaitsChildTasks) {
+    auto parent = [](WorkflowEngine& e) -> WorkflowTask<int> {
+        co_await e.schedule();
+        int x = co_await add(1, 2);
+        int y = co_await add(x, 4);
+        co_return y;
+    };
+    EXPECT_EQ(engine.start(parent(engine)).get(), 7);
+}
+
+TEST_F(WorkflowEngineTest, DeepAwaitChain) {
+    EXPECT_EQ(engine.start(sum_chain(10000)).get(), 10000);
+}
+
+TEST_F(WorkflowEngineTest, PropagatesExceptionsToAwaiter) {
+    auto parent = []() -> WorkflowTask<std::string> {
+        try {
+            co_await failing_step();
+        } catch (const std::runtime_error& e) {
+            co_return std::string("caught: ") + e.what();
+        }
+        co_return "unreachable";
+    };
+    EXPECT_EQ(engine.start(parent()).get(), "caught: step failed");
+    EXPECT_THROW(engine.start(failing_step()).get(), std::runtime_error);
+}
+
+TEST_F(WorkflowEngineTest, RegisteredWorkflows) {
+    engine.registerWorkflow<int>("answer", [](WorkflowEngine&) -> WorkflowTask<int> {
+        co_return co_await add(40, 2);
+    });
+    EXPECT_TRUE(engine.hasWorkflow("answer"));
+    EXPECT_EQ(engine.start(engine.executeWorkflow<int>("answer")).get(), 42);
+    EXPECT_THROW(engine.executeWorkflow<int>("missing"), std::out_of_range);
+}
+
+TEST_F(WorkflowEngineTest, CancellationStopsAtNextAwaitPoint) {
+    CancellationSource source;
+    Completion<int> gate(&engine.executor());
+    std::atomic<bool> reached_second_step{false};
+
+    auto flow = [&]() -> WorkflowTask<int> {
+        int value = co_await gate;
+        co_await engine.schedule();
+        reached_second_step = true;
+        co_return value;
+    };
+
+    auto result = engine.start(flow(), source.token());
+    source.cancel();
+    gate.set_value(1);
+
+    EXPECT_THROW(result.get(), WorkflowCancelled);
+    EXPECT_FALSE(reached_second_step.load());
+}
+
+TEST_F(WorkflowEngineTest, ManyConcurrentFlowsOnFewThreads) {
+    constexpr int kFlows = 2000;
+    std::vector<Completion<int>> inputs;
+    inputs.reserve(kFlows);
+    for (int i = 0; i < kFlows; ++i) {
+        inputs.emplace_back(&engine.executor());
+    }
+
+    auto flow = [](Completion<int> input) -> WorkflowTask<int> {
+        int value = co_await input;
+        co_return value + co_await add(value, 1);
+    };
+
+    std::vector<std::future<int>> results;
+    results.reserve(kFlows);
+    for (int i = 0; i < kFlows; ++i) {
+        results.push_back(engine.start(flow(inputs[static_cast<size_t>(i)])));
+    }
+
+    // Every flow is suspended without holding one of the four workers
+    std::thread producer([&] {
+        for (int i = 0; i < kFlows; ++i) {
+            inputs[static_cast<size_t>(i)].set_value(i);
+        }
+    });
+    producer.join();
+
+    for (int i = 0; i < kFlows; ++i) {
+        EXPECT_EQ(results[static_cast<size_t>(i)].get(), 2 * i + 1);
+    }
+}
+
+TEST_F(WorkflowEngineTest, CoroutineFramesAreRecycled) {
+    ASSERT_TRUE(alloc_tracking::hook_installed());
+    ASSERT_TRUE(frame_allocator::pooling_enabled());
+
+    auto run_inline = [] {
+        auto task = sum_chain(8);
+        task.coro.resume();
+        EXPECT_EQ(task.result(), 8);
+    };
+
+    run_inline();  // warm the calling thread's frame cache
+    auto counters = alloc_tracking::measure(alloc_tracking::Subsystem::Workflow, run_inline);
+    EXPECT_EQ(counters.allocations, 0u);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <zlib.h>
+
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace cortan::network::test_support {
+
+// zlib encoder for decoder tests: window_bits 16 + MAX_WBITS writes gzip,
+// MAX_WBITS zlib-wrapped deflate and -MAX_WBITS raw deflate
+inline std::string compress(std::string_view data, int window_bits = 16 + MAX_WBITS) {
+    z_stream stream{};
+    if (deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("deflateInit2 failed");
+    }
+    std::string out(deflateBound(&stream, static_cast<uLong>(data.size())), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+    int rc = deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    if (rc != Z_STREAM_END) {
+        throw std::runtime_error("deflate failed");
+    }
+    return out;
+}
+
+inline std::string gzip(std::string_view data) {
+    return compress(data, 16 + MAX_WBITS);
+}
+
+} // namespace cortan::network::test_support
@@ -0,0 +1,190 @@
+#pragma once
+
+#include "local_http_server.hpp"
+
+#include <boost/asio/ssl.hpp>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace cortan::network::test_support {
+
+struct TestCertificate {
+    std::string certificate_pem;
+    std::string private_key_pem;
+};
+
+// Self-signed P-256 certificate valid for localhost and 127.0.0.1
+inline TestCertificate make_test_certificate() {
+    auto fail = [](const char* what) { throw std::runtime_error(std::string("test certificate: ") + what); };
+
+    std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> key(EVP_EC_gen("P-256"), EVP_PKEY_free);
+    std::unique_ptr<X509, decltype(&X509_free)> cert(X509_new(), X509_free);
+    if (!key || !cert) fail("allocation");
+
+    X509_set_version(cert.get(), 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert.get()), -60);
+    X509_gmtime_adj(X509_getm_notAfter(cert.get()), 24 * 3600);
+    X509_set_pubkey(cert.get(), key.get());
+
+    X509_NAME* name = X509_get_subject_name(cert.get());
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                               reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+    X509_set_issuer_name(cert.get(), name);
+
+    X509V3_CTX ctx;
+    X509V3_set_ctx_nodb(&ctx);
+    X509V3_set_ctx(&ctx, cert.get(), cert.get(), nullptr, nullptr, 0);
+    X509_EXTENSION* san = X509V3_EXT_conf_nid(nullptr, &ctx, NID_subject_alt_name, "DNS:localhost,IP:127.0.0.1");
+    if (!san) fail("subjectAltName");
+    X509_add_ext(cert.get(), san, -1);
+    X509_EXTENSION_free(san);
+
+    if (!X509_sign(cert.get(), key.get(), EVP_sha256())) fail("signing");
+
+    auto to_pem = [&](auto write) {
+        std::unique_ptr<BIO, decltype(&BIO_free)> bio(BIO_new(BIO_s_mem()), BIO_free);
+        if (!write(bio.get())) fail("PEM encoding");
+        char* data = nullptr;
+        long size = BIO_get_mem_data(bio.get(), &data);
+        return std::string(data, static_cast<size_t>(size));
+    };
+    TestCertificate result;
+    result.certificate_pem = to_pem([&](BIO* bio) { return PEM_write_bio_X509(bio, cert.get()); });
+    result.private_key_pem = to_pem([&](BIO* bio) {
+        return PEM_write_bio_PrivateKey(bio, key.get(), nullptr, nullptr, 0, nullptr, nullptr);
+    });
+    return result;
+}
+
+// HTTPS counterpart of LocalHttpServer with the same handler interface.
+// Counts full and resumed handshakes; session tickets can be switched off to
+// force full handshakes from the server side.
+class LocalTlsServer {
+public:
+    using Request = LocalHttpServer::Request;
+    using Response = LocalHttpServer::Response;
+    using Handler = LocalHttpServer::Handler;
+
+    explicit LocalTlsServer(Handler handler = LocalHttpServer::echo_handler(), bool session_tickets = true)
+        : certificate_(make_test_certificate())
+        , handler_(std::move(handler))
+        , ssl_context_(boost::asio::ssl::context::tls_server)
+        , acceptor_(io_context_, {boost::asio::ip::make_address("127.0.0.1"), 0}) {
+        ssl_context_.use_certificate(boost::asio::buffer(certificate_.certificate_pem),
+                                     boost::asio::ssl::context::pem);
+        ssl_context_.use_private_key(boost::asio::buffer(certificate_.private_key_pem),
+                                     boost::asio::ssl::context::pem);
+        if (!session_tickets) {
+            SSL_CTX_set_options(ssl_context_.native_handle(), SSL_OP_NO_TICKET);
+            SSL_CTX_set_session_cache_mode(ssl_context_.native_handle(), SSL_SESS_CACHE_OFF);
+            SSL_CTX_set_num_tickets(ssl_context_.native_handle(), 0);
+        }
+        accept_thread_ = std::thread([this] { accept_loop(); });
+    }
+
+    ~LocalTlsServer() { stop(); }
+
+    LocalTlsServer(const LocalTlsServer&) = delete;
+    LocalTlsServer& operator=(const LocalTlsServer&) = delete;
+
+    unsigned short port() const { return acceptor_.local_endpoint().port(); }
+    std::string url(const std::string& target = "/") const {
+        return "https://127.0.0.1:" + std::to_string(port()) + target;
+    }
+    const std::string& certificate_pem() const { return certificate_.certificate_pem; }
+
+    size_t full_handshakes() const { return full_handshakes_.load(); }
+    size_t resumed_handshakes() const { return resumed_handshakes_.load(); }
+
+    void stop() {
+        if (stopped_.exchange(true)) {
+            return;
+        }
+        boost::system::error_code ec;
+        boost::asio::ip::tcp::socket waker(io_context_);
+        waker.connect(acceptor_.local_endpoint(), ec);
+        if (accept_thread_.joinable()) accept_thread_.join();
+        acceptor_.close(ec);
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& socket : sockets_) {
+            socket->shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+        }
+        for (auto& thread : connection_threads_) {
+            thread.join();
+        }
+    }
+
+private:
+    void accept_loop() {
+        while (!stopped_) {
+            auto socket = std::make_shared<boost::asio::ip::tcp::socket>(io_context_);
+            boost::system::error_code ec;
+            acceptor_.accept(*socket, ec);
+            if (ec || stopped_) return;
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            sockets_.push_back(socket);
+            connection_threads_.emplace_back([this, socket] { serve(*socket); });
+        }
+    }
+
+    void serve(boost::asio::ip::tcp::socket& socket) {
+        namespace http = boost::beast::http;
+        // Back-to-back responses to pipelined requests must not wait on
+        // Nagle; production servers disable it too
+        boost::system::error_code ignored;
+        socket.set_option(boost::asio::ip::tcp::no_delay(true), ignored);
+        boost::asio::ssl::stream<boost::asio::ip::tcp::socket&> stream(socket, ssl_context_);
+        boost::system::error_code ec;
+        stream.handshake(boost::asio::ssl::stream_base::server, ec);
+        if (ec) return;
+        if (SSL_session_reused(stream.native_handle())) {
+            ++resumed_handshakes_;
+        } else {
+            ++full_handshakes_;
+        }
+
+        boost::beast::flat_buffer buffer;
+        while (true) {
+            Request req;
+            http::read(stream, buffer, req, ec);
+            if (ec) break;
+
+            Response res{http::status::ok, req.version()};
+            res.keep_alive(req.keep_alive());
+            handler_(req, res);
+            res.prepare_payload();
+
+            http::write(stream, res, ec);
+            if (ec || !res.keep_alive()) break;
+        }
+        socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+    }
+
+    TestCertificate certificate_;
+    Handler handler_;
+    boost::asio::ssl::context ssl_context_;
+    boost::asio::io_context io_context_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    std::thread accept_thread_;
+
+    std::mutex mutex_;
+    std::list<std::shared_ptr<boost::asio::ip::tcp::socket>> sockets_;
+    std::list<std::thread> connection_threads_;
+
+    std::atomic<bool> stopped_{false};
+    std::atomic<size_t> full_handshakes_{0};
+    std::atomic<size_t> resumed_handshakes_{0};
+};
+
+} // namespace cortan::network::test_support
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace cortan::network::test_support {
+
+// Minimal WebSocket server on 127.0.0.1 for network tests. Connections are
+// served asynchronously on one thread of its own; every message goes to the
+// handler, whose reply (if any) is sent back with the same text/binary type.
+class LocalWebSocketServer {
+public:
+    using Handler = std::function<std::optional<std::string>(std::string_view message, bool is_text)>;
+
+    explicit LocalWebSocketServer(Handler handler = echo_handler(), bool permessage_deflate = true)
+        : handler_(std::move(handler))
+        , permessage_deflate_(permessage_deflate)
+        , acceptor_(io_context_, {boost::asio::ip::make_address("127.0.0.1"), 0})
+        , port_(acceptor_.local_endpoint().port()) {
+        accept_next();
+        thread_ = std::thread([this] { io_context_.run(); });
+    }
+
+    ~LocalWebSocketServer() { stop(); }
+
+    LocalWebSocketServer(const LocalWebSocketServer&) = delete;
+    LocalWebSocketServer& operator=(const LocalWebSocketServer&) = delete;
+
+    unsigned short port() const { return port_; }
+    std::string url(const std::string& target = "/") const {
+        return "ws://127.0.0.1:" + std::to_string(port()) + target;
+    }
+
+    size_t connections_accepted() const { return accepted_.load(); }
+    size_t messages_received() const { return messages_.load(); }
+
+    // Keeps a copy of every message received from now on, in order
+    void set_recording(bool record) { recording_ = record; }
+    std::vector<std::string> received() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return received_;
+    }
+
+    // Drops every open connection without a close frame
+    void close_connections() {
+        boost::asio::post(io_context_, [this] {
+            for (auto& weak : sessions_) {
+                if (auto session = weak.lock()) {
+                    boost::system::error_code ec;
+                    boost::beast::get_lowest_layer(session->ws).close(ec);
+                }
+            }
+            sessions_.clear();
+        });
+    }
+
+    void stop() {
+        if (stopped_.exchange(true)) {
+            return;
+        }
+        close_connections();
+        boost::asio::post(io_context_, [this] {
+            boost::system::error_code ec;
+            acceptor_.close(ec);
+        });
+        thread_.join();
+    }
+
+    static Handler echo_handler() {
+        return [](std::string_view message, bool) { return std::string(message); };
+    }
+
+private:
+    struct Session {
+        explicit Session(boost::asio::ip::tcp::socket socket) : ws(std::move(socket)) {}
+
+        boost::beast::websocket::stream<boost::asio::ip::tcp::socket> ws;
+        boost::beast::flat_buffer buffer;
+        std::string reply;
+    };
+
+    void accept_next() {
+        acceptor_.async_accept([this](const boost::system::error_code& ec, boost::asio::ip::tcp::socket socket) {
+            if (ec) return;
+            ++accepted_;
+            boost::system::error_code ignored;
+            socket.set_option(boost::asio::ip::tcp::no_delay(true), ignored);
+
+            auto session = std::make_shared<Session>(std::move(socket));
+            namespace websocket = boost::beast::websocket;
+            websocket::permessage_deflate deflate;
+            deflate.server_enable = permessage_deflate_;
+            session->ws.set_option(deflate);
+            session->ws.read_message_max(64 * 1024 * 1024);
+            sessions_.push_back(session);
+            session->ws.async_accept([this, session](const boost::system::error_code& ec) {
+                if (!ec) read_next(session);
+            });
+            accept_next();
+        });
+    }
+
+    void read_next(const std::shared_ptr<Session>& session) {
+        session->ws.async_read(session->buffer, [this, session](const boost::system::error_code& ec, size_t) {
+            if (ec) return;
+            ++messages_;
+            bool is_text = session->ws.got_text();
+            auto data = session->buffer.cdata();
+            std::string_view message(static_cast<const char*>(data.data()), data.size());
+            if (recording_) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                received_.emplace_back(message);
+            }
+            auto reply = handler_(message, is_text);
+            session->buffer.consume(session->buffer.size());
+            if (!reply) {
+                return read_next(session);
+            }
+            session->reply = std::move(*reply);
+            session->ws.text(is_text);
+            session->ws.async_write(boost::asio::buffer(session->reply),
+                [this, session](const boost::system::error_code& ec, size_t) {
+                    if (!ec) read_next(session);
+                });
+        });
+    }
+
+    Handler handler_;
+    bool permessage_deflate_;
+    boost::asio::io_context io_context_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    unsigned short port_;
+    std::thread thread_;
+    std::vector<std::weak_ptr<Session>> sessions_;   // server thread only
+
+    mutable std::mutex mutex_;
+    std::vector<std::string> received_;
+
+    std::atomic<bool> stopped_{false};
+    std::atomic<bool> recording_{false};
+    std::atomic<size_t> accepted_{0};
+    std::atomic<size_t> messages_{0};
+};
+
+} // namespace cortan::network::test_support
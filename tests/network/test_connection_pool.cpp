@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+#include <cortan/network/connection_pool.hpp>
+#include <cortan/network/http_client.hpp>
+#include "local_http_server.hpp"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace cortan::network;
+using test_support::LocalHttpServer;
+using namespace std::chrono_literals;
+
+class ConnectionPoolTest : public ::testing::Test {
+protected:
+    LocalHttpServer server;
+};
+
+TEST_F(ConnectionPoolTest, SequentialRequestsReuseOneConnection) {
+    HttpClient client;
+    for (int i = 0; i < 5; ++i) {
+        auto [ok, body] = client.get(server.url("/ping")).get();
+        ASSERT_TRUE(ok) << body;
+        EXPECT_EQ(body, "/ping");
+    }
+    auto [ok, body] = client.post(server.url("/generate"), "{}").get();
+    ASSERT_TRUE(ok) << body;
+    EXPECT_EQ(body, "/generate {}");
+
+    EXPECT_EQ(server.connections_accepted(), 1u);
+    EXPECT_EQ(server.requests_served(), 6u);
+
+    auto stats = client.connection_pool()->stats();
+    EXPECT_EQ(stats.created, 1u);
+    EXPECT_EQ(stats.reused, 5u);
+    EXPECT_EQ(stats.idle, 1u);
+}
+
+TEST_F(ConnectionPoolTest, ServerCloseIsDetectedOnCheckout) {
+    HttpClient client;
+    ASSERT_TRUE(client.get(server.url()).get().first);
+
+    server.close_connections();
+    std::this_thread::sleep_for(20ms);
+
+    auto [ok, body] = client.get(server.url()).get();
+    ASSERT_TRUE(ok) << body;
+    EXPECT_EQ(server.connections_accepted(), 2u);
+    EXPECT_EQ(client.connection_pool()->stats().evicted, 1u);
+}
+
+TEST_F(ConnectionPoolTest, ConnectionCloseResponsesAreNotPooled) {
+    LocalHttpServer closing_server([](const LocalHttpServer::Request&, LocalHttpServer::Response& res) {
+        res.keep_alive(false);
+        res.body() = "bye";
+    });
+    HttpClient client;
+    ASSERT_TRUE(client.get(closing_server.url()).get().first);
+    ASSERT_TRUE(client.get(closing_server.url()).get().first);
+
+    EXPECT_EQ(closing_server.connections_accepted(), 2u);
+    EXPECT_EQ(client.connection_pool()->stats().idle, 0u);
+}
+
+TEST_F(ConnectionPoolTest, IdleTimeoutEvictsConnections) {
+    ConnectionPoolConfig config;
+    config.idle_timeout = 30ms;
+    HttpClient client(std::make_shared<ConnectionPool>(config));
+
+    ASSERT_TRUE(client.get(server.url()).get().first);
+    std::this_thread::sleep_for(60ms);
+    EXPECT_EQ(client.connection_pool()->evict_idle(), 1u);
+
+    ASSERT_TRUE(client.get(server.url()).get().first);
+    EXPECT_EQ(server.connections_accepted(), 2u);
+}
+
+TEST_F(ConnectionPoolTest, MaxPerHostLimitsCheckouts) {
+    ConnectionPoolConfig config;
+    config.max_per_host = 2;
+    config.acquire_timeout = 50ms;
+    ConnectionPool pool(config);
+    ConnectionKey key{"http", "127.0.0.1", std::to_string(server.port())};
+
+    auto first = pool.get_connection(key);
+    auto second = pool.get_connection(key);
+    EXPECT_THROW(pool.get_connection(key), std::runtime_error);
+
+    // Other origins are unaffected
+    auto other = pool.get_connection("http://localhost:1");
+    EXPECT_EQ(other->key().port, "1");
+
+    // A slot released by another thread wakes the waiter
+    std::thread releaser([&] {
+        std::this_thread::sleep_for(10ms);
+        pool.return_connection(std::move(first));
+    });
+    EXPECT_NO_THROW(pool.get_connection(key));
+    releaser.join();
+}
+
+TEST_F(ConnectionPoolTest, ConcurrentRequestsShareFewConnections) {
+    ConnectionPoolConfig config;
+    config.max_per_host = 16;
+    IoRuntime runtime(2);
+    HttpClient client(std::make_shared<ConnectionPool>(config, runtime));
+
+    // All requests are in flight at once; the runtime's two threads drive
+    // them over at most 16 connections
+    constexpr int kRequests = 2000;
+    std::vector<std::future<std::pair<bool, std::string>>> responses;
+    responses.reserve(kRequests);
+    for (int i = 0; i < kRequests; ++i) {
+        responses.push_back(client.get(server.url("/r" + std::to_string(i))));
+    }
+    for (int i = 0; i < kRequests; ++i) {
+        auto [ok, body] = responses[static_cast<size_t>(i)].get();
+        ASSERT_TRUE(ok) << body;
+        EXPECT_EQ(body, "/r" + std::to_string(i));
+    }
+
+    EXPECT_LE(server.connections_accepted(), 16u);
+    EXPECT_EQ(server.requests_served(), static_cast<size_t>(kRequests));
+}
+
+TEST_F(ConnectionPoolTest, TimeoutCancelsInFlightRequest) {
+    LocalHttpServer slow_server([](const LocalHttpServer::Request&, LocalHttpServer::Response& res) {
+        std::this_thread::sleep_for(500ms);
+        res.body() = "late";
+    });
+    HttpClient client;
+
+    auto started = std::chrono::steady_clock::now();
+    auto [ok, body] = client.get(slow_server.url(), 50ms).get();
+    auto elapsed = std::chrono::steady_clock::now() - started;
+
+    EXPECT_FALSE(ok);
+    EXPECT_NE(body.find("timed out"), std::string::npos) << body;
+    EXPECT_LT(elapsed, 400ms);
+
+    // The aborted connection is not pooled
+    auto stats = client.connection_pool()->stats();
+    EXPECT_EQ(stats.idle, 0u);
+    EXPECT_EQ(stats.active, 0u);
+}
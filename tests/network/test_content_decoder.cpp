@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <cortan/network/content_decoder.hpp>
+#include "compression_helpers.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace cortan::network;
+using test_support::compress;
+using test_support::gzip;
+
+namespace {
+
+// Feeds the encoded data in pieces of the given size
+std::string decode(std::string_view encoding, std::string_view encoded, size_t piece = 4096) {
+    auto decoder = ContentDecoder::create(encoding);
+    EXPECT_NE(decoder, nullptr);
+    std::string decoded;
+    for (size_t offset = 0; offset < encoded.size(); offset += piece) {
+        decoder->decode(encoded.substr(offset, piece), [&decoded](std::string_view block) {
+            EXPECT_LE(block.size(), ContentDecoder::kOutputBlockBytes);
+            decoded.append(block);
+            return true;
+        });
+    }
+    decoder->finish();
+    return decoded;
+}
+
+std::string sample_json(size_t models) {
+    std::string json = "{\"models\":[";
+    for (size_t i = 0; i < models; ++i) {
+        json += (i ? "," : "") + std::string("{\"name\":\"model-") + std::to_string(i) +
+                "\",\"size\":" + std::to_string(i * 7919) + "}";
+    }
+    return json + "]}";
+}
+
+} // namespace
+
+TEST(ContentDecoderTest, GzipDecodesWhateverTheInputSplits) {
+    const std::string json = sample_json(5000);
+    const std::string encoded = gzip(json);
+    ASSERT_LT(encoded.size(), json.size() / 4);
+
+    EXPECT_EQ(decode("gzip", encoded), json);
+    EXPECT_EQ(decode("gzip", encoded, 1), json);
+    EXPECT_EQ(decode(" X-GZIP ", encoded, encoded.size()), json);
+}
+
+TEST(ContentDecoderTest, DeflateAcceptsZlibWrappedAndRawData) {
+    const std::string json = sample_json(200);
+    EXPECT_EQ(decode("deflate", compress(json, MAX_WBITS), 1), json);
+    EXPECT_EQ(decode("deflate", compress(json, -MAX_WBITS), 1), json);
+}
+
+TEST(ContentDecoderTest, ConcatenatedGzipMembersAreOneBody) {
+    EXPECT_EQ(decode("gzip", gzip("first ") + gzip("second")), "first second");
+}
+
+TEST(ContentDecoderTest, CorruptOrTruncatedInputThrows) {
+    const std::string encoded = gzip(sample_json(100));
+    EXPECT_THROW(decode("gzip", encoded.substr(0, encoded.size() / 2)), DecodeError);
+
+    std::string corrupt = encoded;
+    corrupt[corrupt.size() / 2] = static_cast<char>(corrupt[corrupt.size() / 2] ^ 0x55);
+    corrupt[corrupt.size() / 2 + 1] = static_cast<char>(corrupt[corrupt.size() / 2 + 1] ^ 0x55);
+    EXPECT_THROW(decode("gzip", corrupt), DecodeError);
+
+    EXPECT_THROW(decode("gzip", "definitely not gzip"), DecodeError);
+}
+
+TEST(ContentDecoderTest, SinkCanStopDecoding) {
+    const std::string encoded = gzip(std::string(ContentDecoder::kOutputBlockBytes * 8, 'a'));
+    auto decoder = ContentDecoder::create("gzip");
+    size_t blocks = 0;
+    bool finished = decoder->decode(encoded, [&blocks](std::string_view) { return ++blocks < 2; });
+    EXPECT_FALSE(finished);
+    EXPECT_EQ(blocks, 2u);
+}
+
+TEST(ContentDecoderTest, EncodingNegotiation) {
+    EXPECT_EQ(ContentDecoder::create(""), nullptr);
+    EXPECT_EQ(ContentDecoder::create("identity"), nullptr);
+    EXPECT_THROW(ContentDecoder::create("br"), DecodeError);
+    EXPECT_THROW(ContentDecoder::create("gzip, br"), DecodeError);
+    EXPECT_FALSE(ContentDecoder::supports("br"));
+
+    const std::string& accepted = ContentDecoder::accept_encoding();
+    EXPECT_NE(accepted.find("gzip"), std::string::npos);
+    EXPECT_NE(accepted.find("deflate"), std::string::npos);
+    EXPECT_EQ(accepted.find("zstd") != std::string::npos, ContentDecoder::supports("zstd"));
+}
+
+TEST(ContentDecoderTest, ZstdFrame) {
+    if (!ContentDecoder::supports("zstd")) {
+        GTEST_SKIP() << "built without libzstd";
+    }
+    // "zstd-encoded model list" as a single-frame zstd stream
+    const unsigned char frame[] = {
+        0x28, 0xb5, 0x2f, 0xfd, 0x20, 0x17, 0xb9, 0x00, 0x00, 0x7a, 0x73, 0x74,
+        0x64, 0x2d, 0x65, 0x6e, 0x63, 0x6f, 0x64, 0x65, 0x64, 0x20, 0x6d, 0x6f,
+        0x64, 0x65, 0x6c, 0x20, 0x6c, 0x69, 0x73, 0x74,
+    };
+    std::string_view encoded(reinterpret_cast<const char*>(frame), sizeof(frame));
+    EXPECT_EQ(decode("zstd", encoded, 3), "zstd-encoded model list");
+    EXPECT_THROW(decode("zstd", encoded.substr(0, 20)), DecodeError);
+}
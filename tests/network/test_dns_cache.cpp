@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <cortan/network/dns_cache.hpp>
+#include <cortan/network/http_client.hpp>
+#include "local_http_server.hpp"
+
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+using namespace cortan::network;
+using test_support::LocalHttpServer;
+using namespace std::chrono_literals;
+
+namespace {
+
+std::pair<boost::system::error_code, DnsCache::Results> resolve(DnsCache& cache, const std::string& host,
+                                                                const std::string& port) {
+    std::promise<std::pair<boost::system::error_code, DnsCache::Results>> result;
+    auto future = result.get_future();
+    cache.async_resolve(host, port, [&result](const boost::system::error_code& ec, DnsCache::Results results) {
+        result.set_value({ec, std::move(results)});
+    });
+    return future.get();
+}
+
+} // namespace
+
+TEST(DnsCacheTest, RepeatedLookupsAreServedFromCache) {
+    DnsCache cache;
+    auto [ec, results] = resolve(cache, "localhost", "80");
+    ASSERT_FALSE(ec) << ec.message();
+    ASSERT_FALSE(results.empty());
+
+    for (int i = 0; i < 5; ++i) {
+        auto [cached_ec, cached] = resolve(cache, "localhost", "80");
+        EXPECT_FALSE(cached_ec);
+        EXPECT_EQ(cached.begin()->endpoint(), results.begin()->endpoint());
+    }
+
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.lookups, 1u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.hits, 5u);
+}
+
+TEST(DnsCacheTest, ConcurrentMissesShareOneLookup) {
+    DnsCache cache;
+    std::vector<std::promise<boost::system::error_code>> done(16);
+    for (auto& promise : done) {
+        cache.async_resolve("localhost", "443", [&promise](const boost::system::error_code& ec, DnsCache::Results) {
+            promise.set_value(ec);
+        });
+    }
+    for (auto& promise : done) {
+        EXPECT_FALSE(promise.get_future().get());
+    }
+    EXPECT_EQ(cache.stats().lookups, 1u);
+}
+
+TEST(DnsCacheTest, FailuresAreCachedForTheNegativeTtl) {
+    DnsCacheConfig config;
+    config.negative_ttl = 100ms;
+    DnsCache cache(config);
+
+    auto [first_ec, first] = resolve(cache, "no-such-host.invalid", "80");
+    ASSERT_TRUE(first_ec);
+    auto [second_ec, second] = resolve(cache, "no-such-host.invalid", "80");
+    EXPECT_EQ(second_ec, first_ec);
+    EXPECT_EQ(cache.stats().negative_hits, 1u);
+    EXPECT_EQ(cache.stats().lookups, 1u);
+
+    std::this_thread::sleep_for(150ms);
+    resolve(cache, "no-such-host.invalid", "80");
+    EXPECT_EQ(cache.stats().lookups, 2u);
+}
+
+TEST(DnsCacheTest, HitsNearExpiryRefreshInTheBackground) {
+    DnsCacheConfig config;
+    config.ttl = 200ms;
+    config.refresh_ahead = 0.25;
+    DnsCache cache(config);
+
+    ASSERT_FALSE(resolve(cache, "localhost", "80").first);
+    std::this_thread::sleep_for(80ms);
+
+    // Past the refresh point: answered from cache, lookup started behind it
+    ASSERT_FALSE(resolve(cache, "localhost", "80").first);
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.refreshes, 1u);
+
+    // The refreshed entry outlives the original TTL without another miss
+    std::this_thread::sleep_for(150ms);
+    ASSERT_FALSE(resolve(cache, "localhost", "80").first);
+    EXPECT_EQ(cache.stats().misses, 1u);
+}
+
+TEST(DnsCacheTest, ClientsShareTheCache) {
+    // Closing every connection forces each request to connect, and so resolve
+    LocalHttpServer server([](const LocalHttpServer::Request&, LocalHttpServer::Response& res) {
+        res.keep_alive(false);
+        res.body() = "ok";
+    });
+    auto dns = std::make_shared<DnsCache>();
+    HttpClient first(std::make_shared<ConnectionPool>(), dns);
+    HttpClient second(std::make_shared<ConnectionPool>(), dns);
+    std::string url = "http://localhost:" + std::to_string(server.port()) + "/";
+
+    for (int i = 0; i < 3; ++i) {
+        auto [ok, body] = first.get(url).get();
+        ASSERT_TRUE(ok) << body;
+        ASSERT_TRUE(second.get(url).get().first);
+    }
+    EXPECT_EQ(dns->stats().lookups, 1u);
+    EXPECT_EQ(dns->stats().hits, 5u);
+}
@@ -0,0 +1,495 @@
+#include <gtest/gtest.h>
+#include <cortan/network/content_decoder.hpp>
+#include <cortan/network/http_client.hpp>
+#include "local_http_server.hpp"
+#include "compression_helpers.hpp"
+
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cortan::network;
+using test_support::LocalHttpServer;
+using namespace std::chrono_literals;
+
+class HttpClientStreamTest : public ::testing::Test {
+protected:
+    LocalHttpServer server;
+    HttpClient client;
+
+    // Collects chunks from the runtime thread
+    struct Collector {
+        std::mutex mutex;
+        std::vector<std::string> chunks;
+        std::vector<std::chrono::steady_clock::time_point> arrivals;
+
+        HttpClient::ChunkHandler handler(size_t stop_after = 0) {
+            return [this, stop_after](std::string_view chunk) {
+                std::lock_guard<std::mutex> lock(mutex);
+                chunks.emplace_back(chunk);
+                arrivals.push_back(std::chrono::steady_clock::now());
+                return stop_after == 0 || chunks.size() < stop_after;
+            };
+        }
+
+        std::string joined() {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::string all;
+            for (const auto& chunk : chunks) all += chunk;
+            return all;
+        }
+    };
+};
+
+TEST_F(HttpClientStreamTest, ChunksArriveBeforeTheStreamEnds) {
+    server.set_streamer([](const LocalHttpServer::Request&, const LocalHttpServer::ChunkWriter& write) {
+        for (const char* token : {"Hello", ", ", "world"}) {
+            write(token);
+            std::this_thread::sleep_for(100ms);
+        }
+    });
+
+    Collector collector;
+    auto started = std::chrono::steady_clock::now();
+    auto [ok, error] = client.post_stream(server.url("/api/generate"), "{}", collector.handler()).get();
+    auto finished = std::chrono::steady_clock::now();
+
+    ASSERT_TRUE(ok) << error;
+    EXPECT_EQ(collector.joined(), "Hello, world");
+    ASSERT_EQ(collector.chunks.size(), 3u);
+    EXPECT_LT(collector.arrivals.front() - started, 150ms);
+    EXPECT_GE(finished - collector.arrivals.front(), 200ms);
+
+    // A completed stream leaves the connection reusable
+    EXPECT_EQ(client.connection_pool()->stats().idle, 1u);
+}
+
+TEST_F(HttpClientStreamTest, ContentLengthBodiesAreDeliveredInPieces) {
+    std::string payload(100 * 1024, 'x');
+    LocalHttpServer fixed_server([&payload](const LocalHttpServer::Request&, LocalHttpServer::Response& res) {
+        res.body() = payload;
+    });
+
+    Collector collector;
+    auto [ok, error] = client.get_stream(fixed_server.url(), collector.handler()).get();
+
+    ASSERT_TRUE(ok) << error;
+    EXPECT_EQ(collector.joined(), payload);
+    EXPECT_GT(collector.chunks.size(), 1u);
+    for (const auto& chunk : collector.chunks) {
+        EXPECT_LE(chunk.size(), 16u * 1024);
+    }
+}
+
+TEST_F(HttpClientStreamTest, HandlerCanStopTheStream) {
+    server.set_streamer([](const LocalHttpServer::Request&, const LocalHttpServer::ChunkWriter& write) {
+        for (int i = 0; i < 50 && write("token "); ++i) {
+            std::this_thread::sleep_for(5ms);
+        }
+    });
+
+    Collector collector;
+    auto [ok, error] = client.get_stream(server.url(), collector.handler(2)).get();
+
+    ASSERT_TRUE(ok) << error;
+    EXPECT_EQ(collector.chunks.size(), 2u);
+    // The rest of the body was never read, so the connection is dropped
+    EXPECT_EQ(client.connection_pool()->stats().idle, 0u);
+}
+
+TEST_F(HttpClientStreamTest, TimeoutAppliesBetweenChunks) {
+    server.set_streamer([](const LocalHttpServer::Request&, const LocalHttpServer::ChunkWriter& write) {
+        for (int i = 0; i < 5; ++i) {
+            write("tick");
+            std::this_thread::sleep_for(60ms);
+        }
+    });
+
+    // 300ms of streaming under a 150ms timeout: every gap is shorter
+    Collector collector;
+    auto [ok, error] = client.get_stream(server.url(), collector.handler(), 150ms).get();
+    ASSERT_TRUE(ok) << error;
+    EXPECT_EQ(collector.chunks.size(), 5u);
+
+    server.set_streamer([](const LocalHttpServer::Request&, const LocalHttpServer::ChunkWriter& write) {
+        write("tick");
+        std::this_thread::sleep_for(300ms);
+        write("late");
+    });
+    Collector stalled;
+    auto [stalled_ok, stalled_error] = client.get_stream(server.url(), stalled.handler(), 150ms).get();
+    EXPECT_FALSE(stalled_ok);
+    EXPECT_NE(stalled_error.find("timed out"), std::string::npos) << stalled_error;
+    EXPECT_EQ(stalled.joined(), "tick");
+}
+
+TEST_F(HttpClientStreamTest, DeadlineBoundsTheWholeStream) {
+    server.set_streamer([](const LocalHttpServer::Request&, const LocalHttpServer::ChunkWriter& write) {
+        for (int i = 0; i < 20; ++i) {
+            if (!write("tick")) return;
+            std::this_thread::sleep_for(50ms);
+        }
+    });
+
+    // Every gap is well inside the timeout; the deadline still ends it
+    RequestOptions options;
+    options.timeout = 200ms;
+    options.deadline = 300ms;
+    Collector collector;
+    auto started = std::chrono::steady_clock::now();
+    auto [ok, error] = client.get_stream(server.url(), collector.handler(), options).get();
+    EXPECT_FALSE(ok);
+    EXPECT_EQ(error, "Request timed out after 300 ms");
+    EXPECT_LT(std::chrono::steady_clock::now() - started, 700ms);
+    EXPECT_GT(collector.chunks.size(), 1u);
+    EXPECT_LT(collector.chunks.size(), 20u);
+}
+
+TEST_F(HttpClientStreamTest, ErrorStatusIsReported) {
+    LocalHttpServer missing_server([](const LocalHttpServer::Request&, LocalHttpServer::Response& res) {
+        res.result(boost::beast::http::status::not_found);
+        res.body() = "no such model";
+    });
+
+    Collector collector;
+    auto [ok, error] = client.get_stream(missing_server.url(), collector.handler()).get();
+    EXPECT_FALSE(ok);
+    EXPECT_EQ(error, "HTTP 404 Not Found");
+    EXPECT_TRUE(collector.chunks.empty());
+
+    // The outcome carries the status and the body the handler never saw
+    std::promise<HttpOutcome> done;
+    client.async_fetch("GET", missing_server.url(), "", {},
+                       [&done](HttpOutcome outcome) { done.set_value(std::move(outcome)); }, collector.handler());
+    auto outcome = done.get_future().get();
+    EXPECT_EQ(outcome.error, HttpError::Status);
+    EXPECT_EQ(outcome.status, 404u);
+    EXPECT_EQ(outcome.error_body, "no such model");
+    EXPECT_TRUE(collector.chunks.empty());
+
+    // A large error body is cut short rather than read to the end
+    LocalHttpServer failing_server([](const LocalHttpServer::Request&, LocalHttpServer::Response& res) {
+        res.result(boost::beast::http::status::internal_server_error);
+        res.body() = std::string(1024 * 1024, 'x');
+    });
+    std::promise<HttpOutcome> failed;
+    client.async_fetch("GET", failing_server.url(), "", {},
+                       [&failed](HttpOutcome outcome) { failed.set_value(std::move(outcome)); }, collector.handler());
+    outcome = failed.get_future().get();
+    EXPECT_EQ(outcome.status, 500u);
+    EXPECT_EQ(outcome.error_body.size(), HttpOutcome::kMaxErrorBodyBytes);
+    EXPECT_TRUE(collector.chunks.empty());
+}
+
+TEST(HttpClientTest, FailuresAreClassified) {
+    LocalHttpServer server([](const LocalHttpServer::Request& req, LocalHttpServer::Response& res) {
+        if (req.target() == "/slow") std::this_thread::sleep_for(300ms);
+        if (req.target() == "/gzip") res.set(boost::beast::http::field::content_encoding, "gzip");
+        res.body() = "not what it claims to be";
+    });
+    HttpClient client;
+    auto fetch = [&client](const std::string& url, HttpClient::ChunkHandler on_chunk = {},
+                           std::chrono::milliseconds timeout = 5000ms) {
+        std::promise<HttpOutcome> done;
+        RequestOptions options;
+        options.timeout = timeout;
+        client.async_fetch("GET", url, "", options,
+                           [&done](HttpOutcome outcome) { done.set_value(std::move(outcome)); }, std::move(on_chunk));
+        return done.get_future().get();
+    };
+
+    auto ok = fetch(server.url("/"));
+    EXPECT_TRUE(ok.result.first);
+    EXPECT_EQ(ok.error, HttpError::None);
+    EXPECT_EQ(ok.status, 200u);
+
+    EXPECT_EQ(fetch("not a url").error, HttpError::Rejected);
+    EXPECT_EQ(fetch(server.url("/slow"), {}, 50ms).error, HttpError::Timeout);
+    EXPECT_EQ(fetch(server.url("/gzip")).error, HttpError::Decode);
+
+    auto thrown = fetch(server.url("/"), [](std::string_view) -> bool { throw std::runtime_error("consumer bug"); });
+    EXPECT_EQ(thrown.error, HttpError::Handler);
+    EXPECT_EQ(thrown.status, 200u);
+
+    unsigned short closed_port;
+    {
+        boost::asio::io_context io;
+        boost::asio::ip::tcp::acceptor probe(io, {boost::asio::ip::make_address("127.0.0.1"), 0});
+        closed_port = probe.local_endpoint().port();
+    }
+    auto refused = fetch("http://127.0.0.1:" + std::to_string(closed_port) + "/");
+    EXPECT_EQ(refused.error, HttpError::Connect);
+    EXPECT_EQ(refused.status, 0u);
+}
+
+TEST(HttpClientTest, MovedPayloadsAreNotCopied) {
+    LocalHttpServer server;
+    HttpClient client;
+    const std::string payload(512 * 1024, 'p');
+
+    auto [ok, body] = client.post(server.url("/moved"), std::string(payload)).get();
+    ASSERT_TRUE(ok) << body;
+    EXPECT_EQ(body.size(), payload.size() + 7);
+    EXPECT_EQ(client.payload_bytes_copied(), 0u);
+
+    // A const reference has to be copied into the request
+    ASSERT_TRUE(client.post(server.url("/copied"), payload).get().first);
+    EXPECT_EQ(client.payload_bytes_copied(), payload.size());
+
+    // Arena bodies are copied in and out
+    auto arena = std::make_shared<cortan::core::RequestArena>();
+    auto [arena_ok, arena_body] = client.post(server.url("/arena"), payload, arena).get();
+    ASSERT_TRUE(arena_ok) << arena_body;
+    EXPECT_EQ(client.payload_bytes_copied(), 2 * payload.size() + arena_body.size());
+}
+
+TEST(HttpClientTest, CollectedBodiesMayExceedTheParserDefault) {
+    // Beast's parsers stop at 8 MB unless told otherwise. Chunked, since
+    // Beast 1.74 can miss the limit on a Content-Length body.
+    LocalHttpServer server;
+    server.set_streamer([](const LocalHttpServer::Request&, const LocalHttpServer::ChunkWriter& write_chunk) {
+        const std::string piece(1024 * 1024, 'b');
+        for (int i = 0; i < 12 && write_chunk(piece); ++i) {}
+    });
+    HttpClient client;
+    const size_t expected = 12 * 1024 * 1024;
+
+    auto [ok, body] = client.get(server.url("/large")).get();
+    ASSERT_TRUE(ok) << body;
+    EXPECT_EQ(body.size(), expected);
+
+    auto arena = std::make_shared<cortan::core::RequestArena>();
+    auto [arena_ok, arena_body] = client.get(server.url("/large"), arena).get();
+    ASSERT_TRUE(arena_ok) << arena_body;
+    EXPECT_EQ(arena_body.size(), expected);
+
+    auto batch = client.send_batch({{"GET", server.url("/large"), ""}}).get();
+    ASSERT_EQ(batch.size(), 1u);
+    EXPECT_TRUE(batch[0].first) << batch[0].second.substr(0, 200);
+    EXPECT_EQ(batch[0].second.size(), expected);
+}
+
+TEST(HttpClientTest, CancelReleasesAnInFlightRequest) {
+    LocalHttpServer server([](const LocalHttpServer::Request&, LocalHttpServer::Response& res) {
+        std::this_thread::sleep_for(800ms);
+        res.body() = "late";
+    });
+    HttpClient client;
+    std::promise<HttpOutcome> done;
+    auto outcome = done.get_future();
+
+    auto started = std::chrono::steady_clock::now();
+    auto handle = client.async_fetch("GET", server.url("/slow"), "", RequestOptions{},
+                                     [&done](HttpOutcome result) { done.set_value(std::move(result)); });
+    std::this_thread::sleep_for(50ms);
+    handle.cancel();
+
+    ASSERT_EQ(outcome.wait_for(400ms), std::future_status::ready);
+    auto result = outcome.get();
+    EXPECT_FALSE(result.result.first);
+    EXPECT_EQ(result.error, HttpError::Cancelled);
+    EXPECT_LT(std::chrono::steady_clock::now() - started, 400ms);
+    EXPECT_EQ(client.connection_pool()->stats().active, 0u);
+
+    handle.cancel();   // already complete: nothing happens
+    RequestHandle{}.cancel();
+}
+
+TEST(HttpClientTest, MethodsReachTheServerAsSent) {
+    LocalHttpServer server([](const LocalHttpServer::Request& req, LocalHttpServer::Response& res) {
+        res.body() = std::string(req.method_string()) + (req.body().empty() ? "" : " " + req.body());
+    });
+    HttpClient client;
+    auto send = [&](std::string_view method, std::string body) {
+        std::promise<std::pair<bool, std::string>> done;
+        auto future = done.get_future();
+        client.async_request(method, server.url("/item"), std::move(body), RequestOptions{},
+                             [&done](std::pair<bool, std::string> result) { done.set_value(std::move(result)); });
+        return future.get();
+    };
+    using Result = std::pair<bool, std::string>;
+
+    EXPECT_EQ(send("PUT", R"({"a":1})"), (Result{true, R"(PUT {"a":1})"}));
+    EXPECT_EQ(send("DELETE", ""), (Result{true, "DELETE"}));
+    EXPECT_EQ(send("PATCH", "x"), (Result{true, "PATCH x"}));
+    EXPECT_EQ(send("", "dropped"), (Result{true, "GET"}));
+    EXPECT_EQ(send("HEAD", ""), (Result{true, ""}));   // Content-Length but no body
+    EXPECT_EQ(send("GET", ""), (Result{true, "GET"}));  // the connection survived the HEAD
+    EXPECT_EQ(send("FROB", "x"), (Result{false, "Unsupported HTTP method: FROB"}));
+    EXPECT_EQ(send("put", "x"), (Result{false, "Unsupported HTTP method: put"}));   // methods are case-sensitive
+    EXPECT_EQ(server.requests_served(), 6u);
+    EXPECT_EQ(server.connections_accepted(), 1u);
+
+    auto batch = client.send_batch({{"PUT", server.url("/a"), "1"}, {"HEAD", server.url("/b"), ""},
+                                    {"DELETE", server.url("/c"), ""}, {"FROB", server.url("/d"), ""}}).get();
+    ASSERT_EQ(batch.size(), 4u);
+    EXPECT_EQ(batch[0], (Result{true, "PUT 1"}));
+    EXPECT_EQ(batch[1], (Result{true, ""}));
+    EXPECT_EQ(batch[2], (Result{true, "DELETE"}));
+    EXPECT_EQ(batch[3], (Result{false, "Unsupported HTTP method: FROB"}));
+}
+
+TEST(HttpClientBatchTest, RequestsShareFewPipelinedConnections) {
+    LocalHttpServer server;
+    HttpClient client;
+    std::vector<BatchRequest> requests;
+    for (int i = 0; i < 40; ++i) {
+        requests.push_back({"GET", server.url("/item/" + std::to_string(i)), ""});
+    }
+
+    std::mutex mutex;
+    std::vector<size_t> reported;
+    BatchOptions options;
+    options.connections_per_host = 2;
+    auto results = client.send_batch(std::move(requests), [&](size_t index, const std::pair<bool, std::string>&) {
+        std::lock_guard<std::mutex> lock(mutex);
+        reported.push_back(index);
+    }, options).get();
+
+    ASSERT_EQ(results.size(), 40u);
+    for (size_t i = 0; i < results.size(); ++i) {
+        ASSERT_TRUE(results[i].first) << results[i].second;
+        EXPECT_EQ(results[i].second, "/item/" + std::to_string(i));
+    }
+    EXPECT_EQ(reported.size(), 40u);
+    EXPECT_LE(server.connections_accepted(), 2u);
+    EXPECT_EQ(client.connection_pool()->stats().idle, server.connections_accepted());
+}
+
+TEST(HttpClientBatchTest, ServerClosingConnectionsGetsOneRequestAtATime) {
+    LocalHttpServer server([](const LocalHttpServer::Request& req, LocalHttpServer::Response& res) {
+        res.keep_alive(false);
+        res.body() = std::string(req.target());
+    });
+    HttpClient client;
+    std::vector<BatchRequest> requests;
+    for (int i = 0; i < 12; ++i) {
+        requests.push_back({"GET", server.url("/" + std::to_string(i)), ""});
+    }
+
+    BatchOptions options;
+    options.connections_per_host = 1;
+    auto results = client.send_batch(std::move(requests), {}, options).get();
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        ASSERT_TRUE(results[i].first) << results[i].second;
+        EXPECT_EQ(results[i].second, "/" + std::to_string(i));
+    }
+    EXPECT_EQ(server.requests_served(), 12u);
+}
+
+TEST(HttpClientBatchTest, FailuresStayWithTheirRequests) {
+    LocalHttpServer server([](const LocalHttpServer::Request& req, LocalHttpServer::Response& res) {
+        if (req.target() == "/missing") {
+            res.result(boost::beast::http::status::not_found);
+        }
+        res.body() = std::string(req.target()) + (req.body().empty() ? "" : " " + req.body());
+    });
+    HttpClient client;
+    std::vector<BatchRequest> requests = {
+        {"POST", server.url("/api/embed"), "{\"input\":\"a\"}"},
+        {"GET", "not a url", ""},
+        {"GET", server.url("/missing"), ""},
+        {"POST", server.url("/api/embed"), "{\"input\":\"b\"}"},
+    };
+
+    BatchOptions options;
+    options.pipeline_posts = true;
+    auto results = client.send_batch(std::move(requests), {}, options).get();
+
+    ASSERT_EQ(results.size(), 4u);
+    EXPECT_EQ(results[0], std::make_pair(true, std::string("/api/embed {\"input\":\"a\"}")));
+    EXPECT_EQ(results[1], std::make_pair(false, std::string("Invalid URL: not a url")));
+    EXPECT_EQ(results[2], std::make_pair(false, std::string("HTTP 404 Not Found")));
+    EXPECT_EQ(results[3], std::make_pair(true, std::string("/api/embed {\"input\":\"b\"}")));
+}
+
+TEST(HttpClientBatchTest, TimeoutFailsRequestsStillWaiting) {
+    LocalHttpServer server([](const LocalHttpServer::Request& req, LocalHttpServer::Response& res) {
+        if (req.target() == "/slow") {
+            std::this_thread::sleep_for(300ms);
+        }
+        res.body() = "done";
+    });
+    HttpClient client;
+    BatchOptions options;
+    options.connections_per_host = 1;
+    options.timeout = 100ms;
+    auto results = client.send_batch({{"GET", server.url("/fast"), ""}, {"GET", server.url("/slow"), ""}},
+                                     {}, options).get();
+
+    EXPECT_TRUE(results[0].first) << results[0].second;
+    EXPECT_FALSE(results[1].first);
+    EXPECT_NE(results[1].second.find("timed out"), std::string::npos) << results[1].second;
+}
+
+TEST(HttpClientCompressionTest, CompressedResponsesAreDecoded) {
+    const std::string json = "{\"models\":[" + std::string(64 * 1024, ' ') + "]}";
+    std::mutex mutex;
+    std::vector<std::string> accepted;
+    LocalHttpServer server([&](const LocalHttpServer::Request& req, LocalHttpServer::Response& res) {
+        std::string accept_encoding(req[boost::beast::http::field::accept_encoding]);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            accepted.push_back(accept_encoding);
+        }
+        if (accept_encoding.find("gzip") != std::string::npos) {
+            res.set(boost::beast::http::field::content_encoding, "gzip");
+            res.body() = test_support::gzip(json);
+        } else {
+            res.body() = json;
+        }
+    });
+    HttpClient client;
+
+    // Loopback traffic goes uncompressed unless asked for
+    auto [plain_ok, plain] = client.get(server.url("/api/tags")).get();
+    ASSERT_TRUE(plain_ok) << plain;
+    EXPECT_EQ(plain, json);
+
+    RequestOptions options;
+    options.compression = Compression::On;
+    auto [ok, body] = client.get(server.url("/api/tags"), options).get();
+    ASSERT_TRUE(ok) << body;
+    EXPECT_EQ(body, json);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(accepted.size(), 2u);
+    EXPECT_EQ(accepted[0], "");
+    EXPECT_EQ(accepted[1], ContentDecoder::accept_encoding());
+}
+
+TEST(HttpClientCompressionTest, StreamsAreDecodedAsTheyArrive) {
+    const std::string text = "token token token token token token token token";
+    const std::string encoded = test_support::gzip(text);
+    LocalHttpServer server;
+    server.set_streamer([&encoded](const LocalHttpServer::Request&, const LocalHttpServer::ChunkWriter& write) {
+        // Split the gzip stream at arbitrary points, as a proxy would
+        for (size_t offset = 0; offset < encoded.size(); offset += 5) {
+            write(std::string_view(encoded).substr(offset, 5));
+        }
+    }, "gzip");
+    HttpClient client;
+
+    std::string received;
+    RequestOptions options;
+    options.compression = Compression::On;
+    auto [ok, error] = client.get_stream(server.url("/api/generate"), [&received](std::string_view chunk) {
+        received.append(chunk);
+        return true;
+    }, options).get();
+    ASSERT_TRUE(ok) << error;
+    EXPECT_EQ(received, text);
+
+    // A stream cut off mid-way fails instead of passing as complete
+    server.set_streamer([&encoded](const LocalHttpServer::Request&, const LocalHttpServer::ChunkWriter& write) {
+        write(std::string_view(encoded).substr(0, encoded.size() - 6));
+    }, "gzip");
+    auto [truncated_ok, truncated_error] = client.get_stream(server.url("/api/generate"),
+                                                             [](std::string_view) { return true; }, options).get();
+    EXPECT_FALSE(truncated_ok);
+    EXPECT_NE(truncated_error.find("Decompression error"), std::string::npos) << truncated_error;
+}
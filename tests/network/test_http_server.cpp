@@ -0,0 +1,336 @@
+#include <gtest/gtest.h>
+#include <cortan/network/http_client.hpp>
+#include <cortan/network/http_server.hpp>
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cortan::network;
+using namespace std::chrono_literals;
+
+namespace {
+
+HttpServerConfig local_config(size_t threads = 2) {
+    HttpServerConfig config;
+    config.address = "127.0.0.1";
+    config.port = 0;
+    config.threads = threads;
+    return config;
+}
+
+std::string url(const HttpServer& server, const std::string& target) {
+    return "http://127.0.0.1:" + std::to_string(server.port()) + target;
+}
+
+// Waits up to five seconds for a condition set on another thread
+template<typename Predicate>
+bool eventually(Predicate&& ready) {
+    for (auto deadline = std::chrono::steady_clock::now() + 5s; std::chrono::steady_clock::now() < deadline;) {
+        if (ready()) return true;
+        std::this_thread::sleep_for(5ms);
+    }
+    return ready();
+}
+
+} // namespace
+
+TEST(HttpServerTest, ServesRoutesOverKeepAlive) {
+    auto handler = std::make_shared<RequestHandler>();
+    handler->register_route("GET", "/api/models/:name", [](const HttpRequest&, const RouteParams& params,
+                                                           HttpResponse& response) {
+        response.body = "{\"name\":\"" + std::string(params.get("name")) + "\"}";
+    });
+    handler->register_route("POST", "/api/echo", [](const HttpRequest& request, const RouteParams&,
+                                                    HttpResponse& response) {
+        response.content_type = std::string(request.header("Content-Type"));
+        response.body = request.body;
+    });
+
+    HttpServer server(handler, local_config());
+    auto [ok, error] = server.start();
+    ASSERT_TRUE(ok) << error;
+    EXPECT_TRUE(server.is_running());
+    EXPECT_NE(server.port(), 0);
+    EXPECT_FALSE(server.start().first);
+
+    HttpClient client;
+    for (int i = 0; i < 5; ++i) {
+        auto result = client.get(url(server, "/api/models/llama" + std::to_string(i))).get();
+        ASSERT_TRUE(result.first) << result.second;
+        EXPECT_EQ(result.second, "{\"name\":\"llama" + std::to_string(i) + "\"}");
+    }
+    auto echoed = client.post(url(server, "/api/echo"), std::string(100 * 1024, 'p')).get();
+    ASSERT_TRUE(echoed.first) << echoed.second;
+    EXPECT_EQ(echoed.second.size(), 100u * 1024);
+
+    auto missing = client.get(url(server, "/api/unknown")).get();
+    EXPECT_FALSE(missing.first);
+    EXPECT_EQ(missing.second, "HTTP 404 Not Found");
+    auto wrong_method = client.post(url(server, "/api/models/x"), std::string("{}")).get();
+    EXPECT_EQ(wrong_method.second, "HTTP 405 Method Not Allowed");
+
+    auto stats = server.stats();
+    EXPECT_EQ(stats.connections_accepted, 1u);   // every request reused one connection
+    EXPECT_EQ(stats.requests_handled, 8u);
+    EXPECT_EQ(stats.bytes_received, 100u * 1024 + 2);
+
+    server.stop();
+    EXPECT_FALSE(server.is_running());
+    EXPECT_FALSE(client.get(url(server, "/api/models/x"), 2s).get().first);
+}
+
+TEST(HttpServerTest, AnswersPipelinedBatchesAcrossThreads) {
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    auto handler = std::make_shared<RequestHandler>();
+    handler->register_route("GET", "/item/:id", [&](const HttpRequest&, const RouteParams& params,
+                                                    HttpResponse& response) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            threads.insert(std::this_thread::get_id());
+        }
+        response.body = std::string(params.get("id"));
+    });
+
+    HttpServer server(handler, local_config(4));
+    ASSERT_TRUE(server.start().first);
+    EXPECT_EQ(server.thread_count(), 4u);
+
+    std::vector<BatchRequest> requests;
+    for (int i = 0; i < 256; ++i) {
+        requests.push_back({"GET", url(server, "/item/" + std::to_string(i)), ""});
+    }
+    BatchOptions options;
+    options.connections_per_host = 8;
+    options.pipeline_depth = 16;
+    auto results = HttpClient().send_batch(std::move(requests), {}, options).get();
+
+    ASSERT_EQ(results.size(), 256u);
+    for (size_t i = 0; i < results.size(); ++i) {
+        ASSERT_TRUE(results[i].first) << results[i].second;
+        EXPECT_EQ(results[i].second, std::to_string(i));
+    }
+    EXPECT_EQ(server.stats().requests_handled, 256u);
+    // Eight connections spread over four listeners by the kernel (or in
+    // turn without SO_REUSEPORT) all but never land on one thread
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_GT(threads.size(), 1u);
+}
+
+TEST(HttpServerTest, StreamsChunkedResponsesFromProducerThreads) {
+    std::vector<std::thread> producers;
+    auto handler = std::make_shared<RequestHandler>();
+    handler->register_route("GET", "/api/generate", [&](const HttpRequest&, const RouteParams&,
+                                                        HttpResponse& response) {
+        response.content_type = "application/x-ndjson";
+        response.streamer = [&](std::shared_ptr<ResponseStream> stream) {
+            producers.emplace_back([stream] {
+                for (int i = 0; i < 100; ++i) {
+                    stream->write("{\"token\":" + std::to_string(i) + "}\n");
+                }
+                stream->finish();
+                EXPECT_FALSE(stream->write("late"));
+            });
+        };
+    });
+    handler->register_route("GET", "/api/tags", [](const HttpRequest&, const RouteParams&, HttpResponse& response) {
+        response.body = "tags";
+    });
+
+    HttpServer server(handler, local_config(1));
+    ASSERT_TRUE(server.start().first);
+    HttpClient client;
+
+    std::string expected;
+    for (int i = 0; i < 100; ++i) {
+        expected += "{\"token\":" + std::to_string(i) + "}\n";
+    }
+    for (int round = 0; round < 2; ++round) {
+        std::string body;
+        auto [ok, error] = client.get_stream(url(server, "/api/generate"), [&](std::string_view chunk) {
+            body.append(chunk);
+            return true;
+        }).get();
+        ASSERT_TRUE(ok) << error;
+        EXPECT_EQ(body, expected);
+    }
+    // The connection is still good for ordinary requests afterwards
+    EXPECT_EQ(client.get(url(server, "/api/tags")).get().second, "tags");
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    auto stats = server.stats();
+    EXPECT_EQ(stats.responses_streamed, 2u);
+    EXPECT_EQ(stats.connections_accepted, 1u);
+}
+
+TEST(HttpServerTest, StreamKeptPastItsResponseCannotTouchTheNext) {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ResponseStream>> streams;
+    auto handler = std::make_shared<RequestHandler>();
+    handler->register_route("GET", "/stream", [&](const HttpRequest&, const RouteParams&, HttpResponse& response) {
+        response.streamer = [&](std::shared_ptr<ResponseStream> stream) {
+            stream->write("start\n");
+            std::lock_guard<std::mutex> lock(mutex);
+            streams.push_back(std::move(stream));
+        };
+    });
+    auto held = [&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return streams.size();
+    };
+
+    HttpServer server(handler, local_config(1));
+    ASSERT_TRUE(server.start().first);
+    HttpClient client;
+    auto collect = [](std::string& body) {
+        return [&body](std::string_view chunk) {
+            body.append(chunk);
+            return true;
+        };
+    };
+
+    std::string first_body;
+    auto first = client.get_stream(url(server, "/stream"), collect(first_body));
+    ASSERT_TRUE(eventually([&] { return held() == 1; }));
+    streams[0]->finish();   // the response ends; the stream object lives on
+    ASSERT_TRUE(first.get().first);
+    EXPECT_EQ(first_body, "start\n");
+
+    // Same keep-alive connection, next streamed response
+    std::string second_body;
+    auto second = client.get_stream(url(server, "/stream"), collect(second_body));
+    ASSERT_TRUE(eventually([&] { return held() == 2; }));
+    EXPECT_FALSE(streams[0]->write("stale\n"));
+    streams[0].reset();   // its destructor must not end the second response
+    EXPECT_TRUE(streams[1]->write("more\n"));
+    streams[1]->finish();
+    auto [ok, error] = second.get();
+    ASSERT_TRUE(ok) << error;
+    EXPECT_EQ(second_body, "start\nmore\n");
+    EXPECT_EQ(server.stats().connections_accepted, 1u);
+}
+
+TEST(HttpServerTest, HeadOnAStreamedRouteSendsTheStreamedHeaders) {
+    namespace http = boost::beast::http;
+    std::atomic<int> streamed{0};
+    auto handler = std::make_shared<RequestHandler>();
+    handler->register_route("GET", "/stream", [&](const HttpRequest&, const RouteParams&, HttpResponse& response) {
+        response.content_type = "application/x-ndjson";
+        response.streamer = [&](std::shared_ptr<ResponseStream> stream) {
+            ++streamed;
+            stream->write("body\n");
+        };
+    });
+    HttpServer server(handler, local_config(1));
+    ASSERT_TRUE(server.start().first);
+
+    boost::asio::io_context io;
+    boost::asio::ip::tcp::socket socket(io);
+    socket.connect({boost::asio::ip::make_address("127.0.0.1"), server.port()});
+    http::request<http::empty_body> request{http::verb::head, "/stream", 11};
+    request.set(http::field::host, "127.0.0.1");
+    http::write(socket, request);
+
+    boost::beast::flat_buffer buffer;
+    http::response_parser<http::empty_body> parser;
+    parser.skip(true);
+    http::read(socket, buffer, parser);
+    const auto& response = parser.get();
+    EXPECT_EQ(response.result(), http::status::ok);
+    EXPECT_EQ(response[http::field::transfer_encoding], "chunked");
+    EXPECT_EQ(response[http::field::content_type], "application/x-ndjson");
+    EXPECT_EQ(response.count(http::field::content_length), 0u);
+    EXPECT_EQ(streamed.load(), 0);
+
+    // Nothing follows the headers, and the connection takes another request
+    request.method(http::verb::get);
+    http::write(socket, request);
+    http::response<http::string_body> streamed_response;
+    http::read(socket, buffer, streamed_response);
+    EXPECT_EQ(streamed_response.body(), "body\n");
+}
+
+TEST(HttpServerTest, StreamsOutliveStoppedServer) {
+    std::shared_ptr<ResponseStream> held;
+    std::mutex mutex;
+    auto handler = std::make_shared<RequestHandler>();
+    handler->register_route("GET", "/stream", [&](const HttpRequest&, const RouteParams&, HttpResponse& response) {
+        response.streamer = [&](std::shared_ptr<ResponseStream> stream) {
+            stream->write("first\n");
+            std::lock_guard<std::mutex> lock(mutex);
+            held = std::move(stream);
+        };
+    });
+
+    auto server = std::make_unique<HttpServer>(handler, local_config(1));
+    ASSERT_TRUE(server->start().first);
+    HttpClient client;
+    std::promise<void> first_chunk;
+    auto streamed = client.get_stream(url(*server, "/stream"), [&, seen = false](std::string_view) mutable {
+        if (!seen) first_chunk.set_value();
+        seen = true;
+        return true;
+    });
+    ASSERT_EQ(first_chunk.get_future().wait_for(5s), std::future_status::ready);
+
+    server.reset();   // stops with the stream still held
+    EXPECT_FALSE(streamed.get().first);
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_TRUE(held);
+    EXPECT_FALSE(held->write("after stop"));
+    held.reset();
+}
+
+TEST(HttpServerTest, LimitsAndValidation) {
+    auto handler = std::make_shared<RequestHandler>();
+    handler->register_route("POST", "/upload", [](const HttpRequest& request, const RouteParams&,
+                                                  HttpResponse& response) {
+        response.body = std::to_string(request.body.size());
+    });
+
+    auto config = local_config(1);
+    config.max_body_bytes = 1024;
+    HttpServer server(handler, config);
+    ASSERT_TRUE(server.start().first);
+
+    HttpClient client;
+    EXPECT_EQ(client.post(url(server, "/upload"), std::string(1024, 'a')).get().second, "1024");
+    auto rejected = client.post(url(server, "/upload"), std::string(4096, 'a')).get();
+    EXPECT_FALSE(rejected.first);
+    EXPECT_EQ(rejected.second, "HTTP 413 Payload Too Large");
+
+    auto unparsable = local_config(1);
+    unparsable.address = "not-an-address";
+    EXPECT_FALSE(HttpServer(handler, unparsable).start().first);
+
+    EXPECT_THROW(HttpServer(nullptr), std::invalid_argument);
+    config.max_body_bytes = 0;
+    EXPECT_THROW(HttpServer(handler, config), std::invalid_argument);
+}
+
+TEST(HttpServerTest, PortHeldByAnotherServerFailsToStart) {
+    auto handler = std::make_shared<RequestHandler>();
+    HttpServer first(handler, local_config(2));
+    ASSERT_TRUE(first.start().first);
+
+    auto config = local_config(2);
+    config.port = first.port();
+    HttpServer second(handler, config);
+    auto [started, error] = second.start();
+    EXPECT_FALSE(started);
+    EXPECT_NE(error.find("Cannot listen"), std::string::npos) << error;
+    EXPECT_FALSE(second.is_running());
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include <cortan/network/request_handler.hpp>
+
+#include <stdexcept>
+#include <string>
+
+using namespace cortan::network;
+
+namespace {
+
+HttpRequest make_request(std::string method, std::string target) {
+    HttpRequest request;
+    request.method = std::move(method);
+    request.target = std::move(target);
+    return request;
+}
+
+// Answers with the route's name followed by its parameters
+RequestHandler::RouteHandler named(std::string name, std::vector<std::string> params = {}) {
+    return [name = std::move(name), params = std::move(params)](const HttpRequest&, const RouteParams& values,
+                                                                 HttpResponse& response) {
+        response.body = name;
+        for (const auto& param : params) {
+            response.body += " " + param + "=" + std::string(values.get(param));
+        }
+    };
+}
+
+HttpResponse dispatch(RequestHandler& handler, const std::string& method, const std::string& target) {
+    HttpResponse response;
+    handler.handle_request(make_request(method, target), response);
+    return response;
+}
+
+} // namespace
+
+TEST(RequestHandlerTest, MatchesStaticParamAndCatchAllRoutes) {
+    RequestHandler handler;
+    handler.register_route("GET", "/api/tags", named("tags"));
+    handler.register_route("GET", "/api/models/:name", named("model", {"name"}));
+    handler.register_route("GET", "/api/models/:name/blobs/:digest", named("blob", {"name", "digest"}));
+    handler.register_route("GET", "/static/*file", named("static", {"file"}));
+    handler.register_route("/health", named("health"));
+    EXPECT_EQ(handler.route_count(), 5u);
+
+    EXPECT_EQ(dispatch(handler, "GET", "/api/tags").body, "tags");
+    EXPECT_EQ(dispatch(handler, "GET", "/api/models/llama3?verbose=1").body, "model name=llama3");
+    EXPECT_EQ(dispatch(handler, "GET", "/api/models/llama3/blobs/sha256-1").body,
+              "blob name=llama3 digest=sha256-1");
+    EXPECT_EQ(dispatch(handler, "GET", "/static/css/site.css").body, "static file=css/site.css");
+    EXPECT_EQ(dispatch(handler, "GET", "/static/").body, "static file=");
+    EXPECT_EQ(dispatch(handler, "DELETE", "/health").body, "health");
+
+    EXPECT_EQ(dispatch(handler, "GET", "/api/models/").status, 404);   // parameters are never empty
+    EXPECT_EQ(dispatch(handler, "GET", "/api/tagsx").status, 404);
+    EXPECT_EQ(dispatch(handler, "GET", "/api").status, 404);
+}
+
+TEST(RequestHandlerTest, PrefersStaticSegmentsAndBacktracks) {
+    RequestHandler handler;
+    handler.register_route("GET", "/models/list", named("list"));
+    handler.register_route("GET", "/models/:name", named("model", {"name"}));
+    handler.register_route("GET", "/models/:name/info", named("info", {"name"}));
+    handler.register_route("GET", "/models/*rest", named("rest", {"rest"}));
+    handler.register_route("GET", "/v1/models:generate", named("colon"));   // ':' inside a segment is literal
+
+    EXPECT_EQ(dispatch(handler, "GET", "/models/list").body, "list");
+    EXPECT_EQ(dispatch(handler, "GET", "/models/lis").body, "model name=lis");
+    EXPECT_EQ(dispatch(handler, "GET", "/models/listing").body, "model name=listing");
+    EXPECT_EQ(dispatch(handler, "GET", "/models/list/info").body, "info name=list");
+    EXPECT_EQ(dispatch(handler, "GET", "/models/a/b/c").body, "rest rest=a/b/c");
+    EXPECT_EQ(dispatch(handler, "GET", "/v1/models:generate").body, "colon");
+}
+
+TEST(RequestHandlerTest, UnknownPathsAndMethods) {
+    RequestHandler handler;
+    handler.register_route("GET", "/api/tags", named("get"));
+    handler.register_route("POST", "/api/tags", named("post"));
+
+    EXPECT_EQ(dispatch(handler, "GET", "/api/tags").body, "get");
+    EXPECT_EQ(dispatch(handler, "POST", "/api/tags").body, "post");
+    EXPECT_EQ(dispatch(handler, "HEAD", "/api/tags").body, "get");
+
+    auto missing = dispatch(handler, "GET", "/nope");
+    EXPECT_EQ(missing.status, 404);
+
+    auto wrong = dispatch(handler, "PUT", "/api/tags");
+    EXPECT_EQ(wrong.status, 405);
+    ASSERT_EQ(wrong.headers.size(), 1u);
+    EXPECT_EQ(wrong.headers[0].first, "Allow");
+    EXPECT_EQ(wrong.headers[0].second, "GET, HEAD, POST");
+}
+
+TEST(RequestHandlerTest, RejectsBadConflictingAndLateRoutes) {
+    RequestHandler handler;
+    handler.register_route("GET", "/models/:name", named("model"));
+
+    EXPECT_THROW(handler.register_route("GET", "models", named("x")), std::invalid_argument);
+    EXPECT_THROW(handler.register_route("GET", "/models/:", named("x")), std::invalid_argument);
+    EXPECT_THROW(handler.register_route("GET", "/files/*path/more", named("x")), std::invalid_argument);
+    EXPECT_THROW(handler.register_route("GET", "/models/:id/info", named("x")), std::invalid_argument);
+    EXPECT_THROW(handler.register_route("GET", "/models/:name", named("x")), std::invalid_argument);
+    EXPECT_THROW(handler.register_route("GET", "/empty", nullptr), std::invalid_argument);
+    handler.register_route("POST", "/models/:name", named("x"));   // another method is fine
+
+    handler.compile();
+    EXPECT_THROW(handler.register_route("GET", "/late", named("late")), std::logic_error);
+    EXPECT_EQ(dispatch(handler, "GET", "/models/a").body, "model");
+}
+
+TEST(RequestHandlerTest, HandlerExceptionsBecomeServerErrors) {
+    RequestHandler handler;
+    handler.register_route("GET", "/fail", [](const HttpRequest&, const RouteParams&, HttpResponse& response) {
+        response.streamer = [](std::shared_ptr<ResponseStream>) {};
+        throw std::runtime_error("model unavailable");
+    });
+
+    auto response = dispatch(handler, "GET", "/fail");
+    EXPECT_EQ(response.status, 500);
+    EXPECT_EQ(response.body, "Internal Server Error");   // the message is logged, not sent
+    EXPECT_FALSE(response.streamer);
+}
+
+TEST(RequestHandlerTest, RequestAccessors) {
+    auto request = make_request("GET", "/api/generate?stream=true&model=llama3");
+    request.headers = {{"Content-Type", "application/json"}, {"X-Request-Id", "42"}};
+
+    EXPECT_EQ(request.path(), "/api/generate");
+    EXPECT_EQ(request.query(), "stream=true&model=llama3");
+    EXPECT_EQ(request.header("content-type"), "application/json");
+    EXPECT_EQ(request.header("X-REQUEST-ID"), "42");
+    EXPECT_TRUE(request.header("Accept").empty());
+    EXPECT_TRUE(make_request("GET", "/plain").query().empty());
+}
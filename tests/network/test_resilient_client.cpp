@@ -0,0 +1,285 @@
+#include <gtest/gtest.h>
+#include <cortan/network/resilient_client.hpp>
+#include "local_http_server.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+
+using namespace cortan::network;
+using test_support::LocalHttpServer;
+using namespace std::chrono_literals;
+
+namespace {
+
+namespace http = boost::beast::http;
+
+// Answers request n (0-based) with whatever the script says for it
+class ScriptedServer {
+public:
+    struct Reply {
+        http::status status = http::status::ok;
+        std::chrono::milliseconds delay{0};
+    };
+    using Script = std::function<Reply(size_t n)>;
+
+    explicit ScriptedServer(Script script)
+        : script_(std::move(script))
+        , server_([this](const LocalHttpServer::Request&, LocalHttpServer::Response& res) {
+            auto reply = script_(next_.fetch_add(1));
+            if (reply.delay.count() > 0) std::this_thread::sleep_for(reply.delay);
+            res.result(reply.status);
+            res.body() = "reply";
+        }) {}
+
+    std::string url() const { return server_.url("/resource"); }
+    size_t requests() const { return next_.load(); }
+
+private:
+    Script script_;
+    std::atomic<size_t> next_{0};
+    LocalHttpServer server_;
+};
+
+ResilienceConfig fast_config() {
+    ResilienceConfig config;
+    config.retry.base_backoff = 1ms;
+    config.retry.max_backoff = 5ms;
+    return config;
+}
+
+} // namespace
+
+TEST(ResilientClientTest, RetriesServerErrorsUntilSuccess) {
+    ScriptedServer server([](size_t n) {
+        return ScriptedServer::Reply{n < 2 ? http::status::service_unavailable : http::status::ok, {}};
+    });
+    ResilientClient client(nullptr, fast_config());
+
+    auto [ok, body] = client.get(server.url()).get();
+    ASSERT_TRUE(ok) << body;
+    EXPECT_EQ(body, "reply");
+    EXPECT_EQ(server.requests(), 3u);
+
+    auto stats = client.stats(server.url());
+    EXPECT_EQ(stats.requests, 1u);
+    EXPECT_EQ(stats.attempts, 3u);
+    EXPECT_EQ(stats.retries, 2u);
+    EXPECT_EQ(stats.state, CircuitBreaker::State::Closed);
+}
+
+TEST(ResilientClientTest, ClientErrorsAndNonIdempotentPostsAreNotRetried) {
+    ScriptedServer not_found([](size_t) { return ScriptedServer::Reply{http::status::not_found, {}}; });
+    ResilientClient client(nullptr, fast_config());
+
+    auto [ok, error] = client.get(not_found.url()).get();
+    EXPECT_FALSE(ok);
+    EXPECT_EQ(error.rfind("HTTP 404", 0), 0u) << error;
+    EXPECT_EQ(not_found.requests(), 1u);
+
+    ScriptedServer unavailable([](size_t) { return ScriptedServer::Reply{http::status::service_unavailable, {}}; });
+    EXPECT_FALSE(client.post(unavailable.url(), "{}").get().first);
+    EXPECT_EQ(unavailable.requests(), 1u);
+
+    // Marked idempotent, the same POST is retried up to max_attempts
+    EXPECT_FALSE(client.post(unavailable.url(), "{}", {}, true).get().first);
+    EXPECT_EQ(unavailable.requests(), 4u);
+}
+
+TEST(ResilientClientTest, IdempotentMethodsAreRetriedAndUnknownOnesRefused) {
+    ScriptedServer server([](size_t n) {
+        return ScriptedServer::Reply{n == 0 ? http::status::service_unavailable : http::status::ok, {}};
+    });
+    ResilientClient client(nullptr, fast_config());
+    auto send = [&](std::string_view method) {
+        std::promise<std::pair<bool, std::string>> done;
+        auto future = done.get_future();
+        client.async_request(method, server.url(), "", RequestOptions{}, false,
+                             [&done](std::pair<bool, std::string> result) { done.set_value(std::move(result)); });
+        return future.get();
+    };
+
+    EXPECT_TRUE(send("PUT").first);   // 503, then retried
+    EXPECT_EQ(server.requests(), 2u);
+
+    auto [ok, error] = send("FROB");
+    EXPECT_FALSE(ok);
+    EXPECT_EQ(error, "Unsupported HTTP method: FROB");
+    EXPECT_EQ(server.requests(), 2u);
+    EXPECT_EQ(client.stats(server.url()).requests, 1u);   // never reached the endpoint
+}
+
+TEST(ResilientClientTest, TimeoutsAreRetried) {
+    ScriptedServer server([](size_t n) { return ScriptedServer::Reply{http::status::ok, n == 0 ? 500ms : 0ms}; });
+    ResilientClient client(nullptr, fast_config());
+
+    RequestOptions options;
+    options.timeout = 100ms;
+    auto started = std::chrono::steady_clock::now();
+    auto [ok, body] = client.get(server.url(), options).get();
+    ASSERT_TRUE(ok) << body;
+    EXPECT_LT(std::chrono::steady_clock::now() - started, 450ms);
+    EXPECT_EQ(client.stats(server.url()).retries, 1u);
+}
+
+TEST(ResilientClientTest, CircuitOpensShortCircuitsAndRecoversThroughAProbe) {
+    std::atomic<bool> healthy{false};
+    ScriptedServer server([&](size_t) {
+        return ScriptedServer::Reply{healthy ? http::status::ok : http::status::internal_server_error, {}};
+    });
+    auto config = fast_config();
+    config.retry.max_attempts = 1;
+    config.breaker.failure_threshold = 3;
+    config.breaker.open_duration = 200ms;
+    ResilientClient client(nullptr, config);
+
+    for (int i = 0; i < 3; ++i) EXPECT_FALSE(client.get(server.url()).get().first);
+    EXPECT_EQ(client.stats(server.url()).state, CircuitBreaker::State::Open);
+
+    // Open: fails at once without reaching the server
+    auto [ok, error] = client.get(server.url()).get();
+    EXPECT_FALSE(ok);
+    EXPECT_EQ(error.rfind("Circuit open for http://127.0.0.1:", 0), 0u) << error;
+    EXPECT_EQ(server.requests(), 3u);
+    EXPECT_EQ(client.stats(server.url()).short_circuited, 1u);
+
+    // A failed probe reopens the circuit for another open_duration
+    std::this_thread::sleep_for(250ms);
+    EXPECT_FALSE(client.get(server.url()).get().first);
+    EXPECT_EQ(server.requests(), 4u);
+    EXPECT_EQ(client.stats(server.url()).state, CircuitBreaker::State::Open);
+
+    healthy = true;
+    EXPECT_FALSE(client.get(server.url()).get().first);
+    std::this_thread::sleep_for(250ms);
+    EXPECT_TRUE(client.get(server.url()).get().first);
+    EXPECT_EQ(client.stats(server.url()).state, CircuitBreaker::State::Closed);
+    EXPECT_TRUE(client.get(server.url()).get().first);
+}
+
+TEST(ResilientClientTest, FailuresOfTheCallersMakingLeaveTheCircuitClosed) {
+    // Claims gzip but sends plain text: the endpoint answered, the body is bad
+    LocalHttpServer server([](const LocalHttpServer::Request&, LocalHttpServer::Response& res) {
+        res.set(http::field::content_encoding, "gzip");
+        res.body() = "not gzip";
+    });
+    auto config = fast_config();
+    config.breaker.failure_threshold = 2;
+    ResilientClient client(nullptr, config);
+
+    for (int i = 0; i < 3; ++i) {
+        auto [ok, error] = client.get(server.url("/resource")).get();
+        EXPECT_FALSE(ok);
+        EXPECT_EQ(error.rfind("Decompression error", 0), 0u) << error;
+    }
+    EXPECT_EQ(server.requests_served(), 3u);   // not retried either
+    auto stats = client.stats(server.url("/resource"));
+    EXPECT_EQ(stats.state, CircuitBreaker::State::Closed);
+    EXPECT_EQ(stats.retries, 0u);
+}
+
+TEST(ResilientClientTest, StreamsAreRetriedOnlyBeforeTheFirstChunk) {
+    ScriptedServer flaky([](size_t n) {
+        return ScriptedServer::Reply{n < 2 ? http::status::service_unavailable : http::status::ok, {}};
+    });
+    ResilientClient client(nullptr, fast_config());
+    auto fetch = [&client](const std::string& url, std::string& received) {
+        std::promise<HttpOutcome> done;
+        client.async_fetch("POST", url, "prompt", {}, true,
+                           [&done](HttpOutcome outcome) { done.set_value(std::move(outcome)); },
+                           [&received](std::string_view chunk) {
+                               received.append(chunk);
+                               return true;
+                           });
+        return done.get_future().get();
+    };
+
+    // The failed attempts delivered nothing, so the handler sees one reply
+    std::string received;
+    auto outcome = fetch(flaky.url(), received);
+    ASSERT_TRUE(outcome.result.first) << outcome.result.second;
+    EXPECT_EQ(received, "reply");
+    EXPECT_EQ(flaky.requests(), 3u);
+
+    // Dropped part way: the handler has seen data, so the failure stands
+    LocalHttpServer dropping;
+    dropping.set_streamer([&dropping](const LocalHttpServer::Request&, const LocalHttpServer::ChunkWriter& write) {
+        write("partial");
+        std::this_thread::sleep_for(20ms);
+        dropping.close_connections();
+    });
+    received.clear();
+    outcome = fetch(dropping.url("/resource"), received);
+    EXPECT_FALSE(outcome.result.first);
+    EXPECT_EQ(outcome.error, HttpError::Transport);
+    EXPECT_EQ(received, "partial");
+    EXPECT_EQ(dropping.requests_served(), 1u);
+    EXPECT_EQ(client.stats(dropping.url("/resource")).retries, 0u);
+}
+
+TEST(ResilientClientTest, RetryBudgetBoundsExtraLoad) {
+    ScriptedServer server([](size_t) { return ScriptedServer::Reply{http::status::service_unavailable, {}}; });
+    auto config = fast_config();
+    config.retry.max_attempts = 5;
+    config.retry.budget_cap = 2.0;
+    config.retry.budget_ratio = 0.0;
+    config.breaker.failure_threshold = 100;
+    ResilientClient client(nullptr, config);
+
+    EXPECT_FALSE(client.get(server.url()).get().first);
+    EXPECT_EQ(server.requests(), 3u);   // two retries spent the budget
+    EXPECT_FALSE(client.get(server.url()).get().first);
+    EXPECT_EQ(server.requests(), 4u);   // nothing left to retry with
+
+    auto stats = client.stats(server.url());
+    EXPECT_EQ(stats.retries, 2u);
+    EXPECT_EQ(stats.budget_exhausted, 2u);
+}
+
+TEST(ResilientClientTest, HedgesARequestStuckPastThePercentile) {
+    constexpr size_t kWarmup = 20;
+    ScriptedServer server([](size_t n) {
+        return ScriptedServer::Reply{http::status::ok, n == kWarmup ? 800ms : 0ms};
+    });
+    auto config = fast_config();
+    config.hedge.enabled = true;
+    config.hedge.min_samples = kWarmup;
+    config.hedge.min_delay = 20ms;
+    ResilientClient client(nullptr, config);
+
+    for (size_t i = 0; i < kWarmup; ++i) ASSERT_TRUE(client.get(server.url()).get().first);
+    EXPECT_GE(client.stats(server.url()).hedge_delay, 20ms);
+
+    auto started = std::chrono::steady_clock::now();
+    auto [ok, body] = client.get(server.url()).get();
+    ASSERT_TRUE(ok) << body;
+    EXPECT_LT(std::chrono::steady_clock::now() - started, 400ms);
+
+    auto stats = client.stats(server.url());
+    EXPECT_EQ(stats.hedges, 1u);
+    EXPECT_EQ(stats.hedge_wins, 1u);
+    EXPECT_EQ(server.requests(), kWarmup + 2);
+
+    // The stuck attempt was cancelled instead of holding its connection
+    // until the server answers it
+    auto pool = client.client()->connection_pool();
+    while (pool->stats().active > 0 && std::chrono::steady_clock::now() - started < 400ms) {
+        std::this_thread::sleep_for(5ms);
+    }
+    EXPECT_EQ(pool->stats().active, 0u);
+    EXPECT_EQ(client.stats(server.url()).state, CircuitBreaker::State::Closed);
+}
+
+TEST(ResilientClientTest, RejectsInvalidConfig) {
+    ResilienceConfig config;
+    config.retry.max_attempts = 0;
+    EXPECT_THROW(ResilientClient(nullptr, config), std::invalid_argument);
+
+    config = {};
+    config.hedge.percentile = 1.0;
+    EXPECT_THROW(ResilientClient(nullptr, config), std::invalid_argument);
+
+    EXPECT_THROW(CircuitBreaker(CircuitBreakerConfig{0, 1s}), std::invalid_argument);
+}
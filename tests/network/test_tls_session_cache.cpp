@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <cortan/network/http_client.hpp>
+#include <cortan/network/tls_session_cache.hpp>
+#include "local_tls_server.hpp"
+
+#include <memory>
+#include <string>
+
+using namespace cortan::network;
+using test_support::LocalHttpServer;
+using test_support::LocalTlsServer;
+
+namespace {
+
+// Every response closes its connection, so every request handshakes
+void closing_handler(const LocalHttpServer::Request&, LocalHttpServer::Response& res) {
+    res.keep_alive(false);
+    res.body() = "secure";
+}
+
+} // namespace
+
+class TlsSessionCacheTest : public ::testing::Test {
+protected:
+    LocalTlsServer server{closing_handler};
+
+    std::shared_ptr<TlsSessionCache> make_cache(bool resumption = true) {
+        TlsConfig config;
+        config.extra_ca_pem = server.certificate_pem();
+        config.session_resumption = resumption;
+        return std::make_shared<TlsSessionCache>(config);
+    }
+};
+
+TEST_F(TlsSessionCacheTest, LaterConnectionsResumeTheSession) {
+    auto tls = make_cache();
+    HttpClient client(std::make_shared<ConnectionPool>(), nullptr, tls);
+
+    for (int i = 0; i < 3; ++i) {
+        auto [ok, body] = client.get(server.url()).get();
+        ASSERT_TRUE(ok) << body;
+        EXPECT_EQ(body, "secure");
+    }
+
+    EXPECT_EQ(server.full_handshakes(), 1u);
+    EXPECT_EQ(server.resumed_handshakes(), 2u);
+    auto stats = tls->stats();
+    EXPECT_EQ(stats.full_handshakes, 1u);
+    EXPECT_EQ(stats.resumed_handshakes, 2u);
+    EXPECT_EQ(stats.sessions, 1u);
+}
+
+TEST_F(TlsSessionCacheTest, SessionsAreSharedAcrossClients) {
+    auto tls = make_cache();
+    HttpClient first(std::make_shared<ConnectionPool>(), nullptr, tls);
+    HttpClient second(std::make_shared<ConnectionPool>(), nullptr, tls);
+
+    ASSERT_TRUE(first.get(server.url()).get().first);
+    ASSERT_TRUE(second.get(server.url()).get().first);
+    EXPECT_EQ(server.resumed_handshakes(), 1u);
+}
+
+TEST_F(TlsSessionCacheTest, ResumptionCanBeDisabled) {
+    auto tls = make_cache(false);
+    HttpClient client(std::make_shared<ConnectionPool>(), nullptr, tls);
+
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(client.get(server.url()).get().first);
+    }
+    EXPECT_EQ(server.full_handshakes(), 3u);
+    EXPECT_EQ(tls->stats().sessions, 0u);
+}
+
+TEST_F(TlsSessionCacheTest, UntrustedCertificatesAreRejected) {
+    HttpClient client(std::make_shared<ConnectionPool>(), nullptr, std::make_shared<TlsSessionCache>());
+    auto [ok, error] = client.get(server.url()).get();
+    EXPECT_FALSE(ok);
+    EXPECT_NE(error.find("HTTPS request error"), std::string::npos) << error;
+}
@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+#include <cortan/network/websocket_client.hpp>
+#include "local_websocket_server.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cortan::network;
+using test_support::LocalWebSocketServer;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Collects messages from the runtime thread
+struct Inbox {
+    std::mutex mutex;
+    std::condition_variable arrived;
+    std::vector<std::pair<std::string, bool>> messages;
+    std::string close_reason;
+    bool closed = false;
+
+    void attach(WebSocketClient& client) {
+        client.on_message([this](std::string_view message, bool is_text) {
+            std::lock_guard<std::mutex> lock(mutex);
+            messages.emplace_back(std::string(message), is_text);
+            arrived.notify_all();
+        });
+        client.on_close([this](const std::string& reason) {
+            std::lock_guard<std::mutex> lock(mutex);
+            close_reason = reason;
+            closed = true;
+            arrived.notify_all();
+        });
+    }
+
+    bool wait_for(size_t count) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return arrived.wait_for(lock, 5s, [&] { return messages.size() >= count; });
+    }
+
+    bool wait_closed() {
+        std::unique_lock<std::mutex> lock(mutex);
+        return arrived.wait_for(lock, 5s, [&] { return closed; });
+    }
+};
+
+bool eventually(const std::function<bool()>& condition) {
+    auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(2ms);
+    }
+    return true;
+}
+
+} // namespace
+
+TEST(WebSocketClientTest, EchoesTextAndBinaryMessages) {
+    LocalWebSocketServer server;
+    WebSocketClient client;
+    Inbox inbox;
+    inbox.attach(client);
+
+    auto [ok, error] = client.connect(server.url("/events")).get();
+    ASSERT_TRUE(ok) << error;
+    EXPECT_TRUE(client.is_connected());
+
+    ASSERT_TRUE(client.send("hello"));
+    ASSERT_TRUE(client.send(std::string("\x00\x01\x02", 3), false));
+    ASSERT_TRUE(client.send(std::make_shared<const std::string>("shared")));
+    EXPECT_TRUE(client.flush().get().first);
+
+    ASSERT_TRUE(inbox.wait_for(3));
+    std::lock_guard<std::mutex> lock(inbox.mutex);
+    EXPECT_EQ(inbox.messages[0], std::make_pair(std::string("hello"), true));
+    EXPECT_EQ(inbox.messages[1], std::make_pair(std::string("\x00\x01\x02", 3), false));
+    EXPECT_EQ(inbox.messages[2], std::make_pair(std::string("shared"), true));
+}
+
+TEST(WebSocketClientTest, NegotiatesPermessageDeflate) {
+    const std::string large(200 * 1024, 'x');
+    {
+        LocalWebSocketServer server;
+        WebSocketClient client;
+        Inbox inbox;
+        inbox.attach(client);
+        ASSERT_TRUE(client.connect(server.url()).get().first);
+        EXPECT_TRUE(client.compression_active());
+
+        client.send(large);
+        ASSERT_TRUE(inbox.wait_for(1));
+        std::lock_guard<std::mutex> lock(inbox.mutex);
+        EXPECT_EQ(inbox.messages[0].first, large);
+    }
+    {
+        LocalWebSocketServer server(LocalWebSocketServer::echo_handler(), false);
+        WebSocketClient client;
+        ASSERT_TRUE(client.connect(server.url()).get().first);
+        EXPECT_FALSE(client.compression_active());
+    }
+}
+
+TEST(WebSocketClientTest, LargeMessagesAreFragmented) {
+    LocalWebSocketServer server;
+    server.set_recording(true);
+    WebSocketOptions options;
+    options.fragment_bytes = 16 * 1024;
+    options.permessage_deflate = false;
+    WebSocketClient client(options);
+    ASSERT_TRUE(client.connect(server.url()).get().first);
+
+    std::string payload(100 * 1024, '\0');
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = static_cast<char>('a' + i % 26);
+    }
+    client.send(payload);
+    ASSERT_TRUE(client.flush().get().first);
+
+    auto stats = client.stats();
+    EXPECT_EQ(stats.messages_sent, 1u);
+    EXPECT_EQ(stats.frames_sent, 7u);   // six full 16 KiB frames and the rest
+    ASSERT_TRUE(eventually([&] { return server.messages_received() == 1; }));
+    ASSERT_EQ(server.received().size(), 1u);
+    EXPECT_EQ(server.received()[0], payload);
+}
+
+TEST(WebSocketClientTest, CoalescesQueuedSmallMessages) {
+    LocalWebSocketServer server([](std::string_view, bool) { return std::nullopt; });
+    server.set_recording(true);
+    WebSocketOptions options;
+    options.coalesce = true;
+    WebSocketClient client(options);
+
+    // Queued while connecting, so they all wait for the first write pass
+    auto connected = client.connect(server.url());
+    std::string expected;
+    for (int i = 0; i < 200; ++i) {
+        std::string token = "{\"token\":" + std::to_string(i) + "}";
+        expected += (i ? "\n" : "") + token;
+        ASSERT_TRUE(client.send(std::move(token)));
+    }
+    ASSERT_TRUE(connected.get().first);
+    ASSERT_TRUE(client.flush().get().first);
+
+    auto stats = client.stats();
+    EXPECT_EQ(stats.messages_queued, 200u);
+    EXPECT_EQ(stats.messages_sent + stats.messages_coalesced, 200u);
+    EXPECT_LT(stats.messages_sent, 200u);
+
+    ASSERT_TRUE(eventually([&] { return server.messages_received() == stats.messages_sent; }));
+    std::string joined;
+    for (const auto& message : server.received()) {
+        joined += (joined.empty() ? "" : "\n") + message;
+    }
+    EXPECT_EQ(joined, expected);
+}
+
+TEST(WebSocketClientTest, QueueLimitAndClosedConnection) {
+    LocalWebSocketServer server;
+    WebSocketOptions options;
+    options.max_queued_bytes = 1024;
+    WebSocketClient client(options);
+
+    EXPECT_FALSE(client.send("not connected"));
+    auto connected = client.connect(server.url());
+    EXPECT_TRUE(client.send(std::string(1000, 'a')));
+    EXPECT_FALSE(client.send(std::string(100, 'b')));   // over the limit while connecting
+    ASSERT_TRUE(connected.get().first);
+    EXPECT_TRUE(client.flush().get().first);
+
+    auto again = client.connect(server.url()).get();
+    EXPECT_FALSE(again.first);
+
+    client.disconnect();
+    EXPECT_TRUE(eventually([&] { return !client.is_connected(); }));
+    EXPECT_FALSE(client.send("after close"));
+}
+
+TEST(WebSocketClientTest, ReportsServerDisconnectAndFailedConnect) {
+    LocalWebSocketServer server;
+    WebSocketClient client;
+    Inbox inbox;
+    inbox.attach(client);
+    ASSERT_TRUE(client.connect(server.url()).get().first);
+
+    server.close_connections();
+    ASSERT_TRUE(inbox.wait_closed());
+    {
+        std::lock_guard<std::mutex> lock(inbox.mutex);
+        EXPECT_FALSE(inbox.close_reason.empty());
+    }
+    EXPECT_FALSE(client.is_connected());
+
+    WebSocketClient refused;
+    unsigned short port = server.port();
+    server.stop();
+    auto [ok, error] = refused.connect("ws://127.0.0.1:" + std::to_string(port) + "/").get();
+    EXPECT_FALSE(ok);
+    EXPECT_NE(error.find("Connect error"), std::string::npos) << error;
+
+    EXPECT_FALSE(WebSocketClient().connect("http://127.0.0.1/").get().first);
+}
@@ -0,0 +1,374 @@
+#include <gtest/gtest.h>
+#include <cortan/network/websocket_client.hpp>
+#include <cortan/network/websocket_server.hpp>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/websocket.hpp>
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cortan;
+using namespace cortan::network;
+using namespace std::chrono_literals;
+
+namespace {
+
+WebSocketServerConfig local_config() {
+    WebSocketServerConfig config;
+    config.address = "127.0.0.1";
+    config.port = 0;
+    return config;
+}
+
+std::string url(const WebSocketServer& server, const std::string& target) {
+    return "ws://127.0.0.1:" + std::to_string(server.port()) + target;
+}
+
+bool eventually(const std::function<bool()>& condition) {
+    auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(2ms);
+    }
+    return true;
+}
+
+// A connected client and the messages it received
+struct Subscriber {
+    WebSocketClient client;
+    std::mutex mutex;
+    std::condition_variable arrived;
+    std::vector<std::string> messages;
+    bool closed = false;
+
+    Subscriber() {
+        client.on_message([this](std::string_view message, bool) {
+            std::lock_guard<std::mutex> lock(mutex);
+            messages.emplace_back(message);
+            arrived.notify_all();
+        });
+        client.on_close([this](const std::string&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+            arrived.notify_all();
+        });
+    }
+
+    bool connect(const std::string& target_url) { return client.connect(target_url).get().first; }
+
+    bool wait_for(size_t count) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return arrived.wait_for(lock, 5s, [&] { return messages.size() >= count; });
+    }
+
+    std::vector<std::string> received() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return messages;
+    }
+};
+
+std::shared_ptr<const std::string> text(std::string value) {
+    return std::make_shared<const std::string>(std::move(value));
+}
+
+} // namespace
+
+TEST(WebSocketServerTest, BroadcastsToSubscribedTopics) {
+    WebSocketServer server(local_config());
+    auto [ok, error] = server.start();
+    ASSERT_TRUE(ok) << error;
+    EXPECT_FALSE(server.start().first);
+
+    Subscriber tasks, users, everything;
+    ASSERT_TRUE(tasks.connect(url(server, "/events?topics=ai.processing")));
+    ASSERT_TRUE(users.connect(url(server, "/events?topics=user.request,user.welcome")));
+    ASSERT_TRUE(everything.connect(url(server, "/events?topics=%2A,ai.processing")));
+    ASSERT_TRUE(eventually([&] { return server.client_count() == 3; }));
+    EXPECT_TRUE(server.has_subscribers("ai.processing"));
+    EXPECT_TRUE(server.has_subscribers("anything"));   // through "*"
+
+    EXPECT_EQ(server.broadcast("ai.processing", text("task")), 2u);
+    EXPECT_EQ(server.broadcast("user.welcome", text("hello")), 2u);
+    EXPECT_EQ(server.broadcast("environment.change", text("env")), 1u);
+
+    ASSERT_TRUE(tasks.wait_for(1));
+    ASSERT_TRUE(users.wait_for(1));
+    ASSERT_TRUE(everything.wait_for(3));
+    EXPECT_EQ(tasks.received(), std::vector<std::string>{"task"});
+    EXPECT_EQ(users.received(), std::vector<std::string>{"hello"});
+    EXPECT_EQ(everything.received(), (std::vector<std::string>{"task", "hello", "env"}));
+
+    auto stats = server.stats();
+    EXPECT_EQ(stats.connections_accepted, 3u);
+    EXPECT_EQ(stats.messages_queued, 5u);
+    EXPECT_TRUE(eventually([&] { return server.stats().messages_sent == 5; }));
+}
+
+TEST(WebSocketServerTest, SubscriptionMessagesChangeTopics) {
+    WebSocketServer server(local_config());
+    ASSERT_TRUE(server.start().first);
+    Subscriber subscriber;
+    ASSERT_TRUE(subscriber.connect(url(server, "/events")));
+    EXPECT_FALSE(server.has_subscribers("metrics"));
+
+    subscriber.client.send(R"({"subscribe": ["metrics", "alerts"]})");
+    ASSERT_TRUE(eventually([&] { return server.has_subscribers("alerts"); }));
+    server.broadcast("metrics", text("m1"));
+    server.broadcast("alerts", text("a1"));
+    ASSERT_TRUE(subscriber.wait_for(2));
+
+    subscriber.client.send(R"({"unsubscribe": "metrics"})");
+    subscriber.client.send("not json");
+    ASSERT_TRUE(eventually([&] { return !server.has_subscribers("metrics"); }));
+    EXPECT_EQ(server.broadcast("metrics", text("m2")), 0u);
+    server.broadcast("alerts", text("a2"));
+    ASSERT_TRUE(subscriber.wait_for(3));
+    EXPECT_EQ(subscriber.received(), (std::vector<std::string>{"m1", "a1", "a2"}));
+}
+
+TEST(WebSocketServerTest, BridgesEventBusWithOneSerializationPerEvent) {
+    core::EventBus bus;
+    WebSocketServer server(local_config());
+    ASSERT_TRUE(server.start().first);
+    server.bridge(bus, {"ai.processing", "user.request"});
+
+    // Nobody listening yet: nothing is serialized
+    bus.publish("ai.processing", core::cortana_events::createTaskStarted("t0")).get();
+    EXPECT_EQ(server.stats().events_serialized, 0u);
+
+    std::vector<std::unique_ptr<Subscriber>> subscribers;
+    for (int i = 0; i < 3; ++i) {
+        subscribers.push_back(std::make_unique<Subscriber>());
+        ASSERT_TRUE(subscribers.back()->connect(url(server, "/events?topics=ai.processing")));
+    }
+    ASSERT_TRUE(eventually([&] { return server.client_count() == 3; }));
+
+    bus.publish("ai.processing", core::cortana_events::createTaskProgress("t1", "half way")).get();
+    bus.publish("user.request", core::cortana_events::createUserCommand("status")).get();
+    for (auto& subscriber : subscribers) {
+        ASSERT_TRUE(subscriber->wait_for(1));
+    }
+
+    auto stats = server.stats();
+    EXPECT_EQ(stats.events_serialized, 1u);   // user.request had no subscribers
+    EXPECT_EQ(stats.messages_queued, 3u);
+
+    auto first = subscribers[0]->received();
+    ASSERT_EQ(first.size(), 1u);
+    for (auto& subscriber : subscribers) {
+        EXPECT_EQ(subscriber->received(), first);
+    }
+    auto json = nlohmann::json::parse(first[0]);
+    EXPECT_EQ(json["topic"], "ai.processing");
+    EXPECT_EQ(json["type"], "ai.processing");
+    EXPECT_EQ(json["task_id"], "t1");
+    EXPECT_EQ(json["stage"], "progress");
+    EXPECT_EQ(json["details"], "half way");
+}
+
+namespace {
+
+// Completes the WebSocket handshake and then reads nothing until asked, so
+// the server's queue for it backs up
+class StalledClient {
+public:
+    StalledClient(unsigned short port, const std::string& target) : ws_(io_context_) {
+        namespace net = boost::asio;
+        auto& socket = ws_.next_layer();
+        socket.open(net::ip::tcp::v4());
+        socket.set_option(net::socket_base::receive_buffer_size(4096));
+        socket.connect({net::ip::make_address("127.0.0.1"), port});
+        ws_.handshake("127.0.0.1", target);
+    }
+
+    // Reads until `done` accepts a message, giving up after five seconds
+    std::vector<std::string> read_until(const std::function<bool(const std::string&)>& done) {
+        std::vector<std::string> messages;
+        bool finished = false;
+        std::function<void()> read_next = [&] {
+            ws_.async_read(buffer_, [&](const boost::system::error_code& ec, size_t) {
+                if (ec) return;
+                messages.push_back(boost::beast::buffers_to_string(buffer_.data()));
+                buffer_.consume(buffer_.size());
+                if (done(messages.back())) {
+                    finished = true;
+                    return;
+                }
+                read_next();
+            });
+        };
+        read_next();
+        io_context_.run_for(5s);
+        EXPECT_TRUE(finished);
+        return messages;
+    }
+
+private:
+    boost::asio::io_context io_context_;
+    boost::beast::websocket::stream<boost::asio::ip::tcp::socket> ws_;
+    boost::beast::flat_buffer buffer_;
+};
+
+} // namespace
+
+namespace {
+
+// Status of an upgrade request sent with extra headers; 101 when accepted
+unsigned handshake_status(unsigned short port, const std::string& target,
+                          const std::vector<std::pair<boost::beast::http::field, std::string>>& headers) {
+    namespace net = boost::asio;
+    namespace http = boost::beast::http;
+    net::io_context io_context;
+    net::ip::tcp::socket socket(io_context);
+    socket.connect({net::ip::make_address("127.0.0.1"), port});
+
+    http::request<http::empty_body> request(http::verb::get, target, 11);
+    request.set(http::field::host, "127.0.0.1");
+    request.set(http::field::upgrade, "websocket");
+    request.set(http::field::connection, "upgrade");
+    request.set(http::field::sec_websocket_key, "dGhlIHNhbXBsZSBub25jZQ==");
+    request.set(http::field::sec_websocket_version, "13");
+    for (const auto& [field, value] : headers) request.set(field, value);
+    http::write(socket, request);
+
+    boost::beast::flat_buffer buffer;
+    http::response_parser<http::empty_body> response;
+    boost::system::error_code ec;
+    http::read_header(socket, buffer, response, ec);
+    return ec ? 0u : response.get().result_int();
+}
+
+} // namespace
+
+TEST(WebSocketServerTest, HandshakesCheckOriginTokenAndTopics) {
+    using boost::beast::http::field;
+    auto config = local_config();
+    config.allowed_origins = {"http://localhost:3000"};
+    config.authenticate = [](std::string_view token) -> std::optional<std::string> {
+        if (token == "ops-token") return std::string("ops");
+        if (token == "root-token") return std::string("root");
+        return std::nullopt;
+    };
+    config.authorize_subscription = [](const std::string& user, const std::string& topic) {
+        return user == "root" || topic == "ai.processing";
+    };
+    WebSocketServer server(config);
+    ASSERT_TRUE(server.start().first);
+    const auto port = server.port();
+
+    // A page on another site cannot connect, token or not
+    EXPECT_EQ(handshake_status(port, "/events?topics=ai.processing",
+                               {{field::origin, "https://evil.example"},
+                                {field::authorization, "Bearer root-token"}}), 403u);
+    EXPECT_EQ(handshake_status(port, "/events?topics=ai.processing&access_token=root-token",
+                               {{field::origin, "http://localhost:3000"}}), 101u);
+
+    EXPECT_EQ(handshake_status(port, "/events?topics=ai.processing", {}), 401u);
+    EXPECT_EQ(handshake_status(port, "/events?topics=ai.processing",
+                               {{field::authorization, "Bearer wrong"}}), 401u);
+    EXPECT_EQ(handshake_status(port, "/events?topics=ai.processing",
+                               {{field::authorization, "Bearer ops-token"}}), 101u);
+    EXPECT_EQ(handshake_status(port, "/events?topics=%2A",
+                               {{field::authorization, "Bearer ops-token"}}), 403u);
+    EXPECT_EQ(handshake_status(port, "/events?topics=%2A",
+                               {{field::authorization, "Bearer root-token"}}), 101u);
+    EXPECT_EQ(server.stats().handshakes_refused, 4u);
+
+    // Later subscribe messages drop the topics the user may not see
+    Subscriber subscriber;
+    ASSERT_TRUE(subscriber.connect(url(server, "/events?access_token=ops-token")));
+    subscriber.client.send(R"({"subscribe": ["user.request", "ai.processing"]})");
+    ASSERT_TRUE(eventually([&] { return server.has_subscribers("ai.processing"); }));
+    EXPECT_FALSE(server.has_subscribers("user.request"));
+    EXPECT_EQ(server.stats().subscriptions_denied, 1u);
+}
+
+TEST(WebSocketServerTest, SlowConsumersDropWithoutStallingOthers) {
+    auto config = local_config();
+    config.max_queued_messages = 8;
+    config.slow_consumer = SlowConsumerPolicy::DropOldest;
+    WebSocketServer server(config);
+    ASSERT_TRUE(server.start().first);
+
+    StalledClient stalled(server.port(), "/events?topics=tokens");
+    Subscriber fast;
+    ASSERT_TRUE(fast.connect(url(server, "/events?topics=tokens")));
+    ASSERT_TRUE(eventually([&] { return server.client_count() == 2; }));
+
+    // Far more than the socket buffers hold; the fast client keeps pace
+    const std::string payload(64 * 1024, 'x');
+    constexpr size_t kMessages = 300;
+    for (size_t i = 0; i < kMessages; ++i) {
+        server.broadcast("tokens", text(std::to_string(i) + ":" + payload));
+        ASSERT_TRUE(fast.wait_for(i + 1)) << "fast client stalled at " << i;
+    }
+    EXPECT_GT(server.stats().messages_dropped, 0u);
+
+    // The stalled client still gets the newest messages once it reads
+    auto messages = stalled.read_until([&](const std::string& message) {
+        return message.rfind(std::to_string(kMessages - 1) + ":", 0) == 0;
+    });
+    EXPECT_LT(messages.size(), kMessages);
+}
+
+TEST(WebSocketServerTest, SlowConsumersCoalesceByTopic) {
+    auto config = local_config();
+    config.max_queued_messages = 4;
+    config.slow_consumer = SlowConsumerPolicy::Coalesce;
+    WebSocketServer server(config);
+    ASSERT_TRUE(server.start().first);
+
+    StalledClient stalled(server.port(), "/events?topics=gpu,cpu");
+    ASSERT_TRUE(eventually([&] { return server.client_count() == 1; }));
+
+    const std::string padding(64 * 1024, ' ');
+    constexpr int kRounds = 200;
+    for (int i = 0; i < kRounds; ++i) {
+        server.broadcast("gpu", text("gpu " + std::to_string(i) + padding));
+        server.broadcast("cpu", text("cpu " + std::to_string(i) + padding));
+    }
+    auto stats = server.stats();
+    EXPECT_GT(stats.messages_coalesced, 0u);
+    EXPECT_EQ(stats.messages_dropped, 0u);   // there is always a queued one to replace
+
+    // Both topics end on their latest value
+    const std::string last = " " + std::to_string(kRounds - 1) + " ";
+    bool gpu_seen = false, cpu_seen = false;
+    stalled.read_until([&](const std::string& message) {
+        gpu_seen = gpu_seen || message.rfind("gpu" + last, 0) == 0;
+        cpu_seen = cpu_seen || message.rfind("cpu" + last, 0) == 0;
+        return gpu_seen && cpu_seen;
+    });
+}
+
+TEST(WebSocketServerTest, StopClosesClients) {
+    WebSocketServer server(local_config());
+    ASSERT_TRUE(server.start().first);
+    Subscriber subscriber;
+    ASSERT_TRUE(subscriber.connect(url(server, "/events?topics=a")));
+    ASSERT_TRUE(eventually([&] { return server.client_count() == 1; }));
+
+    server.stop();
+    {
+        std::unique_lock<std::mutex> lock(subscriber.mutex);
+        EXPECT_TRUE(subscriber.arrived.wait_for(lock, 5s, [&] { return subscriber.closed; }));
+    }
+    EXPECT_TRUE(eventually([&] { return server.client_count() == 0; }));
+    EXPECT_EQ(server.broadcast("a", text("late")), 0u);
+
+    EXPECT_FALSE(WebSocketClient().connect(url(server, "/events")).get().first);
+
+    auto bad = local_config();
+    bad.max_queued_messages = 0;
+    EXPECT_THROW(WebSocketServer{bad}, std::invalid_argument);
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace cortan::network::test_support {
+
+// Minimal blocking HTTP/1.1 server on 127.0.0.1 for network tests. Each
+// accepted connection gets its own thread and serves keep-alive requests
+// until either side closes it.
+class LocalHttpServer {
+public:
+    using Request = boost::beast::http::request<boost::beast::http::string_body>;
+    using Response = boost::beast::http::response<boost::beast::http::string_body>;
+    using Handler = std::function<void(const Request&, Response&)>;
+    // Writes a chunked 200 response piece by piece; write_chunk returns false
+    // once the client has gone away
+    using ChunkWriter = std::function<bool(std::string_view chunk)>;
+    using Streamer = std::function<void(const Request&, const ChunkWriter& write_chunk)>;
+    using RequestFilter = std::function<bool(const Request&)>;
+
+    explicit LocalHttpServer(Handler handler = echo_handler())
+        : handler_(std::move(handler))
+        , acceptor_(io_context_, {boost::asio::ip::make_address("127.0.0.1"), 0}) {
+        accept_thread_ = std::thread([this] { accept_loop(); });
+    }
+
+    ~LocalHttpServer() { stop(); }
+
+    LocalHttpServer(const LocalHttpServer&) = delete;
+    LocalHttpServer& operator=(const LocalHttpServer&) = delete;
+
+    unsigned short port() const { return acceptor_.local_endpoint().port(); }
+    std::string url(const std::string& target = "/") const {
+        return "http://127.0.0.1:" + std::to_string(port()) + target;
+    }
+
+    // Subsequent requests are answered by the streamer instead of the
+    // handler; a content_encoding labels the bytes it writes. With a filter,
+    // only the requests it accepts are streamed.
+    void set_streamer(Streamer streamer, std::string content_encoding = "", RequestFilter filter = {}) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        streamer_ = std::move(streamer);
+        stream_encoding_ = std::move(content_encoding);
+        stream_filter_ = std::move(filter);
+    }
+
+    size_t connections_accepted() const { return accepted_.load(); }
+    size_t requests_served() const { return requests_.load(); }
+
+    // Server-side close of every open connection, as an idle timeout would
+    void close_connections() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& socket : sockets_) {
+            boost::system::error_code ec;
+            socket->shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+        }
+    }
+
+    void stop() {
+        if (stopped_.exchange(true)) {
+            return;
+        }
+        // A blocking accept() is not interrupted by close(); wake it with a
+        // throwaway connection first
+        boost::system::error_code ec;
+        boost::asio::ip::tcp::socket waker(io_context_);
+        waker.connect(acceptor_.local_endpoint(), ec);
+        if (accept_thread_.joinable()) accept_thread_.join();
+        acceptor_.close(ec);
+        close_connections();
+        for (auto& thread : connection_threads_) {
+            thread.join();
+        }
+    }
+
+    static Handler echo_handler() {
+        return [](const Request& req, Response& res) {
+            res.result(boost::beast::http::status::ok);
+            res.body() = std::string(req.target()) + (req.body().empty() ? "" : " " + req.body());
+        };
+    }
+
+private:
+    void accept_loop() {
+        while (!stopped_) {
+            auto socket = std::make_shared<boost::asio::ip::tcp::socket>(io_context_);
+            boost::system::error_code ec;
+            acceptor_.accept(*socket, ec);
+            if (ec || stopped_) return;
+
+            ++accepted_;
+            std::lock_guard<std::mutex> lock(mutex_);
+            sockets_.push_back(socket);
+            connection_threads_.emplace_back([this, socket] { serve(*socket); });
+        }
+    }
+
+    void serve(boost::asio::ip::tcp::socket& socket) {
+        namespace http = boost::beast::http;
+        // Back-to-back responses to pipelined requests must not wait on
+        // Nagle; production servers disable it too
+        boost::system::error_code ignored;
+        socket.set_option(boost::asio::ip::tcp::no_delay(true), ignored);
+        boost::beast::flat_buffer buffer;
+        while (true) {
+            // No body limit: tests and benchmarks post multi-megabyte payloads
+            http::request_parser<http::string_body> parser;
+            parser.body_limit(std::numeric_limits<std::uint64_t>::max());
+            boost::system::error_code ec;
+            http::read(socket, buffer, parser, ec);
+            if (ec) break;
+            Request req = parser.release();
+
+            Streamer streamer;
+            std::string encoding;
+            RequestFilter filter;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                streamer = streamer_;
+                encoding = stream_encoding_;
+                filter = stream_filter_;
+            }
+            if (streamer && (!filter || filter(req))) {
+                ++requests_;
+                if (!stream(socket, req, streamer, encoding)) break;
+                continue;
+            }
+
+            Response res{http::status::ok, req.version()};
+            res.keep_alive(req.keep_alive());
+            handler_(req, res);
+            res.prepare_payload();
+            ++requests_;
+
+            if (req.method() == http::verb::head) {
+                // The headers a GET would get, without the body
+                http::response_serializer<http::string_body> serializer(res);
+                http::write_header(socket, serializer, ec);
+            } else {
+                http::write(socket, res, ec);
+            }
+            if (ec || !res.keep_alive()) break;
+        }
+        boost::system::error_code ec;
+        socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+    }
+
+    static bool stream(boost::asio::ip::tcp::socket& socket, const Request& req, const Streamer& streamer,
+                       const std::string& encoding) {
+        namespace net = boost::asio;
+        boost::system::error_code ec;
+        std::string header = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n";
+        if (!encoding.empty()) {
+            header += "Content-Encoding: " + encoding + "\r\n";
+        }
+        header += "\r\n";
+        net::write(socket, net::buffer(header), ec);
+
+        streamer(req, [&](std::string_view chunk) {
+            if (ec || chunk.empty()) return !ec;
+            std::ostringstream framed;
+            framed << std::hex << chunk.size() << "\r\n" << chunk << "\r\n";
+            net::write(socket, net::buffer(framed.str()), ec);
+            return !ec;
+        });
+        if (!ec) net::write(socket, net::buffer(std::string_view("0\r\n\r\n")), ec);
+        return !ec;
+    }
+
+    Handler handler_;
+    Streamer streamer_;
+    std::string stream_encoding_;
+    RequestFilter stream_filter_;
+    boost::asio::io_context io_context_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    std::thread accept_thread_;
+
+    std::mutex mutex_;
+    std::list<std::shared_ptr<boost::asio::ip::tcp::socket>> sockets_;
+    std::list<std::thread> connection_threads_;
+
+    std::atomic<bool> stopped_{false};
+    std::atomic<size_t> accepted_{0};
+    std::atomic<size_t> requests_{0};
+};
+
+} // namespace cortan::network::test_support
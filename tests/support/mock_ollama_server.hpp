@@ -0,0 +1,188 @@
+#pragma once
+
+#include "local_http_server.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace cortan::ai::test_support {
+
+// Speaks enough of the Ollama HTTP API for tests and benchmarks: /api/tags
+// lists the scripted models, and /api/generate and /api/chat stream the
+// scripted tokens as NDJSON with Ollama's field layout, ending with a
+// "done" line carrying counts and timings. Like Ollama, an unknown model is
+// answered with 404 and a JSON {"error": ...} body.
+class MockOllamaServer {
+public:
+    struct Script {
+        std::vector<std::string> models = {"llama3:8b"};
+        std::vector<std::string> tokens = {"Hello", ",", " world", "!"};
+        std::chrono::milliseconds first_token_delay{0};   // prompt evaluation
+        std::chrono::milliseconds token_interval{0};
+        // Non-zero: write each line in pieces of this many bytes, so lines
+        // straddle chunk boundaries
+        size_t split_every = 0;
+        // Length of the token "context" array on the final /api/generate line
+        size_t context_length = 16;
+    };
+
+    MockOllamaServer() : MockOllamaServer(Script{}) {}
+    explicit MockOllamaServer(Script script)
+        : script_(std::move(script))
+        , server_([this](const Request& req, Response& res) { answer(req, res); }) {
+        server_.set_streamer([this](const Request& req, const ChunkWriter& write) { serve(req, write); }, "",
+                             [this](const Request& req) { return generates(req); });
+    }
+
+    std::string endpoint() const { return server_.url(""); }
+    size_t requests() const { return server_.requests_served(); }
+
+    void set_script(Script script) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        script_ = std::move(script);
+    }
+
+    std::string last_request_body() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return last_body_;
+    }
+
+    // The NDJSON stream /api/generate answers with, for parser tests and
+    // benchmarks that do not need a socket
+    static std::string generate_stream(const Script& script, const std::string& model = "llama3:8b") {
+        std::string stream;
+        for (const auto& token : script.tokens) stream += token_line(model, token, false) + "\n";
+        stream += done_line(model, script, false) + "\n";
+        return stream;
+    }
+
+private:
+    using Request = network::test_support::LocalHttpServer::Request;
+    using Response = network::test_support::LocalHttpServer::Response;
+    using ChunkWriter = network::test_support::LocalHttpServer::ChunkWriter;
+
+    static bool is_generation(std::string_view target) { return target == "/api/generate" || target == "/api/chat"; }
+
+    static std::string model_of(const Request& req) {
+        auto request = nlohmann::json::parse(req.body(), nullptr, false);
+        return request.is_object() ? request.value("model", "") : "";
+    }
+
+    bool has_model(const std::string& model) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return std::find(script_.models.begin(), script_.models.end(), model) != script_.models.end();
+    }
+
+    // Streamed: a generation with a model we have
+    bool generates(const Request& req) const {
+        std::string_view target(req.target().data(), req.target().size());
+        return is_generation(target) && has_model(model_of(req));
+    }
+
+    // Everything else: the model list, unknown models and unknown paths
+    void answer(const Request& req, Response& res) {
+        namespace http = boost::beast::http;
+        std::string_view target(req.target().data(), req.target().size());
+        res.set(http::field::content_type, "application/json");
+        if (target == "/api/tags") {
+            auto models = nlohmann::json::array();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (const auto& name : script_.models) models.push_back({{"name", name}, {"model", name}});
+            }
+            res.body() = nlohmann::json{{"models", std::move(models)}}.dump();
+            return;
+        }
+        res.result(http::status::not_found);
+        if (is_generation(target)) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                last_body_ = req.body();
+            }
+            std::string model = model_of(req);
+            res.body() = nlohmann::json{{"error", "model \"" + model + "\" not found, try pulling it first"}}.dump();
+        } else {
+            res.body() = nlohmann::json{{"error", "404 page not found"}}.dump();
+        }
+    }
+
+    static nlohmann::json base_line(const std::string& model) {
+        return {{"model", model}, {"created_at", "2026-10-18T09:00:00.000000Z"}};
+    }
+
+    static std::string token_line(const std::string& model, const std::string& token, bool chat) {
+        auto line = base_line(model);
+        if (chat) {
+            line["message"] = {{"role", "assistant"}, {"content", token}};
+        } else {
+            line["response"] = token;
+        }
+        line["done"] = false;
+        return line.dump();
+    }
+
+    static std::string done_line(const std::string& model, const Script& script, bool chat) {
+        auto line = base_line(model);
+        if (chat) {
+            line["message"] = {{"role", "assistant"}, {"content", ""}};
+        } else {
+            line["response"] = "";
+        }
+        line["done"] = true;
+        line["done_reason"] = "stop";
+        if (!chat) {
+            auto context = nlohmann::json::array();
+            for (size_t i = 0; i < script.context_length; ++i) context.push_back(128000 + i);
+            line["context"] = std::move(context);
+        }
+        line["total_duration"] = 5'250'000'000ULL;
+        line["load_duration"] = 12'000'000ULL;
+        line["prompt_eval_count"] = 26;
+        line["prompt_eval_duration"] = 130'000'000ULL;
+        line["eval_count"] = script.tokens.size();
+        line["eval_duration"] = 4'900'000'000ULL;
+        return line.dump();
+    }
+
+    void serve(const Request& req, const ChunkWriter& write) {
+        Script script;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            script = script_;
+            last_body_ = req.body();
+        }
+
+        auto write_line = [&](const std::string& line) {
+            std::string framed = line + "\n";
+            if (script.split_every == 0) return write(framed);
+            for (size_t at = 0; at < framed.size(); at += script.split_every) {
+                if (!write(std::string_view(framed).substr(at, script.split_every))) return false;
+            }
+            return true;
+        };
+
+        bool chat = req.target() == "/api/chat";
+        std::string model = model_of(req);
+
+        std::this_thread::sleep_for(script.first_token_delay);
+        for (size_t i = 0; i < script.tokens.size(); ++i) {
+            if (i > 0) std::this_thread::sleep_for(script.token_interval);
+            if (!write_line(token_line(model, script.tokens[i], chat))) return;
+        }
+        write_line(done_line(model, script, chat));
+    }
+
+    mutable std::mutex mutex_;
+    Script script_;
+    std::string last_body_;
+    network::test_support::LocalHttpServer server_;
+};
+
+} // namespace cortan::ai::test_support
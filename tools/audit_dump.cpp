@@ -0,0 +1,87 @@
+// Decodes security audit logs written by ai::AuditLog.
+//
+//   cortan_audit_dump [--json] FILE...
+//
+// Prints one record per line (JSON lines with --json) and a summary per file
+// on stderr. In text mode the event type and details are printed as JSON
+// strings, so a newline or control character in them cannot pass for
+// another record. Exits with 1 when a file cannot be read and 2 when a file has
+// damaged or torn records.
+
+#include <cortan/ai/audit_log.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string format_time(std::chrono::system_clock::time_point time) {
+    auto seconds = std::chrono::time_point_cast<std::chrono::seconds>(time);
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(time - seconds).count();
+    std::time_t time_value = std::chrono::system_clock::to_time_t(seconds);
+    std::tm utc{};
+    gmtime_r(&time_value, &utc);
+    std::ostringstream out;
+    out << std::put_time(&utc, "%Y-%m-%dT%H:%M:%S") << '.' << std::setw(6) << std::setfill('0') << micros << 'Z';
+    return out.str();
+}
+
+// JSON string syntax: quoted, with control characters escaped and invalid
+// UTF-8 replaced
+std::string quoted(const std::string& text) {
+    return nlohmann::json(text).dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool json = false;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else {
+            files.emplace_back(argv[i]);
+        }
+    }
+    if (files.empty()) {
+        std::cerr << "usage: " << argv[0] << " [--json] FILE...\n";
+        return 1;
+    }
+
+    int status = 0;
+    for (const auto& file : files) {
+        auto result = cortan::ai::AuditLog::read_file(file, [&](const cortan::ai::AuditRecord& record) {
+            if (json) {
+                nlohmann::json line = {{"sequence", record.sequence},
+                                       {"time", format_time(record.time)},
+                                       {"event_type", record.event_type},
+                                       {"details", record.details}};
+                std::cout << line.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) << '\n';
+            } else {
+                std::cout << record.sequence << ' ' << format_time(record.time) << ' ' << quoted(record.event_type)
+                          << ' ' << quoted(record.details) << '\n';
+            }
+        });
+
+        if (!result.error.empty()) {
+            std::cerr << result.error << '\n';
+            status = 1;
+            continue;
+        }
+        std::cerr << file << ": " << result.records << " records";
+        if (result.corrupt) std::cerr << ", " << result.corrupt << " corrupt";
+        if (result.truncated) std::cerr << ", truncated";
+        std::cerr << '\n';
+        if ((result.corrupt || result.truncated) && status == 0) status = 2;
+    }
+    return status;
+}